@@ -32,6 +32,8 @@
 
 #include <vector>
 #include <array>
+#include <functional>
+#include <system_error>
 
 #include "BlockchainExplorerData.h"
 
@@ -49,6 +51,10 @@ public:
 
 class IBlockchainExplorer {
 public:
+  typedef std::function<void(std::error_code)> Callback;
+  // Receives consecutive pages of a streamed request in request order, returning false stops the request
+  typedef std::function<bool(std::vector<BlockDetails>&& blocks)> BlocksHandler;
+
   virtual ~IBlockchainExplorer() {};
 
   virtual bool addObserver(IBlockchainObserver* observer) = 0;
@@ -61,6 +67,11 @@ public:
   virtual bool getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<BlockDetails>& blocks) = 0;
   virtual bool getBlocks(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<BlockDetails>& blocks, uint32_t& blocksNumberWithinTimestamps) = 0;
 
+  // Stream blocks without blocking the caller, keeping several node requests in flight.
+  // The callback is invoked once: after the last page, when the handler stops the request or on the first error.
+  virtual void getBlocks(uint32_t startHeight, uint32_t count, const BlocksHandler& handler, const Callback& callback) = 0;
+  virtual void getBlocks(std::vector<Crypto::Hash>&& blockHashes, const BlocksHandler& handler, const Callback& callback) = 0;
+
   virtual bool getBlockchainTop(BlockDetails& topBlock) = 0;
 
   virtual bool getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<TransactionDetails>& transactions) = 0;
@@ -140,6 +140,8 @@ public:
 
   // signing
   virtual void signInputKey(size_t input, const TransactionTypes::InputKeyInfo& info, const KeyPair& ephKeys) = 0;
+  // signs key inputs 0..inputs.size()-1 on up to threadCount threads, same as calling signInputKey for each of them
+  virtual void signInputKeys(const std::vector<std::pair<TransactionTypes::InputKeyInfo, KeyPair>>& inputs, size_t threadCount) = 0;
   virtual void signInputMultisignature(size_t input, const Crypto::PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) = 0;
   virtual void signInputMultisignature(size_t input, const KeyPair& ephemeralKeys) = 0;
 };
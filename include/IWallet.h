@@ -32,6 +32,7 @@
 
 #include <limits>
 #include <string>
+#include <system_error>
 #include <vector>
 #include "CryptoNote.h"
 
@@ -125,6 +126,11 @@ struct TransactionParameters {
   std::string changeDestination;
 };
 
+struct TransferBatchResult {
+  size_t transactionId = WALLET_INVALID_TRANSACTION_ID;
+  std::error_code error;
+};
+
 struct WalletTransactionWithTransfers {
   WalletTransaction transaction;
   std::vector<WalletTransfer> transfers;
@@ -135,6 +141,12 @@ struct TransactionsInBlockInfo {
   std::vector<WalletTransactionWithTransfers> transactions;
 };
 
+struct TransactionsFilter {
+  std::vector<std::string> addresses;
+  bool hasPaymentId = false;
+  Crypto::Hash paymentId;
+};
+
 class IWallet {
 public:
   virtual ~IWallet() {}
@@ -170,12 +182,17 @@ public:
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const = 0;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const = 0;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const = 0;
+  //returns only transactions with a transfer to one of filter.addresses (if any) and with filter.paymentId (if set)
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count, const TransactionsFilter& filter) const = 0;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const = 0;
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const = 0;
   virtual uint32_t getBlockCount() const  = 0;
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const = 0;
   virtual std::vector<size_t> getDelayedTransactionIds() const = 0;
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) = 0;
+  //plans all transactions together so they never pick the same outputs; failures are reported per transaction
+  virtual std::vector<TransferBatchResult> transferBatch(const std::vector<TransactionParameters>& sendingTransactions) = 0;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) = 0;
   virtual void commitTransaction(size_t transactionId) = 0;
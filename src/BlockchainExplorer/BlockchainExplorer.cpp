@@ -30,8 +30,12 @@
 
 #include "BlockchainExplorer.h"
 
+#include <algorithm>
 #include <future>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
 
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
@@ -91,6 +95,154 @@ private:
   const std::function<void(const INode::Callback&)> requestFunc;
 };
 
+namespace {
+
+const size_t BLOCKS_STREAM_PAGE_SIZE = 100;
+const size_t BLOCKS_STREAM_MAX_PAGES_IN_FLIGHT = 4;
+
+}
+
+// Splits a streamed request into pages and keeps up to BLOCKS_STREAM_MAX_PAGES_IN_FLIGHT of them requested
+// ahead of the handler. Pages completing out of order wait for their predecessors, so at most that many
+// pages are held in memory at once.
+class BlocksStream : public std::enable_shared_from_this<BlocksStream> {
+public:
+  typedef std::function<void(size_t page, std::vector<BlockDetails>& blocks, const INode::Callback& callback)> PageRequest;
+
+  BlocksStream(size_t pageCount, PageRequest&& pageRequest, const IBlockchainExplorer::BlocksHandler& handler, const IBlockchainExplorer::Callback& callback,
+    const std::atomic<bool>& stopping, BlockchainExplorer::AsyncContextCounter& asyncContextCounter) :
+    pageCount(pageCount),
+    pageRequest(std::move(pageRequest)),
+    handler(handler),
+    callback(callback),
+    stopping(stopping),
+    asyncContextCounter(asyncContextCounter),
+    nextRequested(0),
+    nextDelivered(0),
+    delivering(false),
+    finished(false) {
+  }
+
+  void start() {
+    requestPages();
+  }
+
+private:
+  void requestPages() {
+    for (;;) {
+      size_t page;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (finished || nextRequested == pageCount || nextRequested == nextDelivered + BLOCKS_STREAM_MAX_PAGES_IN_FLIGHT) {
+          return;
+        }
+
+        if (stopping.load()) {
+          finished = true;
+          lock.unlock();
+          callback(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::NOT_INITIALIZED));
+          return;
+        }
+
+        page = nextRequested++;
+      }
+
+      std::shared_ptr<BlocksStream> self = shared_from_this();
+      std::shared_ptr<std::vector<BlockDetails>> blocks = std::make_shared<std::vector<BlockDetails>>();
+      NodeRequest request([this, page, blocks](const INode::Callback& callback) {
+        pageRequest(page, *blocks, callback);
+      });
+
+      request.performAsync(asyncContextCounter, [self, page, blocks](std::error_code ec) {
+        self->pageCompleted(page, std::move(*blocks), ec);
+      });
+    }
+  }
+
+  void pageCompleted(size_t page, std::vector<BlockDetails>&& blocks, std::error_code ec) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (finished) {
+        return;
+      }
+
+      if (ec) {
+        finished = true;
+      } else {
+        completedPages.emplace(page, std::move(blocks));
+        if (delivering) {
+          return;
+        }
+
+        delivering = true;
+      }
+    }
+
+    if (ec) {
+      callback(ec);
+      return;
+    }
+
+    deliverPages();
+    requestPages();
+  }
+
+  void deliverPages() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      auto it = completedPages.find(nextDelivered);
+      if (finished || it == completedPages.end()) {
+        delivering = false;
+        return;
+      }
+
+      std::vector<BlockDetails> blocks = std::move(it->second);
+      completedPages.erase(it);
+      lock.unlock();
+
+      bool proceed = false;
+      std::error_code ec;
+      try {
+        proceed = handler(std::move(blocks));
+      } catch (std::system_error& e) {
+        ec = e.code();
+      } catch (...) {
+        ec = make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::INTERNAL_ERROR);
+      }
+
+      lock.lock();
+      if (finished) {
+        delivering = false;
+        return;
+      }
+
+      ++nextDelivered;
+      if (ec || !proceed || nextDelivered == pageCount) {
+        finished = true;
+        delivering = false;
+        completedPages.clear();
+        lock.unlock();
+        callback(ec);
+        return;
+      }
+    }
+  }
+
+  const size_t pageCount;
+  const PageRequest pageRequest;
+  const IBlockchainExplorer::BlocksHandler handler;
+  const IBlockchainExplorer::Callback callback;
+  const std::atomic<bool>& stopping;
+  BlockchainExplorer::AsyncContextCounter& asyncContextCounter;
+
+  std::mutex mutex;
+  std::map<size_t, std::vector<BlockDetails>> completedPages;
+  size_t nextRequested;
+  size_t nextDelivered;
+  bool delivering;
+  bool finished;
+};
+
 BlockchainExplorer::PoolUpdateGuard::PoolUpdateGuard() :
   m_state(State::NONE) {
 }
@@ -158,6 +310,7 @@ BlockchainExplorer::BlockchainExplorer(INode& node, Logging::ILogger& logger) :
   node(node), 
   logger(logger, "BlockchainExplorer"),
   state(NOT_INITIALIZED), 
+  stopping(false),
   synchronized(false), 
   observersCounter(0) {
 }
@@ -187,6 +340,7 @@ void BlockchainExplorer::init() {
     logger(ERROR) << "Init called on already initialized BlockchainExplorer.";
     throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::ALREADY_INITIALIZED));
   }
+  stopping.store(false);
   if (node.addObserver(this)) {
     state.store(INITIALIZED);
   } else {
@@ -208,6 +362,7 @@ void BlockchainExplorer::shutdown() {
     logger(ERROR) << "Shutdown called on not initialized BlockchainExplorer.";
     throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::NOT_INITIALIZED));
   }
+  stopping.store(true);
   node.removeObserver(this);
   asyncContextCounter.waitAsyncContextsFinish();
   state.store(NOT_INITIALIZED);
@@ -308,6 +463,93 @@ bool BlockchainExplorer::getBlocks(uint64_t timestampBegin, uint64_t timestampEn
   return true;
 }
 
+void BlockchainExplorer::getBlocks(uint32_t startHeight, uint32_t count, const BlocksHandler& handler, const Callback& callback) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::NOT_INITIALIZED));
+  }
+
+  if (count > std::numeric_limits<uint32_t>::max() - startHeight) {
+    throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::REQUEST_ERROR));
+  }
+
+  logger(DEBUGGING) << "Stream blocks by height request came.";
+  if (count == 0) {
+    callback(std::error_code());
+    return;
+  }
+
+  std::shared_ptr<BlocksStream> stream = std::make_shared<BlocksStream>(
+    (count + BLOCKS_STREAM_PAGE_SIZE - 1) / BLOCKS_STREAM_PAGE_SIZE,
+    [this, startHeight, count](size_t page, std::vector<BlockDetails>& blocks, const INode::Callback& callback) {
+      uint32_t begin = startHeight + static_cast<uint32_t>(page * BLOCKS_STREAM_PAGE_SIZE);
+      uint32_t end = begin + static_cast<uint32_t>(std::min<size_t>(BLOCKS_STREAM_PAGE_SIZE, startHeight + count - begin));
+      std::shared_ptr<std::vector<uint32_t>> heights = std::make_shared<std::vector<uint32_t>>();
+      heights->reserve(end - begin);
+      for (uint32_t height = begin; height != end; ++height) {
+        heights->push_back(height);
+      }
+
+      std::shared_ptr<std::vector<std::vector<BlockDetails>>> blocksByHeight = std::make_shared<std::vector<std::vector<BlockDetails>>>();
+      node.getBlocks(*heights, *blocksByHeight, [heights, blocksByHeight, &blocks, callback](std::error_code ec) {
+        if (!ec) {
+          for (std::vector<BlockDetails>& sameHeight : *blocksByHeight) {
+            std::move(sameHeight.begin(), sameHeight.end(), std::back_inserter(blocks));
+          }
+        }
+
+        callback(ec);
+      });
+    },
+    handler,
+    [this, callback](std::error_code ec) {
+      if (ec) {
+        logger(ERROR) << "Can't stream blocks by height: " << ec.message();
+      }
+
+      callback(ec);
+    },
+    stopping,
+    asyncContextCounter);
+
+  stream->start();
+}
+
+void BlockchainExplorer::getBlocks(std::vector<Hash>&& blockHashes, const BlocksHandler& handler, const Callback& callback) {
+  if (state.load() != INITIALIZED) {
+    throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::NOT_INITIALIZED));
+  }
+
+  logger(DEBUGGING) << "Stream blocks by hash request came.";
+  if (blockHashes.empty()) {
+    callback(std::error_code());
+    return;
+  }
+
+  std::shared_ptr<std::vector<Hash>> hashes = std::make_shared<std::vector<Hash>>(std::move(blockHashes));
+  std::shared_ptr<BlocksStream> stream = std::make_shared<BlocksStream>(
+    (hashes->size() + BLOCKS_STREAM_PAGE_SIZE - 1) / BLOCKS_STREAM_PAGE_SIZE,
+    [this, hashes](size_t page, std::vector<BlockDetails>& blocks, const INode::Callback& callback) {
+      size_t begin = page * BLOCKS_STREAM_PAGE_SIZE;
+      size_t end = std::min(hashes->size(), begin + BLOCKS_STREAM_PAGE_SIZE);
+      std::shared_ptr<std::vector<Hash>> pageHashes = std::make_shared<std::vector<Hash>>(hashes->begin() + begin, hashes->begin() + end);
+      node.getBlocks(*pageHashes, blocks, [pageHashes, callback](std::error_code ec) {
+        callback(ec);
+      });
+    },
+    handler,
+    [this, callback](std::error_code ec) {
+      if (ec) {
+        logger(ERROR) << "Can't stream blocks by hash: " << ec.message();
+      }
+
+      callback(ec);
+    },
+    stopping,
+    asyncContextCounter);
+
+  stream->start();
+}
+
 bool BlockchainExplorer::getBlockchainTop(BlockDetails& topBlock) {
   if (state.load() != INITIALIZED) {
     throw std::system_error(make_error_code(CryptoNote::error::BlockchainExplorerErrorCodes::NOT_INITIALIZED));
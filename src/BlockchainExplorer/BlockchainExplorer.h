@@ -65,6 +65,9 @@ public:
   virtual bool getBlocks(const std::vector<Crypto::Hash>& blockHashes, std::vector<BlockDetails>& blocks) override;
   virtual bool getBlocks(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<BlockDetails>& blocks, uint32_t& blocksNumberWithinTimestamps) override;
 
+  virtual void getBlocks(uint32_t startHeight, uint32_t count, const BlocksHandler& handler, const Callback& callback) override;
+  virtual void getBlocks(std::vector<Crypto::Hash>&& blockHashes, const BlocksHandler& handler, const Callback& callback) override;
+
   virtual bool getBlockchainTop(BlockDetails& topBlock) override;
 
   virtual bool getTransactions(const std::vector<Crypto::Hash>& transactionHashes, std::vector<TransactionDetails>& transactions) override;
@@ -116,6 +119,7 @@ private:
   std::unordered_set<Crypto::Hash> knownPoolState;
 
   std::atomic<State> state;
+  std::atomic<bool> stopping;
   std::atomic<bool> synchronized;
   std::atomic<uint32_t> observersCounter;
   Tools::ObserverManager<IBlockchainObserver> observerManager;
@@ -34,6 +34,7 @@
 #include <boost/range/combine.hpp>
 
 #include "Common/StringTools.h"
+#include "CryptoNoteCore/BlockchainIndices.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionExtra.h"
@@ -242,7 +243,14 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
   }
   transactionDetails.totalInputsAmount = inputsAmount;
 
-  if (transaction.inputs.size() > 0 && transaction.inputs.front().type() == typeid(BaseInput)) {
+  ExplorerTransactionEntry indexEntry;
+  bool indexed = transactionDetails.inBlockchain && core.getExplorerTransaction(hash, indexEntry) &&
+    indexEntry.inputs.size() == transaction.inputs.size() && indexEntry.globalIndexes.size() == transaction.outputs.size();
+
+  if (indexed) {
+    transactionDetails.fee = indexEntry.fee;
+    transactionDetails.mixin = indexEntry.mixin;
+  } else if (transaction.inputs.size() > 0 && transaction.inputs.front().type() == typeid(BaseInput)) {
     //It's gen transaction
     transactionDetails.fee = 0;
     transactionDetails.mixin = 0;
@@ -260,7 +268,9 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
   }
 
   Crypto::Hash paymentId;
-  if (getPaymentId(transaction, paymentId)) {
+  if (indexed) {
+    transactionDetails.paymentId = indexEntry.hasPaymentId ? indexEntry.paymentId : boost::value_initialized<Crypto::Hash>();
+  } else if (getPaymentId(transaction, paymentId)) {
     transactionDetails.paymentId = paymentId;
   } else {
     transactionDetails.paymentId = boost::value_initialized<Crypto::Hash>();
@@ -279,7 +289,8 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
   }
 
   transactionDetails.inputs.reserve(transaction.inputs.size());
-  for (const TransactionInput& txIn : transaction.inputs) {
+  for (size_t inputIndex = 0; inputIndex < transaction.inputs.size(); ++inputIndex) {
+    const TransactionInput& txIn = transaction.inputs[inputIndex];
     TransactionInputDetails txInDetails;
 
     if (txIn.type() == typeid(BaseInput)) {
@@ -293,28 +304,38 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
     } else if (txIn.type() == typeid(KeyInput)) {
       TransactionInputToKeyDetails txInToKeyDetails;
       const KeyInput& txInToKey = boost::get<KeyInput>(txIn);
-      std::list<std::pair<Crypto::Hash, size_t>> outputReferences;
-      if (!core.scanOutputkeysForIndices(txInToKey, outputReferences)) {
-        return false;
+      if (indexed) {
+        txInToKeyDetails.output.number = indexEntry.inputs[inputIndex].number;
+        txInToKeyDetails.output.transactionHash = indexEntry.inputs[inputIndex].transactionHash;
+      } else {
+        std::list<std::pair<Crypto::Hash, size_t>> outputReferences;
+        if (!core.scanOutputkeysForIndices(txInToKey, outputReferences)) {
+          return false;
+        }
+        txInToKeyDetails.output.number = outputReferences.back().second;
+        txInToKeyDetails.output.transactionHash = outputReferences.back().first;
       }
       txInDetails.amount = txInToKey.amount;
       txInToKeyDetails.outputIndexes = txInToKey.outputIndexes;
       txInToKeyDetails.keyImage = txInToKey.keyImage;
       txInToKeyDetails.mixin = txInToKey.outputIndexes.size();
-      txInToKeyDetails.output.number = outputReferences.back().second;
-      txInToKeyDetails.output.transactionHash = outputReferences.back().first;
       txInDetails.input = txInToKeyDetails;
     } else if (txIn.type() == typeid(MultisignatureInput)) {
       TransactionInputMultisignatureDetails txInMultisigDetails;
       const MultisignatureInput& txInMultisig = boost::get<MultisignatureInput>(txIn);
       txInDetails.amount = txInMultisig.amount;
       txInMultisigDetails.signatures = txInMultisig.signatureCount;
-      std::pair<Crypto::Hash, size_t> outputReference;
-      if (!core.getMultisigOutputReference(txInMultisig, outputReference)) {
-        return false;
+      if (indexed) {
+        txInMultisigDetails.output.number = indexEntry.inputs[inputIndex].number;
+        txInMultisigDetails.output.transactionHash = indexEntry.inputs[inputIndex].transactionHash;
+      } else {
+        std::pair<Crypto::Hash, size_t> outputReference;
+        if (!core.getMultisigOutputReference(txInMultisig, outputReference)) {
+          return false;
+        }
+        txInMultisigDetails.output.number = outputReference.second;
+        txInMultisigDetails.output.transactionHash = outputReference.first;
       }
-      txInMultisigDetails.output.number = outputReference.second;
-      txInMultisigDetails.output.transactionHash = outputReference.first;
       txInDetails.input = txInMultisigDetails;
     } else {
       return false;
@@ -325,7 +346,9 @@ bool BlockchainExplorerDataBuilder::fillTransactionDetails(const Transaction& tr
   transactionDetails.outputs.reserve(transaction.outputs.size());
   std::vector<uint32_t> globalIndices;
   globalIndices.reserve(transaction.outputs.size());
-  if (!transactionDetails.inBlockchain || !core.get_tx_outputs_gindexs(hash, globalIndices)) {
+  if (indexed) {
+    globalIndices = std::move(indexEntry.globalIndexes);
+  } else if (!transactionDetails.inBlockchain || !core.get_tx_outputs_gindexs(hash, globalIndices)) {
     for (size_t i = 0; i < transaction.outputs.size(); ++i) {
       globalIndices.push_back(0);
     }
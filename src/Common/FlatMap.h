@@ -0,0 +1,183 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Common {
+
+// Associative container kept as a vector of pairs sorted by key. Lookups are binary searches over contiguous memory
+// and iteration visits keys in ascending order like std::map; insertion and erasure move the following elements.
+template <typename Key, typename Value>
+class FlatMap {
+public:
+  typedef std::pair<Key, Value> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  // Builds the map from items in any order, of items with equal keys the last one is kept
+  static FlatMap fromUnsorted(std::vector<value_type>&& items) {
+    FlatMap map;
+    map.items = std::move(items);
+    if (!std::is_sorted(map.items.begin(), map.items.end(), &FlatMap::less)) {
+      std::stable_sort(map.items.begin(), map.items.end(), &FlatMap::less);
+    }
+
+    auto out = map.items.begin();
+    for (auto it = map.items.begin(); it != map.items.end(); ++it) {
+      if (out != map.items.begin() && (out - 1)->first == it->first) {
+        *(out - 1) = std::move(*it);
+      } else {
+        if (out != it) {
+          *out = std::move(*it);
+        }
+
+        ++out;
+      }
+    }
+
+    map.items.erase(out, map.items.end());
+    return map;
+  }
+
+  iterator begin() {
+    return items.begin();
+  }
+
+  const_iterator begin() const {
+    return items.begin();
+  }
+
+  iterator end() {
+    return items.end();
+  }
+
+  const_iterator end() const {
+    return items.end();
+  }
+
+  bool empty() const {
+    return items.empty();
+  }
+
+  size_t size() const {
+    return items.size();
+  }
+
+  void clear() {
+    items.clear();
+  }
+
+  void swap(FlatMap& other) {
+    items.swap(other.items);
+  }
+
+  iterator find(const Key& key) {
+    auto it = lowerBound(key);
+    return it != items.end() && it->first == key ? it : items.end();
+  }
+
+  const_iterator find(const Key& key) const {
+    auto it = lowerBound(key);
+    return it != items.end() && it->first == key ? it : items.end();
+  }
+
+  size_t count(const Key& key) const {
+    return find(key) != items.end() ? 1 : 0;
+  }
+
+  Value& at(const Key& key) {
+    auto it = find(key);
+    if (it == items.end()) {
+      throw std::out_of_range("FlatMap::at");
+    }
+
+    return it->second;
+  }
+
+  const Value& at(const Key& key) const {
+    auto it = find(key);
+    if (it == items.end()) {
+      throw std::out_of_range("FlatMap::at");
+    }
+
+    return it->second;
+  }
+
+  Value& operator[](const Key& key) {
+    auto it = lowerBound(key);
+    if (it == items.end() || key < it->first) {
+      it = items.emplace(it, key, Value());
+    }
+
+    return it->second;
+  }
+
+  // Inserts value unless key is present, like std::map::emplace
+  template <typename V>
+  std::pair<iterator, bool> emplace(const Key& key, V&& value) {
+    auto it = lowerBound(key);
+    if (it != items.end() && !(key < it->first)) {
+      return std::make_pair(it, false);
+    }
+
+    return std::make_pair(items.emplace(it, key, std::forward<V>(value)), true);
+  }
+
+  size_t erase(const Key& key) {
+    auto it = find(key);
+    if (it == items.end()) {
+      return 0;
+    }
+
+    items.erase(it);
+    return 1;
+  }
+
+private:
+  static bool less(const value_type& left, const value_type& right) {
+    return left.first < right.first;
+  }
+
+  iterator lowerBound(const Key& key) {
+    return std::lower_bound(items.begin(), items.end(), key, [](const value_type& item, const Key& key) { return item.first < key; });
+  }
+
+  const_iterator lowerBound(const Key& key) const {
+    return std::lower_bound(items.begin(), items.end(), key, [](const value_type& item, const Key& key) { return item.first < key; });
+  }
+
+  std::vector<value_type> items;
+};
+
+}
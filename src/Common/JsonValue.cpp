@@ -30,11 +30,265 @@
 
 
 #include "JsonValue.h"
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+#include "JsonWriter.h"
 
 namespace Common {
 
+namespace {
+
+bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+const char* skipWhitespace(const char* current, const char* end) {
+  // most runs are a single space or none, check them before setting up the vector loop
+  if (current == end || !isWhitespace(*current)) {
+    return current;
+  }
+
+  ++current;
+#if defined(__SSE2__) && defined(__GNUC__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i newLine = _mm_set1_epi8('\n');
+  const __m128i carriageReturn = _mm_set1_epi8('\r');
+  const __m128i tab = _mm_set1_epi8('\t');
+  while (end - current >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+    __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newLine)),
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn), _mm_cmpeq_epi8(chunk, tab)));
+    unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(whitespace)) & 0xffff;
+    if (mask != 0) {
+      return current + __builtin_ctz(mask);
+    }
+
+    current += 16;
+  }
+#endif
+
+  while (current != end && isWhitespace(*current)) {
+    ++current;
+  }
+
+  return current;
+}
+
+// Returns the first quote or backslash
+const char* findStringDelimiter(const char* current, const char* end) {
+#if defined(__SSE2__) && defined(__GNUC__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (end - current >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash))));
+    if (mask != 0) {
+      return current + __builtin_ctz(mask);
+    }
+
+    current += 16;
+  }
+#endif
+
+  while (current != end && *current != '"' && *current != '\\') {
+    ++current;
+  }
+
+  return current;
+}
+
+// Recursive descent parser over a memory buffer
+class JsonParser {
+public:
+  JsonParser(const char* begin, const char* end) : current(begin), end(end) {
+  }
+
+  void parse(JsonValue& value) {
+    readValue(value, readNonWsChar());
+  }
+
+  const char* position() const {
+    return current;
+  }
+
+private:
+  const char* current;
+  const char* end;
+
+  char readNonWsChar() {
+    current = skipWhitespace(current, end);
+    if (current == end) {
+      throw std::runtime_error("Unable to parse: unexpected end of stream");
+    }
+
+    return *current++;
+  }
+
+  void expect(const char* rest, size_t size) {
+    if (static_cast<size_t>(end - current) < size || !std::equal(rest, rest + size, current)) {
+      throw std::runtime_error("Unable to parse");
+    }
+
+    current += size;
+  }
+
+  void readValue(JsonValue& value, char c) {
+    if (c == '[') {
+      readArray(value);
+    } else if (c == 't') {
+      expect("rue", 3);
+      value = JsonValue(true);
+    } else if (c == 'f') {
+      expect("alse", 4);
+      value = JsonValue(false);
+    } else if ((c == '-') || (c >= '0' && c <= '9')) {
+      readNumber(value);
+    } else if (c == 'n') {
+      expect("ull", 3);
+      value = nullptr;
+    } else if (c == '{') {
+      readObject(value);
+    } else if (c == '"') {
+      std::string text;
+      readString(text);
+      value = std::move(text);
+    } else {
+      throw std::runtime_error("Unable to parse");
+    }
+  }
+
+  void readArray(JsonValue& value) {
+    JsonValue::Array array;
+    char c = readNonWsChar();
+    if (c != ']') {
+      for (;;) {
+        array.emplace_back();
+        readValue(array.back(), c);
+        c = readNonWsChar();
+        if (c == ']') {
+          break;
+        }
+
+        if (c != ',') {
+          throw std::runtime_error("Unable to parse");
+        }
+
+        c = readNonWsChar();
+      }
+    }
+
+    value = std::move(array);
+  }
+
+  void readObject(JsonValue& value) {
+    std::vector<JsonValue::Object::value_type> members;
+    char c = readNonWsChar();
+    if (c != '}') {
+      for (;;) {
+        if (c != '"') {
+          throw std::runtime_error("Unable to parse");
+        }
+
+        members.emplace_back();
+        readString(members.back().first);
+        if (readNonWsChar() != ':') {
+          throw std::runtime_error("Unable to parse");
+        }
+
+        readValue(members.back().second, readNonWsChar());
+        c = readNonWsChar();
+        if (c == '}') {
+          break;
+        }
+
+        if (c != ',') {
+          throw std::runtime_error("Unable to parse");
+        }
+
+        c = readNonWsChar();
+      }
+    }
+
+    value = JsonValue::Object::fromUnsorted(std::move(members));
+  }
+
+  // Escape sequences are kept as written, a backslash only stops the next character from ending the string
+  void readString(std::string& text) {
+    for (;;) {
+      const char* delimiter = findStringDelimiter(current, end);
+      if (delimiter == end) {
+        throw std::runtime_error("Unable to parse: unexpected end of stream");
+      }
+
+      text.append(current, delimiter);
+      current = delimiter + 1;
+      if (*delimiter == '"') {
+        return;
+      }
+
+      if (current == end) {
+        throw std::runtime_error("Unable to parse: unexpected end of stream");
+      }
+
+      text += '\\';
+      text += *current++;
+    }
+  }
+
+  void readNumber(JsonValue& value) {
+    const char* begin = current - 1;
+    size_t dots = 0;
+    while (current != end && ((*current >= '0' && *current <= '9') || *current == '.')) {
+      if (*current == '.') {
+        ++dots;
+      }
+
+      ++current;
+    }
+
+    bool exponent = current != end && (*current == 'e' || *current == 'E');
+    if (exponent) {
+      ++current;
+      if (current != end && (*current == '+' || *current == '-')) {
+        ++current;
+      }
+
+      if (current == end || *current < '0' || *current > '9') {
+        throw std::runtime_error("Unable to parse");
+      }
+
+      while (current != end && *current >= '0' && *current <= '9') {
+        ++current;
+      }
+    }
+
+    if (dots > 1 || (*begin == '-' && current - begin == 1)) {
+      throw std::runtime_error("Unable to parse");
+    }
+
+    // strtod and strtoll need a terminated string
+    std::string text(begin, current);
+    if (dots > 0 || exponent) {
+      value = std::strtod(text.c_str(), nullptr);
+    } else {
+      if (text.size() > 1 && ((text[0] == '0') || (text[0] == '-' && text[1] == '0'))) {
+        throw std::runtime_error("Unable to parse");
+      }
+
+      value = static_cast<JsonValue::Integer>(std::strtoll(text.c_str(), nullptr, 10));
+    }
+  }
+};
+
+}
+
 JsonValue::JsonValue() : type(NIL) {
 }
 
@@ -586,147 +840,35 @@ size_t JsonValue::erase(const Key& key) {
 }
 
 JsonValue JsonValue::fromString(const std::string& source) {
-  JsonValue jsonValue;
-  std::istringstream stream(source);
-  stream >> jsonValue;
-  if (stream.fail()) {
-    throw std::runtime_error("Unable to parse JsonValue");
-  }
+  return fromString(source.data(), source.data() + source.size());
+}
 
+JsonValue JsonValue::fromString(const char* begin, const char* end) {
+  JsonValue jsonValue;
+  JsonParser(begin, end).parse(jsonValue);
   return jsonValue;
 }
 
 std::string JsonValue::toString() const {
-  std::ostringstream stream;
-  stream << *this;
-  return stream.str();
+  std::string text;
+  JsonWriter(text).writeValue(*this);
+  return text;
 }
 
 std::ostream& operator<<(std::ostream& out, const JsonValue& jsonValue) {
-  switch (jsonValue.type) {
-  case JsonValue::ARRAY: {
-    const JsonValue::Array& array = *reinterpret_cast<const JsonValue::Array*>(jsonValue.valueArray);
-    out << '[';
-    if (array.size() > 0) {
-      out << array[0];
-      for (size_t i = 1; i < array.size(); ++i) {
-        out << ',' << array[i];
-      }
-    }
-
-    out << ']';
-    break;
-  }
-  case JsonValue::BOOL:
-    out << (jsonValue.valueBool ? "true" : "false");
-    break;
-  case JsonValue::INTEGER:
-    out << jsonValue.valueInteger;
-    break;
-  case JsonValue::NIL:
-    out << "null";
-    break;
-  case JsonValue::OBJECT: {
-    const JsonValue::Object& object = *reinterpret_cast<const JsonValue::Object*>(jsonValue.valueObject);
-    out << '{';
-    auto iter = object.begin();
-    if (iter != object.end()) {
-      out << '"' << iter->first << "\":" << iter->second;
-      ++iter;
-      for (; iter != object.end(); ++iter) {
-        out << ",\"" << iter->first << "\":" << iter->second;
-      }
-    }
-
-    out << '}';
-    break;
-  }
-  case JsonValue::REAL: {
-    std::ostringstream stream;
-    stream << std::fixed << std::setprecision(11) << jsonValue.valueReal;
-    std::string value = stream.str();
-    while (value.size() > 1 && value[value.size() - 2] != '.' && value[value.size() - 1] == '0') {
-      value.resize(value.size() - 1);
-    }
-
-    out << value;
-    break;
-  }
-  case JsonValue::STRING:
-    out << '"' << *reinterpret_cast<const JsonValue::String*>(jsonValue.valueString) << '"';
-    break;
-  }
-
+  out << jsonValue.toString();
   return out;
 }
 
-
-namespace {
-
-char readChar(std::istream& in) {
-  char c;
-
-  if (!(in >> c)) {
-    throw std::runtime_error("Unable to parse: unexpected end of stream");
-  }
-
-  return c;
-}
-
-char readNonWsChar(std::istream& in) {
-  char c;
-
-  do {
-    c = readChar(in);
-  } while (isspace(c));
-
-  return c;
-}
-
-std::string readStringToken(std::istream& in) {
-  char c;
-  std::string value;
-
-  while (in) {
-    c = readChar(in);
-
-    if (c == '"') {
-      break;
-    }
-
-    if (c == '\\') {
-      value += c;
-      c = readChar(in);
-    }
-
-    value += c;
-  }
-
-  return value;
-}
-
-}
-
-
+// Reads the remaining stream into memory and parses it; seekable streams are positioned right after the value
 std::istream& operator>>(std::istream& in, JsonValue& jsonValue) {
-  char c = readNonWsChar(in);
-
-  if (c == '[') {
-    jsonValue.readArray(in);
-  } else if (c == 't') {
-    jsonValue.readTrue(in);
-  } else if (c == 'f') {
-    jsonValue.readFalse(in);
-  } else if ((c == '-') || (c >= '0' && c <= '9')) {
-    jsonValue.readNumber(in, c);
-  } else if (c == 'n') {
-    jsonValue.readNull(in);
-  } else if (c == '{') {
-    jsonValue.readObject(in);
-  } else if (c == '"') {
-    jsonValue.readString(in);
-  } else {
-    throw std::runtime_error("Unable to parse");
+  std::streampos start = in.tellg();
+  std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  JsonParser parser(text.data(), text.data() + text.size());
+  parser.parse(jsonValue);
+  if (start != std::streampos(-1)) {
+    in.clear();
+    in.seekg(start + static_cast<std::streamoff>(parser.position() - text.data()));
   }
 
   return in;
@@ -748,208 +890,4 @@ void JsonValue::destructValue() {
   }
 }
 
-void JsonValue::readArray(std::istream& in) {
-  JsonValue::Array value;
-  char c = readNonWsChar(in);
-
-  if(c != ']') {
-    in.putback(c);
-    for (;;) {
-      value.resize(value.size() + 1);
-      in >> value.back();
-      c = readNonWsChar(in);
-
-      if (c == ']') {
-        break;
-      }
-
-      if (c != ',') {
-        throw std::runtime_error("Unable to parse");
-      }
-    }
-  }
-
-  if (type != JsonValue::ARRAY) {
-    destructValue();
-    type = JsonValue::NIL;
-    new(valueArray)JsonValue::Array;
-    type = JsonValue::ARRAY;
-  }
-
-  reinterpret_cast<JsonValue::Array*>(valueArray)->swap(value);
-}
-
-void JsonValue::readTrue(std::istream& in) {
-  char data[3];
-  in.read(data, 3);
-  if (data[0] != 'r' || data[1] != 'u' || data[2] != 'e') {
-    throw std::runtime_error("Unable to parse");
-  }
-
-  if (type != JsonValue::BOOL) {
-    destructValue();
-    type = JsonValue::BOOL;
-  }
-
-  valueBool = true;
-}
-
-void JsonValue::readFalse(std::istream& in) {
-  char data[4];
-  in.read(data, 4);
-  if (data[0] != 'a' || data[1] != 'l' || data[2] != 's' || data[3] != 'e') {
-    throw std::runtime_error("Unable to parse");
-  }
-
-  if (type != JsonValue::BOOL) {
-    destructValue();
-    type = JsonValue::BOOL;
-  }
-
-  valueBool = false;
-}
-
-void JsonValue::readNull(std::istream& in) {
-  char data[3];
-  in.read(data, 3);
-  if (data[0] != 'u' || data[1] != 'l' || data[2] != 'l') {
-    throw std::runtime_error("Unable to parse");
-  }
-
-  if (type != JsonValue::NIL) {
-    destructValue();
-    type = JsonValue::NIL;
-  }
-}
-
-void JsonValue::readNumber(std::istream& in, char c) {
-  std::string text;
-  text += c;
-  size_t dots = 0;
-  for (;;) {
-    int i = in.peek();
-    if (i >= '0' && i <= '9') {
-      in.read(&c, 1);
-      text += c;
-    } else  if (i == '.') {
-      in.read(&c, 1);
-      text += '.';
-      ++dots;
-    } else {
-      break;
-    }
-  }
-
-  if (dots > 0) {
-    if (dots > 1) {
-      throw std::runtime_error("Unable to parse");
-    }
-
-    int i = in.peek();
-    if (in.peek() == 'e') {
-      in.read(&c, 1);
-      text += c;
-      i = in.peek();
-      if (i == '+') {
-        in.read(&c, 1);
-        text += c;
-        i = in.peek();
-      } else if (i == '-') {
-        in.read(&c, 1);
-        text += c;
-        i = in.peek();
-      }
-
-      if (i < '0' || i > '9') {
-        throw std::runtime_error("Unable to parse");
-      }
-
-      do {
-        in.read(&c, 1);
-        text += c;
-        i = in.peek();
-      } while (i >= '0' && i <= '9');
-    }
-
-    Real value;
-    std::istringstream(text) >> value;
-    if (type != REAL) {
-      destructValue();
-      type = REAL;
-    }
-
-    valueReal = value;
-  } else {
-    if (text.size() > 1 && ((text[0] == '0') || (text[0] == '-' && text[1] == '0'))) {
-      throw std::runtime_error("Unable to parse");
-    }
-
-    Integer value;
-    std::istringstream(text) >> value;
-    if (type != INTEGER) {
-      destructValue();
-      type = INTEGER;
-    }
-
-    valueInteger = value;
-  }
-}
-
-void JsonValue::readObject(std::istream& in) {
-  char c = readNonWsChar(in);
-  JsonValue::Object value;
-
-  if (c != '}') {
-    std::string name;
-
-    for (;;) {
-      if (c != '"') {
-        throw std::runtime_error("Unable to parse");
-      }
-
-      name = readStringToken(in);
-      c = readNonWsChar(in);
-
-      if (c != ':') {
-        throw std::runtime_error("Unable to parse");
-      }
-
-      in >> value[name];
-      c = readNonWsChar(in);
-
-      if (c == '}') {
-        break;
-      }
-
-      if (c != ',') {
-        throw std::runtime_error("Unable to parse");
-      }
-
-      c = readNonWsChar(in);
-    }
-  }
-
-  if (type != JsonValue::OBJECT) {
-    destructValue();
-    type = JsonValue::NIL;
-    new(valueObject)JsonValue::Object;
-    type = JsonValue::OBJECT;
-  }
-
-  reinterpret_cast<JsonValue::Object*>(valueObject)->swap(value);
-}
-
-void JsonValue::readString(std::istream& in) {
-  String value = readStringToken(in);
-
-  if (type != JsonValue::STRING) {
-    destructValue();
-    type = JsonValue::NIL;
-    new(valueString)String;
-    type = JsonValue::STRING;
-  }
-
-  reinterpret_cast<String*>(valueString)->swap(value);
-}
-
 }
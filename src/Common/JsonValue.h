@@ -33,9 +33,9 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <map>
 #include <string>
 #include <vector>
+#include "FlatMap.h"
 
 namespace Common {
 
@@ -47,7 +47,7 @@ public:
   typedef bool Bool;
   typedef int64_t Integer;
   typedef std::nullptr_t Nil;
-  typedef std::map<Key, JsonValue> Object;
+  typedef FlatMap<Key, JsonValue> Object;
   typedef double Real;
   typedef std::string String;
 
@@ -145,7 +145,9 @@ public:
 
   size_t erase(const Key& key);
 
+  // Parses the first value of source, strings keep their escape sequences as written
   static JsonValue fromString(const std::string& source);
+  static JsonValue fromString(const char* begin, const char* end);
   std::string toString() const;
 
   friend std::ostream& operator<<(std::ostream& out, const JsonValue& jsonValue);
@@ -163,14 +165,6 @@ private:
   };
 
   void destructValue();
-
-  void readArray(std::istream& in);
-  void readTrue(std::istream& in);
-  void readFalse(std::istream& in);
-  void readNull(std::istream& in);
-  void readNumber(std::istream& in, char c);
-  void readObject(std::istream& in);
-  void readString(std::istream& in);
 };
 
 }
@@ -0,0 +1,163 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "JsonWriter.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include "JsonValue.h"
+
+namespace Common {
+
+JsonWriter::JsonWriter(std::string& buffer) : buffer(buffer) {
+}
+
+void JsonWriter::beginValue(StringView name) {
+  if (containers.empty()) {
+    return;
+  }
+
+  if (containers.back().second) {
+    buffer += ',';
+  }
+
+  containers.back().second = true;
+  if (containers.back().first) {
+    buffer += '"';
+    buffer.append(name.getData(), name.getSize());
+    buffer += "\":";
+  }
+}
+
+void JsonWriter::beginObject() {
+  buffer += '{';
+  containers.emplace_back(true, false);
+}
+
+void JsonWriter::endObject() {
+  containers.pop_back();
+  buffer += '}';
+}
+
+void JsonWriter::beginArray() {
+  buffer += '[';
+  containers.emplace_back(false, false);
+}
+
+void JsonWriter::endArray() {
+  containers.pop_back();
+  buffer += ']';
+}
+
+void JsonWriter::writeBool(bool value) {
+  buffer += value ? "true" : "false";
+}
+
+void JsonWriter::writeInteger(int64_t value) {
+  char text[20];
+  char* end = text + sizeof(text);
+  char* begin = end;
+  // negate in unsigned arithmetic so that INT64_MIN is written correctly
+  uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    *--begin = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  if (value < 0) {
+    buffer += '-';
+  }
+
+  buffer.append(begin, end);
+}
+
+void JsonWriter::writeNull() {
+  buffer += "null";
+}
+
+void JsonWriter::writeReal(double value) {
+  // fixed notation with 11 decimals and trailing zeros trimmed, keeping one digit after the point
+  char text[400];
+  int size = snprintf(text, sizeof(text), "%.11f", value);
+  if (size < 0 || static_cast<size_t>(size) >= sizeof(text)) {
+    throw std::runtime_error("JsonWriter::writeReal, snprintf failed");
+  }
+
+  while (size > 1 && text[size - 2] != '.' && text[size - 1] == '0') {
+    --size;
+  }
+
+  buffer.append(text, size);
+}
+
+void JsonWriter::writeString(StringView value) {
+  buffer += '"';
+  buffer.append(value.getData(), value.getSize());
+  buffer += '"';
+}
+
+void JsonWriter::writeValue(const JsonValue& value) {
+  switch (value.getType()) {
+  case JsonValue::ARRAY:
+    beginArray();
+    for (const JsonValue& item : value.getArray()) {
+      beginValue(StringView::NIL);
+      writeValue(item);
+    }
+
+    endArray();
+    break;
+  case JsonValue::BOOL:
+    writeBool(value.getBool());
+    break;
+  case JsonValue::INTEGER:
+    writeInteger(value.getInteger());
+    break;
+  case JsonValue::NIL:
+    writeNull();
+    break;
+  case JsonValue::OBJECT:
+    beginObject();
+    for (const auto& member : value.getObject()) {
+      beginValue(StringView(member.first.data(), member.first.size()));
+      writeValue(member.second);
+    }
+
+    endObject();
+    break;
+  case JsonValue::REAL:
+    writeReal(value.getReal());
+    break;
+  case JsonValue::STRING:
+    writeString(StringView(value.getString().data(), value.getString().size()));
+    break;
+  }
+}
+
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "StringView.h"
+
+namespace Common {
+
+class JsonValue;
+
+// Appends JSON text to a string, placing separators and member names. Every value, including a nested object or array,
+// is preceded by beginValue, which takes the member name inside an object and ignores it inside an array.
+// Strings are written as is, they are expected to be escaped already, as JsonValue keeps them.
+class JsonWriter {
+public:
+  explicit JsonWriter(std::string& buffer);
+
+  void beginValue(StringView name);
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+
+  void writeBool(bool value);
+  void writeInteger(int64_t value);
+  void writeNull();
+  void writeReal(double value);
+  void writeString(StringView value);
+  void writeValue(const JsonValue& value);
+
+private:
+  std::string& buffer;
+  // per open container: whether it is an object and whether it has a value already
+  std::vector<std::pair<bool, bool>> containers;
+};
+
+}
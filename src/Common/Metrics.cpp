@@ -0,0 +1,174 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "Metrics.h"
+
+#include <stdexcept>
+
+namespace Common {
+
+namespace {
+
+void writeSeriesName(std::ostream& stream, const std::string& name, const std::string& suffix, const std::string& labels, const std::string& extraLabel = std::string()) {
+  stream << name << suffix;
+  if (!labels.empty() || !extraLabel.empty()) {
+    stream << '{' << labels;
+    if (!labels.empty() && !extraLabel.empty()) {
+      stream << ',';
+    }
+
+    stream << extraLabel << '}';
+  }
+
+  stream << ' ';
+}
+
+}
+
+const std::array<uint64_t, MetricHistogram::BUCKET_COUNT> MetricHistogram::BUCKET_BOUNDS = {{
+  10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000, 10000000
+}};
+
+MetricHistogram::MetricHistogram() : m_count(0), m_sum(0) {
+  for (auto& bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void MetricHistogram::observe(std::chrono::steady_clock::duration duration) {
+  uint64_t microseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+  size_t index = 0;
+  while (index < BUCKET_COUNT && microseconds > BUCKET_BOUNDS[index]) {
+    ++index;
+  }
+
+  m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+  m_sum.fetch_add(microseconds, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t MetricHistogram::getBucket(size_t index) const {
+  return m_buckets[index].load(std::memory_order_relaxed);
+}
+
+uint64_t MetricHistogram::getCount() const {
+  return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t MetricHistogram::getSumMicroseconds() const {
+  return m_sum.load(std::memory_order_relaxed);
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& series = getFamily(name, help, Type::COUNTER).counters[labels];
+  if (!series) {
+    series.reset(new MetricCounter());
+  }
+
+  return *series;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& series = getFamily(name, help, Type::GAUGE).gauges[labels];
+  if (!series) {
+    series.reset(new MetricGauge());
+  }
+
+  return *series;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& series = getFamily(name, help, Type::HISTOGRAM).histograms[labels];
+  if (!series) {
+    series.reset(new MetricHistogram());
+  }
+
+  return *series;
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(const std::string& name, const std::string& help, Type type) {
+  auto it = m_families.find(name);
+  if (it == m_families.end()) {
+    it = m_families.emplace(name, Family()).first;
+    it->second.type = type;
+    it->second.help = help;
+  } else if (it->second.type != type) {
+    throw std::runtime_error("MetricsRegistry::getFamily, metric " + name + " is registered with another type");
+  }
+
+  return it->second;
+}
+
+void MetricsRegistry::write(std::ostream& stream) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& familyPair : m_families) {
+    const std::string& name = familyPair.first;
+    const Family& family = familyPair.second;
+    stream << "# HELP " << name << ' ' << family.help << '\n';
+    stream << "# TYPE " << name << ' ' << (family.type == Type::COUNTER ? "counter" : family.type == Type::GAUGE ? "gauge" : "histogram") << '\n';
+
+    for (const auto& series : family.counters) {
+      writeSeriesName(stream, name, "", series.first);
+      stream << series.second->get() << '\n';
+    }
+
+    for (const auto& series : family.gauges) {
+      writeSeriesName(stream, name, "", series.first);
+      stream << series.second->get() << '\n';
+    }
+
+    for (const auto& series : family.histograms) {
+      const MetricHistogram& histogram = *series.second;
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i < MetricHistogram::BUCKET_COUNT; ++i) {
+        cumulative += histogram.getBucket(i);
+        writeSeriesName(stream, name, "_bucket", series.first, "le=\"" + std::to_string(static_cast<double>(MetricHistogram::BUCKET_BOUNDS[i]) / 1000000) + "\"");
+        stream << cumulative << '\n';
+      }
+
+      cumulative += histogram.getBucket(MetricHistogram::BUCKET_COUNT);
+      writeSeriesName(stream, name, "_bucket", series.first, "le=\"+Inf\"");
+      stream << cumulative << '\n';
+      writeSeriesName(stream, name, "_sum", series.first);
+      stream << static_cast<double>(histogram.getSumMicroseconds()) / 1000000 << '\n';
+      writeSeriesName(stream, name, "_count", series.first);
+      stream << cumulative << '\n';
+    }
+  }
+}
+
+}
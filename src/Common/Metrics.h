@@ -0,0 +1,181 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace Common {
+
+class MetricCounter {
+public:
+  MetricCounter() : m_value(0) {
+  }
+
+  void add(uint64_t value = 1) {
+    m_value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t get() const {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> m_value;
+};
+
+class MetricGauge {
+public:
+  MetricGauge() : m_value(0) {
+  }
+
+  void set(int64_t value) {
+    m_value.store(value, std::memory_order_relaxed);
+  }
+
+  void add(int64_t value) {
+    m_value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t get() const {
+    return m_value.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> m_value;
+};
+
+// Latency distribution over fixed buckets from 10 microseconds to 10 seconds
+class MetricHistogram {
+public:
+  static const size_t BUCKET_COUNT = 13;
+  static const std::array<uint64_t, BUCKET_COUNT> BUCKET_BOUNDS; // upper bounds in microseconds
+
+  MetricHistogram();
+
+  void observe(std::chrono::steady_clock::duration duration);
+
+  // Observations in bucket index, BUCKET_COUNT is the overflow bucket
+  uint64_t getBucket(size_t index) const;
+  uint64_t getCount() const;
+  uint64_t getSumMicroseconds() const;
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT + 1> m_buckets;
+  std::atomic<uint64_t> m_count;
+  std::atomic<uint64_t> m_sum;
+};
+
+// Records the lifetime of the scope into a histogram
+class MetricTimer {
+public:
+  explicit MetricTimer(MetricHistogram& histogram) : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {
+  }
+
+  ~MetricTimer() {
+    m_histogram.observe(std::chrono::steady_clock::now() - m_start);
+  }
+
+  MetricTimer(const MetricTimer&) = delete;
+  MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+  MetricHistogram& m_histogram;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+// Named metric families, each series is identified by its label set written as in the exposition format, e.g. command="1001".
+// Registration takes a lock, so hot paths keep the returned reference; metrics live as long as the registry.
+class MetricsRegistry {
+public:
+  static MetricsRegistry& instance();
+
+  MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = std::string());
+  MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = std::string());
+  MetricHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = std::string());
+
+  // Prometheus text exposition format, version 0.0.4
+  void write(std::ostream& stream) const;
+
+private:
+  enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+    std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+  };
+
+  Family& getFamily(const std::string& name, const std::string& help, Type type);
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Family> m_families;
+};
+
+// Mutex that records into histogram how long contended lock calls waited
+template <typename Mutex>
+class MeteredMutex {
+public:
+  explicit MeteredMutex(MetricHistogram& waits) : m_waits(waits) {
+  }
+
+  void lock() {
+    if (m_mutex.try_lock()) {
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    m_mutex.lock();
+    m_waits.observe(std::chrono::steady_clock::now() - start);
+  }
+
+  bool try_lock() {
+    return m_mutex.try_lock();
+  }
+
+  void unlock() {
+    m_mutex.unlock();
+  }
+
+private:
+  Mutex m_mutex;
+  MetricHistogram& m_waits;
+};
+
+}
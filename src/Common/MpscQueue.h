@@ -0,0 +1,94 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace Common {
+
+// Unbounded multi-producer single-consumer queue. push may be called from any thread and never blocks or locks,
+// pop must only be called from one consumer thread at a time. Items of one producer are popped in push order.
+template <typename T>
+class MpscQueue {
+public:
+  MpscQueue() : m_head(new Node), m_tail(m_head.load(std::memory_order_relaxed)) {
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    while (m_tail != nullptr) {
+      Node* next = m_tail->next.load(std::memory_order_relaxed);
+      delete m_tail;
+      m_tail = next;
+    }
+  }
+
+  template <typename TT>
+  void push(TT&& value) {
+    Node* node = new Node(std::forward<TT>(value));
+    Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+    // until this store the consumer sees the queue end at previous
+    previous->next.store(node, std::memory_order_release);
+  }
+
+  bool pop(T& value) {
+    Node* next = m_tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+
+    value = std::move(next->value);
+    delete m_tail;
+    m_tail = next;
+    return true;
+  }
+
+private:
+  // m_tail is a consumed node, the items are in the nodes after it
+  struct Node {
+    Node() : next(nullptr) {
+    }
+
+    template <typename TT>
+    explicit Node(TT&& value) : next(nullptr), value(std::forward<TT>(value)) {
+    }
+
+    std::atomic<Node*> next;
+    T value;
+  };
+
+  std::atomic<Node*> m_head;
+  Node* m_tail;
+};
+
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace Common {
+
+// Bounded multi-producer single-consumer ring. tryPush may be called from any thread, never blocks or locks and fails
+// when the ring is full; pop must only be called from one consumer thread at a time. Capacity is rounded up to a power of two.
+template <typename T>
+class MpscRingBuffer {
+public:
+  explicit MpscRingBuffer(size_t capacity) : m_mask(roundUp(capacity) - 1), m_cells(new Cell[m_mask + 1]), m_head(0), m_tail(0) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(const MpscRingBuffer&) = delete;
+  MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+  size_t capacity() const {
+    return m_mask + 1;
+  }
+
+  // Approximate while producers are active
+  size_t size() const {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    return head >= tail ? head - tail : 0;
+  }
+
+  template <typename TT>
+  bool tryPush(TT&& value) {
+    size_t position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell& cell = m_cells[position & m_mask];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::forward<TT>(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        // the cell still holds the item pushed one lap ago
+        return false;
+      } else {
+        position = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool pop(T& value) {
+    size_t position = m_tail.load(std::memory_order_relaxed);
+    Cell& cell = m_cells[position & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+      return false;
+    }
+
+    value = std::move(cell.value);
+    cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+    m_tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  // A cell is free for the push at position when sequence == position and holds its item when sequence == position + 1
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static size_t roundUp(size_t capacity) {
+    size_t result = 2;
+    while (result < capacity) {
+      result <<= 1;
+    }
+
+    return result;
+  }
+
+  const size_t m_mask;
+  std::unique_ptr<Cell[]> m_cells;
+  std::atomic<size_t> m_head;
+  std::atomic<size_t> m_tail;
+};
+
+}
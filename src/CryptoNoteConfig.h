@@ -86,6 +86,8 @@ const uint8_t  BLOCK_MINOR_VERSION_0                         =  0;
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT        =  10000;  //by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT            =  200;    //by default, blocks count in blocks downloading
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT         =  1000;
+const uint32_t COMMAND_RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT       =  60000;  // milliseconds
+const size_t   JSON_RPC_MAX_BATCH_SIZE                       =  100;    // larger JSON-RPC batches are rejected as invalid requests
 const int      P2P_DEFAULT_PORT                              = 17333;
 const int      RPC_DEFAULT_PORT                              = 18333;
 const size_t   P2P_LOCAL_WHITE_PEERLIST_LIMIT                =  1000;
@@ -40,6 +40,7 @@
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
 #include "Serialization/BinarySerializationTools.h"
 #include "CryptoNoteTools.h"
+#include "TransactionExtra.h"
 
 using namespace Logging;
 using namespace Common;
@@ -56,6 +57,16 @@ std::string appendPath(const std::string& path, const std::string& fileName) {
   return result;
 }
 
+MetricHistogram& blockImportStage(const std::string& stage) {
+  return MetricsRegistry::instance().histogram("dynex_block_import_seconds", "Time spent in each stage of adding a block to the main chain",
+    "stage=\"" + stage + "\"");
+}
+
+MetricGauge& blockchainHeight() {
+  static MetricGauge& height = MetricsRegistry::instance().gauge("dynex_blockchain_height", "Number of blocks in the main chain");
+  return height;
+}
+
 }
 
 namespace std {
@@ -69,7 +80,9 @@ bool operator<(const Crypto::KeyImage& keyImage1, const Crypto::KeyImage& keyIma
 }
 
 #define CURRENT_BLOCKCACHE_STORAGE_ARCHIVE_VER 1
-#define CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 1
+#define CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 2
+// version 1 differs only by the missing explorer index, which is rebuilt alone when it is enabled
+#define MIN_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER 1
 
 namespace CryptoNote {
 class BlockCacheSerializer;
@@ -238,7 +251,7 @@ class BlockchainIndicesSerializer {
 
 public:
   BlockchainIndicesSerializer(Blockchain& bs, const Crypto::Hash lastBlockHash, ILogger& logger) :
-    m_bs(bs), m_lastBlockHash(lastBlockHash), m_loaded(false), logger(logger, "BlockchainIndicesSerializer") {
+    m_bs(bs), m_lastBlockHash(lastBlockHash), m_loaded(false), m_explorerIndexLoaded(false), logger(logger, "BlockchainIndicesSerializer") {
   }
 
   void serialize(ISerializer& s) {
@@ -248,7 +261,7 @@ public:
     KV_MEMBER(version);
 
     // ignore old versions, do rebuild
-    if (version != CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER)
+    if (version < MIN_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER || version > CURRENT_BLOCKCHAININDICES_STORAGE_ARCHIVE_VER)
       return;
 
     std::string operation;
@@ -277,6 +290,21 @@ public:
     logger(INFO) << operation << "generated transactions index...";
     s(m_bs.m_generatedTransactionsIndex, "generatedTransactionsIndex");
 
+    bool explorerIndexStored = false;
+    if (version >= 2) {
+      explorerIndexStored = m_bs.m_explorerIndexEnabled;
+      s(explorerIndexStored, "explorerIndexStored");
+    }
+
+    if (explorerIndexStored) {
+      logger(INFO) << operation << "explorer index...";
+      s(m_bs.m_explorerIndex, "explorerIndex");
+      if (s.type() == ISerializer::INPUT && !m_bs.m_explorerIndexEnabled) {
+        m_bs.m_explorerIndex.clear();
+      }
+    }
+
+    m_explorerIndexLoaded = explorerIndexStored;
     m_loaded = true;
   }
 
@@ -317,10 +345,15 @@ public:
     return m_loaded;
   }
 
+  bool explorerIndexLoaded() const {
+    return m_explorerIndexLoaded;
+  }
+
 private:
 
   LoggerRef logger;
   bool m_loaded;
+  bool m_explorerIndexLoaded;
   Blockchain& m_bs;
   Crypto::Hash m_lastBlockHash;
 };
@@ -330,9 +363,12 @@ Blockchain::Blockchain(const Currency& currency, tx_memory_pool& tx_pool, ILogge
 logger(logger, "Blockchain"),
 m_currency(currency),
 m_tx_pool(tx_pool),
+m_blockchain_lock(MetricsRegistry::instance().histogram("dynex_blockchain_lock_wait_seconds", "Time spent waiting for the contended blockchain lock")),
 m_current_block_cumul_sz_limit(0),
 m_is_in_checkpoint_zone(false),
-m_checkpoints(logger) {
+m_checkpoints(logger),
+m_explorerIndexEnabled(false),
+m_explorerIndexStale(false) {
 
   m_outputs.set_deleted_key(0);
   Crypto::KeyImage nullImage = boost::value_initialized<decltype(nullImage)>();
@@ -564,6 +600,7 @@ bool Blockchain::resetAndSetGenesisBlock(const Block& b) {
   m_timestampIndex.clear();
   m_generatedTransactionsIndex.clear();
   m_orthanBlocksIndex.clear();
+  m_explorerIndex.clear();
 
   block_verification_context bvc = boost::value_initialized<block_verification_context>();
   addNewBlock(b, bvc);
@@ -939,7 +976,8 @@ bool Blockchain::complete_timestamps_vector(uint64_t start_top_height, std::vect
   return true;
 }
 
-bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage) {
+bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage,
+  const Crypto::Hash* precomputedProofOfWork) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   auto block_height = get_block_height(b);
@@ -1026,7 +1064,7 @@ bool Blockchain::handle_alternative_block(const Block& b, const Crypto::Hash& id
     difficulty_type current_diff = get_next_difficulty_for_alternative_chain(alt_chain, bei);
     if (!(current_diff)) { logger(ERROR, BRIGHT_RED) << "!!!!!!! DIFFICULTY OVERHEAD !!!!!!!"; return false; }
     Crypto::Hash proof_of_work = NULL_HASH;
-    if (!m_currency.checkProofOfWork(m_cn_context, bei.bl, current_diff, proof_of_work)) {
+    if (!checkProofOfWork(bei.bl, current_diff, precomputedProofOfWork, proof_of_work)) {
       logger(INFO, BRIGHT_RED) <<
         "Block with id: " << id
         << ENDL << " for alternative chain, have not enough proof of work: " << proof_of_work
@@ -1612,6 +1650,14 @@ bool Blockchain::update_next_comulative_size_limit() {
 }
 
 bool Blockchain::addNewBlock(const Block& bl_, block_verification_context& bvc) {
+  return addNewBlock(bl_, nullptr, bvc);
+}
+
+bool Blockchain::addNewBlock(const Block& bl_, const Crypto::Hash& proofOfWork, block_verification_context& bvc) {
+  return addNewBlock(bl_, &proofOfWork, bvc);
+}
+
+bool Blockchain::addNewBlock(const Block& bl_, const Crypto::Hash* precomputedProofOfWork, block_verification_context& bvc) {
   //copy block here to let modify block.target
   Block bl = bl_;
   Crypto::Hash id;
@@ -1638,9 +1684,9 @@ bool Blockchain::addNewBlock(const Block& bl_, block_verification_context& bvc)
     if (!(bl.previousBlockHash == getTailId())) {
       //chain switching or wrong block
       bvc.m_added_to_main_chain = false;
-      add_result = handle_alternative_block(bl, id, bvc);
+      add_result = handle_alternative_block(bl, id, bvc, true, precomputedProofOfWork);
     } else {
-      add_result = pushBlock(bl, bvc);
+      add_result = pushBlock(bl, bvc, precomputedProofOfWork);
       if (add_result) {
         sendMessage(BlockchainMessage(NewBlockMessage(id)));
       }
@@ -1658,14 +1704,23 @@ const Blockchain::TransactionEntry& Blockchain::transactionByIndex(TransactionIn
   return m_blocks[index.block].transactions[index.transaction];
 }
 
-bool Blockchain::pushBlock(const Block& blockData, block_verification_context& bvc) {
+bool Blockchain::checkProofOfWork(const Block& block, difficulty_type currentDifficulty, const Crypto::Hash* precomputedProofOfWork, Crypto::Hash& proofOfWork) {
+  if (precomputedProofOfWork == nullptr) {
+    return m_currency.checkProofOfWork(m_cn_context, block, currentDifficulty, proofOfWork);
+  }
+
+  proofOfWork = *precomputedProofOfWork;
+  return check_hash(proofOfWork, currentDifficulty);
+}
+
+bool Blockchain::pushBlock(const Block& blockData, block_verification_context& bvc, const Crypto::Hash* precomputedProofOfWork) {
   std::vector<Transaction> transactions;
   if (!loadTransactions(blockData, transactions)) {
     bvc.m_verifivation_failed = true;
     return false;
   }
 
-  if (!pushBlock(blockData, transactions, bvc)) {
+  if (!pushBlock(blockData, transactions, bvc, precomputedProofOfWork)) {
     saveTransactions(transactions);
     return false;
   }
@@ -1673,7 +1728,8 @@ bool Blockchain::pushBlock(const Block& blockData, block_verification_context& b
   return true;
 }
 
-bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc) {
+bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc,
+  const Crypto::Hash* precomputedProofOfWork) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
   auto blockProcessingStart = std::chrono::steady_clock::now();
@@ -1701,9 +1757,16 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     return false;
   }
 
+  static MetricHistogram& difficultyStage = blockImportStage("difficulty");
+  static MetricHistogram& proofOfWorkStage = blockImportStage("proof_of_work");
+  static MetricHistogram& transactionsStage = blockImportStage("transactions");
+  static MetricHistogram& totalStage = blockImportStage("total");
+
   auto targetTimeStart = std::chrono::steady_clock::now();
   difficulty_type currentDifficulty = getDifficultyForNextBlock();
-  auto target_calculating_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - targetTimeStart).count();
+  auto targetDuration = std::chrono::steady_clock::now() - targetTimeStart;
+  difficultyStage.observe(targetDuration);
+  auto target_calculating_time = std::chrono::duration_cast<std::chrono::milliseconds>(targetDuration).count();
 
   if (!(currentDifficulty)) {
     logger(ERROR, BRIGHT_RED) << "!!!!!!!!! difficulty overhead !!!!!!!!!";
@@ -1721,7 +1784,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
       return false;
     }
   } else {
-    if (!m_currency.checkProofOfWork(m_cn_context, blockData, currentDifficulty, proof_of_work)) {
+    if (!checkProofOfWork(blockData, currentDifficulty, precomputedProofOfWork, proof_of_work)) {
       logger(INFO, BRIGHT_WHITE) <<
         "Block " << blockHash << ", has too weak proof of work: " << proof_of_work << ", expected difficulty: " << currentDifficulty;
       bvc.m_verifivation_failed = true;
@@ -1729,7 +1792,9 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     }
   }
 
-  auto longhash_calculating_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - longhashTimeStart).count();
+  auto longhashDuration = std::chrono::steady_clock::now() - longhashTimeStart;
+  proofOfWorkStage.observe(longhashDuration);
+  auto longhash_calculating_time = std::chrono::duration_cast<std::chrono::milliseconds>(longhashDuration).count();
 
   if (!prevalidate_miner_transaction(blockData, static_cast<uint32_t>(m_blocks.size()))) {
     logger(INFO, BRIGHT_WHITE) <<
@@ -1747,6 +1812,7 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
   TransactionIndex transactionIndex = { static_cast<uint32_t>(m_blocks.size()), static_cast<uint16_t>(0) };
   pushTransaction(block, minerTransactionHash, transactionIndex);
 
+  auto transactionsTimeStart = std::chrono::steady_clock::now();
   size_t coinbase_blob_size = getObjectBinarySize(blockData.baseTransaction);
   size_t cumulative_block_size = coinbase_blob_size;
   uint64_t fee_summary = 0;
@@ -1776,6 +1842,8 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
     fee_summary += fee;
   }
 
+  transactionsStage.observe(std::chrono::steady_clock::now() - transactionsTimeStart);
+
   if (!checkCumulativeBlockSize(blockHash, cumulative_block_size, m_blocks.size())) {
     bvc.m_verifivation_failed = true;
     return false;
@@ -1801,7 +1869,9 @@ bool Blockchain::pushBlock(const Block& blockData, const std::vector<Transaction
 
   pushBlock(block);
 
-  auto block_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - blockProcessingStart).count();
+  auto blockProcessingDuration = std::chrono::steady_clock::now() - blockProcessingStart;
+  totalStage.observe(blockProcessingDuration);
+  auto block_processing_time = std::chrono::duration_cast<std::chrono::milliseconds>(blockProcessingDuration).count();
 
   logger(DEBUGGING) <<
     "+++++ BLOCK SUCCESSFULLY ADDED" << ENDL << "id:\t" << blockHash
@@ -1828,6 +1898,12 @@ bool Blockchain::pushBlock(BlockEntry& block) {
   m_generatedTransactionsIndex.add(block.bl);
 
   assert(m_blockIndex.size() == m_blocks.size());
+  blockchainHeight().set(static_cast<int64_t>(m_blocks.size()));
+
+  // the index is rebuilt on block boundaries only, where it can be derived from m_blocks
+  if (m_explorerIndexEnabled && m_explorerIndexStale) {
+    rebuildExplorerIndex();
+  }
 
   return true;
 }
@@ -1855,6 +1931,11 @@ void Blockchain::popBlock(const Crypto::Hash& blockHash) {
   m_blockIndex.pop();
 
   assert(m_blockIndex.size() == m_blocks.size());
+  blockchainHeight().set(static_cast<int64_t>(m_blocks.size()));
+
+  if (m_explorerIndexEnabled && m_explorerIndexStale) {
+    rebuildExplorerIndex();
+  }
 }
 
 bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex) {
@@ -1914,6 +1995,12 @@ bool Blockchain::pushTransaction(BlockEntry& block, const Crypto::Hash& transact
 
   m_paymentIdIndex.add(transaction.tx);
 
+  if (m_explorerIndexEnabled && !m_explorerIndexStale && !addToExplorerIndex(transaction.tx, transactionHash, transactionIndex, transaction.m_global_output_indexes)) {
+    logger(ERROR, BRIGHT_RED) <<
+      "Failed to add transaction " << transactionHash << " to explorer index, it will be rebuilt.";
+    m_explorerIndexStale = true;
+  }
+
   return true;
 }
 
@@ -2011,6 +2098,12 @@ void Blockchain::popTransaction(const Transaction& transaction, const Crypto::Ha
 
   m_paymentIdIndex.remove(transaction);
 
+  if (m_explorerIndexEnabled && !m_explorerIndexStale && !m_explorerIndex.remove(transactionIndex.block, transactionIndex.transaction, transactionHash)) {
+    logger(ERROR, BRIGHT_RED) <<
+      "Blockchain consistency broken - cannot find transaction in explorer index, it will be rebuilt.";
+    m_explorerIndexStale = true;
+  }
+
   size_t count = m_transactionMap.erase(transactionHash);
   if (count != 1) {
     logger(ERROR, BRIGHT_RED) <<
@@ -2205,6 +2298,8 @@ bool Blockchain::loadBlockchainIndices() {
     m_paymentIdIndex.clear();
     m_timestampIndex.clear();
     m_generatedTransactionsIndex.clear();
+    m_explorerIndex.clear();
+    bool explorerIndexBuilt = true;
 
     for (uint32_t b = 0; b < m_blocks.size(); ++b) {
       if (b % 1000 == 0) {
@@ -2216,15 +2311,120 @@ bool Blockchain::loadBlockchainIndices() {
       for (uint16_t t = 0; t < block.transactions.size(); ++t) {
         const TransactionEntry& transaction = block.transactions[t];
         m_paymentIdIndex.add(transaction.tx);
+        if (m_explorerIndexEnabled) {
+          Crypto::Hash transactionHash = t == 0 ? getObjectHash(block.bl.baseTransaction) : block.bl.transactionHashes[t - 1];
+          explorerIndexBuilt = explorerIndexBuilt && addToExplorerIndex(transaction.tx, transactionHash, { b, t }, transaction.m_global_output_indexes);
+        }
       }
     }
 
+    if (m_explorerIndexEnabled && !explorerIndexBuilt) {
+      disableExplorerIndex();
+    }
+
     std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
     logger(INFO, BRIGHT_WHITE) << "Rebuilding blockchain indices took: " << duration.count();
+  } else if (m_explorerIndexEnabled && !loader.explorerIndexLoaded()) {
+    logger(WARNING, BRIGHT_YELLOW) << "No actual explorer index found, rebuilding...";
+    rebuildExplorerIndex();
   }
   return true;
 }
 
+bool Blockchain::addToExplorerIndex(const Transaction& transaction, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex, const std::vector<uint32_t>& globalIndexes) {
+  ExplorerTransactionEntry entry;
+  entry.fee = 0;
+  entry.mixin = 0;
+  entry.hasPaymentId = getPaymentIdFromTxExtra(transaction.extra, entry.paymentId);
+  if (!entry.hasPaymentId) {
+    entry.paymentId = NULL_HASH;
+  }
+
+  entry.inputs.reserve(transaction.inputs.size());
+  for (const TransactionInput& input : transaction.inputs) {
+    ExplorerOutputReference reference = { NULL_HASH, 0 };
+    TransactionIndex sourceIndex;
+    if (input.type() == typeid(KeyInput)) {
+      const KeyInput& keyInput = boost::get<KeyInput>(input);
+      entry.mixin = std::max<uint64_t>(entry.mixin, keyInput.outputIndexes.size());
+      auto amountOutputs = m_outputs.find(keyInput.amount);
+      if (amountOutputs == m_outputs.end() || keyInput.outputIndexes.empty()) {
+        return false;
+      }
+
+      uint32_t lastOutput = relative_output_offsets_to_absolute(keyInput.outputIndexes).back();
+      if (lastOutput >= amountOutputs->second.size()) {
+        return false;
+      }
+
+      sourceIndex = amountOutputs->second[lastOutput].first;
+      reference.number = amountOutputs->second[lastOutput].second;
+    } else if (input.type() == typeid(MultisignatureInput)) {
+      const MultisignatureInput& multisignatureInput = boost::get<MultisignatureInput>(input);
+      auto amountOutputs = m_multisignatureOutputs.find(multisignatureInput.amount);
+      if (amountOutputs == m_multisignatureOutputs.end() || multisignatureInput.outputIndex >= amountOutputs->second.size()) {
+        return false;
+      }
+
+      sourceIndex = amountOutputs->second[multisignatureInput.outputIndex].transactionIndex;
+      reference.number = amountOutputs->second[multisignatureInput.outputIndex].outputIndex;
+    } else {
+      entry.inputs.push_back(reference);
+      continue;
+    }
+
+    if (!m_explorerIndex.findHash(sourceIndex.block, sourceIndex.transaction, reference.transactionHash)) {
+      return false;
+    }
+
+    entry.inputs.push_back(reference);
+  }
+
+  if (transaction.inputs.empty() || transaction.inputs.front().type() != typeid(BaseInput)) {
+    if (!get_tx_fee(transaction, entry.fee)) {
+      return false;
+    }
+  }
+
+  entry.globalIndexes = globalIndexes;
+  return m_explorerIndex.add(transactionIndex.block, transactionIndex.transaction, transactionHash, std::move(entry));
+}
+
+void Blockchain::rebuildExplorerIndex() {
+  std::chrono::steady_clock::time_point timePoint = std::chrono::steady_clock::now();
+  m_explorerIndex.clear();
+  m_explorerIndexStale = false;
+  for (uint32_t b = 0; b < m_blocks.size(); ++b) {
+    if (b % 1000 == 0) {
+      logger(INFO, BRIGHT_WHITE) << "Height " << b << " of " << m_blocks.size();
+    }
+    const BlockEntry& block = m_blocks[b];
+    for (uint16_t t = 0; t < block.transactions.size(); ++t) {
+      const TransactionEntry& transaction = block.transactions[t];
+      Crypto::Hash transactionHash = t == 0 ? getObjectHash(block.bl.baseTransaction) : block.bl.transactionHashes[t - 1];
+      if (!addToExplorerIndex(transaction.tx, transactionHash, { b, t }, transaction.m_global_output_indexes)) {
+        disableExplorerIndex();
+        return;
+      }
+    }
+  }
+
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - timePoint;
+  logger(INFO, BRIGHT_WHITE) << "Rebuilding explorer index took: " << duration.count();
+}
+
+void Blockchain::disableExplorerIndex() {
+  // a transaction that cannot be indexed from the chain itself would fail every rebuild, so fall back to the scans
+  logger(ERROR, BRIGHT_RED) << "Failed to rebuild explorer index, disabling it";
+  m_explorerIndex.clear();
+  m_explorerIndexEnabled = false;
+}
+
+bool Blockchain::getExplorerTransaction(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry) {
+  std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
+  return m_explorerIndexEnabled && !m_explorerIndexStale && m_explorerIndex.find(transactionHash, entry);
+}
+
 bool Blockchain::getGeneratedTransactionsNumber(uint32_t height, uint64_t& generatedTransactions) {
   std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
   return m_generatedTransactionsIndex.find(height, generatedTransactions);
@@ -35,6 +35,7 @@
 #include "google/sparse_hash_set"
 #include "google/sparse_hash_map"
 
+#include "Common/Metrics.h"
 #include "Common/ObserverManager.h"
 #include "Common/Util.h"
 #include "CryptoNoteCore/BlockIndex.h"
@@ -103,6 +104,9 @@ namespace CryptoNote {
     difficulty_type getDifficultyForNextBlock();
     uint64_t getCoinsInCirculation();
     bool addNewBlock(const Block& bl_, block_verification_context& bvc);
+    // proofOfWork is the long hash of the block computed by the caller, e.g. by the block import pipeline
+    bool addNewBlock(const Block& bl_, const Crypto::Hash& proofOfWork, block_verification_context& bvc);
+    bool isInCheckpointZone(uint32_t height) const { return m_checkpoints.is_in_checkpoint_zone(height); }
     bool resetAndSetGenesisBlock(const Block& b);
     bool haveBlock(const Crypto::Hash& id);
     size_t getTotalTransactions();
@@ -127,6 +131,9 @@ namespace CryptoNote {
     bool getOrphanBlockIdsByHeight(uint32_t height, std::vector<Crypto::Hash>& blockHashes);
     bool getBlockIdsByTimestamp(uint64_t timestampBegin, uint64_t timestampEnd, uint32_t blocksNumberLimit, std::vector<Crypto::Hash>& hashes, uint32_t& blocksNumberWithinTimestamps);
     bool getTransactionIdsByPaymentId(const Crypto::Hash& paymentId, std::vector<Crypto::Hash>& transactionHashes);
+    // Must be called before init
+    void setExplorerIndexEnabled(bool enabled) { m_explorerIndexEnabled = enabled; }
+    bool getExplorerTransaction(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry);
     bool isBlockInMainChain(const Crypto::Hash& blockId);
 
     template<class visitor_t> bool scanOutputKeysForIndexes(const KeyInput& tx_in_to_key, visitor_t& vis, uint32_t* pmax_related_block_height = NULL);
@@ -136,7 +143,7 @@ namespace CryptoNote {
 
     template<class t_ids_container, class t_blocks_container, class t_missed_container>
     bool getBlocks(const t_ids_container& block_ids, t_blocks_container& blocks, t_missed_container& missed_bs) {
-      std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+      std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
 
       for (const auto& bl_id : block_ids) {
         uint32_t height = 0;
@@ -246,7 +253,7 @@ namespace CryptoNote {
 
     const Currency& m_currency;
     tx_memory_pool& m_tx_pool;
-    std::recursive_mutex m_blockchain_lock; // TODO: add here reader/writer lock
+    Common::MeteredMutex<std::recursive_mutex> m_blockchain_lock; // TODO: add here reader/writer lock
     Crypto::cn_context m_cn_context;
     Tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
@@ -275,6 +282,9 @@ namespace CryptoNote {
     TimestampBlocksIndex m_timestampIndex;
     GeneratedTransactionsIndex m_generatedTransactionsIndex;
     OrphanBlocksIndex m_orthanBlocksIndex;
+    bool m_explorerIndexEnabled;
+    bool m_explorerIndexStale;
+    ExplorerIndex m_explorerIndex;
 
     IntrusiveLinkedList<MessageQueue<BlockchainMessage>> m_messageQueueList;
 
@@ -283,7 +293,8 @@ namespace CryptoNote {
     void rebuildCache();
     bool storeCache();
     bool switch_to_alternative_blockchain(std::list<blocks_ext_by_hash::iterator>& alt_chain, bool discard_disconnected_chain);
-    bool handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage = true);
+    bool handle_alternative_block(const Block& b, const Crypto::Hash& id, block_verification_context& bvc, bool sendNewAlternativeBlockMessage = true,
+      const Crypto::Hash* precomputedProofOfWork = nullptr);
     difficulty_type get_next_difficulty_for_alternative_chain(const std::list<blocks_ext_by_hash::iterator>& alt_chain, BlockEntry& bei);
     bool prevalidate_miner_transaction(const Block& b, uint32_t height);
     bool validate_miner_transaction(const Block& b, uint32_t height, size_t cumulativeBlockSize, uint64_t alreadyGeneratedCoins, uint64_t fee, uint64_t& reward, int64_t& emissionChange);
@@ -305,8 +316,11 @@ namespace CryptoNote {
     bool checkTransactionInputs(const Transaction& tx, uint32_t* pmax_used_block_height = NULL);
     bool have_tx_keyimg_as_spent(const Crypto::KeyImage &key_im);
     const TransactionEntry& transactionByIndex(TransactionIndex index);
-    bool pushBlock(const Block& blockData, block_verification_context& bvc);
-    bool pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc);
+    bool addNewBlock(const Block& bl_, const Crypto::Hash* precomputedProofOfWork, block_verification_context& bvc);
+    bool checkProofOfWork(const Block& block, difficulty_type currentDifficulty, const Crypto::Hash* precomputedProofOfWork, Crypto::Hash& proofOfWork);
+    bool pushBlock(const Block& blockData, block_verification_context& bvc, const Crypto::Hash* precomputedProofOfWork = nullptr);
+    bool pushBlock(const Block& blockData, const std::vector<Transaction>& transactions, block_verification_context& bvc,
+      const Crypto::Hash* precomputedProofOfWork = nullptr);
     bool pushBlock(BlockEntry& block);
     void popBlock(const Crypto::Hash& blockHash);
     bool pushTransaction(BlockEntry& block, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex);
@@ -316,6 +330,9 @@ namespace CryptoNote {
 
     bool storeBlockchainIndices();
     bool loadBlockchainIndices();
+    bool addToExplorerIndex(const Transaction& transaction, const Crypto::Hash& transactionHash, TransactionIndex transactionIndex, const std::vector<uint32_t>& globalIndexes);
+    void rebuildExplorerIndex();
+    void disableExplorerIndex();
 
     bool loadTransactions(const Block& block, std::vector<Transaction>& transactions);
     void saveTransactions(const std::vector<Transaction>& transactions);
@@ -338,11 +355,11 @@ namespace CryptoNote {
   private:
 
     Blockchain& m_bc;
-    std::lock_guard<std::recursive_mutex> m_lock;
+    std::lock_guard<decltype(Blockchain::m_blockchain_lock)> m_lock;
   };
 
   template<class visitor_t> bool Blockchain::scanOutputKeysForIndexes(const KeyInput& tx_in_to_key, visitor_t& vis, uint32_t* pmax_related_block_height) {
-    std::lock_guard<std::recursive_mutex> lk(m_blockchain_lock);
+    std::lock_guard<decltype(m_blockchain_lock)> lk(m_blockchain_lock);
     auto it = m_outputs.find(tx_in_to_key.amount);
     if (it == m_outputs.end() || !tx_in_to_key.outputIndexes.size())
       return false;
@@ -234,6 +234,84 @@ void GeneratedTransactionsIndex::serialize(ISerializer& s) {
   s(lastGeneratedTxNumber, "lastGeneratedTxNumber");
 }
 
+void serialize(ExplorerOutputReference& reference, ISerializer& s) {
+  s(reference.transactionHash, "transactionHash");
+  s(reference.number, "number");
+}
+
+void serialize(ExplorerTransactionEntry& entry, ISerializer& s) {
+  s(entry.fee, "fee");
+  s(entry.mixin, "mixin");
+  s(entry.hasPaymentId, "hasPaymentId");
+  s(entry.paymentId, "paymentId");
+  s(entry.inputs, "inputs");
+  s(entry.globalIndexes, "globalIndexes");
+}
+
+bool ExplorerIndex::add(uint32_t block, uint16_t transaction, const Crypto::Hash& transactionHash, ExplorerTransactionEntry&& entry) {
+  if (block + 1 < blockTransactions.size()) {
+    return false;
+  }
+
+  if (block >= blockTransactions.size()) {
+    blockTransactions.resize(block + 1);
+  }
+
+  if (static_cast<size_t>(transaction) != blockTransactions[block].size()) {
+    return false;
+  }
+
+  if (!index.emplace(transactionHash, std::move(entry)).second) {
+    return false;
+  }
+
+  blockTransactions[block].push_back(transactionHash);
+  return true;
+}
+
+bool ExplorerIndex::remove(uint32_t block, uint16_t transaction, const Crypto::Hash& transactionHash) {
+  if (block + 1 != blockTransactions.size() || static_cast<size_t>(transaction) + 1 != blockTransactions[block].size() || blockTransactions[block].back() != transactionHash) {
+    return false;
+  }
+
+  index.erase(transactionHash);
+  blockTransactions[block].pop_back();
+  while (!blockTransactions.empty() && blockTransactions.back().empty()) {
+    blockTransactions.pop_back();
+  }
+
+  return true;
+}
+
+bool ExplorerIndex::find(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry) const {
+  auto it = index.find(transactionHash);
+  if (it == index.end()) {
+    return false;
+  }
+
+  entry = it->second;
+  return true;
+}
+
+bool ExplorerIndex::findHash(uint32_t block, uint16_t transaction, Crypto::Hash& transactionHash) const {
+  if (block >= blockTransactions.size() || transaction >= blockTransactions[block].size()) {
+    return false;
+  }
+
+  transactionHash = blockTransactions[block][transaction];
+  return true;
+}
+
+void ExplorerIndex::clear() {
+  index.clear();
+  blockTransactions.clear();
+}
+
+void ExplorerIndex::serialize(ISerializer& s) {
+  s(index, "index");
+  s(blockTransactions, "blockTransactions");
+}
+
 bool OrphanBlocksIndex::add(const Block& block) {
   Crypto::Hash blockHash = get_block_hash(block);
   uint32_t blockHeight = boost::get<BaseInput>(block.baseTransaction.inputs.front()).blockIndex;
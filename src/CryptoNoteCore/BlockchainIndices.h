@@ -33,6 +33,7 @@
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <vector>
 
 #include "crypto/hash.h"
 #include "CryptoNoteBasic.h"
@@ -119,6 +120,41 @@ private:
   uint64_t lastGeneratedTxNumber;
 };
 
+struct ExplorerOutputReference {
+  Crypto::Hash transactionHash;
+  uint32_t number;
+};
+
+struct ExplorerTransactionEntry {
+  uint64_t fee;
+  uint64_t mixin;
+  bool hasPaymentId;
+  Crypto::Hash paymentId;
+  // referenced output of every input, the last ring member for key inputs and null for the base input
+  std::vector<ExplorerOutputReference> inputs;
+  std::vector<uint32_t> globalIndexes;
+};
+
+void serialize(ExplorerOutputReference& reference, ISerializer& s);
+void serialize(ExplorerTransactionEntry& entry, ISerializer& s);
+
+// Details the block explorer would otherwise resolve by scanning ring members, materialized once per transaction
+class ExplorerIndex {
+public:
+  ExplorerIndex() = default;
+
+  bool add(uint32_t block, uint16_t transaction, const Crypto::Hash& transactionHash, ExplorerTransactionEntry&& entry);
+  bool remove(uint32_t block, uint16_t transaction, const Crypto::Hash& transactionHash);
+  bool find(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry) const;
+  bool findHash(uint32_t block, uint16_t transaction, Crypto::Hash& transactionHash) const;
+  void clear();
+
+  void serialize(ISerializer& s);
+private:
+  std::unordered_map<Crypto::Hash, ExplorerTransactionEntry> index;
+  std::vector<std::vector<Crypto::Hash>> blockTransactions;
+};
+
 class OrphanBlocksIndex {
 public:
   OrphanBlocksIndex() = default;
@@ -145,6 +145,7 @@ size_t core::get_alternative_blocks_count() {
     bool r = m_mempool.init(m_config_folder);
   if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to initialize memory pool"; return false; }
 
+  m_blockchain.setExplorerIndexEnabled(config.explorerIndexEnabled);
   r = m_blockchain.init(m_config_folder, load_existing);
   if (!(r)) { logger(ERROR, BRIGHT_RED) << "Failed to initialize blockchain storage"; return false; }
 
@@ -512,12 +513,25 @@ bool core::handle_incoming_block_blob(const BinaryArray& block_blob, block_verif
   return handle_incoming_block(b, bvc, control_miner, relay_block);
 }
 
-bool core::handle_incoming_block(const Block& b, block_verification_context& bvc, bool control_miner, bool relay_block) {
+bool core::handleIncomingBlock(const Block& block, const Crypto::Hash* proofOfWork, block_verification_context& bvc, bool control_miner, bool relay_block) {
+  return handle_incoming_block(block, bvc, control_miner, relay_block, proofOfWork);
+}
+
+bool core::isInCheckpointZone(uint32_t height) {
+  return m_blockchain.isInCheckpointZone(height);
+}
+
+bool core::handle_incoming_block(const Block& b, block_verification_context& bvc, bool control_miner, bool relay_block,
+  const Crypto::Hash* precomputedProofOfWork) {
   if (control_miner) {
     pause_mining();
   }
 
-  m_blockchain.addNewBlock(b, bvc);
+  if (precomputedProofOfWork != nullptr) {
+    m_blockchain.addNewBlock(b, *precomputedProofOfWork, bvc);
+  } else {
+    m_blockchain.addNewBlock(b, bvc);
+  }
 
   if (control_miner) {
     update_block_template_and_resume_mining();
@@ -584,6 +598,12 @@ std::vector<Transaction> core::getPoolTransactions() {
   return result;
 }
 
+std::vector<Crypto::Hash> core::getPoolTransactionHashes() {
+  std::vector<Crypto::Hash> hashes;
+  m_mempool.get_transaction_ids(hashes);
+  return hashes;
+}
+
 std::vector<Crypto::Hash> core::buildSparseChain() {
   assert(m_blockchain.getCurrentBlockchainHeight() != 0);
   return m_blockchain.buildSparseChain();
@@ -864,6 +884,10 @@ bool core::getMultisigOutputReference(const MultisignatureInput& txInMultisig, s
   return m_blockchain.getMultisigOutputReference(txInMultisig, outputReference);
 }
 
+bool core::getExplorerTransaction(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry) {
+  return m_blockchain.getExplorerTransaction(transactionHash, entry);
+}
+
 bool core::getGeneratedTransactionsNumber(uint32_t height, uint64_t& generatedTransactions) {
   return m_blockchain.getGeneratedTransactionsNumber(height, generatedTransactions);
 }
@@ -35,6 +35,12 @@
 
 namespace CryptoNote {
 
+namespace {
+
+const command_line::arg_descriptor<bool> arg_enable_explorer_index = {"enable-explorer-index", "Keep a persistent index of transaction details served by the blockchain explorer"};
+
+}
+
 CoreConfig::CoreConfig() {
   configFolder = Tools::getDefaultDataDirectory();
 }
@@ -44,8 +50,13 @@ void CoreConfig::init(const boost::program_options::variables_map& options) {
     configFolder = command_line::get_arg(options, command_line::arg_data_dir);
     configFolderDefaulted = options[command_line::arg_data_dir.name].defaulted();
   }
+
+  if (command_line::has_arg(options, arg_enable_explorer_index)) {
+    explorerIndexEnabled = true;
+  }
 }
 
 void CoreConfig::initOptions(boost::program_options::options_description& desc) {
+  command_line::add_arg(desc, arg_enable_explorer_index);
 }
 } //namespace CryptoNote
@@ -45,6 +45,7 @@ public:
 
   std::string configFolder;
   bool configFolderDefaulted = true;
+  bool explorerIndexEnabled = false;
 };
 
 } //namespace CryptoNote
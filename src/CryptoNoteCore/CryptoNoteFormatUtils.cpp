@@ -32,6 +32,7 @@
 
 #include <set>
 #include <Logging/LoggerRef.h>
+#include <Common/ParallelFor.h>
 #include <Common/Varint.h>
 
 #include "Serialization/BinaryOutputStreamSerializer.h"
@@ -133,7 +134,8 @@ bool constructTransaction(
   std::vector<uint8_t> extra,
   Transaction& tx,
   uint64_t unlock_time,
-  Logging::ILogger& log) {
+  Logging::ILogger& log,
+  size_t threadCount) {
   LoggerRef logger(log, "construct_tx");
 
   tx.inputs.clear();
@@ -149,29 +151,38 @@ bool constructTransaction(
 
   struct input_generation_context_data {
     KeyPair in_ephemeral;
+    KeyImage image;
+    bool derived;
   };
 
-  std::vector<input_generation_context_data> in_contexts;
   uint64_t summary_inputs_money = 0;
-  //fill inputs
   for (const TransactionSourceEntry& src_entr : sources) {
     if (src_entr.realOutput >= src_entr.outputs.size()) {
       logger(ERROR) << "real_output index (" << src_entr.realOutput << ")bigger than output_keys.size()=" << src_entr.outputs.size();
       return false;
     }
     summary_inputs_money += src_entr.amount;
+  }
 
-    //KeyDerivation recv_derivation;
-    in_contexts.push_back(input_generation_context_data());
-    KeyPair& in_ephemeral = in_contexts.back().in_ephemeral;
-    KeyImage img;
-    if (!generate_key_image_helper(sender_account_keys, src_entr.realTransactionPublicKey, src_entr.realOutputIndexInTransaction, in_ephemeral, img))
+  //derive the one-time keys and key images of all inputs, they are independent of each other
+  std::vector<input_generation_context_data> in_contexts(sources.size());
+  parallelFor(sources.size(), threadCount, [&](size_t i) {
+    const TransactionSourceEntry& src_entr = sources[i];
+    input_generation_context_data& context = in_contexts[i];
+    context.derived = generate_key_image_helper(sender_account_keys, src_entr.realTransactionPublicKey, src_entr.realOutputIndexInTransaction, context.in_ephemeral, context.image);
+  });
+
+  //fill inputs
+  for (size_t i = 0; i < sources.size(); ++i) {
+    const TransactionSourceEntry& src_entr = sources[i];
+    const input_generation_context_data& context = in_contexts[i];
+    if (!context.derived)
       return false;
 
     //check that derived key is equal with real output key
-    if (!(in_ephemeral.publicKey == src_entr.outputs[src_entr.realOutput].second)) {
+    if (!(context.in_ephemeral.publicKey == src_entr.outputs[src_entr.realOutput].second)) {
       logger(ERROR) << "derived public key mismatch with output public key! " << ENDL << "derived_key:"
-        << Common::podToHex(in_ephemeral.publicKey) << ENDL << "real output_public_key:"
+        << Common::podToHex(context.in_ephemeral.publicKey) << ENDL << "real output_public_key:"
         << Common::podToHex(src_entr.outputs[src_entr.realOutput].second);
       return false;
     }
@@ -179,7 +190,7 @@ bool constructTransaction(
     //put key image into tx input
     KeyInput input_to_key;
     input_to_key.amount = src_entr.amount;
-    input_to_key.keyImage = img;
+    input_to_key.keyImage = context.image;
 
     //fill outputs array and use relative offsets
     for (const TransactionSourceEntry::OutputEntry& out_entry : src_entr.outputs) {
@@ -244,20 +255,26 @@ bool constructTransaction(
   Hash tx_prefix_hash;
   getObjectHash(*static_cast<TransactionPrefix*>(&tx), tx_prefix_hash);
 
-  size_t i = 0;
-  for (const TransactionSourceEntry& src_entr : sources) {
+  //randomness is drawn in input order, so the signatures don't depend on how the inputs are spread over threads
+  std::vector<std::vector<EllipticCurveScalar>> randomness(sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    randomness[i].resize(ring_signature_randomness_size(sources[i].outputs.size()));
+    generate_ring_signature_randomness(sources[i].outputs.size(), randomness[i].data());
+  }
+
+  tx.signatures.resize(sources.size());
+  parallelFor(sources.size(), threadCount, [&](size_t i) {
+    const TransactionSourceEntry& src_entr = sources[i];
     std::vector<const PublicKey*> keys_ptrs;
     for (const TransactionSourceEntry::OutputEntry& o : src_entr.outputs) {
       keys_ptrs.push_back(&o.second);
     }
 
-    tx.signatures.push_back(std::vector<Signature>());
-    std::vector<Signature>& sigs = tx.signatures.back();
+    std::vector<Signature>& sigs = tx.signatures[i];
     sigs.resize(src_entr.outputs.size());
-    generate_ring_signature(tx_prefix_hash, boost::get<KeyInput>(tx.inputs[i]).keyImage, keys_ptrs,
-      in_contexts[i].in_ephemeral.secretKey, src_entr.realOutput, sigs.data());
-    i++;
-  }
+    generate_ring_signature(tx_prefix_hash, boost::get<KeyInput>(tx.inputs[i]).keyImage, keys_ptrs.data(), keys_ptrs.size(),
+      in_contexts[i].in_ephemeral.secretKey, src_entr.realOutput, randomness[i].data(), sigs.data());
+  });
 
   return true;
 }
@@ -500,6 +517,24 @@ bool get_block_longhash(cn_context &context, const Block& b, Hash& res) {
   return true;
 }
 
+bool get_block_longhashes(cn_multi_context &context, const Block* const* blocks, size_t count, Hash* res) {
+  assert(count <= context.ways());
+  BinaryArray blobs[SLOW_HASH_MAX_WAYS];
+  const void* data[SLOW_HASH_MAX_WAYS];
+  size_t lengths[SLOW_HASH_MAX_WAYS];
+  for (size_t i = 0; i < count; ++i) {
+    if (!get_block_hashing_blob(*blocks[i], blobs[i])) {
+      return false;
+    }
+
+    data[i] = blobs[i].data();
+    lengths[i] = blobs[i].size();
+  }
+
+  cn_slow_hash_multi(context, data, lengths, res, count);
+  return true;
+}
+
 std::vector<uint32_t> relative_output_offsets_to_absolute(const std::vector<uint32_t>& off) {
   std::vector<uint32_t> res = off;
   for (size_t i = 1; i < res.size(); i++)
@@ -65,6 +65,7 @@ namespace CryptoNote
     m_handler(handler),
     m_pausers_count(0),
     m_threads_total(0),
+    m_hash_ways(1),
     m_starter_nonce(0),
     m_last_hr_merge_time(0),
     m_hashes(0),
@@ -165,6 +166,13 @@ namespace CryptoNote
   }
 
   bool miner::init(const MinerConfig& config) {
+    if (config.miningHashWays == 0 || config.miningHashWays > Crypto::SLOW_HASH_MAX_WAYS) {
+      logger(ERROR, BRIGHT_RED) << "Mining hash ways must be 1.." << Crypto::SLOW_HASH_MAX_WAYS;
+      return false;
+    }
+
+    m_hash_ways = config.miningHashWays;
+
     if (!config.extraMessages.empty()) {
       std::string buff;
       if (!Common::loadFileToString(config.extraMessages, buff)) {
@@ -367,8 +375,13 @@ namespace CryptoNote
     uint32_t nonce = m_starter_nonce + th_local_index;
     difficulty_type local_diff = 0;
     uint32_t local_template_ver = 0;
-    Crypto::cn_context context;
-    Block b;
+    const size_t ways = m_hash_ways;
+    Crypto::cn_multi_context context(ways);
+    Block blocks[Crypto::SLOW_HASH_MAX_WAYS];
+    const Block* blockPointers[Crypto::SLOW_HASH_MAX_WAYS];
+    for (size_t i = 0; i < ways; ++i) {
+      blockPointers[i] = &blocks[i];
+    }
 
     while(!m_stop)
     {
@@ -380,7 +393,9 @@ namespace CryptoNote
 
       if(local_template_ver != m_template_no) {
         std::unique_lock<std::mutex> lk(m_template_lock);
-        b = m_template;
+        for (size_t i = 0; i < ways; ++i) {
+          blocks[i] = m_template;
+        }
         local_diff = m_diffic;
         lk.unlock();
 
@@ -395,30 +410,36 @@ namespace CryptoNote
         continue;
       }
 
-      b.nonce = nonce;
-      Crypto::Hash h;
-      if (!m_stop && !get_block_longhash(context, b, h)) {
+      //every way takes the nonce the next thread round would have taken
+      for (size_t i = 0; i < ways; ++i) {
+        blocks[i].nonce = nonce + static_cast<uint32_t>(i) * m_threads_total;
+      }
+
+      Crypto::Hash hashes[Crypto::SLOW_HASH_MAX_WAYS];
+      if (!m_stop && !get_block_longhashes(context, blockPointers, ways, hashes)) {
         logger(ERROR) << "Failed to get block long hash";
         m_stop = true;
       }
 
-      if (!m_stop && check_hash(h, local_diff))
-      {
-        //we lucky!
-        ++m_config.current_extra_message_index;
+      for (size_t i = 0; i < ways && !m_stop; ++i) {
+        if (check_hash(hashes[i], local_diff))
+        {
+          //we lucky!
+          ++m_config.current_extra_message_index;
 
-        logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
+          logger(INFO, GREEN) << "Found block for difficulty: " << local_diff;
 
-        if(!m_handler.handle_block_found(b)) {
-          --m_config.current_extra_message_index;
-        } else {
-          //success update, lets update config
-          Common::saveStringToFile(m_config_folder_path + "/" + CryptoNote::parameters::MINER_CONFIG_FILE_NAME, storeToJson(m_config));
+          if(!m_handler.handle_block_found(blocks[i])) {
+            --m_config.current_extra_message_index;
+          } else {
+            //success update, lets update config
+            Common::saveStringToFile(m_config_folder_path + "/" + CryptoNote::parameters::MINER_CONFIG_FILE_NAME, storeToJson(m_config));
+          }
         }
       }
 
-      nonce += m_threads_total;
-      ++m_hashes;
+      nonce += m_threads_total * static_cast<uint32_t>(ways);
+      m_hashes += ways;
     }
     logger(INFO) << "Miner thread stopped ["<< th_local_index << "]";
     return true;
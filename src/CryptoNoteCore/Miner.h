@@ -92,6 +92,7 @@ namespace CryptoNote {
     difficulty_type m_diffic;
 
     std::atomic<uint32_t> m_threads_total;
+    size_t m_hash_ways;
     std::atomic<int32_t> m_pausers_count;
     std::mutex m_miners_count_lock;
 
@@ -38,16 +38,19 @@ namespace {
 const command_line::arg_descriptor<std::string> arg_extra_messages =  {"extra-messages-file", "Specify file for extra messages to include into coinbase transactions", "", true};
 const command_line::arg_descriptor<std::string> arg_start_mining =    {"start-mining", "Specify wallet address to mining for", "", true};
 const command_line::arg_descriptor<uint32_t>    arg_mining_threads =  {"mining-threads", "Specify mining threads count", 0, true};
+const command_line::arg_descriptor<uint32_t>    arg_mining_hash_ways = {"mining-hash-ways", "Specify nonces hashed at once by every mining thread, 1..4", 2, true};
 }
 
 MinerConfig::MinerConfig() {
   miningThreads = 0;
+  miningHashWays = 2;
 }
 
 void MinerConfig::initOptions(boost::program_options::options_description& desc) {
   command_line::add_arg(desc, arg_extra_messages);
   command_line::add_arg(desc, arg_start_mining);
   command_line::add_arg(desc, arg_mining_threads);
+  command_line::add_arg(desc, arg_mining_hash_ways);
 }
 
 void MinerConfig::init(const boost::program_options::variables_map& options) {
@@ -62,6 +65,10 @@ void MinerConfig::init(const boost::program_options::variables_map& options) {
   if (command_line::has_arg(options, arg_mining_threads)) {
     miningThreads = command_line::get_arg(options, arg_mining_threads);
   }
+
+  if (command_line::has_arg(options, arg_mining_hash_ways)) {
+    miningHashWays = command_line::get_arg(options, arg_mining_hash_ways);
+  }
 }
 
 } //namespace CryptoNote
@@ -47,6 +47,7 @@ public:
   std::string extraMessages;
   std::string startMining;
   uint32_t miningThreads;
+  uint32_t miningHashWays;
 };
 
 } //namespace CryptoNote
@@ -40,6 +40,7 @@
 #include <string>
 #include <vector>
 
+#include "Common/Metrics.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Serialization/BinaryInputStreamSerializer.h"
@@ -285,6 +286,11 @@ template<class T> typename SwappedVector<T>::const_iterator SwappedVector<T>::en
 }
 
 template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
+  static Common::MetricCounter& cacheHits = Common::MetricsRegistry::instance().counter("dynex_swapped_vector_cache_hits_total",
+    "Items read from the SwappedVector cache");
+  static Common::MetricCounter& cacheMisses = Common::MetricsRegistry::instance().counter("dynex_swapped_vector_cache_misses_total",
+    "Items loaded from the SwappedVector file");
+
   auto itemIter = m_items.find(index);
   if (itemIter != m_items.end()) {
     if (itemIter->second.cacheIter != --m_cache.end()) {
@@ -292,6 +298,7 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     }
 
     ++m_cacheHits;
+    cacheHits.add();
     return itemIter->second.item;
   }
 
@@ -313,6 +320,7 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
   T* item = prepare(index);
   std::swap(tempItem, *item);
   ++m_cacheMisses;
+  cacheMisses.add();
   return *item;
 }
 
@@ -35,6 +35,7 @@
 #include "Account.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteConfig.h"
+#include "Common/ParallelFor.h"
 
 #include <boost/optional.hpp>
 #include <numeric>
@@ -120,6 +121,7 @@ namespace CryptoNote {
     virtual size_t addOutput(uint64_t amount, const MultisignatureOutput& out) override;
 
     virtual void signInputKey(size_t input, const TransactionTypes::InputKeyInfo& info, const KeyPair& ephKeys) override;
+    virtual void signInputKeys(const std::vector<std::pair<TransactionTypes::InputKeyInfo, KeyPair>>& inputs, size_t threadCount) override;
     virtual void signInputMultisignature(size_t input, const PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) override;
     virtual void signInputMultisignature(size_t input, const KeyPair& ephemeralKeys) override;
 
@@ -363,6 +365,51 @@ namespace CryptoNote {
     invalidateHash();
   }
 
+  void TransactionImpl::signInputKeys(const std::vector<std::pair<TransactionTypes::InputKeyInfo, KeyPair>>& inputs, size_t threadCount) {
+    std::vector<const KeyInput*> keyInputs;
+    keyInputs.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      keyInputs.push_back(&boost::get<KeyInput>(getInputChecked(transaction, i, TransactionTypes::InputType::Key)));
+    }
+
+    Hash prefixHash = getTransactionPrefixHash();
+
+    // randomness is drawn in input order, so the result doesn't depend on the thread count
+    std::vector<std::vector<EllipticCurveScalar>> randomness(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      randomness[i].resize(ring_signature_randomness_size(inputs[i].first.outputs.size()));
+      generate_ring_signature_randomness(inputs[i].first.outputs.size(), randomness[i].data());
+    }
+
+    std::vector<std::vector<Signature>> signatures(inputs.size());
+    Common::parallelFor(inputs.size(), threadCount, [&](size_t i) {
+      const TransactionTypes::InputKeyInfo& info = inputs[i].first;
+
+      std::vector<const PublicKey*> keysPtrs;
+      for (const auto& o : info.outputs) {
+        keysPtrs.push_back(reinterpret_cast<const PublicKey*>(&o.targetKey));
+      }
+
+      signatures[i].resize(keysPtrs.size());
+
+      generate_ring_signature(
+        prefixHash,
+        keyInputs[i]->keyImage,
+        keysPtrs.data(),
+        keysPtrs.size(),
+        inputs[i].second.secretKey,
+        info.realOutput.transactionIndex,
+        randomness[i].data(),
+        signatures[i].data());
+    });
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      getSignatures(i) = std::move(signatures[i]);
+    }
+
+    invalidateHash();
+  }
+
   void TransactionImpl::signInputMultisignature(size_t index, const PublicKey& sourceTransactionKey, size_t outputIndex, const AccountKeys& accountKeys) {
     KeyDerivation derivation;
     PublicKey ephemeralPublicKey;
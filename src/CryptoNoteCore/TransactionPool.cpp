@@ -38,6 +38,7 @@
 #include <boost/filesystem.hpp>
 
 #include "Common/int-util.h"
+#include "Common/Metrics.h"
 #include "Common/Util.h"
 #include "crypto/hash.h"
 
@@ -52,6 +53,26 @@ using namespace Logging;
 
 #undef ERROR
 
+namespace {
+
+struct PoolMetrics {
+  Common::MetricGauge& transactions;
+  Common::MetricCounter& added;
+  Common::MetricCounter& removed;
+};
+
+PoolMetrics& poolMetrics() {
+  static PoolMetrics metrics = {
+    Common::MetricsRegistry::instance().gauge("dynex_mempool_transactions", "Transactions in the memory pool"),
+    Common::MetricsRegistry::instance().counter("dynex_mempool_added_total", "Transactions added to the memory pool"),
+    Common::MetricsRegistry::instance().counter("dynex_mempool_removed_total", "Transactions removed from the memory pool")
+  };
+
+  return metrics;
+}
+
+}
+
 namespace CryptoNote {
 
   //---------------------------------------------------------------------------------
@@ -221,6 +242,8 @@ namespace CryptoNote {
       }
       m_paymentIdIndex.add(txd.tx);
       m_timestampIndex.add(txd.receiveTime, txd.id);
+      poolMetrics().added.add();
+      poolMetrics().transactions.set(static_cast<int64_t>(m_transactions.size()));
 
     }
 
@@ -273,6 +296,14 @@ namespace CryptoNote {
     }
   }
   //---------------------------------------------------------------------------------
+  void tx_memory_pool::get_transaction_ids(std::vector<Crypto::Hash>& ids) const {
+    std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
+    ids.reserve(ids.size() + m_transactions.size());
+    for (const auto& tx_vt : m_transactions) {
+      ids.push_back(tx_vt.id);
+    }
+  }
+  //---------------------------------------------------------------------------------
   void tx_memory_pool::get_difference(const std::vector<Crypto::Hash>& known_tx_ids, std::vector<Crypto::Hash>& new_tx_ids, std::vector<Crypto::Hash>& deleted_tx_ids) const {
     std::lock_guard<std::recursive_mutex> lock(m_transactions_lock);
     std::unordered_set<Crypto::Hash> ready_tx_ids;
@@ -439,6 +470,7 @@ namespace CryptoNote {
     }
 
     removeExpiredTransactions();
+    poolMetrics().transactions.set(static_cast<int64_t>(m_transactions.size()));
 
     // Ignore deserialization error
     return true;
@@ -550,7 +582,10 @@ namespace CryptoNote {
     removeTransactionInputs(i->id, i->tx, i->keptByBlock);
     m_paymentIdIndex.remove(i->tx);
     m_timestampIndex.remove(i->receiveTime, i->id);
-    return m_transactions.erase(i);
+    auto next = m_transactions.erase(i);
+    poolMetrics().removed.add();
+    poolMetrics().transactions.set(static_cast<int64_t>(m_transactions.size()));
+    return next;
   }
 
   bool tx_memory_pool::removeTransactionInputs(const Crypto::Hash& tx_id, const Transaction& tx, bool keptByBlock) {
@@ -0,0 +1,279 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
+
+#include "BlockImportPipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include <System/Dispatcher.h>
+#include <System/RemoteContext.h>
+
+#include "Common/BlockingQueue.h"
+#include "Common/ScopeExit.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/ICore.h"
+
+namespace CryptoNote {
+
+namespace {
+
+// blocks whose long hashes a worker computes together, see Crypto::cn_slow_hash_multi
+const size_t PROOF_OF_WORK_WAYS = 2;
+
+uint64_t microsecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+BlockImportPipeline::BlockImportPipeline(System::Dispatcher& dispatcher, const Currency& currency, ICore& core, size_t threadCount, size_t maxReadAhead) :
+  m_dispatcher(dispatcher), m_currency(currency), m_core(core), m_threadCount(threadCount), m_maxReadAhead(maxReadAhead) {
+
+  if (m_threadCount == 0) {
+    m_threadCount = std::thread::hardware_concurrency();
+    if (m_threadCount == 0) {
+      m_threadCount = 2;
+    }
+  }
+
+  if (m_maxReadAhead < m_threadCount * PROOF_OF_WORK_WAYS) {
+    m_maxReadAhead = m_threadCount * PROOF_OF_WORK_WAYS;
+  }
+
+  for (StageCounters* counters : { &m_decode, &m_proofOfWork, &m_commit }) {
+    counters->items = 0;
+    counters->busyMicroseconds = 0;
+  }
+}
+
+void BlockImportPipeline::process(const std::vector<block_complete_entry>& blocks, const CommitHandler& commit) {
+  size_t count = blocks.size();
+  std::vector<PreparedBlock> prepared(count);
+  for (size_t i = 0; i < count; ++i) {
+    prepared[i].entry = &blocks[i];
+  }
+
+  std::mutex mutex;
+  std::condition_variable preparedChanged;
+  std::condition_variable committedChanged;
+  std::vector<bool> ready(count, false);
+  size_t committed = 0;
+  std::atomic<bool> stop(false);
+
+  BlockingQueue<size_t> inputQueue(m_threadCount * 2);
+
+  // feeds indices of the first block of every run of PROOF_OF_WORK_WAYS blocks to workers,
+  // keeping them at most m_maxReadAhead blocks ahead of commit
+  auto feeder = std::async(std::launch::async, [&] {
+    for (size_t i = 0; i < count; i += PROOF_OF_WORK_WAYS) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stop && i >= committed + m_maxReadAhead) {
+          committedChanged.wait(lock);
+        }
+      }
+
+      if (stop || !inputQueue.push(i)) {
+        break;
+      }
+    }
+
+    inputQueue.close();
+  });
+
+  std::vector<std::future<void>> workers;
+  for (size_t i = 0; i < m_threadCount && i * PROOF_OF_WORK_WAYS < count; ++i) {
+    workers.push_back(std::async(std::launch::async, [&] {
+      Crypto::cn_multi_context context(PROOF_OF_WORK_WAYS);
+      size_t first;
+      while (!stop && inputQueue.pop(first)) {
+        size_t last = std::min(first + PROOF_OF_WORK_WAYS, count);
+        try {
+          prepare(&prepared[first], last - first, context);
+        } catch (std::exception&) {
+          for (size_t index = first; index < last; ++index) {
+            prepared[index].valid = false;
+          }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t index = first; index < last; ++index) {
+          ready[index] = true;
+        }
+
+        preparedChanged.notify_all();
+      }
+    }));
+  }
+
+  Tools::ScopeExit joinStages([&] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+      committedChanged.notify_all();
+    }
+
+    inputQueue.close();
+    System::RemoteContext<void>(m_dispatcher, [&] {
+      feeder.wait();
+      for (auto& worker : workers) {
+        worker.wait();
+      }
+    }).get();
+  });
+
+  for (size_t next = 0; next < count; ++next) {
+    bool isReady;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      isReady = ready[next];
+    }
+
+    if (!isReady) {
+      System::RemoteContext<void>(m_dispatcher, [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!ready[next]) {
+          preparedChanged.wait(lock);
+        }
+      }).get();
+    }
+
+    auto commitStart = std::chrono::steady_clock::now();
+    bool proceed = commit(prepared[next]);
+    m_commit.busyMicroseconds += microsecondsSince(commitStart);
+    ++m_commit.items;
+
+    // release memory of committed blocks, the batch may be large
+    prepared[next] = PreparedBlock();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      committed = next + 1;
+      committedChanged.notify_all();
+    }
+
+    if (!proceed) {
+      break;
+    }
+  }
+}
+
+void BlockImportPipeline::prepare(PreparedBlock* blocks, size_t count, Crypto::cn_multi_context& context) {
+  const Block* proofOfWorkBlocks[Crypto::SLOW_HASH_MAX_WAYS];
+  Crypto::Hash proofsOfWork[Crypto::SLOW_HASH_MAX_WAYS];
+  PreparedBlock* proofOfWorkTargets[Crypto::SLOW_HASH_MAX_WAYS];
+  size_t proofOfWorkCount = 0;
+
+  for (size_t i = 0; i < count; ++i) {
+    PreparedBlock& prepared = blocks[i];
+    prepared.hasProofOfWork = false;
+    prepared.valid = decode(prepared);
+
+    // blocks in the checkpoint zone are verified by their hash, long hash isn't needed
+    if (prepared.valid && !m_core.isInCheckpointZone(get_block_height(prepared.block))) {
+      proofOfWorkBlocks[proofOfWorkCount] = &prepared.block;
+      proofOfWorkTargets[proofOfWorkCount] = &prepared;
+      ++proofOfWorkCount;
+    }
+  }
+
+  if (proofOfWorkCount == 0) {
+    return;
+  }
+
+  auto proofOfWorkStart = std::chrono::steady_clock::now();
+  bool hashed = get_block_longhashes(context, proofOfWorkBlocks, proofOfWorkCount, proofsOfWork);
+  m_proofOfWork.busyMicroseconds += microsecondsSince(proofOfWorkStart);
+  m_proofOfWork.items += proofOfWorkCount;
+
+  for (size_t i = 0; i < proofOfWorkCount; ++i) {
+    proofOfWorkTargets[i]->hasProofOfWork = hashed;
+    proofOfWorkTargets[i]->proofOfWork = proofsOfWork[i];
+  }
+}
+
+bool BlockImportPipeline::decode(PreparedBlock& prepared) {
+  auto decodeStart = std::chrono::steady_clock::now();
+
+  // oversized blobs are rejected before anything is parsed or hashed
+  if (prepared.entry->block.size() > m_currency.maxBlockBlobSize()) {
+    return false;
+  }
+
+  for (const auto& txBlob : prepared.entry->txs) {
+    if (txBlob.size() > m_currency.maxTxSize()) {
+      return false;
+    }
+  }
+
+  if (!fromBinaryArray(prepared.block, Common::asBinaryArray(prepared.entry->block)) || !get_block_hash(prepared.block, prepared.hash)) {
+    return false;
+  }
+
+  prepared.transactions.resize(prepared.entry->txs.size());
+  for (size_t i = 0; i < prepared.entry->txs.size(); ++i) {
+    const BinaryArray txBlob = Common::asBinaryArray(prepared.entry->txs[i]);
+    PreparedTransaction& tx = prepared.transactions[i];
+    Crypto::Hash prefixHash;
+    if (!parseAndValidateTransactionFromBinaryArray(txBlob, tx.tx, tx.hash, prefixHash)) {
+      return false;
+    }
+
+    tx.blobSize = txBlob.size();
+  }
+
+  m_decode.busyMicroseconds += microsecondsSince(decodeStart);
+  ++m_decode.items;
+  return true;
+}
+
+BlockImportStatistics BlockImportPipeline::getStatistics() const {
+  BlockImportStatistics statistics;
+  statistics.decode = toStatistics(m_decode);
+  statistics.proofOfWork = toStatistics(m_proofOfWork);
+  statistics.commit = toStatistics(m_commit);
+  return statistics;
+}
+
+BlockImportStageStatistics BlockImportPipeline::toStatistics(const StageCounters& counters) {
+  BlockImportStageStatistics statistics;
+  statistics.items = counters.items;
+  statistics.busyMicroseconds = counters.busyMicroseconds;
+  return statistics;
+}
+
+}
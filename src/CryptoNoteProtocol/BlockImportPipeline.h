@@ -0,0 +1,113 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
+
+namespace System {
+class Dispatcher;
+}
+
+namespace CryptoNote {
+
+class Currency;
+class ICore;
+
+struct BlockImportStageStatistics {
+  uint64_t items;
+  uint64_t busyMicroseconds;
+};
+
+struct BlockImportStatistics {
+  BlockImportStageStatistics decode;
+  BlockImportStageStatistics proofOfWork;
+  BlockImportStageStatistics commit;
+};
+
+// Imports a batch of downloaded blocks in stages:
+//   decode       - check blob sizes, parse transactions and compute their hashes, in parallel per block
+//   proofOfWork  - compute the block long hash, several blocks interleaved per worker, skipped in the checkpoint zone
+//   commit       - add transactions and the block to the core, serially, in order, on the dispatcher
+// The first two stages run on worker threads and never get more than maxReadAhead blocks ahead of commit.
+// While commit waits for them the dispatcher keeps serving other contexts.
+class BlockImportPipeline {
+public:
+  struct PreparedTransaction {
+    Transaction tx;
+    Crypto::Hash hash;
+    size_t blobSize;
+  };
+
+  struct PreparedBlock {
+    const block_complete_entry* entry;
+    Block block;
+    Crypto::Hash hash;
+    std::vector<PreparedTransaction> transactions;
+    bool hasProofOfWork;
+    Crypto::Hash proofOfWork;
+    bool valid;
+  };
+
+  // Returns false to stop the import.
+  typedef std::function<bool(PreparedBlock&)> CommitHandler;
+
+  BlockImportPipeline(System::Dispatcher& dispatcher, const Currency& currency, ICore& core, size_t threadCount = 0, size_t maxReadAhead = 64);
+
+  void process(const std::vector<block_complete_entry>& blocks, const CommitHandler& commit);
+  BlockImportStatistics getStatistics() const;
+
+private:
+  struct StageCounters {
+    std::atomic<uint64_t> items;
+    std::atomic<uint64_t> busyMicroseconds;
+  };
+
+  void prepare(PreparedBlock* blocks, size_t count, Crypto::cn_multi_context& context);
+  bool decode(PreparedBlock& block);
+  static BlockImportStageStatistics toStatistics(const StageCounters& counters);
+
+  System::Dispatcher& m_dispatcher;
+  const Currency& m_currency;
+  ICore& m_core;
+  size_t m_threadCount;
+  size_t m_maxReadAhead;
+
+  StageCounters m_decode;
+  StageCounters m_proofOfWork;
+  StageCounters m_commit;
+};
+
+}
@@ -32,6 +32,7 @@
 
 #include <list>
 #include "CryptoNoteCore/CryptoNoteBasic.h"
+#include "crypto/hash.h"
 
 // ISerializer-based serialization
 #include "Serialization/ISerializer.h"
@@ -222,4 +223,83 @@ namespace CryptoNote
     const static int ID = BC_COMMANDS_POOL_BASE + 8;
     typedef NOTIFY_REQUEST_TX_POOL_request request;
   };
+
+  /************************************************************************/
+  /*                                                                      */
+  /************************************************************************/
+  // Short transaction id used by compact block relay: first 8 bytes of Keccak(salt || txHash).
+  // The salt is chosen per announcement by the sender, so colliding ids cannot be precomputed.
+  inline uint64_t getCompactTransactionShortId(uint64_t salt, const Crypto::Hash& txHash) {
+    uint8_t data[sizeof(salt) + sizeof(txHash)];
+    memcpy(data, &salt, sizeof(salt));
+    memcpy(data + sizeof(salt), &txHash, sizeof(txHash));
+
+    Crypto::Hash hash;
+    Crypto::cn_fast_hash(data, sizeof(data), hash);
+
+    uint64_t shortId;
+    memcpy(&shortId, &hash, sizeof(shortId));
+    return shortId;
+  }
+
+  struct NOTIFY_NEW_COMPACT_BLOCK_request
+  {
+    Crypto::Hash blockHash;
+    std::string block; // block blob without transactionHashes: header and base transaction only
+    uint64_t salt;
+    std::vector<uint64_t> shortTxIds;
+    uint32_t current_blockchain_height;
+    uint32_t hop;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(blockHash)
+      KV_MEMBER(block)
+      KV_MEMBER(salt)
+      serializeAsBinary(shortTxIds, "shortTxIds", s);
+      KV_MEMBER(current_blockchain_height)
+      KV_MEMBER(hop)
+    }
+  };
+
+  struct NOTIFY_NEW_COMPACT_BLOCK
+  {
+    const static int ID = BC_COMMANDS_POOL_BASE + 9;
+    typedef NOTIFY_NEW_COMPACT_BLOCK_request request;
+  };
+
+  struct NOTIFY_REQUEST_COMPACT_BLOCK_TXS_request
+  {
+    Crypto::Hash blockHash;
+    std::vector<uint32_t> indices;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(blockHash)
+      serializeAsBinary(indices, "indices", s);
+    }
+  };
+
+  struct NOTIFY_REQUEST_COMPACT_BLOCK_TXS
+  {
+    const static int ID = BC_COMMANDS_POOL_BASE + 10;
+    typedef NOTIFY_REQUEST_COMPACT_BLOCK_TXS_request request;
+  };
+
+  struct NOTIFY_RESPONSE_COMPACT_BLOCK_TXS_request
+  {
+    Crypto::Hash blockHash;
+    std::vector<uint32_t> indices;
+    std::vector<std::string> txs;
+
+    void serialize(ISerializer& s) {
+      KV_MEMBER(blockHash)
+      serializeAsBinary(indices, "indices", s);
+      KV_MEMBER(txs)
+    }
+  };
+
+  struct NOTIFY_RESPONSE_COMPACT_BLOCK_TXS
+  {
+    const static int ID = BC_COMMANDS_POOL_BASE + 11;
+    typedef NOTIFY_RESPONSE_COMPACT_BLOCK_TXS_request request;
+  };
 }
@@ -31,6 +31,7 @@
 #include "CryptoNoteProtocolHandler.h"
 
 #include <future>
+#include <unordered_map>
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <System/Dispatcher.h>
@@ -65,6 +66,7 @@ CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(const Currency& currency, S
   m_dispatcher(dispatcher),
   m_currency(currency),
   m_core(rcore),
+  m_blockImportPipeline(dispatcher, currency, rcore),
   m_p2p(p_net_layout),
   m_synchronized(false),
   m_stop(false),
@@ -92,6 +94,8 @@ void CryptoNoteProtocolHandler::onConnectionOpened(CryptoNoteConnectionContext&
 }
 
 void CryptoNoteProtocolHandler::onConnectionClosed(CryptoNoteConnectionContext& context) {
+  m_pendingCompactBlocks.erase(context.m_connection_id);
+
   bool updated = false;
   {
     std::lock_guard<std::mutex> lock(m_observedHeightMutex);
@@ -238,6 +242,9 @@ int CryptoNoteProtocolHandler::handleCommand(bool is_notify, int command, const
     HANDLE_NOTIFY(NOTIFY_REQUEST_CHAIN, &CryptoNoteProtocolHandler::handle_request_chain)
     HANDLE_NOTIFY(NOTIFY_RESPONSE_CHAIN_ENTRY, &CryptoNoteProtocolHandler::handle_response_chain_entry)
     HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, &CryptoNoteProtocolHandler::handleRequestTxPool)
+    HANDLE_NOTIFY(NOTIFY_NEW_COMPACT_BLOCK, &CryptoNoteProtocolHandler::handle_notify_new_compact_block)
+    HANDLE_NOTIFY(NOTIFY_REQUEST_COMPACT_BLOCK_TXS, &CryptoNoteProtocolHandler::handle_request_compact_block_txs)
+    HANDLE_NOTIFY(NOTIFY_RESPONSE_COMPACT_BLOCK_TXS, &CryptoNoteProtocolHandler::handle_response_compact_block_txs)
 
   default:
     handled = false;
@@ -269,6 +276,10 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
     }
   }
 
+  return processNewBlock(arg, context);
+}
+
+int CryptoNoteProtocolHandler::processNewBlock(NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context) {
   block_verification_context bvc = boost::value_initialized<block_verification_context>();
   m_core.handle_incoming_block_blob(asBinaryArray(arg.b.block), bvc, true, false);
   if (bvc.m_verifivation_failed) {
@@ -278,9 +289,7 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
   }
   if (bvc.m_added_to_main_chain) {
     ++arg.hop;
-    //TODO: Add here announce protocol usage
-    relay_post_notify<NOTIFY_NEW_BLOCK>(*m_p2p, arg, &context.m_connection_id);
-    // relay_block(arg, context);
+    relayBlock(arg, &context.m_connection_id);
 
     if (bvc.m_switched_to_alt_chain) {
       requestMissingPoolTransactions(context);
@@ -296,6 +305,178 @@ int CryptoNoteProtocolHandler::handle_notify_new_block(int command, NOTIFY_NEW_B
   return 1;
 }
 
+int CryptoNoteProtocolHandler::handle_notify_new_compact_block(int command, NOTIFY_NEW_COMPACT_BLOCK::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_NEW_COMPACT_BLOCK (hop " << arg.hop << ", txs " << arg.shortTxIds.size() << ")";
+
+  updateObservedHeight(arg.current_blockchain_height, context);
+
+  context.m_remote_blockchain_height = arg.current_blockchain_height;
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  if (m_core.have_block(arg.blockHash)) {
+    return 1;
+  }
+
+  PendingCompactBlock pending;
+  if (!fromBinaryArray(pending.block, asBinaryArray(arg.block)) || !pending.block.transactionHashes.empty()) {
+    logger(Logging::INFO) << context << "Failed to parse compact block, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  pending.blockHash = arg.blockHash;
+  pending.currentBlockchainHeight = arg.current_blockchain_height;
+  pending.hop = arg.hop;
+  pending.fullListRequested = false;
+  pending.block.transactionHashes.resize(arg.shortTxIds.size());
+
+  if (!arg.shortTxIds.empty()) {
+    std::unordered_map<uint64_t, Crypto::Hash> poolShortIds;
+    for (const auto& txHash : m_core.getPoolTransactionHashes()) {
+      poolShortIds.emplace(getCompactTransactionShortId(arg.salt, txHash), txHash);
+    }
+
+    for (uint32_t i = 0; i < arg.shortTxIds.size(); ++i) {
+      auto it = poolShortIds.find(arg.shortTxIds[i]);
+      if (it == poolShortIds.end()) {
+        pending.missingIndices.push_back(i);
+      } else {
+        pending.block.transactionHashes[i] = it->second;
+      }
+    }
+  }
+
+  if (pending.missingIndices.empty()) {
+    return processCompactBlock(pending, context);
+  }
+
+  logger(Logging::TRACE) << context << "Compact block " << pending.blockHash << " misses " << pending.missingIndices.size() << " of " <<
+    arg.shortTxIds.size() << " transactions";
+  requestCompactBlockTransactions(pending, context);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_request_compact_block_txs(int command, NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_REQUEST_COMPACT_BLOCK_TXS: indices.size()=" << arg.indices.size();
+
+  Block block;
+  if (!m_core.getBlockByHash(arg.blockHash, block)) {
+    logger(Logging::DEBUGGING) << context << "Transactions requested for unknown block " << arg.blockHash;
+    return 1;
+  }
+
+  std::vector<Crypto::Hash> txHashes;
+  txHashes.reserve(arg.indices.size());
+  for (auto index : arg.indices) {
+    if (index >= block.transactionHashes.size()) {
+      logger(Logging::ERROR) << context << "sent wrong NOTIFY_REQUEST_COMPACT_BLOCK_TXS: transaction index " << index <<
+        " is out of range, dropping connection";
+      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      return 1;
+    }
+
+    txHashes.push_back(block.transactionHashes[index]);
+  }
+
+  std::list<Transaction> txs;
+  std::list<Crypto::Hash> missedTxs;
+  m_core.getTransactions(txHashes, txs, missedTxs, true);
+  if (!missedTxs.empty()) {
+    logger(Logging::DEBUGGING) << context << "Can't find " << missedTxs.size() << " transactions of block " << arg.blockHash;
+    return 1;
+  }
+
+  NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request rsp;
+  rsp.blockHash = arg.blockHash;
+  rsp.indices = std::move(arg.indices);
+  for (auto& tx : txs) {
+    rsp.txs.push_back(asString(toBinaryArray(tx)));
+  }
+
+  logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_COMPACT_BLOCK_TXS: txs.size()=" << rsp.txs.size();
+  post_notify<NOTIFY_RESPONSE_COMPACT_BLOCK_TXS>(*m_p2p, rsp, context);
+  return 1;
+}
+
+int CryptoNoteProtocolHandler::handle_response_compact_block_txs(int command, NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context) {
+  logger(Logging::TRACE) << context << "NOTIFY_RESPONSE_COMPACT_BLOCK_TXS: txs.size()=" << arg.txs.size();
+
+  auto it = m_pendingCompactBlocks.find(context.m_connection_id);
+  if (it == m_pendingCompactBlocks.end() || it->second.blockHash != arg.blockHash) {
+    logger(Logging::DEBUGGING) << context << "Unexpected NOTIFY_RESPONSE_COMPACT_BLOCK_TXS for block " << arg.blockHash << ", ignoring";
+    return 1;
+  }
+
+  PendingCompactBlock pending = std::move(it->second);
+  m_pendingCompactBlocks.erase(it);
+
+  if (arg.indices != pending.missingIndices || arg.txs.size() != arg.indices.size()) {
+    logger(Logging::ERROR) << context << "sent wrong NOTIFY_RESPONSE_COMPACT_BLOCK_TXS: transactions don't match the request, dropping connection";
+    context.m_state = CryptoNoteConnectionContext::state_shutdown;
+    return 1;
+  }
+
+  if (context.m_state != CryptoNoteConnectionContext::state_normal) {
+    return 1;
+  }
+
+  for (size_t i = 0; i < arg.txs.size(); ++i) {
+    BinaryArray txBlob = asBinaryArray(arg.txs[i]);
+    pending.block.transactionHashes[arg.indices[i]] = getBinaryArrayHash(txBlob);
+
+    tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
+    m_core.handle_incoming_tx(txBlob, tvc, true);
+    if (tvc.m_verifivation_failed) {
+      logger(Logging::INFO) << context << "Block verification failed: transaction verification failed, dropping connection";
+      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      return 1;
+    }
+  }
+
+  pending.missingIndices.clear();
+  return processCompactBlock(pending, context);
+}
+
+int CryptoNoteProtocolHandler::processCompactBlock(PendingCompactBlock& pending, CryptoNoteConnectionContext& context) {
+  if (get_block_hash(pending.block) != pending.blockHash) {
+    if (pending.fullListRequested) {
+      logger(Logging::INFO) << context << "Failed to reconstruct compact block " << pending.blockHash << ", dropping connection";
+      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      return 1;
+    }
+
+    // Short id collision with a pool transaction: fetch the whole transaction list from the peer
+    logger(Logging::DEBUGGING) << context << "Compact block " << pending.blockHash << " doesn't match the pool, requesting all transactions";
+    pending.missingIndices.resize(pending.block.transactionHashes.size());
+    for (uint32_t i = 0; i < pending.missingIndices.size(); ++i) {
+      pending.missingIndices[i] = i;
+    }
+
+    pending.fullListRequested = true;
+    requestCompactBlockTransactions(pending, context);
+    return 1;
+  }
+
+  NOTIFY_NEW_BLOCK::request arg;
+  arg.b.block = asString(toBinaryArray(pending.block));
+  arg.current_blockchain_height = pending.currentBlockchainHeight;
+  arg.hop = pending.hop;
+  return processNewBlock(arg, context);
+}
+
+void CryptoNoteProtocolHandler::requestCompactBlockTransactions(PendingCompactBlock& pending, CryptoNoteConnectionContext& context) {
+  NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request req;
+  req.blockHash = pending.blockHash;
+  req.indices = pending.missingIndices;
+
+  logger(Logging::TRACE) << context << "-->>NOTIFY_REQUEST_COMPACT_BLOCK_TXS: indices.size()=" << req.indices.size();
+  post_notify<NOTIFY_REQUEST_COMPACT_BLOCK_TXS>(*m_p2p, req, context);
+  m_pendingCompactBlocks[context.m_connection_id] = std::move(pending);
+}
+
 int CryptoNoteProtocolHandler::handle_notify_new_transactions(int command, NOTIFY_NEW_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context) {
   logger(Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTIONS";
   if (context.m_state != CryptoNoteConnectionContext::state_normal)
@@ -421,49 +602,62 @@ int CryptoNoteProtocolHandler::handle_response_get_objects(int command, NOTIFY_R
 }
 
 int CryptoNoteProtocolHandler::processObjects(CryptoNoteConnectionContext& context, const std::vector<block_complete_entry>& blocks) {
+  int result = 0;
 
-  for (const block_complete_entry& block_entry : blocks) {
+  m_blockImportPipeline.process(blocks, [&](BlockImportPipeline::PreparedBlock& prepared) {
     if (m_stop) {
-      break;
+      return false;
+    }
+
+    if (!prepared.valid) {
+      logger(Logging::ERROR) << context << "sent wrong block: block or its transactions are too big or failed to parse on NOTIFY_RESPONSE_GET_OBJECTS, dropping connection";
+      context.m_state = CryptoNoteConnectionContext::state_shutdown;
+      result = 1;
+      return false;
     }
 
     //process transactions
-    for (auto& tx_blob : block_entry.txs) {
+    for (auto& tx : prepared.transactions) {
       tx_verification_context tvc = boost::value_initialized<decltype(tvc)>();
-      m_core.handle_incoming_tx(asBinaryArray(tx_blob), tvc, true);
+      m_core.handleIncomingTransaction(tx.tx, tx.hash, tx.blobSize, tvc, true);
+
       if (tvc.m_verifivation_failed) {
         logger(Logging::ERROR) << context << "transaction verification failed on NOTIFY_RESPONSE_GET_OBJECTS, \r\ntx_id = "
-          << Common::podToHex(getBinaryArrayHash(asBinaryArray(tx_blob))) << ", dropping connection";
+          << Common::podToHex(tx.hash) << ", dropping connection";
         context.m_state = CryptoNoteConnectionContext::state_shutdown;
-        return 1;
+        result = 1;
+        return false;
       }
     }
 
     // process block
     block_verification_context bvc = boost::value_initialized<block_verification_context>();
-    m_core.handle_incoming_block_blob(asBinaryArray(block_entry.block), bvc, false, false);
+    m_core.handleIncomingBlock(prepared.block, prepared.hasProofOfWork ? &prepared.proofOfWork : nullptr, bvc, false, false);
 
     if (bvc.m_verifivation_failed) {
       logger(Logging::DEBUGGING) << context << "Block verification failed, dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
-      return 1;
+      result = 1;
+      return false;
     } else if (bvc.m_marked_as_orphaned) {
       logger(Logging::INFO) << context << "Block received at sync phase was marked as orphaned, dropping connection";
       context.m_state = CryptoNoteConnectionContext::state_shutdown;
-      return 1;
+      result = 1;
+      return false;
     } else if (bvc.m_already_exists) {
       logger(Logging::DEBUGGING) << context << "Block already exists, switching to idle state";
       context.m_state = CryptoNoteConnectionContext::state_idle;
       context.m_needed_objects.clear();
       context.m_requested_objects.clear();
-      return 1;
+      result = 1;
+      return false;
     }
 
     m_dispatcher.yield();
-  }
-
-  return 0;
+    return true;
+  });
 
+  return result;
 }
 
 
@@ -627,8 +821,72 @@ int CryptoNoteProtocolHandler::handleRequestTxPool(int command, NOTIFY_REQUEST_T
 
 
 void CryptoNoteProtocolHandler::relay_block(NOTIFY_NEW_BLOCK::request& arg) {
-  auto buf = LevinProtocol::encode(arg);
-  m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_BLOCK::ID, buf);
+  // can be called from external threads, connections are only touched from the dispatcher
+  m_dispatcher.remoteSpawn([this, arg]() mutable {
+    relayBlock(arg, nullptr);
+  });
+}
+
+void CryptoNoteProtocolHandler::relayBlock(NOTIFY_NEW_BLOCK::request& arg, const net_connection_id* excludeConnection) {
+  Block block;
+  if (!fromBinaryArray(block, asBinaryArray(arg.b.block))) {
+    logger(Logging::ERROR) << "Failed to parse block for relay";
+    return;
+  }
+
+  NOTIFY_NEW_COMPACT_BLOCK::request compact;
+  compact.blockHash = get_block_hash(block);
+  compact.salt = Crypto::rand<uint64_t>();
+  compact.current_blockchain_height = arg.current_blockchain_height;
+  compact.hop = arg.hop;
+  compact.shortTxIds.reserve(block.transactionHashes.size());
+  for (const auto& txHash : block.transactionHashes) {
+    compact.shortTxIds.push_back(getCompactTransactionShortId(compact.salt, txHash));
+  }
+
+  block.transactionHashes.clear();
+  compact.block = asString(toBinaryArray(block));
+
+  BinaryArray compactBuffer = LevinProtocol::encode(compact);
+  BinaryArray fullBuffer;
+  net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
+
+  m_p2p->for_each_connection([&](CryptoNoteConnectionContext& conn, PeerIdType peerId) {
+    if (peerId == 0 || conn.m_connection_id == excludeId ||
+        (conn.m_state != CryptoNoteConnectionContext::state_normal && conn.m_state != CryptoNoteConnectionContext::state_synchronizing)) {
+      return;
+    }
+
+    if (conn.version >= P2PProtocolVersion::V2) {
+      m_p2p->invoke_notify_to_peer(NOTIFY_NEW_COMPACT_BLOCK::ID, compactBuffer, conn);
+      return;
+    }
+
+    // peers without compact block support still get the full block with every transaction blob
+    if (fullBuffer.empty()) {
+      if (arg.b.txs.size() != compact.shortTxIds.size()) {
+        Block fullBlock;
+        fromBinaryArray(fullBlock, asBinaryArray(arg.b.block));
+
+        std::list<Transaction> txs;
+        std::list<Crypto::Hash> missedTxs;
+        m_core.getTransactions(fullBlock.transactionHashes, txs, missedTxs, true);
+        if (!missedTxs.empty()) {
+          logger(Logging::ERROR) << "Can't find " << missedTxs.size() << " transactions of block " << compact.blockHash << " for relay";
+          return;
+        }
+
+        arg.b.txs.clear();
+        for (auto& tx : txs) {
+          arg.b.txs.push_back(asString(toBinaryArray(tx)));
+        }
+      }
+
+      fullBuffer = LevinProtocol::encode(arg);
+    }
+
+    m_p2p->invoke_notify_to_peer(NOTIFY_NEW_BLOCK::ID, fullBuffer, conn);
+  });
 }
 
 void CryptoNoteProtocolHandler::relay_transactions(NOTIFY_NEW_TRANSACTIONS::request& arg) {
@@ -654,6 +912,27 @@ void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteC
   }
 }
 
+BlockImportStatistics CryptoNoteProtocolHandler::getBlockImportStatistics() const {
+  return m_blockImportPipeline.getStatistics();
+}
+
+void CryptoNoteProtocolHandler::log_block_import_statistics() {
+  auto statistics = getBlockImportStatistics();
+  auto printStage = [](std::stringstream& ss, const char* name, const BlockImportStageStatistics& stage) {
+    ss << std::setw(15) << std::left << name
+      << std::setw(15) << stage.items
+      << std::setw(20) << stage.busyMicroseconds / 1000
+      << std::setw(15) << (stage.busyMicroseconds != 0 ? stage.items * 1000000 / stage.busyMicroseconds : 0) << ENDL;
+  };
+
+  std::stringstream ss;
+  ss << std::setw(15) << std::left << "Stage" << std::setw(15) << "Items" << std::setw(20) << "Busy (ms)" << std::setw(15) << "Items/sec" << ENDL;
+  printStage(ss, "decode", statistics.decode);
+  printStage(ss, "proof of work", statistics.proofOfWork);
+  printStage(ss, "commit", statistics.commit);
+  logger(INFO) << "Block import: " << ENDL << ss.str();
+}
+
 void CryptoNoteProtocolHandler::updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context) {
   bool updated = false;
   {
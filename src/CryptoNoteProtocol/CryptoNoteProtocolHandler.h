@@ -31,11 +31,13 @@
 #pragma once
 
 #include <atomic>
+#include <map>
 
 #include <Common/ObserverManager.h>
 
 #include "CryptoNoteCore/ICore.h"
 
+#include "CryptoNoteProtocol/BlockImportPipeline.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolDefinitions.h"
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandlerCommon.h"
 #include "CryptoNoteProtocol/ICryptoNoteProtocolObserver.h"
@@ -84,8 +86,20 @@ namespace CryptoNote
     virtual size_t getPeerCount() const override;
     virtual uint32_t getObservedHeight() const override;
     void requestMissingPoolTransactions(const CryptoNoteConnectionContext& context);
+    BlockImportStatistics getBlockImportStatistics() const;
+    void log_block_import_statistics();
 
   private:
+    // Compact block whose transactions are being fetched from the announcing peer
+    struct PendingCompactBlock {
+      Block block;
+      Crypto::Hash blockHash;
+      uint32_t currentBlockchainHeight;
+      uint32_t hop;
+      std::vector<uint32_t> missingIndices;
+      bool fullListRequested;
+    };
+
     //----------------- commands handlers ----------------------------------------------
     int handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context);
     int handle_notify_new_transactions(int command, NOTIFY_NEW_TRANSACTIONS::request& arg, CryptoNoteConnectionContext& context);
@@ -94,6 +108,9 @@ namespace CryptoNote
     int handle_request_chain(int command, NOTIFY_REQUEST_CHAIN::request& arg, CryptoNoteConnectionContext& context);
     int handle_response_chain_entry(int command, NOTIFY_RESPONSE_CHAIN_ENTRY::request& arg, CryptoNoteConnectionContext& context);
     int handleRequestTxPool(int command, NOTIFY_REQUEST_TX_POOL::request& arg, CryptoNoteConnectionContext& context);
+    int handle_notify_new_compact_block(int command, NOTIFY_NEW_COMPACT_BLOCK::request& arg, CryptoNoteConnectionContext& context);
+    int handle_request_compact_block_txs(int command, NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context);
+    int handle_response_compact_block_txs(int command, NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request& arg, CryptoNoteConnectionContext& context);
 
     //----------------- i_cryptonote_protocol ----------------------------------
     virtual void relay_block(NOTIFY_NEW_BLOCK::request& arg) override;
@@ -106,6 +123,10 @@ namespace CryptoNote
     void updateObservedHeight(uint32_t peerHeight, const CryptoNoteConnectionContext& context);
     void recalculateMaxObservedHeight(const CryptoNoteConnectionContext& context);
     int processObjects(CryptoNoteConnectionContext& context, const std::vector<block_complete_entry>& blocks);
+    int processNewBlock(NOTIFY_NEW_BLOCK::request& arg, CryptoNoteConnectionContext& context);
+    int processCompactBlock(PendingCompactBlock& pending, CryptoNoteConnectionContext& context);
+    void requestCompactBlockTransactions(PendingCompactBlock& pending, CryptoNoteConnectionContext& context);
+    void relayBlock(NOTIFY_NEW_BLOCK::request& arg, const net_connection_id* excludeConnection);
     Logging::LoggerRef logger;
 
   private:
@@ -113,6 +134,7 @@ namespace CryptoNote
     System::Dispatcher& m_dispatcher;
     ICore& m_core;
     const Currency& m_currency;
+    BlockImportPipeline m_blockImportPipeline;
 
     p2p_endpoint_stub m_p2p_stub;
     IP2pEndpoint* m_p2p;
@@ -123,6 +145,7 @@ namespace CryptoNote
     uint32_t m_observedHeight;
 
     std::atomic<size_t> m_peersCount;
+    std::map<net_connection_id, PendingCompactBlock> m_pendingCompactBlocks;
     Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
   };
 }
@@ -99,6 +99,7 @@ JsonValue buildLoggerConfiguration(Level level, const std::string& logfile) {
   fileLogger.insert("type", "file");
   fileLogger.insert("filename", logfile);
   fileLogger.insert("level", static_cast<int64_t>(TRACE));
+  fileLogger.insert("async", JsonValue(true));
 
   JsonValue& consoleLogger = cfgLoggers.pushBack(JsonValue::OBJECT);
   consoleLogger.insert("type", "console");
@@ -52,6 +52,7 @@ DaemonCommandsHandler::DaemonCommandsHandler(CryptoNote::core& core, CryptoNote:
   m_consoleHandler.setHandler("help", boost::bind(&DaemonCommandsHandler::help, this, boost::placeholders::_1), "Show this help");
   m_consoleHandler.setHandler("print_pl", boost::bind(&DaemonCommandsHandler::print_pl, this, boost::placeholders::_1), "Print peer list");
   m_consoleHandler.setHandler("print_cn", boost::bind(&DaemonCommandsHandler::print_cn, this, boost::placeholders::_1), "Print connections");
+  m_consoleHandler.setHandler("print_import", boost::bind(&DaemonCommandsHandler::print_import, this, boost::placeholders::_1), "Print block import pipeline statistics");
   m_consoleHandler.setHandler("print_bc", boost::bind(&DaemonCommandsHandler::print_bc, this, boost::placeholders::_1), "Print blockchain info in a given blocks range, print_bc <begin_height> [<end_height>]");
   //m_consoleHandler.setHandler("print_bci", boost::bind(&DaemonCommandsHandler::print_bci, this, _1));
   //m_consoleHandler.setHandler("print_bc_outs", boost::bind(&DaemonCommandsHandler::print_bc_outs, this, _1));
@@ -132,6 +133,12 @@ bool DaemonCommandsHandler::print_cn(const std::vector<std::string>& args)
   return true;
 }
 //--------------------------------------------------------------------------------
+bool DaemonCommandsHandler::print_import(const std::vector<std::string>& args)
+{
+  m_srv.get_payload_object().log_block_import_statistics();
+  return true;
+}
+//--------------------------------------------------------------------------------
 bool DaemonCommandsHandler::print_bc(const std::vector<std::string> &args) {
   if (!args.size()) {
     std::cout << "need block index parameter" << ENDL;
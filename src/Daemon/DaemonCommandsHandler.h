@@ -73,6 +73,7 @@ private:
   bool hide_hr(const std::vector<std::string>& args);
   bool print_bc_outs(const std::vector<std::string>& args);
   bool print_cn(const std::vector<std::string>& args);
+  bool print_import(const std::vector<std::string>& args);
   bool print_bc(const std::vector<std::string>& args);
   bool print_bci(const std::vector<std::string>& args);
   bool set_log(const std::vector<std::string>& args);
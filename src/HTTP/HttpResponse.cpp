@@ -85,11 +85,7 @@ void HttpResponse::addHeader(const std::string& name, const std::string& value)
 
 void HttpResponse::setBody(const std::string& b) {
   body = b;
-  if (!body.empty()) {
-    headers["Content-Length"] = std::to_string(body.size());
-  } else {
-    headers.erase("Content-Length");
-  }
+  headers["Content-Length"] = std::to_string(body.size());
 }
 
 std::ostream& HttpResponse::printHttpResponse(std::ostream& os) const {
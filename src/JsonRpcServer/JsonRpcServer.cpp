@@ -45,6 +45,9 @@
 #include "HTTP/HttpResponse.h"
 
 #include "Common/JsonValue.h"
+#include "Common/Metrics.h"
+#include "Common/ScopeExit.h"
+#include "CryptoNoteConfig.h"
 #include "Serialization/JsonInputValueSerializer.h"
 #include "Serialization/JsonOutputStreamSerializer.h"
 
@@ -69,12 +72,11 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
     logger(Logging::TRACE) << "HTTP request came: \n" << req;
 
     if (req.getUrl() == "/json_rpc") {
-      std::istringstream jsonInputStream(req.getBody());
       Common::JsonValue jsonRpcRequest;
       Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
 
       try {
-        jsonInputStream >> jsonRpcRequest;
+        jsonRpcRequest = Common::JsonValue::fromString(req.getBody());
       } catch (std::runtime_error&) {
         logger(Logging::DEBUGGING) << "Couldn't parse request: \"" << req.getBody() << "\"";
         makeJsonParsingErrorResponse(jsonRpcResponse);
@@ -83,14 +85,25 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
         return;
       }
 
-      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
 
-      std::ostringstream jsonOutputStream;
-      jsonOutputStream << jsonRpcResponse;
+      if (jsonRpcRequest.isArray()) {
+        std::string body;
+        processJsonRpcBatch(jsonRpcRequest, body);
+        resp.setBody(body);
+        return;
+      }
 
-      resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
-      resp.setBody(jsonOutputStream.str());
+      processJsonRpcRequest(jsonRpcRequest, jsonRpcResponse);
+      resp.setBody(jsonRpcResponse.toString());
 
+    } else if (req.getUrl() == "/metrics") {
+      // prometheus, e.g. the NodeRpcProxy call latencies of walletd
+      std::ostringstream metrics;
+      Common::MetricsRegistry::instance().write(metrics);
+      resp.setStatus(CryptoNote::HttpResponse::STATUS_200);
+      resp.addHeader("Content-Type", "text/plain; version=0.0.4");
+      resp.setBody(metrics.str());
     } else {
       logger(Logging::WARNING) << "Requested url \"" << req.getUrl() << "\" is not found";
       resp.setStatus(CryptoNote::HttpResponse::STATUS_404);
@@ -102,6 +115,79 @@ void JsonRpcServer::processRequest(const CryptoNote::HttpRequest& req, CryptoNot
   }
 }
 
+void JsonRpcServer::processJsonRpcBatch(const Common::JsonValue& batch, std::string& body) {
+  if (batch.size() == 0) {
+    Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
+    makeInvalidRequestResponse(jsonRpcResponse);
+    body = jsonRpcResponse.toString();
+    return;
+  }
+
+  if (batch.size() > JSON_RPC_MAX_BATCH_SIZE) {
+    logger(Logging::DEBUGGING) << "Batch of " << batch.size() << " requests rejected";
+    Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
+    makeInvalidRequestResponse(jsonRpcResponse);
+    body = jsonRpcResponse.toString();
+    return;
+  }
+
+  logger(Logging::DEBUGGING) << "Batch of " << batch.size() << " requests came";
+
+  // responses are appended to the body as soon as they are ready, the batch response never exists as a JsonValue
+  bool readOnlyRun = false;
+  Tools::ScopeExit readOnlyRunGuard([this, &readOnlyRun] {
+    if (readOnlyRun) {
+      endReadOnlyRequests();
+    }
+  });
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const Common::JsonValue& request = batch[i];
+    bool readOnly = request.isObject() && isReadOnlyRequest(request);
+    if (readOnly != readOnlyRun) {
+      readOnlyRun = readOnly;
+      if (readOnly) {
+        beginReadOnlyRequests();
+      } else {
+        endReadOnlyRequests();
+      }
+    }
+
+    appendBatchResponse(request, body);
+  }
+
+  //a batch of notifications only gets an empty body
+  if (!body.empty()) {
+    body.push_back(']');
+  }
+}
+
+void JsonRpcServer::appendBatchResponse(const Common::JsonValue& req, std::string& body) {
+  Common::JsonValue jsonRpcResponse(Common::JsonValue::OBJECT);
+
+  if (!req.isObject()) {
+    makeInvalidRequestResponse(jsonRpcResponse);
+  } else {
+    processJsonRpcRequest(req, jsonRpcResponse);
+    if (!req.contains("id")) {
+      return;
+    }
+  }
+
+  body.push_back(body.empty() ? '[' : ',');
+  body += jsonRpcResponse.toString();
+}
+
+bool JsonRpcServer::isReadOnlyRequest(const Common::JsonValue& req) const {
+  return false;
+}
+
+void JsonRpcServer::beginReadOnlyRequests() {
+}
+
+void JsonRpcServer::endReadOnlyRequests() {
+}
+
 void JsonRpcServer::prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp) {
   using Common::JsonValue;
 
@@ -181,6 +267,16 @@ void JsonRpcServer::fillJsonResponse(const Common::JsonValue& v, Common::JsonVal
   resp.insert("result", v);
 }
 
+void JsonRpcServer::makeInvalidRequestResponse(Common::JsonValue& resp) {
+  using Common::JsonValue;
+
+  resp = JsonValue(JsonValue::OBJECT);
+  resp.insert("jsonrpc", "2.0");
+  resp.insert("id", nullptr);
+
+  makeGenericErrorReponse(resp, "Invalid Request", -32600);
+}
+
 void JsonRpcServer::makeJsonParsingErrorResponse(Common::JsonValue& resp) {
   using Common::JsonValue;
 
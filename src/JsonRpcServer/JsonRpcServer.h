@@ -68,13 +68,24 @@ protected:
   static void fillJsonResponse(const Common::JsonValue& v, Common::JsonValue& resp);
   static void prepareJsonResponse(const Common::JsonValue& req, Common::JsonValue& resp);
   static void makeJsonParsingErrorResponse(Common::JsonValue& resp);
+  static void makeInvalidRequestResponse(Common::JsonValue& resp);
 
   virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) = 0;
 
+  // Consecutive requests of a batch for which isReadOnlyRequest returns true are processed between
+  // beginReadOnlyRequests and endReadOnlyRequests, so an implementation may take its locks once per run.
+  // Handlers called in between must not suspend the current context.
+  virtual bool isReadOnlyRequest(const Common::JsonValue& req) const;
+  virtual void beginReadOnlyRequests();
+  virtual void endReadOnlyRequests();
+
 private:
   // HttpServer
   virtual void processRequest(const CryptoNote::HttpRequest& request, CryptoNote::HttpResponse& response) override;
 
+  void processJsonRpcBatch(const Common::JsonValue& batch, std::string& body);
+  void appendBatchResponse(const Common::JsonValue& req, std::string& body);
+
   System::Dispatcher& system;
   System::Event& stopEvent;
   Logging::LoggerRef logger;
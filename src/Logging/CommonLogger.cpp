@@ -83,7 +83,7 @@ void CommonLogger::operator()(const std::string& category, Level level, boost::p
       body2.insert(insertPos, formatPattern(pattern, category, level, time));
     }
 
-    doLogString(body2);
+    doLogMessage(level, body2);
   }
 }
 
@@ -103,10 +103,18 @@ void CommonLogger::setMaxLevel(Level level) {
   logLevel = level;
 }
 
+Level CommonLogger::getMaxLevel() const {
+  return logLevel;
+}
+
 CommonLogger::CommonLogger(Level level) : logLevel(level), pattern("%D %T %L [%C] ") {
 }
 
 void CommonLogger::doLogString(const std::string& message) {
 }
 
+void CommonLogger::doLogMessage(Level level, const std::string& message) {
+  doLogString(message);
+}
+
 }
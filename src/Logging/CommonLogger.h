@@ -42,6 +42,7 @@ public:
   virtual void enableCategory(const std::string& category);
   virtual void disableCategory(const std::string& category);
   virtual void setMaxLevel(Level level);
+  virtual Level getMaxLevel() const override;
 
   void setPattern(const std::string& pattern);
 
@@ -52,6 +53,8 @@ protected:
 
   CommonLogger(Level level);
   virtual void doLogString(const std::string& message);
+  // Receives every accepted message with its level, the default implementation forwards to doLogString
+  virtual void doLogMessage(Level level, const std::string& message);
 };
 
 }
@@ -35,6 +35,11 @@ namespace Logging {
 FileLogger::FileLogger(Level level) : StreamLogger(level) {
 }
 
+FileLogger::~FileLogger() {
+  // the writer thread must be gone before fileStream is destroyed
+  stopAsync();
+}
+
 void FileLogger::init(const std::string& fileName) {
   fileStream.open(fileName, std::ios::app);
   StreamLogger::attachToStream(fileStream);
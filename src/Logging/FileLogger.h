@@ -38,6 +38,7 @@ namespace Logging {
 class FileLogger : public StreamLogger {
 public:
   FileLogger(Level level = DEBUGGING);
+  virtual ~FileLogger();
   void init(const std::string& filename);
 
 private:
@@ -69,7 +69,10 @@ public:
 
   const static std::array<std::string, 6> LEVEL_NAMES;
 
+  virtual ~ILogger() {}
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) = 0;
+  // Most verbose level any message can pass, messages above it are not formatted at all
+  virtual Level getMaxLevel() const { return TRACE; }
 };
 
 #ifndef ENDL
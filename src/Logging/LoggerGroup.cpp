@@ -44,6 +44,15 @@ void LoggerGroup::removeLogger(ILogger& logger) {
   loggers.erase(std::remove(loggers.begin(), loggers.end(), &logger), loggers.end());
 }
 
+Level LoggerGroup::getMaxLevel() const {
+  Level level = FATAL;
+  for (ILogger* logger : loggers) {
+    level = std::max(level, logger->getMaxLevel());
+  }
+
+  return std::min(level, logLevel);
+}
+
 void LoggerGroup::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
   if (level <= logLevel && disabledCategories.count(category) == 0) {
     for (auto& logger : loggers) {
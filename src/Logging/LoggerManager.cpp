@@ -37,7 +37,7 @@ namespace Logging {
 
 using Common::JsonValue;
 
-LoggerManager::LoggerManager() {
+LoggerManager::LoggerManager() : maxLevel(LoggerGroup::getMaxLevel()) {
 }
 
 void LoggerManager::operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) {
@@ -45,6 +45,16 @@ void LoggerManager::operator()(const std::string& category, Level level, boost::
   LoggerGroup::operator()(category, level, time, body);
 }
 
+void LoggerManager::setMaxLevel(Level level) {
+  std::unique_lock<std::mutex> lock(reconfigureLock);
+  LoggerGroup::setMaxLevel(level);
+  maxLevel = LoggerGroup::getMaxLevel();
+}
+
+Level LoggerManager::getMaxLevel() const {
+  return maxLevel.load(std::memory_order_relaxed);
+}
+
 void LoggerManager::configure(const JsonValue& val) {
   std::unique_lock<std::mutex> lock(reconfigureLock);
   loggers.clear();
@@ -100,8 +110,26 @@ void LoggerManager::configure(const JsonValue& val) {
         } else if (type == "file") {
           std::string filename = loggerConfiguration("filename").getString();
           auto fileLogger = new FileLogger(level);
-          fileLogger->init(filename);
           logger.reset(fileLogger);
+          fileLogger->init(filename);
+          if (loggerConfiguration.contains("async") && loggerConfiguration("async").getBool()) {
+            size_t queueSize = 8192;
+            if (loggerConfiguration.contains("queueSize")) {
+              queueSize = static_cast<size_t>(loggerConfiguration("queueSize").getInteger());
+            }
+
+            int64_t flushInterval = 100;
+            if (loggerConfiguration.contains("flushInterval")) {
+              flushInterval = loggerConfiguration("flushInterval").getInteger();
+            }
+
+            Level flushLevel = ERROR;
+            if (loggerConfiguration.contains("flushLevel")) {
+              flushLevel = static_cast<Level>(loggerConfiguration("flushLevel").getInteger());
+            }
+
+            fileLogger->startAsync(queueSize, std::chrono::milliseconds(flushInterval), flushLevel);
+          }
         } else {
           throw std::runtime_error("Unknown logger type: " + type);
         }
@@ -131,7 +159,8 @@ void LoggerManager::configure(const JsonValue& val) {
   } else {
     throw std::runtime_error("loggers parameter missing");
   }
-  setMaxLevel(globalLevel);
+  LoggerGroup::setMaxLevel(globalLevel);
+  maxLevel = LoggerGroup::getMaxLevel();
   for (const auto& category : globalDisabledCategories) {
     disableCategory(category);
   }
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -43,10 +44,14 @@ public:
   LoggerManager();
   void configure(const Common::JsonValue& val);
   virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override;
+  virtual void setMaxLevel(Level level) override;
+  virtual Level getMaxLevel() const override;
 
 private:
   std::vector<std::unique_ptr<CommonLogger>> loggers;
   std::mutex reconfigureLock;
+  // Levels of the owned loggers only change in configure, so the effective level is cached for lock-free checks
+  std::atomic<Level> maxLevel;
 };
 
 }
@@ -30,97 +30,131 @@
 
 #include "LoggerMessage.h"
 
+#include <vector>
+
 namespace Logging {
 
-LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level level, const std::string& color)
+namespace {
+
+class LoggerStreamPool {
+public:
+  ~LoggerStreamPool() {
+    for (LoggerStream* stream : streams) {
+      delete stream;
+    }
+  }
+
+  LoggerStream* acquire() {
+    if (streams.empty()) {
+      return new LoggerStream();
+    }
+
+    LoggerStream* stream = streams.back();
+    streams.pop_back();
+    return stream;
+  }
+
+  void release(LoggerStream* stream) {
+    streams.push_back(stream);
+  }
+
+private:
+  std::vector<LoggerStream*> streams;
+};
+
+thread_local LoggerStreamPool streamPool;
+
+}
+
+LoggerStream::LoggerStream()
   : std::ostream(this)
   , std::streambuf()
-  , logger(logger)
-  , category(category)
-  , logLevel(level)
-  , message(color)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
+  , logger(nullptr)
+  , logLevel(INFO)
+  , gotText(false)
+  , defaultFlags(flags()) {
+  setp(buffer, buffer + sizeof(buffer));
 }
 
-LoggerMessage::~LoggerMessage() {
-  if (gotText) {
+void LoggerStream::start(ILogger& logger, const std::string& category, Level level, const std::string& color) {
+  this->logger = &logger;
+  this->category = category;
+  logLevel = level;
+  message = color;
+  timestamp = boost::posix_time::microsec_clock::local_time();
+  gotText = false;
+  clear();
+  flags(defaultFlags);
+  precision(6);
+  width(0);
+  fill(' ');
+}
+
+void LoggerStream::finish() {
+  if (gotText || pptr() != pbase()) {
     (*this) << std::endl;
   }
 }
 
-#ifndef __linux__
-LoggerMessage::LoggerMessage(LoggerMessage&& other)
-  : std::ostream(std::move(other))
-  , std::streambuf(std::move(other))
-  , category(other.category)
-  , logLevel(other.logLevel)
-  , logger(other.logger)
-  , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
-  this->set_rdbuf(this);
-}
-#else
-LoggerMessage::LoggerMessage(LoggerMessage&& other)
-  : std::ostream(nullptr)
-  , std::streambuf()
-  , category(other.category)
-  , logLevel(other.logLevel)
-  , logger(other.logger)
-  , message(other.message)
-  , timestamp(boost::posix_time::microsec_clock::local_time())
-  , gotText(false) {
-  if (this != &other) {
-    _M_tie = nullptr;
-    _M_streambuf = nullptr;
-
-    //ios_base swap
-    std::swap(_M_streambuf_state, other._M_streambuf_state);
-    std::swap(_M_exception, other._M_exception);
-    std::swap(_M_flags, other._M_flags);
-    std::swap(_M_precision, other._M_precision);
-    std::swap(_M_width, other._M_width);
-
-    std::swap(_M_callbacks, other._M_callbacks);
-    std::swap(_M_ios_locale, other._M_ios_locale);
-    //ios_base swap
-
-    //streambuf swap
-    char *_Pfirst = pbase();
-    char *_Pnext = pptr();
-    char *_Pend = epptr();
-    char *_Gfirst = eback();
-    char *_Gnext = gptr();
-    char *_Gend = egptr();
-
-    setp(other.pbase(), other.epptr());
-    other.setp(_Pfirst, _Pend);
-
-    setg(other.eback(), other.gptr(), other.egptr());
-    other.setg(_Gfirst, _Gnext, _Gend);
-
-    std::swap(_M_buf_locale, other._M_buf_locale);
-    //streambuf swap
-
-    std::swap(_M_fill, other._M_fill);
-    std::swap(_M_tie, other._M_tie);
+void LoggerStream::flushBuffer() {
+  if (pptr() != pbase()) {
+    gotText = true;
+    message.append(pbase(), pptr());
+    setp(buffer, buffer + sizeof(buffer));
   }
-  _M_streambuf = this;
 }
-#endif
 
-int LoggerMessage::sync() {
-  logger(category, logLevel, timestamp, message);
+int LoggerStream::sync() {
+  flushBuffer();
+  (*logger)(category, logLevel, timestamp, message);
   gotText = false;
   message = DEFAULT;
   return 0;
 }
 
-int LoggerMessage::overflow(int c) {
-  gotText = true;
-  message += static_cast<char>(c);
+int LoggerStream::overflow(int c) {
+  flushBuffer();
+  if (c != std::streambuf::traits_type::eof()) {
+    gotText = true;
+    message += static_cast<char>(c);
+  }
+
   return 0;
 }
 
+LoggerMessage::LoggerMessage() : stream(nullptr) {
+}
+
+LoggerMessage::LoggerMessage(ILogger& logger, const std::string& category, Level level, const std::string& color)
+  : stream(streamPool.acquire()) {
+  stream->start(logger, category, level, color);
+}
+
+LoggerMessage::~LoggerMessage() {
+  if (stream != nullptr) {
+    stream->finish();
+    streamPool.release(stream);
+  }
+}
+
+LoggerMessage::LoggerMessage(LoggerMessage&& other) : stream(other.stream) {
+  other.stream = nullptr;
+}
+
+LoggerMessage& LoggerMessage::operator<<(std::ostream& (*manipulator)(std::ostream&)) {
+  if (stream != nullptr) {
+    manipulator(*stream);
+  }
+
+  return *this;
+}
+
+LoggerMessage& LoggerMessage::operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+  if (stream != nullptr) {
+    manipulator(*stream);
+  }
+
+  return *this;
+}
+
 }
@@ -31,28 +31,61 @@
 #pragma once
 
 #include <iostream>
+#include <utility>
 #include "ILogger.h"
 
 namespace Logging {
 
-class LoggerMessage : public std::ostream, std::streambuf {
+// Formats one message at a time and hands every completed line to the logger. Streams are pooled per thread
+// and reused, so the buffer keeps its capacity between messages.
+class LoggerStream : public std::ostream, std::streambuf {
 public:
-  LoggerMessage(ILogger& logger, const std::string& category, Level level, const std::string& color);
-  ~LoggerMessage();
-  LoggerMessage(const LoggerMessage&) = delete;
-  LoggerMessage& operator=(const LoggerMessage&) = delete;
-  LoggerMessage(LoggerMessage&& other);
+  LoggerStream();
+  LoggerStream(const LoggerStream&) = delete;
+  LoggerStream& operator=(const LoggerStream&) = delete;
+
+  void start(ILogger& logger, const std::string& category, Level level, const std::string& color);
+  void finish();
 
 private:
   int sync() override;
   int overflow(int c) override;
+  void flushBuffer();
 
-  std::string message;
-  const std::string category;
+  ILogger* logger;
+  std::string category;
   Level logLevel;
-  ILogger& logger;
+  std::string message;
   boost::posix_time::ptime timestamp;
   bool gotText;
+  std::ios_base::fmtflags defaultFlags;
+  char buffer[256];
+};
+
+// A message that is not accepted by any logger is created without a stream and drops everything written to it
+class LoggerMessage {
+public:
+  LoggerMessage();
+  LoggerMessage(ILogger& logger, const std::string& category, Level level, const std::string& color);
+  ~LoggerMessage();
+  LoggerMessage(const LoggerMessage&) = delete;
+  LoggerMessage& operator=(const LoggerMessage&) = delete;
+  LoggerMessage(LoggerMessage&& other);
+
+  template<typename T>
+  LoggerMessage& operator<<(T&& value) {
+    if (stream != nullptr) {
+      *stream << std::forward<T>(value);
+    }
+
+    return *this;
+  }
+
+  LoggerMessage& operator<<(std::ostream& (*manipulator)(std::ostream&));
+  LoggerMessage& operator<<(std::ios_base& (*manipulator)(std::ios_base&));
+
+private:
+  LoggerStream* stream;
 };
 
 }
@@ -36,6 +36,10 @@ LoggerRef::LoggerRef(ILogger& logger, const std::string& category) : logger(&log
 }
 
 LoggerMessage LoggerRef::operator()(Level level, const std::string& color) const {
+  if (level > logger->getMaxLevel()) {
+    return LoggerMessage();
+  }
+
   return LoggerMessage(*logger, category, level, color);
 }
 
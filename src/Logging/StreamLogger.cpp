@@ -29,33 +29,152 @@
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
 #include "StreamLogger.h"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
 namespace Logging {
 
-StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr) {
+namespace {
+
+void appendText(std::string& text, const std::string& message) {
+  size_t textStart = 0;
+  bool readingText = true;
+  for (size_t charPos = 0; charPos < message.size(); ++charPos) {
+    if (message[charPos] == ILogger::COLOR_DELIMETER) {
+      if (readingText) {
+        text.append(message, textStart, charPos - textStart);
+      }
+
+      readingText = !readingText;
+      textStart = charPos + 1;
+    }
+  }
+
+  if (readingText) {
+    text.append(message, textStart, std::string::npos);
+  }
+}
+
+}
+
+StreamLogger::StreamLogger(Level level) : CommonLogger(level), stream(nullptr), async(false), flushRequested(false), droppedCount(0),
+  flushInterval(0), flushLevel(ERROR), stopping(false) {
+}
+
+StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream), async(false), flushRequested(false),
+  droppedCount(0), flushInterval(0), flushLevel(ERROR), stopping(false) {
 }
 
-StreamLogger::StreamLogger(std::ostream& stream, Level level) : CommonLogger(level), stream(&stream) {
+StreamLogger::~StreamLogger() {
+  stopAsync();
 }
 
 void StreamLogger::attachToStream(std::ostream& stream) {
   this->stream = &stream;
 }
 
+void StreamLogger::startAsync(size_t queueSize, std::chrono::milliseconds flushInterval, Level flushLevel) {
+  if (async) {
+    return;
+  }
+
+  queue.reset(new Common::MpscRingBuffer<std::string>(queueSize));
+  // a zero interval would turn the writer's timed wait into a busy loop
+  this->flushInterval = std::max(flushInterval, std::chrono::milliseconds(1));
+  this->flushLevel = flushLevel;
+  stopping = false;
+  flushRequested = false;
+  writer = std::thread(&StreamLogger::writerLoop, this);
+  async = true;
+}
+
+void StreamLogger::stopAsync() {
+  if (!async) {
+    return;
+  }
+
+  async = false;
+  {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    stopping = true;
+  }
+
+  writerEvent.notify_one();
+  writer.join();
+  queue.reset();
+}
+
+uint64_t StreamLogger::getDroppedCount() const {
+  return droppedCount.load(std::memory_order_relaxed);
+}
+
 void StreamLogger::doLogString(const std::string& message) {
-  if (stream != nullptr && stream->good()) {
-    std::lock_guard<std::mutex> lock(mutex);
-    bool readingText = true;
-    for (size_t charPos = 0; charPos < message.size(); ++charPos) {
-      if (message[charPos] == ILogger::COLOR_DELIMETER) {
-        readingText = !readingText;
-      } else if (readingText) {
-        *stream << message[charPos];
-      }
+  std::string text;
+  text.reserve(message.size());
+  appendText(text, message);
+  writeBatch(text);
+}
+
+void StreamLogger::doLogMessage(Level level, const std::string& message) {
+  if (!async.load(std::memory_order_acquire)) {
+    doLogString(message);
+    return;
+  }
+
+  std::string text;
+  text.reserve(message.size());
+  appendText(text, message);
+  if (!queue->tryPush(std::move(text))) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+  } else if (level > flushLevel && queue->size() < queue->capacity() / 2) {
+    return;
+  }
+
+  if (!flushRequested.exchange(true)) {
+    writerEvent.notify_one();
+  }
+}
+
+void StreamLogger::writerLoop() {
+  std::string batch;
+  std::string text;
+  uint64_t reportedDrops = 0;
+  for (;;) {
+    bool stop;
+    {
+      std::unique_lock<std::mutex> lock(writerMutex);
+      // producers notify without taking the lock, a notification lost here is only delayed until flushInterval elapses
+      writerEvent.wait_for(lock, flushInterval, [this] { return stopping || flushRequested.load(); });
+      stop = stopping;
     }
 
+    flushRequested = false;
+    while (queue->pop(text)) {
+      batch += text;
+    }
+
+    uint64_t dropped = droppedCount.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops) {
+      batch += std::to_string(dropped - reportedDrops) + " log messages dropped\n";
+      reportedDrops = dropped;
+    }
+
+    if (!batch.empty()) {
+      writeBatch(batch);
+      batch.clear();
+    }
+
+    if (stop) {
+      break;
+    }
+  }
+}
+
+void StreamLogger::writeBatch(const std::string& batch) {
+  if (stream != nullptr && stream->good()) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stream->write(batch.data(), batch.size());
     *stream << std::flush;
   }
 }
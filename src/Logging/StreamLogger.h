@@ -30,8 +30,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include "CommonLogger.h"
+#include "Common/MpscRingBuffer.h"
 
 namespace Logging {
 
@@ -39,16 +45,40 @@ class StreamLogger : public CommonLogger {
 public:
   StreamLogger(Level level = DEBUGGING);
   StreamLogger(std::ostream& stream, Level level = DEBUGGING);
+  virtual ~StreamLogger();
   void attachToStream(std::ostream& stream);
 
+  // Hands messages to a background thread instead of writing them on the caller's thread. Messages are queued in a
+  // ring of queueSize entries and written in batches; the stream is flushed at least every flushInterval (1 ms or more) and
+  // right away after a message of flushLevel or more severe. When the ring is full messages are dropped and counted.
+  void startAsync(size_t queueSize, std::chrono::milliseconds flushInterval, Level flushLevel = ERROR);
+  // Writes out queued messages and returns to synchronous logging, must not run concurrently with logging
+  void stopAsync();
+  uint64_t getDroppedCount() const;
+
 protected:
   virtual void doLogString(const std::string& message) override;
+  virtual void doLogMessage(Level level, const std::string& message) override;
 
 protected:
   std::ostream* stream;
 
 private:
+  void writerLoop();
+  void writeBatch(const std::string& batch);
+
   std::mutex mutex;
+
+  std::unique_ptr<Common::MpscRingBuffer<std::string>> queue;
+  std::atomic<bool> async;
+  std::atomic<bool> flushRequested;
+  std::atomic<uint64_t> droppedCount;
+  std::chrono::milliseconds flushInterval;
+  Level flushLevel;
+  bool stopping;
+  std::mutex writerMutex;
+  std::condition_variable writerEvent;
+  std::thread writer;
 };
 
 }
@@ -40,7 +40,7 @@
 #include "Rpc/JsonRpc.h"
 #include "Rpc/HttpClient.h"
 
-BlockchainMonitor::BlockchainMonitor(System::Dispatcher& dispatcher, const std::string& daemonHost, uint16_t daemonPort, size_t pollingInterval, Logging::ILogger& logger):
+BlockchainMonitor::BlockchainMonitor(System::Dispatcher& dispatcher, const std::string& daemonHost, uint16_t daemonPort, size_t pollingInterval, CryptoNote::MinerMetrics& metrics, Logging::ILogger& logger):
   m_dispatcher(dispatcher),
   m_daemonHost(daemonHost),
   m_daemonPort(daemonPort),
@@ -48,6 +48,7 @@ BlockchainMonitor::BlockchainMonitor(System::Dispatcher& dispatcher, const std::
   m_stopped(false),
   m_httpEvent(dispatcher),
   m_sleepingContext(dispatcher),
+  m_metrics(metrics),
   m_logger(logger, "BlockchainMonitor") {
 
   m_httpEvent.set();
@@ -91,6 +92,7 @@ Crypto::Hash BlockchainMonitor::requestLastBlockHash() {
   m_logger(Logging::DEBUGGING) << "Requesting last block hash";
 
   try {
+    Common::MetricTimer timer(m_metrics.blockchainPoll());
     CryptoNote::HttpClient client(m_dispatcher, m_daemonHost, m_daemonPort);
 
     CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::request request;
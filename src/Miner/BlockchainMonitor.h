@@ -37,10 +37,11 @@
 #include <System/Event.h>
 
 #include "Logging/LoggerRef.h"
+#include "MinerMetrics.h"
 
 class BlockchainMonitor {
 public:
-  BlockchainMonitor(System::Dispatcher& dispatcher, const std::string& daemonHost, uint16_t daemonPort, size_t pollingInterval, Logging::ILogger& logger);
+  BlockchainMonitor(System::Dispatcher& dispatcher, const std::string& daemonHost, uint16_t daemonPort, size_t pollingInterval, CryptoNote::MinerMetrics& metrics, Logging::ILogger& logger);
 
   void waitBlockchainUpdate();
   void stop();
@@ -52,6 +53,7 @@ private:
   bool m_stopped;
   System::Event m_httpEvent;
   System::ContextGroup m_sleepingContext;
+  CryptoNote::MinerMetrics& m_metrics;
 
   Logging::LoggerRef m_logger;
 
@@ -30,48 +30,87 @@
 
 #include "Miner.h"
 
+#include <cstring>
 #include <functional>
 
 #include "crypto/crypto.h"
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
 
 #include <System/InterruptedException.h>
 
 namespace CryptoNote {
 
-Miner::Miner(System::Dispatcher& dispatcher, Logging::ILogger& logger) :
+Miner::Miner(System::Dispatcher& dispatcher, Logging::ILogger& logger, MinerMetrics& metrics) :
   m_dispatcher(dispatcher),
   m_miningStopped(dispatcher),
   m_state(MiningState::MINING_STOPPED),
-  m_logger(logger, "Miner") {
+  m_templateEpochs{0, 0},
+  m_foundEpoch(0),
+  m_foundNonce(0),
+  m_logger(logger, "Miner"),
+  m_metrics(metrics) {
 }
 
 Miner::~Miner() {
   assert(m_state != MiningState::MINING_IN_PROGRESS);
 }
 
-Block Miner::mine(const BlockMiningParameters& blockMiningParameters, size_t threadCount) {
+Block Miner::mine(const BlockMiningParameters& blockMiningParameters, size_t threadCount, size_t hashWays) {
   if (threadCount == 0) {
     throw std::runtime_error("Miner requires at least one thread");
   }
 
+  if (hashWays == 0 || hashWays > Crypto::SLOW_HASH_MAX_WAYS) {
+    throw std::runtime_error("Miner hash ways must be 1.." + std::to_string(Crypto::SLOW_HASH_MAX_WAYS));
+  }
+
   if (m_state == MiningState::MINING_IN_PROGRESS) {
     throw std::runtime_error("Mining is already in progress");
   }
 
-  m_state = MiningState::MINING_IN_PROGRESS;
-  m_miningStopped.clear();
+  updateJob(blockMiningParameters);
+
+  for (;;) {
+    m_state = MiningState::MINING_IN_PROGRESS;
+    m_miningStopped.clear();
+
+    runWorkers(threadCount, hashWays);
 
-  runWorkers(blockMiningParameters, threadCount);
+    assert(m_state != MiningState::MINING_IN_PROGRESS);
+    if (m_state == MiningState::MINING_STOPPED) {
+      m_logger(Logging::DEBUGGING) << "Mining has been stopped";
+      throw System::InterruptedException();
+    }
 
-  assert(m_state != MiningState::MINING_IN_PROGRESS);
-  if (m_state == MiningState::MINING_STOPPED) {
-    m_logger(Logging::DEBUGGING) << "Mining has been stopped";
-    throw System::InterruptedException();
+    assert(m_state == MiningState::BLOCK_FOUND);
+    Block block;
+    if (takeFoundBlock(block)) {
+      return block;
+    }
+
+    m_metrics.staleBlock();
+    m_logger(Logging::WARNING) << "Block found for outdated job " << m_foundEpoch << ", mining continues";
+  }
+}
+
+void Miner::updateJob(const BlockMiningParameters& blockMiningParameters) {
+  BinaryArray header;
+  BinaryArray hashingBlob;
+  if (!toBinaryArray(static_cast<const BlockHeader&>(blockMiningParameters.blockTemplate), header) ||
+    !get_block_hashing_blob(blockMiningParameters.blockTemplate, hashingBlob)) {
+    throw std::runtime_error("Couldn't serialize block template");
   }
 
-  assert(m_state == MiningState::BLOCK_FOUND);
-  return m_block;
+  //the nonce is the last field of the header and the header starts the hashing blob
+  size_t nonceOffset = header.size() - sizeof(blockMiningParameters.blockTemplate.nonce);
+  uint64_t epoch = m_job.publish(hashingBlob, nonceOffset, blockMiningParameters.difficulty, Crypto::rand<uint32_t>());
+
+  m_templates[epoch % 2] = blockMiningParameters.blockTemplate;
+  m_templateEpochs[epoch % 2] = epoch;
+  m_metrics.jobStarted();
+
+  m_logger(Logging::INFO) << "Mining for difficulty " << blockMiningParameters.difficulty << ", job " << epoch;
 }
 
 void Miner::stop() {
@@ -83,20 +122,14 @@ void Miner::stop() {
   }
 }
 
-void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount) {
+void Miner::runWorkers(size_t threadCount, size_t hashWays) {
   assert(threadCount > 0);
 
-  m_logger(Logging::INFO) << "Starting mining for difficulty " << blockMiningParameters.difficulty;
-
   try {
-    blockMiningParameters.blockTemplate.nonce = Crypto::rand<uint32_t>();
-
     for (size_t i = 0; i < threadCount; ++i) {
       m_workers.emplace_back(std::unique_ptr<System::RemoteContext<void>> (
-        new System::RemoteContext<void>(m_dispatcher, std::bind(&Miner::workerFunc, this, blockMiningParameters.blockTemplate, blockMiningParameters.difficulty, threadCount)))
+        new System::RemoteContext<void>(m_dispatcher, std::bind(&Miner::workerFunc, this, static_cast<uint32_t>(i), static_cast<uint32_t>(threadCount), hashWays)))
       );
-
-      blockMiningParameters.blockTemplate.nonce++;
     }
 
     m_workers.clear();
@@ -109,33 +142,63 @@ void Miner::runWorkers(BlockMiningParameters blockMiningParameters, size_t threa
   m_miningStopped.set();
 }
 
-void Miner::workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep) {
+void Miner::workerFunc(uint32_t workerIndex, uint32_t nonceStep, size_t hashWays) {
   try {
-    Block block = blockTemplate;
-    Crypto::cn_context cryptoContext;
+    Crypto::cn_multi_context cryptoContext(hashWays);
+    MiningJobDescriptor::Job job;
+    job.epoch = 0;
+    uint8_t blobs[Crypto::SLOW_HASH_MAX_WAYS][MiningJobDescriptor::MAX_HASHING_BLOB_SIZE];
+    const void* data[Crypto::SLOW_HASH_MAX_WAYS];
+    size_t lengths[Crypto::SLOW_HASH_MAX_WAYS];
+    uint32_t nonce = 0;
 
     while (m_state == MiningState::MINING_IN_PROGRESS) {
-      Crypto::Hash hash;
-      if (!get_block_longhash(cryptoContext, block, hash)) {
-        //error occured
-        m_logger(Logging::DEBUGGING) << "calculating long hash error occured";
-        m_state = MiningState::MINING_STOPPED;
-        return;
+      if (m_job.epoch() != job.epoch) {
+        m_job.read(job);
+        for (size_t i = 0; i < hashWays; ++i) {
+          memcpy(blobs[i], job.blob, job.blobSize);
+          data[i] = blobs[i];
+          lengths[i] = job.blobSize;
+        }
+
+        nonce = job.startNonce + workerIndex;
+      }
+
+      //the nonce is serialized as raw bytes, so it is patched the same way
+      for (size_t i = 0; i < hashWays; ++i) {
+        uint32_t wayNonce = nonce + static_cast<uint32_t>(i) * nonceStep;
+        memcpy(&blobs[i][job.nonceOffset], &wayNonce, sizeof(wayNonce));
       }
 
-      if (check_hash(hash, difficulty)) {
-        m_logger(Logging::INFO) << "Found block for difficulty " << difficulty;
+      Crypto::Hash hashes[Crypto::SLOW_HASH_MAX_WAYS];
+      Crypto::cn_slow_hash_multi(cryptoContext, data, lengths, hashes, hashWays);
+      m_metrics.addHashes(workerIndex, hashWays);
+
+      for (size_t i = 0; i < hashWays; ++i) {
+        if (!check_hash(hashes[i], job.difficulty)) {
+          continue;
+        }
+
+        if (m_job.epoch() != job.epoch) {
+          m_logger(Logging::DEBUGGING) << "Found block for replaced job " << job.epoch;
+          m_metrics.staleBlock();
+          break;
+        }
+
+        m_logger(Logging::INFO) << "Found block for difficulty " << job.difficulty;
+        m_metrics.blockFound();
 
         if (!setStateBlockFound()) {
           m_logger(Logging::DEBUGGING) << "block is already found or mining stopped";
           return;
         }
 
-        m_block = block;
+        m_foundEpoch = job.epoch;
+        m_foundNonce = nonce + static_cast<uint32_t>(i) * nonceStep;
         return;
       }
 
-      block.nonce += nonceStep;
+      nonce += nonceStep * static_cast<uint32_t>(hashWays);
     }
   } catch (std::exception& e) {
     m_logger(Logging::ERROR) << "Miner got error: " << e.what();
@@ -143,6 +206,17 @@ void Miner::workerFunc(const Block& blockTemplate, difficulty_type difficulty, u
   }
 }
 
+bool Miner::takeFoundBlock(Block& block) const {
+  size_t slot = m_foundEpoch % 2;
+  if (m_templateEpochs[slot] != m_foundEpoch) {
+    return false;
+  }
+
+  block = m_templates[slot];
+  block.nonce = m_foundNonce;
+  return true;
+}
+
 bool Miner::setStateBlockFound() {
   auto state = m_state.load();
 
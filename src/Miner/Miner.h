@@ -41,6 +41,8 @@
 #include "CryptoNoteCore/Difficulty.h"
 
 #include "Logging/LoggerRef.h"
+#include "MinerMetrics.h"
+#include "MiningJob.h"
 
 namespace CryptoNote {
 
@@ -51,10 +53,14 @@ struct BlockMiningParameters {
 
 class Miner {
 public:
-  Miner(System::Dispatcher& dispatcher, Logging::ILogger& logger);
+  Miner(System::Dispatcher& dispatcher, Logging::ILogger& logger, MinerMetrics& metrics);
   ~Miner();
 
-  Block mine(const BlockMiningParameters& blockMiningParameters, size_t threadCount);
+  //hashWays is the number of nonces each thread hashes at once, 1..Crypto::SLOW_HASH_MAX_WAYS
+  Block mine(const BlockMiningParameters& blockMiningParameters, size_t threadCount, size_t hashWays = 1);
+
+  //Replaces the job of running mine() call, its threads switch to the new template after the current hash batch
+  void updateJob(const BlockMiningParameters& blockMiningParameters);
 
   //NOTE! this is blocking method
   void stop();
@@ -68,13 +74,22 @@ private:
 
   std::vector<std::unique_ptr<System::RemoteContext<void>>>  m_workers;
 
-  Block m_block;
+  MiningJobDescriptor m_job;
+  //templates of the two latest jobs, a block may be found on the previous one while the next is published
+  Block m_templates[2];
+  uint64_t m_templateEpochs[2];
+
+  //written by the thread which switched the state to BLOCK_FOUND
+  uint64_t m_foundEpoch;
+  uint32_t m_foundNonce;
 
   Logging::LoggerRef m_logger;
+  MinerMetrics& m_metrics;
 
-  void runWorkers(BlockMiningParameters blockMiningParameters, size_t threadCount);
-  void workerFunc(const Block& blockTemplate, difficulty_type difficulty, uint32_t nonceStep);
+  void runWorkers(size_t threadCount, size_t hashWays);
+  void workerFunc(uint32_t workerIndex, uint32_t nonceStep, size_t hashWays);
   bool setStateBlockFound();
+  bool takeFoundBlock(Block& block) const;
 };
 
 } //namespace CryptoNote
@@ -68,8 +68,10 @@ MinerManager::MinerManager(System::Dispatcher& dispatcher, const CryptoNote::Min
   m_logger(logger, "MinerManager"),
   m_contextGroup(dispatcher),
   m_config(config),
-  m_miner(dispatcher, logger),
-  m_blockchainMonitor(dispatcher, m_config.daemonHost, m_config.daemonPort, m_config.scanPeriod, logger),
+  m_metrics(config.threadCount),
+  m_miner(dispatcher, logger, m_metrics),
+  m_blockchainMonitor(dispatcher, m_config.daemonHost, m_config.daemonPort, m_config.scanPeriod, m_metrics, logger),
+  m_statsServer(dispatcher, logger, m_metrics),
   m_eventOccurred(dispatcher),
   m_httpEvent(dispatcher),
   m_lastBlockTimestamp(0) {
@@ -78,11 +80,21 @@ MinerManager::MinerManager(System::Dispatcher& dispatcher, const CryptoNote::Min
 }
 
 MinerManager::~MinerManager() {
+  if (m_config.statsPort != 0) {
+    m_statsServer.stop();
+  }
 }
 
 void MinerManager::start() {
   m_logger(Logging::DEBUGGING) << "starting";
 
+  if (m_config.statsPort != 0) {
+    m_statsServer.start(m_config.statsBindIp, m_config.statsPort);
+    m_logger(Logging::INFO) << "Stats are served on http://" << m_config.statsBindIp << ":" << m_config.statsPort << "/stats";
+  }
+
+  startReporting();
+
   BlockMiningParameters params;
   for (;;) {
     m_logger(Logging::INFO) << "requesting mining parameters";
@@ -137,13 +149,13 @@ void MinerManager::eventLoop() {
 
       case MinerEventType::BLOCKCHAIN_UPDATED: {
         m_logger(Logging::DEBUGGING) << "got BLOCKCHAIN_UPDATED event";
-        stopMining();
         stopBlockchainMonitoring();
         BlockMiningParameters params = requestMiningParameters(m_dispatcher, m_config.daemonHost, m_config.daemonPort, m_config.miningAddress);
         adjustBlockTemplate(params.blockTemplate);
 
+        //mining threads keep running and pick up the new template
+        m_miner.updateJob(params);
         startBlockchainMonitoring();
-        startMining(params);
         break;
       }
 
@@ -174,7 +186,7 @@ void MinerManager::pushEvent(MinerEvent&& event) {
 void MinerManager::startMining(const CryptoNote::BlockMiningParameters& params) {
   m_contextGroup.spawn([this, params] () {
     try {
-      m_minedBlock = m_miner.mine(params, m_config.threadCount);
+      m_minedBlock = m_miner.mine(params, m_config.threadCount, m_config.hashWays);
       pushEvent(BlockMinedEvent());
     } catch (System::InterruptedException&) {
     } catch (std::exception& e) {
@@ -183,8 +195,34 @@ void MinerManager::startMining(const CryptoNote::BlockMiningParameters& params)
   });
 }
 
-void MinerManager::stopMining() {
-  m_miner.stop();
+void MinerManager::startReporting() {
+  if (m_config.statsInterval == 0) {
+    return;
+  }
+
+  m_contextGroup.spawn([this] () {
+    try {
+      System::Timer timer(m_dispatcher);
+      uint64_t lastHashes = m_metrics.getHashes();
+      auto lastTime = std::chrono::steady_clock::now();
+      for (;;) {
+        timer.sleep(std::chrono::seconds(m_config.statsInterval));
+
+        uint64_t hashes = m_metrics.getHashes();
+        auto time = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(time - lastTime).count();
+        CryptoNote::MinerStatistics statistics = m_metrics.getStatistics();
+
+        m_logger(Logging::INFO) << "Hashrate " << static_cast<uint64_t>((hashes - lastHashes) / seconds) << " H/s, job age " <<
+          statistics.jobAgeSeconds << " s, found " << statistics.blocksFound << ", stale " << statistics.staleBlocks <<
+          ", template fetch p50/p99 " << statistics.templateFetch.p50Microseconds << "/" << statistics.templateFetch.p99Microseconds << " us";
+
+        lastHashes = hashes;
+        lastTime = time;
+      }
+    } catch (System::InterruptedException&) {
+    }
+  });
 }
 
 void MinerManager::startBlockchainMonitoring() {
@@ -213,11 +251,16 @@ bool MinerManager::submitBlock(const Block& minedBlock, const std::string& daemo
     COMMAND_RPC_SUBMITBLOCK::response response;
 
     System::EventLock lk(m_httpEvent);
-    JsonRpc::invokeJsonRpcCommand(client, "submitblock", request, response);
+    {
+      Common::MetricTimer timer(m_metrics.blockSubmit());
+      JsonRpc::invokeJsonRpcCommand(client, "submitblock", request, response);
+    }
 
+    m_metrics.blockSubmitted(true);
     m_logger(Logging::INFO) << "Block has been successfully submitted. Block hash: " << Common::podToHex(get_block_hash(minedBlock));
     return true;
   } catch (std::exception& e) {
+    m_metrics.blockSubmitted(false);
     m_logger(Logging::WARNING) << "Couldn't submit block: " << Common::podToHex(get_block_hash(minedBlock)) << ", reason: " << e.what();
     return false;
   }
@@ -234,7 +277,10 @@ BlockMiningParameters MinerManager::requestMiningParameters(System::Dispatcher&
     COMMAND_RPC_GETBLOCKTEMPLATE::response response;
 
     System::EventLock lk(m_httpEvent);
-    JsonRpc::invokeJsonRpcCommand(client, "getblocktemplate", request, response);
+    {
+      Common::MetricTimer timer(m_metrics.templateFetch());
+      JsonRpc::invokeJsonRpcCommand(client, "getblocktemplate", request, response);
+    }
 
     if (response.status != CORE_RPC_STATUS_OK) {
       throw std::runtime_error("Core responded with wrong status: " + response.status);
@@ -39,6 +39,8 @@
 #include "Logging/LoggerRef.h"
 #include "Miner.h"
 #include "MinerEvent.h"
+#include "MinerMetrics.h"
+#include "MinerStatsServer.h"
 #include "MiningConfig.h"
 
 namespace System {
@@ -59,8 +61,10 @@ private:
   Logging::LoggerRef m_logger;
   System::ContextGroup m_contextGroup;
   CryptoNote::MiningConfig m_config;
+  CryptoNote::MinerMetrics m_metrics;
   CryptoNote::Miner m_miner;
   BlockchainMonitor m_blockchainMonitor;
+  CryptoNote::MinerStatsServer m_statsServer;
 
   System::Event m_eventOccurred;
   System::Event m_httpEvent;
@@ -75,7 +79,8 @@ private:
   void pushEvent(MinerEvent&& event);
 
   void startMining(const CryptoNote::BlockMiningParameters& params);
-  void stopMining();
+
+  void startReporting();
 
   void startBlockchainMonitoring();
   void stopBlockchainMonitoring();
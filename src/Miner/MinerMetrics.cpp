@@ -0,0 +1,138 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "MinerMetrics.h"
+
+#include <array>
+#include <chrono>
+
+namespace CryptoNote {
+
+MinerMetrics::MinerMetrics(size_t threadCount) :
+  m_threadCount(threadCount),
+  m_threads(new ThreadCounters[threadCount]),
+  m_startTime(now()),
+  m_jobStartTime(m_startTime),
+  m_jobs(0),
+  m_blocksFound(0),
+  m_staleBlocks(0),
+  m_blocksSubmitted(0),
+  m_blocksRejected(0) {
+
+  for (size_t i = 0; i < threadCount; ++i) {
+    m_threads[i].hashes.store(0, std::memory_order_relaxed);
+  }
+}
+
+void MinerMetrics::jobStarted() {
+  m_jobs.fetch_add(1, std::memory_order_relaxed);
+  m_jobStartTime.store(now(), std::memory_order_relaxed);
+}
+
+void MinerMetrics::blockSubmitted(bool accepted) {
+  if (accepted) {
+    m_blocksSubmitted.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    m_blocksRejected.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+uint64_t MinerMetrics::getHashes() const {
+  uint64_t hashes = 0;
+  for (size_t i = 0; i < m_threadCount; ++i) {
+    hashes += m_threads[i].hashes.load(std::memory_order_relaxed);
+  }
+
+  return hashes;
+}
+
+MinerStatistics MinerMetrics::getStatistics() const {
+  MinerStatistics statistics;
+  int64_t currentTime = now();
+
+  statistics.uptimeSeconds = static_cast<uint64_t>(currentTime - m_startTime) / 1000;
+  statistics.hashes = 0;
+  for (size_t i = 0; i < m_threadCount; ++i) {
+    uint64_t hashes = m_threads[i].hashes.load(std::memory_order_relaxed);
+    statistics.threadHashes.push_back(hashes);
+    statistics.hashes += hashes;
+  }
+
+  statistics.averageHashrate = statistics.uptimeSeconds == 0 ? 0 : statistics.hashes / statistics.uptimeSeconds;
+  statistics.jobs = m_jobs.load(std::memory_order_relaxed);
+  statistics.jobAgeSeconds = static_cast<uint64_t>(currentTime - m_jobStartTime.load(std::memory_order_relaxed)) / 1000;
+  statistics.blocksFound = m_blocksFound.load(std::memory_order_relaxed);
+  statistics.staleBlocks = m_staleBlocks.load(std::memory_order_relaxed);
+  statistics.blocksSubmitted = m_blocksSubmitted.load(std::memory_order_relaxed);
+  statistics.blocksRejected = m_blocksRejected.load(std::memory_order_relaxed);
+  statistics.templateFetch = getLatencyStatistics(m_templateFetch);
+  statistics.blockSubmit = getLatencyStatistics(m_blockSubmit);
+  statistics.blockchainPoll = getLatencyStatistics(m_blockchainPoll);
+  return statistics;
+}
+
+LatencyStatistics MinerMetrics::getLatencyStatistics(const Common::MetricHistogram& histogram) {
+  std::array<uint64_t, Common::MetricHistogram::BUCKET_COUNT + 1> buckets;
+  uint64_t count = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    buckets[i] = histogram.getBucket(i);
+    count += buckets[i];
+  }
+
+  LatencyStatistics statistics;
+  statistics.count = count;
+  statistics.averageMicroseconds = count == 0 ? 0 : histogram.getSumMicroseconds() / count;
+  statistics.p50Microseconds = 0;
+  statistics.p99Microseconds = 0;
+
+  uint64_t seen = 0;
+  bool p50Found = false;
+  for (size_t i = 0; i < buckets.size() && count != 0; ++i) {
+    // the overflow bucket has no upper bound, report the largest one
+    uint64_t upperBound = i < Common::MetricHistogram::BUCKET_COUNT ? Common::MetricHistogram::BUCKET_BOUNDS[i] : Common::MetricHistogram::BUCKET_BOUNDS.back();
+    seen += buckets[i];
+    if (!p50Found && seen * 2 >= count) {
+      statistics.p50Microseconds = upperBound;
+      p50Found = true;
+    }
+
+    if (seen * 100 >= count * 99) {
+      statistics.p99Microseconds = upperBound;
+      break;
+    }
+  }
+
+  return statistics;
+}
+
+int64_t MinerMetrics::now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Common/Metrics.h"
+#include "Serialization/ISerializer.h"
+#include "Serialization/SerializationOverloads.h"
+
+namespace CryptoNote {
+
+struct LatencyStatistics {
+  uint64_t count;
+  uint64_t averageMicroseconds;
+  // upper bounds of the Common::MetricHistogram buckets holding the percentiles
+  uint64_t p50Microseconds;
+  uint64_t p99Microseconds;
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(count)
+    KV_MEMBER(averageMicroseconds)
+    KV_MEMBER(p50Microseconds)
+    KV_MEMBER(p99Microseconds)
+  }
+};
+
+struct MinerStatistics {
+  uint64_t uptimeSeconds;
+  uint64_t hashes;
+  std::vector<uint64_t> threadHashes;
+  uint64_t averageHashrate;
+  uint64_t jobs;
+  uint64_t jobAgeSeconds;
+  uint64_t blocksFound;
+  uint64_t staleBlocks;
+  uint64_t blocksSubmitted;
+  uint64_t blocksRejected;
+  LatencyStatistics templateFetch;
+  LatencyStatistics blockSubmit;
+  LatencyStatistics blockchainPoll;
+
+  void serialize(ISerializer& s) {
+    KV_MEMBER(uptimeSeconds)
+    KV_MEMBER(hashes)
+    KV_MEMBER(threadHashes)
+    KV_MEMBER(averageHashrate)
+    KV_MEMBER(jobs)
+    KV_MEMBER(jobAgeSeconds)
+    KV_MEMBER(blocksFound)
+    KV_MEMBER(staleBlocks)
+    KV_MEMBER(blocksSubmitted)
+    KV_MEMBER(blocksRejected)
+    KV_MEMBER(templateFetch)
+    KV_MEMBER(blockSubmit)
+    KV_MEMBER(blockchainPoll)
+  }
+};
+
+// Counters of the standalone miner. Mining threads update only their own cache line.
+class MinerMetrics {
+public:
+  explicit MinerMetrics(size_t threadCount);
+
+  void addHashes(size_t thread, uint64_t hashes) {
+    m_threads[thread].hashes.fetch_add(hashes, std::memory_order_relaxed);
+  }
+
+  void jobStarted();
+  void blockFound() { m_blocksFound.fetch_add(1, std::memory_order_relaxed); }
+  void staleBlock() { m_staleBlocks.fetch_add(1, std::memory_order_relaxed); }
+  void blockSubmitted(bool accepted);
+
+  Common::MetricHistogram& templateFetch() { return m_templateFetch; }
+  Common::MetricHistogram& blockSubmit() { return m_blockSubmit; }
+  Common::MetricHistogram& blockchainPoll() { return m_blockchainPoll; }
+
+  uint64_t getHashes() const;
+  MinerStatistics getStatistics() const;
+
+private:
+  struct ThreadCounters {
+    std::atomic<uint64_t> hashes;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  static int64_t now();
+  static LatencyStatistics getLatencyStatistics(const Common::MetricHistogram& histogram);
+
+  size_t m_threadCount;
+  std::unique_ptr<ThreadCounters[]> m_threads;
+  int64_t m_startTime;
+  std::atomic<int64_t> m_jobStartTime;
+  std::atomic<uint64_t> m_jobs;
+  std::atomic<uint64_t> m_blocksFound;
+  std::atomic<uint64_t> m_staleBlocks;
+  std::atomic<uint64_t> m_blocksSubmitted;
+  std::atomic<uint64_t> m_blocksRejected;
+  Common::MetricHistogram m_templateFetch;
+  Common::MetricHistogram m_blockSubmit;
+  Common::MetricHistogram m_blockchainPoll;
+};
+
+}
@@ -39,6 +39,7 @@
 #include <boost/program_options.hpp>
 
 #include "CryptoNoteConfig.h"
+#include "crypto/hash.h"
 #include "Logging/ILogger.h"
 
 namespace po = boost::program_options;
@@ -48,6 +49,9 @@ namespace CryptoNote {
 namespace {
 
 const size_t DEFAULT_SCANT_PERIOD = 30;
+const size_t DEFAULT_HASH_WAYS = 2;
+const size_t DEFAULT_STATS_INTERVAL = 60;
+const char* DEFAULT_STATS_BIND_IP = "127.0.0.1";
 const char* DEFAULT_DAEMON_HOST = "127.0.0.1";
 const size_t CONCURRENCY_LEVEL = std::thread::hardware_concurrency();
 
@@ -84,8 +88,12 @@ MiningConfig::MiningConfig(): help(false) {
       ("daemon-rpc-port", po::value<uint16_t>()->default_value(static_cast<uint16_t>(RPC_DEFAULT_PORT)), "Daemon's RPC port")
       ("daemon-address", po::value<std::string>(), "Daemon host:port. If you use this option you must not use --daemon-host and --daemon-port options")
       ("threads", po::value<size_t>()->default_value(CONCURRENCY_LEVEL), "Mining threads count. Must not be greater than you concurrency level. Default value is your hardware concurrency level")
+      ("hash-ways", po::value<size_t>()->default_value(DEFAULT_HASH_WAYS), "Nonces hashed at once by every mining thread, 1..4. Each one needs 2 MiB of scratchpad, so keep it within the cache available per thread")
       ("scan-time", po::value<size_t>()->default_value(DEFAULT_SCANT_PERIOD), "Blockchain polling interval (seconds). How often miner will check blockchain for updates")
       ("log-level", po::value<int>()->default_value(1), "Log level. Must be 0..5")
+      ("stats-interval", po::value<size_t>()->default_value(DEFAULT_STATS_INTERVAL), "Hashrate report interval (seconds). 0 disables the report")
+      ("stats-bind-ip", po::value<std::string>()->default_value(DEFAULT_STATS_BIND_IP), "Interface for the JSON stats endpoint")
+      ("stats-port", po::value<uint16_t>()->default_value(0), "Port for the JSON stats endpoint, served on GET /stats. 0 disables it")
       ("limit", po::value<size_t>()->default_value(0), "Mine exact quantity of blocks. 0 means no limit")
       ("first-block-timestamp", po::value<uint64_t>()->default_value(0), "Set timestamp to the first mined block. 0 means leave timestamp unchanged")
       ("block-timestamp-interval", po::value<int64_t>()->default_value(0), "Timestamp step for each subsequent block. May be set only if --first-block-timestamp has been set."
@@ -124,6 +132,11 @@ void MiningConfig::parse(int argc, char** argv) {
     throw std::runtime_error("--threads option must be 1.." + std::to_string(CONCURRENCY_LEVEL));
   }
 
+  hashWays = options["hash-ways"].as<size_t>();
+  if (hashWays == 0 || hashWays > Crypto::SLOW_HASH_MAX_WAYS) {
+    throw std::runtime_error("--hash-ways option must be 1.." + std::to_string(Crypto::SLOW_HASH_MAX_WAYS));
+  }
+
   scanPeriod = options["scan-time"].as<size_t>();
   if (scanPeriod == 0) {
     throw std::runtime_error("--scan-time must not be zero");
@@ -135,6 +148,9 @@ void MiningConfig::parse(int argc, char** argv) {
   }
 
   blocksLimit = options["limit"].as<size_t>();
+  statsInterval = options["stats-interval"].as<size_t>();
+  statsBindIp = options["stats-bind-ip"].as<std::string>();
+  statsPort = options["stats-port"].as<uint16_t>();
 
   if (!options["block-timestamp-interval"].defaulted() && options["first-block-timestamp"].defaulted()) {
     throw std::runtime_error("If you specify --block-timestamp-interval you must specify --first-block-timestamp either");
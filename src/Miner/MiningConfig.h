@@ -45,11 +45,15 @@ struct MiningConfig {
   std::string daemonHost;
   uint16_t daemonPort;
   size_t threadCount;
+  size_t hashWays;
   size_t scanPeriod;
   uint8_t logLevel;
   size_t blocksLimit;
   uint64_t firstBlockTimestamp;
   int64_t blockTimestampInterval;
+  size_t statsInterval;
+  std::string statsBindIp;
+  uint16_t statsPort;
   bool help;
 };
 
@@ -0,0 +1,100 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "MiningJob.h"
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace CryptoNote {
+
+MiningJobDescriptor::MiningJobDescriptor() : m_sequence(0), m_difficulty(0), m_startNonce(0), m_nonceOffset(0), m_blobSize(0) {
+  for (auto& word : m_blob) {
+    word.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint64_t MiningJobDescriptor::publish(const BinaryArray& hashingBlob, size_t nonceOffset, difficulty_type difficulty, uint32_t startNonce) {
+  if (hashingBlob.size() > MAX_HASHING_BLOB_SIZE || nonceOffset + sizeof(uint32_t) > hashingBlob.size()) {
+    throw std::runtime_error("Block hashing blob doesn't fit mining job");
+  }
+
+  uint64_t words[BLOB_WORDS] = {};
+  memcpy(words, hashingBlob.data(), hashingBlob.size());
+
+  uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+  assert((sequence & 1) == 0);
+  m_sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  m_difficulty.store(difficulty, std::memory_order_relaxed);
+  m_startNonce.store(startNonce, std::memory_order_relaxed);
+  m_nonceOffset.store(static_cast<uint32_t>(nonceOffset), std::memory_order_relaxed);
+  m_blobSize.store(static_cast<uint32_t>(hashingBlob.size()), std::memory_order_relaxed);
+  for (size_t i = 0; i < BLOB_WORDS; ++i) {
+    m_blob[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  m_sequence.store(sequence + 2, std::memory_order_release);
+  return (sequence + 2) / 2;
+}
+
+uint64_t MiningJobDescriptor::epoch() const {
+  return m_sequence.load(std::memory_order_acquire) / 2;
+}
+
+void MiningJobDescriptor::read(Job& job) const {
+  uint64_t words[BLOB_WORDS];
+  for (;;) {
+    uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    job.difficulty = m_difficulty.load(std::memory_order_relaxed);
+    job.startNonce = m_startNonce.load(std::memory_order_relaxed);
+    job.nonceOffset = m_nonceOffset.load(std::memory_order_relaxed);
+    job.blobSize = m_blobSize.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < BLOB_WORDS; ++i) {
+      words[i] = m_blob[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+      job.epoch = sequence / 2;
+      memcpy(job.blob, words, sizeof(job.blob));
+      return;
+    }
+  }
+}
+
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "CryptoNote.h"
+#include "CryptoNoteCore/Difficulty.h"
+
+namespace CryptoNote {
+
+// The job all mining threads work on: a block hashing blob, the offset of the nonce in it and the difficulty.
+// One publisher replaces the job, any number of workers poll epoch() between hash batches and
+// read() the new job when it changes. Neither side locks nor allocates.
+class MiningJobDescriptor {
+public:
+  static const size_t MAX_HASHING_BLOB_SIZE = 128;
+
+  struct Job {
+    uint64_t epoch;
+    difficulty_type difficulty;
+    uint32_t startNonce;
+    size_t nonceOffset;
+    size_t blobSize;
+    uint8_t blob[MAX_HASHING_BLOB_SIZE];
+  };
+
+  MiningJobDescriptor();
+
+  // Must not be called concurrently. Returns the epoch of the new job, the first one is 1.
+  uint64_t publish(const BinaryArray& hashingBlob, size_t nonceOffset, difficulty_type difficulty, uint32_t startNonce);
+
+  // 0 until the first job is published
+  uint64_t epoch() const;
+  void read(Job& job) const;
+
+private:
+  static const size_t BLOB_WORDS = MAX_HASHING_BLOB_SIZE / sizeof(uint64_t);
+
+  // odd while a job is being written, twice the epoch otherwise
+  std::atomic<uint64_t> m_sequence;
+  std::atomic<uint64_t> m_difficulty;
+  std::atomic<uint32_t> m_startNonce;
+  std::atomic<uint32_t> m_nonceOffset;
+  std::atomic<uint32_t> m_blobSize;
+  std::array<std::atomic<uint64_t>, BLOB_WORDS> m_blob;
+};
+
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "DecoyOutputsCache.h"
+
+#include <algorithm>
+
+namespace CryptoNote {
+
+DecoyOutputsCache::DecoyOutputsCache() : m_outsPerAmount(0), m_maxAge(Clock::duration::zero()) {
+}
+
+void DecoyOutputsCache::setLimits(size_t outsPerAmount, Clock::duration maxAge) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_outsPerAmount = outsPerAmount;
+  m_maxAge = maxAge;
+  if (m_outsPerAmount == 0) {
+    m_outs.clear();
+  }
+}
+
+bool DecoyOutputsCache::isEnabled() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_outsPerAmount != 0;
+}
+
+bool DecoyOutputsCache::take(const std::vector<uint64_t>& amounts, uint64_t outsCount, std::vector<OutsForAmount>& result, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_outsPerAmount == 0) {
+    return false;
+  }
+
+  std::unordered_map<uint64_t, uint64_t> neededCounts;
+  for (uint64_t amount : amounts) {
+    neededCounts[amount] += outsCount;
+  }
+
+  bool enough = true;
+  for (const auto& needed : neededCounts) {
+    AmountOuts& amountOuts = m_outs[needed.first];
+    amountOuts.lastRequestTime = now;
+    dropStale(amountOuts, now);
+    if (amountOuts.entries.size() < needed.second) {
+      enough = false;
+    }
+  }
+
+  if (!enough) {
+    return false;
+  }
+
+  result.clear();
+  result.reserve(amounts.size());
+  for (uint64_t amount : amounts) {
+    AmountOuts& amountOuts = m_outs[amount];
+
+    OutsForAmount outsForAmount;
+    outsForAmount.amount = amount;
+    for (uint64_t i = 0; i < outsCount; ++i) {
+      outsForAmount.outs.push_back(amountOuts.entries.front().out);
+      amountOuts.entries.pop_front();
+    }
+
+    result.push_back(std::move(outsForAmount));
+  }
+
+  return true;
+}
+
+std::vector<uint64_t> DecoyOutputsCache::getMissingAmounts(uint64_t& outsCount, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::vector<uint64_t> amounts;
+  outsCount = 0;
+  for (auto it = m_outs.begin(); it != m_outs.end();) {
+    if (now - it->second.lastRequestTime > m_maxAge) {
+      it = m_outs.erase(it);
+      continue;
+    }
+
+    dropStale(it->second, now);
+    if (it->second.entries.size() < m_outsPerAmount) {
+      amounts.push_back(it->first);
+      outsCount = std::max<uint64_t>(outsCount, m_outsPerAmount - it->second.entries.size());
+    }
+
+    ++it;
+  }
+
+  return amounts;
+}
+
+void DecoyOutputsCache::add(const std::vector<OutsForAmount>& outs, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (const auto& outsForAmount : outs) {
+    auto it = m_outs.find(outsForAmount.amount);
+    if (it == m_outs.end()) {
+      continue;
+    }
+
+    std::deque<Entry>& entries = it->second.entries;
+    for (const auto& out : outsForAmount.outs) {
+      if (entries.size() >= m_outsPerAmount) {
+        break;
+      }
+
+      auto sameOut = std::find_if(entries.begin(), entries.end(), [&out](const Entry& entry) {
+        return entry.out.global_amount_index == out.global_amount_index;
+      });
+
+      if (sameOut == entries.end()) {
+        entries.push_back({ out, now });
+      }
+    }
+  }
+}
+
+void DecoyOutputsCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& amountOuts : m_outs) {
+    amountOuts.second.entries.clear();
+  }
+}
+
+size_t DecoyOutputsCache::size(uint64_t amount) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_outs.find(amount);
+  return it == m_outs.end() ? 0 : it->second.entries.size();
+}
+
+void DecoyOutputsCache::dropStale(AmountOuts& amountOuts, Clock::time_point now) {
+  while (!amountOuts.entries.empty() && now - amountOuts.entries.front().fetchTime > m_maxAge) {
+    amountOuts.entries.pop_front();
+  }
+}
+
+}
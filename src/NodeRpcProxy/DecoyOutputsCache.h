@@ -0,0 +1,84 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Rpc/CoreRpcServerCommandsDefinitions.h"
+
+namespace CryptoNote {
+
+// Random outputs fetched ahead of time, grouped by amount. Each entry is handed out once, entries older than maxAge
+// are dropped, and only amounts requested within maxAge are refilled. A cache with outsPerAmount == 0 is disabled.
+class DecoyOutputsCache {
+public:
+  typedef std::chrono::steady_clock Clock;
+  typedef COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount OutsForAmount;
+
+  DecoyOutputsCache();
+
+  void setLimits(size_t outsPerAmount, Clock::duration maxAge);
+  bool isEnabled() const;
+
+  // Fills result in the order of amounts only if every amount has outsCount fresh entries, otherwise takes nothing.
+  // The amounts are remembered as wanted either way.
+  bool take(const std::vector<uint64_t>& amounts, uint64_t outsCount, std::vector<OutsForAmount>& result, Clock::time_point now = Clock::now());
+  // Wanted amounts below the target size and the count to request for each of them; empty when nothing is missing
+  std::vector<uint64_t> getMissingAmounts(uint64_t& outsCount, Clock::time_point now = Clock::now());
+  void add(const std::vector<OutsForAmount>& outs, Clock::time_point now = Clock::now());
+  void clear();
+
+  size_t size(uint64_t amount) const;
+
+private:
+  struct Entry {
+    COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry out;
+    Clock::time_point fetchTime;
+  };
+
+  struct AmountOuts {
+    std::deque<Entry> entries;
+    Clock::time_point lastRequestTime;
+  };
+
+  void dropStale(AmountOuts& amountOuts, Clock::time_point now);
+
+  mutable std::mutex m_mutex;
+  std::unordered_map<uint64_t, AmountOuts> m_outs;
+  size_t m_outsPerAmount;
+  Clock::duration m_maxAge;
+};
+
+}
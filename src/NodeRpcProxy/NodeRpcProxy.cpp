@@ -31,24 +31,26 @@
 #include "NodeRpcProxy.h"
 #include "NodeErrors.h"
 
+#include <algorithm>
 #include <atomic>
 #include <system_error>
 #include <thread>
 
 #include <HTTP/HttpRequest.h>
 #include <HTTP/HttpResponse.h>
+#include <System/Context.h>
 #include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
-#include <System/Event.h>
-#include <System/EventLock.h>
 #include <System/Timer.h>
 #include <CryptoNoteCore/TransactionApi.h>
 
+#include "Common/Metrics.h"
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteBasicImpl.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "Rpc/CoreRpcServerCommandsDefinitions.h"
 #include "Rpc/HttpClient.h"
+#include "Rpc/HttpClientPool.h"
 #include "Rpc/JsonRpc.h"
 
 #ifndef AUTO_VAL_INIT
@@ -76,7 +78,9 @@ std::error_code interpretResponseStatus(const std::string& status) {
 
 NodeRpcProxy::NodeRpcProxy(const std::string& nodeHost, unsigned short nodePort) :
     m_rpcTimeout(10000),
+    m_connectionCount(4),
     m_pullInterval(5000),
+    m_longPollTimeout(30000),
     m_nodeHost(nodeHost),
     m_nodePort(nodePort),
     m_lastLocalBlockTimestamp(0),
@@ -96,6 +100,7 @@ void NodeRpcProxy::resetInternalState() {
   m_peerCount.store(0, std::memory_order_relaxed);
   m_nodeHeight.store(0, std::memory_order_relaxed);
   m_networkHeight.store(0, std::memory_order_relaxed);
+  m_longPollSupported = true;
   m_lastKnowHash = CryptoNote::NULL_HASH;
   m_knownTxs.clear();
 }
@@ -132,6 +137,10 @@ bool NodeRpcProxy::shutdown() {
 
   m_dispatcher->remoteSpawn([this]() {
     m_stop = true;
+    if (m_waitForChangesContext != nullptr) {
+      m_waitForChangesContext->interrupt();
+    }
+
     // Run all spawned contexts
     m_dispatcher->yield();
   });
@@ -150,11 +159,12 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
     m_dispatcher = &dispatcher;
     ContextGroup contextGroup(dispatcher);
     m_context_group = &contextGroup;
-    HttpClient httpClient(dispatcher, m_nodeHost, m_nodePort);
+    HttpClientPool httpClient(dispatcher, m_nodeHost, m_nodePort, std::max<size_t>(m_connectionCount, 1));
+    // the node may have accepted a transaction before the connection broke, so it is never relayed twice
+    httpClient.addNonIdempotentUrl("/sendrawtransaction");
     m_httpClient = &httpClient;
-    Event httpEvent(dispatcher);
-    m_httpEvent = &httpEvent;
-    m_httpEvent->set();
+    HttpClient notificationClient(dispatcher, m_nodeHost, m_nodePort);
+    m_notificationClient = &notificationClient;
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
@@ -167,10 +177,16 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
 
     contextGroup.spawn([this]() {
       Timer pullTimer(*m_dispatcher);
+      bool statusOutdated = true;
       while (!m_stop) {
-        updateNodeStatus();
-        if (!m_stop) {
+        if (statusOutdated) {
+          updateNodeStatus();
+          refillDecoyCache();
+        }
+
+        if (!m_stop && !waitForNodeChanges(statusOutdated) && !m_stop) {
           pullTimer.sleep(std::chrono::milliseconds(m_pullInterval));
+          statusOutdated = true;
         }
       }
     });
@@ -184,7 +200,7 @@ void NodeRpcProxy::workerThread(const INode::Callback& initialized_callback) {
   m_dispatcher = nullptr;
   m_context_group = nullptr;
   m_httpClient = nullptr;
-  m_httpEvent = nullptr;
+  m_notificationClient = nullptr;
   m_connected = false;
   m_rpcProxyObserverManager.notify(&INodeRpcProxyObserver::connectionStatusUpdated, m_connected);
 }
@@ -222,6 +238,46 @@ bool NodeRpcProxy::updatePoolStatus() {
   return true;
 }
 
+// Parks a long-poll request on the node and applies the pool changes it returns. statusOutdated is set when the tail
+// block changed or the request timed out, so the caller refreshes the tail and the node info. Returns false when the node
+// can not be waited on (an older daemon, a busy core or a network error) and the caller has to fall back to polling.
+bool NodeRpcProxy::waitForNodeChanges(bool& statusOutdated) {
+  if (!m_longPollSupported) {
+    return false;
+  }
+
+  bool isBcActual = false;
+  std::vector<std::unique_ptr<ITransactionReader>> addedTxs;
+  std::vector<Crypto::Hash> deletedTxsIds;
+
+  std::error_code ec;
+  {
+    System::Context<std::error_code> waitContext(*m_dispatcher, [this, &isBcActual, &addedTxs, &deletedTxsIds] {
+      return doWaitForChanges(isBcActual, addedTxs, deletedTxsIds);
+    });
+
+    m_waitForChangesContext = &waitContext;
+    ec = waitContext.get();
+    m_waitForChangesContext = nullptr;
+  }
+
+  if (ec || m_stop) {
+    return false;
+  }
+
+  if (!isBcActual) {
+    statusOutdated = true;
+  } else if (!addedTxs.empty() || !deletedTxsIds.empty()) {
+    updatePoolState(addedTxs, deletedTxsIds);
+    m_observerManager.notify(&INodeObserver::poolChanged);
+    statusOutdated = false;
+  } else {
+    statusOutdated = true;
+  }
+
+  return true;
+}
+
 void NodeRpcProxy::updateBlockchainStatus() {
   CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::request req = AUTO_VAL_INIT(req);
   CryptoNote::COMMAND_RPC_GET_LAST_BLOCK_HEADER::response rsp = AUTO_VAL_INIT(rsp);
@@ -235,6 +291,12 @@ void NodeRpcProxy::updateBlockchainStatus() {
     }
 
     if (blockHash != m_lastKnowHash) {
+      //cached decoys may point to outputs of the replaced blocks, a tail that merely grew by one block keeps them
+      Crypto::Hash prevBlockHash;
+      if (!parse_hash256(rsp.block_header.prev_hash, prevBlockHash) || prevBlockHash != m_lastKnowHash) {
+        m_decoyCache.clear();
+      }
+
       m_lastKnowHash = blockHash;
       m_nodeHeight.store(static_cast<uint32_t>(rsp.block_header.height), std::memory_order_relaxed);
       m_lastLocalBlockTimestamp.store(rsp.block_header.timestamp, std::memory_order_relaxed);
@@ -282,6 +344,28 @@ void NodeRpcProxy::updatePoolState(const std::vector<std::unique_ptr<ITransactio
   }
 }
 
+void NodeRpcProxy::refillDecoyCache() {
+  if (m_decoyCacheRefilling || m_stop || !m_decoyCache.isEnabled()) {
+    return;
+  }
+
+  COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request req = AUTO_VAL_INIT(req);
+  COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response rsp = AUTO_VAL_INIT(rsp);
+  req.amounts = m_decoyCache.getMissingAmounts(req.outs_count);
+  if (req.amounts.empty()) {
+    return;
+  }
+
+  m_decoyCacheRefilling = true;
+  Crypto::Hash tailBlock = m_lastKnowHash;
+  std::error_code ec = binaryCommand("/getrandom_outs.bin", req, rsp);
+  if (!ec && tailBlock == m_lastKnowHash) {
+    m_decoyCache.add(rsp.outs);
+  }
+
+  m_decoyCacheRefilling = false;
+}
+
 std::vector<Crypto::Hash> NodeRpcProxy::getKnownTxsVector() const {
   return std::vector<Crypto::Hash>(m_knownTxs.begin(), m_knownTxs.end());
 }
@@ -496,6 +580,14 @@ std::error_code NodeRpcProxy::doRelayTransaction(const CryptoNote::Transaction&
 
 std::error_code NodeRpcProxy::doGetRandomOutsByAmounts(std::vector<uint64_t>& amounts, uint64_t outsCount,
                                                        std::vector<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount>& outs) {
+  if (m_decoyCache.isEnabled()) {
+    bool cached = m_decoyCache.take(amounts, outsCount, outs);
+    m_context_group->spawn(std::bind(&NodeRpcProxy::refillDecoyCache, this));
+    if (cached) {
+      return std::error_code();
+    }
+  }
+
   COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request req = AUTO_VAL_INIT(req);
   COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response rsp = AUTO_VAL_INIT(rsp);
   req.amounts = std::move(amounts);
@@ -608,6 +700,52 @@ std::error_code NodeRpcProxy::doGetPoolSymmetricDifference(std::vector<Crypto::H
   return ec;
 }
 
+std::error_code NodeRpcProxy::doWaitForChanges(bool& isBcActual, std::vector<std::unique_ptr<ITransactionReader>>& newTxs,
+        std::vector<Crypto::Hash>& deletedTxIds) {
+  CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::request req = AUTO_VAL_INIT(req);
+  CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::response rsp = AUTO_VAL_INIT(rsp);
+
+  req.tailBlockId = m_lastKnowHash;
+  req.knownTxsIds = getKnownTxsVector();
+  req.timeout = m_longPollTimeout;
+
+  try {
+    HttpRequest httpReq;
+    HttpResponse httpRes;
+
+    httpReq.setUrl("/wait_for_changes.bin");
+    httpReq.setBody(storeToBinaryKeyValue(req));
+    m_notificationClient->request(httpReq, httpRes);
+
+    if (httpRes.getStatus() == HttpResponse::STATUS_404) {
+      // the daemon predates the long-poll endpoint, keep polling it
+      m_longPollSupported = false;
+      return make_error_code(error::INTERNAL_NODE_ERROR);
+    }
+
+    if (httpRes.getStatus() != HttpResponse::STATUS_200 || !loadFromBinaryKeyValue(rsp, httpRes.getBody())) {
+      return make_error_code(error::INTERNAL_NODE_ERROR);
+    }
+  } catch (const ConnectException&) {
+    return make_error_code(error::CONNECT_ERROR);
+  } catch (const std::exception&) {
+    return make_error_code(error::NETWORK_ERROR);
+  }
+
+  std::error_code ec = interpretResponseStatus(rsp.status);
+  if (ec) {
+    return ec;
+  }
+
+  isBcActual = rsp.isTailBlockActual;
+  deletedTxIds = std::move(rsp.deletedTxsIds);
+  for (const auto& tpi : rsp.addedTxs) {
+    newTxs.push_back(createTransactionPrefix(tpi.txPrefix, tpi.txHash));
+  }
+
+  return ec;
+}
+
 void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure, const Callback& callback) {
   // callback is located on stack, so copy it inside binder
   class Wrapper {
@@ -647,12 +785,23 @@ void NodeRpcProxy::scheduleRequest(std::function<std::error_code()>&& procedure,
     }, std::move(procedure), callback));
 }
 
+MetricHistogram& NodeRpcProxy::callLatency(const std::string& call) {
+  auto it = m_callLatency.find(call);
+  if (it == m_callLatency.end()) {
+    MetricHistogram& histogram = MetricsRegistry::instance().histogram("dynex_node_rpc_call_seconds",
+      "Node RPC call latency seen by NodeRpcProxy by call, including the wait for a free connection", "call=\"" + call + "\"");
+    it = m_callLatency.emplace(call, &histogram).first;
+  }
+
+  return *it->second;
+}
+
 template <typename Request, typename Response>
 std::error_code NodeRpcProxy::binaryCommand(const std::string& url, const Request& req, Response& res) {
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
+    MetricTimer timer(callLatency(url));
     invokeBinaryCommand(*m_httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
@@ -669,7 +818,7 @@ std::error_code NodeRpcProxy::jsonCommand(const std::string& url, const Request&
   std::error_code ec;
 
   try {
-    EventLock eventLock(*m_httpEvent);
+    MetricTimer timer(callLatency(url));
     invokeJsonCommand(*m_httpClient, url, req, res);
     ec = interpretResponseStatus(res.status);
   } catch (const ConnectException&) {
@@ -686,7 +835,7 @@ std::error_code NodeRpcProxy::jsonRpcCommand(const std::string& method, const Re
   std::error_code ec = make_error_code(error::INTERNAL_NODE_ERROR);
 
   try {
-    EventLock eventLock(*m_httpEvent);
+    MetricTimer timer(callLatency(method));
 
     JsonRpc::JsonRpcRequest jsReq;
 
@@ -31,24 +31,32 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "Common/ObserverManager.h"
+#include "DecoyOutputsCache.h"
 #include "INode.h"
 
+namespace Common {
+  class MetricHistogram;
+}
+
 namespace System {
+  template<typename ResultType> class Context;
   class ContextGroup;
   class Dispatcher;
-  class Event;
 }
 
 namespace CryptoNote {
 
 class HttpClient;
+class HttpClientPool;
 
 class INodeRpcProxyObserver {
 public:
@@ -96,6 +104,22 @@ public:
   unsigned int rpcTimeout() const { return m_rpcTimeout; }
   void rpcTimeout(unsigned int val) { m_rpcTimeout = val; }
 
+  // Number of keep-alive connections independent requests are spread over, takes effect on the next init()
+  size_t connectionCount() const { return m_connectionCount; }
+  void connectionCount(size_t val) { m_connectionCount = val; }
+
+  // Milliseconds between status polls while the node can't be long-polled
+  uint64_t pullInterval() const { return m_pullInterval; }
+  void pullInterval(uint64_t val) { m_pullInterval = val; }
+
+  // Milliseconds a long-poll request asks the node to wait for a change
+  uint32_t longPollTimeout() const { return m_longPollTimeout; }
+  void longPollTimeout(uint32_t val) { m_longPollTimeout = val; }
+
+  // Keeps up to outsPerAmount random outputs for every recently requested amount and serves getRandomOutsByAmounts
+  // from them. Outputs older than maxAge are not served, and the pool is emptied when the blockchain tail is replaced.
+  void setDecoyCacheLimits(size_t outsPerAmount, std::chrono::seconds maxAge) { m_decoyCache.setLimits(outsPerAmount, maxAge); }
+
 private:
   void resetInternalState();
   void workerThread(const Callback& initialized_callback);
@@ -105,8 +129,10 @@ private:
   void updateNodeStatus();
   void updateBlockchainStatus();
   bool updatePoolStatus();
+  bool waitForNodeChanges(bool& statusOutdated);
   void updatePeerCount(size_t peerCount);
   void updatePoolState(const std::vector<std::unique_ptr<ITransactionReader>>& addedTxs, const std::vector<Crypto::Hash>& deletedTxsIds);
+  void refillDecoyCache();
 
   std::error_code doRelayTransaction(const CryptoNote::Transaction& transaction);
   std::error_code doGetRandomOutsByAmounts(std::vector<uint64_t>& amounts, uint64_t outsCount,
@@ -119,8 +145,10 @@ private:
     std::vector<CryptoNote::BlockShortEntry>& newBlocks, uint32_t& startHeight);
   std::error_code doGetPoolSymmetricDifference(std::vector<Crypto::Hash>&& knownPoolTxIds, Crypto::Hash knownBlockId, bool& isBcActual,
           std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds);
+  std::error_code doWaitForChanges(bool& isBcActual, std::vector<std::unique_ptr<ITransactionReader>>& newTxs, std::vector<Crypto::Hash>& deletedTxIds);
 
   void scheduleRequest(std::function<std::error_code()>&& procedure, const Callback& callback);
+  Common::MetricHistogram& callLatency(const std::string& call);
   template <typename Request, typename Response>
   std::error_code binaryCommand(const std::string& url, const Request& req, Response& res);
   template <typename Request, typename Response>
@@ -147,22 +175,33 @@ private:
   const std::string m_nodeHost;
   const unsigned short m_nodePort;
   unsigned int m_rpcTimeout;
-  HttpClient* m_httpClient = nullptr;
-  System::Event* m_httpEvent = nullptr;
+  size_t m_connectionCount;
+  HttpClientPool* m_httpClient = nullptr;
+  // separate connection for the long-poll requests, so they never occupy the pool
+  HttpClient* m_notificationClient = nullptr;
+  System::Context<std::error_code>* m_waitForChangesContext = nullptr;
 
   uint64_t m_pullInterval;
+  uint32_t m_longPollTimeout;
 
   // Internal state
   bool m_stop = false;
   std::atomic<size_t> m_peerCount;
   std::atomic<uint32_t> m_nodeHeight;
   std::atomic<uint32_t> m_networkHeight;
+  bool m_longPollSupported;
 
   //protect it with mutex if decided to add worker threads
   Crypto::Hash m_lastKnowHash;
   std::atomic<uint64_t> m_lastLocalBlockTimestamp;
   std::unordered_set<Crypto::Hash> m_knownTxs;
 
+  // latency histograms by RPC call, only touched from the dispatcher thread
+  std::unordered_map<std::string, Common::MetricHistogram*> m_callLatency;
+
+  DecoyOutputsCache m_decoyCache;
+  bool m_decoyCacheRefilling = false;
+
   bool m_connected;
 };
 
@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <unordered_map>
 
 #include <boost/foreach.hpp>
 #include <boost/uuid/random_generator.hpp>
@@ -51,6 +52,7 @@
 #include <System/TcpConnector.h>
  
 #include "version.h"
+#include "Common/Metrics.h"
 #include "Common/StdInputStream.h"
 #include "Common/StdOutputStream.h"
 #include "Common/Util.h"
@@ -59,6 +61,7 @@
 #include "ConnectionContext.h"
 #include "LevinProtocol.h"
 #include "P2pProtocolDefinitions.h"
+#include "P2pShard.h"
 
 #include "Serialization/BinaryInputStreamSerializer.h"
 #include "Serialization/BinaryOutputStreamSerializer.h"
@@ -117,6 +120,37 @@ bool parse_peer_from_string(NetworkAddress& pe, const std::string& node_addr) {
   return Common::parseIpAddressAndPort(pe.ip, pe.port, node_addr);
 }
 
+struct CommandMetrics {
+  MetricCounter* messages;
+  MetricCounter* bytes;
+};
+
+// Called by connectionHandler on reads and by writeHandler on writes. Shards run writeHandler for their own
+// sockets on their own threads, so the series are cached per thread and looked up in the registry once there.
+void countMessage(bool received, uint32_t command, size_t size) {
+  thread_local std::unordered_map<uint64_t, CommandMetrics> cache;
+
+  uint64_t key = (static_cast<uint64_t>(command) << 1) | (received ? 1 : 0);
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    std::string labels = "command=\"" + std::to_string(command) + "\"";
+    auto& registry = MetricsRegistry::instance();
+    CommandMetrics metrics;
+    if (received) {
+      metrics.messages = &registry.counter("dynex_p2p_received_messages_total", "P2P messages received by command", labels);
+      metrics.bytes = &registry.counter("dynex_p2p_received_bytes_total", "P2P payload bytes received by command", labels);
+    } else {
+      metrics.messages = &registry.counter("dynex_p2p_sent_messages_total", "P2P messages sent by command", labels);
+      metrics.bytes = &registry.counter("dynex_p2p_sent_bytes_total", "P2P payload bytes sent by command", labels);
+    }
+
+    it = cache.emplace(key, metrics).first;
+  }
+
+  it->second.messages->add();
+  it->second.bytes->add(size);
+}
+
 }
 
 
@@ -153,6 +187,11 @@ namespace CryptoNote
   //-----------------------------------------------------------------------------------
 
   bool P2pConnectionContext::pushMessage(P2pMessage&& msg) {
+    if (shard != nullptr) {
+      shard->send(std::vector<boost::uuids::uuid>(1, m_connection_id), msg.type, msg.command, msg.buffer, msg.returnCode);
+      return true;
+    }
+
     writeQueueSize += msg.size();
 
     if (writeQueueSize > P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE) {
@@ -191,6 +230,56 @@ namespace CryptoNote
     stopped = true;
     queueEvent.set();
     context->interrupt();
+    if (shard != nullptr) {
+      shard->closeConnection(m_connection_id);
+    }
+  }
+
+  bool P2pConnectionContext::pushCommand(LevinProtocol::Command&& cmd) {
+    // a single command up to the packet size limit is always taken
+    if (!readQueue.empty() && readQueueSize + cmd.buf.size() > P2P_CONNECTION_MAX_WRITE_BUFFER_SIZE) {
+      logger(DEBUGGING) << *this << "Read queue overflows. Stop connection";
+      stopped = true;
+      queueEvent.set();
+      shard->closeConnection(m_connection_id);
+      return false;
+    }
+
+    readQueueSize += cmd.buf.size();
+    readQueue.push_back(std::move(cmd));
+    queueEvent.set();
+    return true;
+  }
+
+  bool P2pConnectionContext::popCommand(LevinProtocol::Command& cmd) {
+    while (readQueue.empty() && !released && !stopped) {
+      queueEvent.clear();
+      queueEvent.wait();
+    }
+
+    if (readQueue.empty() || stopped) {
+      return false;
+    }
+
+    cmd = std::move(readQueue.front());
+    readQueue.pop_front();
+    readQueueSize -= cmd.buf.size();
+    return true;
+  }
+
+  void P2pConnectionContext::release() {
+    released = true;
+    queueEvent.set();
+  }
+
+  void P2pConnectionContext::waitRelease() {
+    while (!released) {
+      queueEvent.clear();
+      try {
+        queueEvent.wait();
+      } catch (System::InterruptedException&) {
+      }
+    }
   }
 
 
@@ -225,12 +314,18 @@ namespace CryptoNote
     m_timedSyncTimer(m_dispatcher),
     m_timeoutTimer(m_dispatcher),
     m_stop(false),
+    m_shardCount(0),
+    m_shardEvents(new P2pShardQueue<P2pShardEvent>(dispatcher, std::bind(&NodeServer::handleShardEvent, this, std::placeholders::_1))),
     // intervals
     // m_peer_handshake_idle_maker_interval(CryptoNote::P2P_DEFAULT_HANDSHAKE_INTERVAL),
     m_connections_maker_interval(1),
     m_peerlist_store_interval(60*30, false) {
   }
 
+  NodeServer::~NodeServer() {
+    stopShards();
+  }
+
   void NodeServer::serialize(ISerializer& s) {
     uint8_t version = 1;
     s(version, "version");
@@ -415,6 +510,7 @@ namespace CryptoNote
     std::copy(seedNodes.begin(), seedNodes.end(), std::back_inserter(m_seed_nodes));
 
     m_hide_my_port = config.getHideMyPort();
+    m_shardCount = config.getShardCount();
     return true;
   }
 
@@ -489,7 +585,10 @@ namespace CryptoNote
     logger(INFO) << "Binding on " << m_bind_ip << ":" << m_port;
     m_listeningPort = Common::fromString<uint16_t>(m_port);
 
-    m_listener = System::TcpListener(m_dispatcher, System::Ipv4Address(m_bind_ip), static_cast<uint16_t>(m_listeningPort));
+    startShards();
+    if (m_shards.empty()) {
+      m_listener = System::TcpListener(m_dispatcher, System::Ipv4Address(m_bind_ip), static_cast<uint16_t>(m_listeningPort));
+    }
 
     logger(INFO, BRIGHT_GREEN) << "Net service binded on " << m_bind_ip << ":" << m_listeningPort;
 
@@ -511,7 +610,10 @@ namespace CryptoNote
   bool NodeServer::run() {
     logger(INFO) << "Starting node_server";
 
-    m_workingContextGroup.spawn(std::bind(&NodeServer::acceptLoop, this));
+    if (m_shards.empty()) {
+      m_workingContextGroup.spawn(std::bind(&NodeServer::acceptLoop, this));
+    }
+
     m_workingContextGroup.spawn(std::bind(&NodeServer::onIdle, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timedSyncLoop, this));
     m_workingContextGroup.spawn(std::bind(&NodeServer::timeoutLoop, this));
@@ -521,6 +623,7 @@ namespace CryptoNote
     logger(INFO) << "Stopping NodeServer and it's" << m_connections.size() << " connections...";
     m_workingContextGroup.interrupt();
     m_workingContextGroup.wait();
+    stopShards();
 
     logger(INFO) << "NodeServer loop stopped";
     return true;
@@ -630,12 +733,10 @@ namespace CryptoNote
     m_payload_handler.get_payload_sync_data(arg.payload_data);
     auto cmdBuf = LevinProtocol::encode<COMMAND_TIMED_SYNC::request>(arg);
 
-    forEachConnection([&](P2pConnectionContext& conn) {
-      if (conn.peerId && 
-          (conn.m_state == CryptoNoteConnectionContext::state_normal || 
-           conn.m_state == CryptoNoteConnectionContext::state_idle)) {
-        conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
-      }
+    pushMessageToConnections(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf, [](const P2pConnectionContext& conn) {
+      return conn.peerId &&
+          (conn.m_state == CryptoNoteConnectionContext::state_normal ||
+           conn.m_state == CryptoNoteConnectionContext::state_idle);
     });
 
     return true;
@@ -680,6 +781,24 @@ namespace CryptoNote
     }
   }
 
+  void NodeServer::pushMessageToConnections(P2pMessage::Type type, uint32_t command, const BinaryArray& buffer, std::function<bool(const P2pConnectionContext&)> filter) {
+    // connections of a shard get the message with a single request to it
+    std::unordered_map<P2pShard*, std::vector<boost::uuids::uuid>> shardConnections;
+    forEachConnection([&](P2pConnectionContext& conn) {
+      if (filter(conn)) {
+        if (conn.shard != nullptr) {
+          shardConnections[conn.shard].push_back(conn.m_connection_id);
+        } else {
+          conn.pushMessage(P2pMessage(type, command, buffer));
+        }
+      }
+    });
+
+    for (auto& shardConnection : shardConnections) {
+      shardConnection.first->send(std::move(shardConnection.second), type, command, buffer);
+    }
+  }
+
   //----------------------------------------------------------------------------------- 
   bool NodeServer::is_peer_used(const PeerlistEntry& peer) {
     if(m_config.m_peer_id == peer.id)
@@ -1065,12 +1184,10 @@ namespace CryptoNote
   void NodeServer::relay_notify_to_all(int command, const BinaryArray& data_buff, const net_connection_id* excludeConnection) {
     net_connection_id excludeId = excludeConnection ? *excludeConnection : boost::value_initialized<net_connection_id>();
 
-    forEachConnection([&](P2pConnectionContext& conn) {
-      if (conn.peerId && conn.m_connection_id != excludeId &&
+    pushMessageToConnections(P2pMessage::NOTIFY, command, data_buff, [&](const P2pConnectionContext& conn) {
+      return conn.peerId && conn.m_connection_id != excludeId &&
           (conn.m_state == CryptoNoteConnectionContext::state_normal ||
-           conn.m_state == CryptoNoteConnectionContext::state_synchronizing)) {
-        conn.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, data_buff));
-      }
+           conn.m_state == CryptoNoteConnectionContext::state_synchronizing);
     });
   }
  
@@ -1294,6 +1411,77 @@ namespace CryptoNote
     return true;
   }
 
+  void NodeServer::startShards() {
+    try {
+      for (uint32_t i = 0; i < m_shardCount; ++i) {
+        std::unique_ptr<P2pShard> shard(new P2pShard(*this, logger.getLogger()));
+        shard->start(m_bind_ip, static_cast<uint16_t>(m_listeningPort));
+        m_shards.push_back(std::move(shard));
+      }
+    } catch (const std::exception& e) {
+      logger(WARNING) << "Failed to start p2p shards, connections are handled on the main thread: " << e.what();
+      stopShards();
+      return;
+    }
+
+    if (!m_shards.empty()) {
+      logger(INFO) << "Incoming connections are handled by " << m_shards.size() << " p2p shards";
+    }
+  }
+
+  void NodeServer::stopShards() {
+    for (auto& shard : m_shards) {
+      shard->stop();
+    }
+
+    // events the shards sent while stopping still wait for this dispatcher and point to the shards
+    while (m_shardEvents->isDrainScheduled()) {
+      m_dispatcher.yield();
+    }
+
+    m_shards.clear();
+  }
+
+  void NodeServer::pushShardEvent(P2pShardEvent&& event) {
+    m_shardEvents->push(std::move(event));
+  }
+
+  void NodeServer::handleShardEvent(P2pShardEvent& event) {
+    if (event.type == P2pShardEvent::CONNECTION_OPENED) {
+      if (m_stop || !event.shard->isRunning()) {
+        event.shard->closeConnection(event.connectionId);
+        return;
+      }
+
+      P2pConnectionContext ctx(m_dispatcher, logger.getLogger(), System::TcpConnection());
+      ctx.shard = event.shard;
+      ctx.m_connection_id = event.connectionId;
+      ctx.m_is_income = true;
+      ctx.m_started = event.started;
+      ctx.m_remote_ip = event.remoteIp;
+      ctx.m_remote_port = event.remotePort;
+
+      auto iter = m_connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
+      const boost::uuids::uuid& connectionId = iter->first;
+      P2pConnectionContext& connection = iter->second;
+
+      m_workingContextGroup.spawn(std::bind(&NodeServer::connectionHandler, this, std::cref(connectionId), std::ref(connection)));
+      return;
+    }
+
+    auto it = m_connections.find(event.connectionId);
+    if (it == m_connections.end()) {
+      return;
+    }
+
+    if (event.type == P2pShardEvent::COMMAND) {
+      it->second.pushCommand(std::move(event.command));
+    } else {
+      assert(event.type == P2pShardEvent::CONNECTION_CLOSED);
+      it->second.release();
+    }
+  }
+
   void NodeServer::acceptLoop() {
     for (;;) {
       try {
@@ -1379,7 +1567,11 @@ namespace CryptoNote
   void NodeServer::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
     // This inner context is necessary in order to stop connection handler at any moment
     System::Context<> context(m_dispatcher, [this, &connectionId, &ctx] {
-      System::Context<> writeContext(m_dispatcher, std::bind(&NodeServer::writeHandler, this, std::ref(ctx)));
+      // the shard of a connection does its reads and writes, here commands come from its queue
+      std::unique_ptr<System::Context<>> writeContext;
+      if (ctx.shard == nullptr) {
+        writeContext.reset(new System::Context<>(m_dispatcher, std::bind(&NodeServer::writeHandler, this, std::ref(ctx))));
+      }
 
       try {
         on_connection_new(ctx);
@@ -1396,10 +1588,12 @@ namespace CryptoNote
             m_payload_handler.requestMissingPoolTransactions(ctx);
           }
 
-          if (!proto.readCommand(cmd)) {
+          if (!(ctx.shard == nullptr ? proto.readCommand(cmd) : ctx.popCommand(cmd))) {
             break;
           }
 
+          countMessage(true, cmd.command, cmd.buf.size());
+
           BinaryArray response;
           bool handled = false;
           auto retcode = handleCommand(cmd, response, ctx, handled);
@@ -1425,8 +1619,12 @@ namespace CryptoNote
       }
 
       ctx.interrupt();
-      writeContext.interrupt();
-      writeContext.get();
+      if (writeContext) {
+        writeContext->interrupt();
+        writeContext->get();
+      } else {
+        ctx.waitRelease();
+      }
 
       on_connection_close(ctx);
       m_connections.erase(connectionId);
@@ -1455,6 +1653,7 @@ namespace CryptoNote
 
         for (const auto& msg : msgs) {
           logger(DEBUGGING) << ctx << "msg " << msg.type << ':' << msg.command;
+          countMessage(false, msg.command, msg.buffer.size());
           switch (msg.type) {
           case P2pMessage::COMMAND:
             proto.sendMessage(msg.command, msg.buffer, true);
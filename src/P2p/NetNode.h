@@ -30,7 +30,9 @@
 
 #pragma once
 
+#include <deque>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -64,6 +66,9 @@ namespace CryptoNote
 {
   class LevinProtocol;
   class ISerializer;
+  class P2pShard;
+  struct P2pShardEvent;
+  template <typename T> class P2pShardQueue;
 
   struct P2pMessage {
     enum Type {
@@ -98,11 +103,14 @@ namespace CryptoNote
     System::Context<void>* context;
     PeerIdType peerId;
     System::TcpConnection connection;
+    // Shard reading and writing the connection, nullptr when the connection belongs to the NodeServer dispatcher
+    P2pShard* shard;
 
     P2pConnectionContext(System::Dispatcher& dispatcher, Logging::ILogger& log, System::TcpConnection&& conn) :
       context(nullptr),
       peerId(0),
       connection(std::move(conn)),
+      shard(nullptr),
       logger(log, "node_server"),
       queueEvent(dispatcher),
       stopped(false) {
@@ -113,6 +121,7 @@ namespace CryptoNote
       context(ctx.context),
       peerId(ctx.peerId),
       connection(std::move(ctx.connection)),
+      shard(ctx.shard),
       logger(ctx.logger.getLogger(), "node_server"),
       queueEvent(std::move(ctx.queueEvent)),
       stopped(std::move(ctx.stopped)) {
@@ -122,6 +131,13 @@ namespace CryptoNote
     std::vector<P2pMessage> popBuffer();
     void interrupt();
 
+    // Commands the shard has read, popped by the connection handler on the NodeServer dispatcher
+    bool pushCommand(LevinProtocol::Command&& cmd);
+    bool popCommand(LevinProtocol::Command& cmd);
+    // The shard has closed the connection and sends nothing more for it
+    void release();
+    void waitRelease();
+
     uint64_t writeDuration(TimePoint now) const;
 
   private:
@@ -130,6 +146,9 @@ namespace CryptoNote
     System::Event queueEvent;
     std::vector<P2pMessage> writeQueue;
     size_t writeQueueSize = 0;
+    std::deque<LevinProtocol::Command> readQueue;
+    size_t readQueueSize = 0;
+    bool released = false;
     bool stopped;
   };
 
@@ -140,6 +159,7 @@ namespace CryptoNote
     static void init_options(boost::program_options::options_description& desc);
 
     NodeServer(System::Dispatcher& dispatcher, CryptoNote::CryptoNoteProtocolHandler& payload_handler, Logging::ILogger& log);
+    ~NodeServer();
 
     bool run();
     bool init(const NetNodeConfig& config);
@@ -159,6 +179,7 @@ namespace CryptoNote
     CryptoNote::PeerlistManager& getPeerlistManager() { return m_peerlist; }
 
   private:
+    friend class P2pShard;
 
     int handleCommand(const LevinProtocol::Command& cmd, BinaryArray& buff_out, P2pConnectionContext& context, bool& handled);
 
@@ -182,6 +203,7 @@ namespace CryptoNote
     bool timedSync();
     bool handleTimedSyncResponse(const BinaryArray& in, P2pConnectionContext& context);
     void forEachConnection(std::function<void(P2pConnectionContext&)> action);
+    void pushMessageToConnections(P2pMessage::Type type, uint32_t command, const BinaryArray& buffer, std::function<bool(const P2pConnectionContext&)> filter);
 
     void on_connection_new(P2pConnectionContext& context);
     void on_connection_close(P2pConnectionContext& context);
@@ -224,6 +246,12 @@ namespace CryptoNote
     typedef ConnectionContainer::iterator ConnectionIterator;
     ConnectionContainer m_connections;
 
+    void startShards();
+    void stopShards();
+    // Called from shard threads
+    void pushShardEvent(P2pShardEvent&& event);
+    void handleShardEvent(P2pShardEvent& event);
+
     void acceptLoop();
     void connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& connection);
     void writeHandler(P2pConnectionContext& ctx);
@@ -262,6 +290,9 @@ namespace CryptoNote
     System::TcpListener m_listener;
     Logging::LoggerRef logger;
     std::atomic<bool> m_stop;
+    uint32_t m_shardCount;
+    std::vector<std::unique_ptr<P2pShard>> m_shards;
+    std::unique_ptr<P2pShardQueue<P2pShardEvent>> m_shardEvents;
 
     CryptoNoteProtocolHandler& m_payload_handler;
     PeerlistManager m_peerlist;
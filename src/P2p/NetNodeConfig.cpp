@@ -51,6 +51,7 @@ const command_line::arg_descriptor<std::vector<std::string> > arg_p2p_add_exclus
       " If this option is given the options add-priority-node and seed-node are ignored"};
 const command_line::arg_descriptor<std::vector<std::string> > arg_p2p_seed_node   = {"seed-node", "Connect to a node to retrieve peer addresses, and disconnect"};
 const command_line::arg_descriptor<bool> arg_p2p_hide_my_port   =    {"hide-my-port", "Do not announce yourself as peerlist candidate", false, true};
+const command_line::arg_descriptor<uint32_t> arg_p2p_shards   =    {"p2p-shards", "Number of threads reading and writing incoming p2p connections, 0 handles them on the main thread", 0};
 
 bool parsePeerFromString(NetworkAddress& pe, const std::string& node_addr) {
   return Common::parseIpAddressAndPort(pe.ip, pe.port, node_addr);
@@ -84,6 +85,7 @@ void NetNodeConfig::initOptions(boost::program_options::options_description& des
   command_line::add_arg(desc, arg_p2p_add_exclusive_node);
   command_line::add_arg(desc, arg_p2p_seed_node);
   command_line::add_arg(desc, arg_p2p_hide_my_port);
+  command_line::add_arg(desc, arg_p2p_shards);
 }
 
 NetNodeConfig::NetNodeConfig() {
@@ -94,6 +96,7 @@ NetNodeConfig::NetNodeConfig() {
   hideMyPort = false;
   configFolder = Tools::getDefaultDataDirectory();
   testnet = false;
+  shardCount = 0;
 }
 
 bool NetNodeConfig::init(const boost::program_options::variables_map& vm)
@@ -152,6 +155,10 @@ bool NetNodeConfig::init(const boost::program_options::variables_map& vm)
     hideMyPort = true;
   }
 
+  if (vm.count(arg_p2p_shards.name) != 0 && (!vm[arg_p2p_shards.name].defaulted() || shardCount == 0)) {
+    shardCount = command_line::get_arg(vm, arg_p2p_shards);
+  }
+
   return true;
 }
 
@@ -211,6 +218,10 @@ std::string NetNodeConfig::getConfigFolder() const {
   return configFolder;
 }
 
+uint32_t NetNodeConfig::getShardCount() const {
+  return shardCount;
+}
+
 void NetNodeConfig::setP2pStateFilename(const std::string& filename) {
   p2pStateFilename = filename;
 }
@@ -255,5 +266,9 @@ void NetNodeConfig::setConfigFolder(const std::string& folder) {
   configFolder = folder;
 }
 
+void NetNodeConfig::setShardCount(uint32_t count) {
+  shardCount = count;
+}
+
 
 } //namespace nodetool
@@ -57,6 +57,7 @@ public:
   std::vector<NetworkAddress> getSeedNodes() const;
   bool getHideMyPort() const;
   std::string getConfigFolder() const;
+  uint32_t getShardCount() const;
 
   void setP2pStateFilename(const std::string& filename);
   void setTestnet(bool isTestnet);
@@ -70,6 +71,7 @@ public:
   void setSeedNodes(const std::vector<NetworkAddress>& addresses);
   void setHideMyPort(bool hide);
   void setConfigFolder(const std::string& folder);
+  void setShardCount(uint32_t count);
 
 private:
   std::string bindIp;
@@ -84,6 +86,7 @@ private:
   std::string configFolder;
   std::string p2pStateFilename;
   bool testnet;
+  uint32_t shardCount;
 };
 
 } //namespace nodetool
@@ -464,7 +464,8 @@ std::list<PeerlistEntry> P2pNode::getLocalPeerList() const {
 basic_node_data P2pNode::getNodeData() const {
   basic_node_data nodeData;
   nodeData.network_id = m_cfg.getNetworkId();
-  nodeData.version = P2PProtocolVersion::CURRENT;
+  // P2pNode has no compact block handlers, so it must not advertise V2
+  nodeData.version = P2PProtocolVersion::V1;
   nodeData.local_time = time(nullptr);
   nodeData.peer_id = m_myPeerId;
 
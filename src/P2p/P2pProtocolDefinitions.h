@@ -68,7 +68,8 @@ namespace CryptoNote
   enum P2PProtocolVersion : uint8_t {
     V0 = 0,
     V1 = 1,
-    CURRENT = V1
+    V2 = 2, // compact block relay
+    CURRENT = V2
   };
 
   struct basic_node_data
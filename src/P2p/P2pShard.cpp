@@ -0,0 +1,303 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "P2pShard.h"
+
+#include <cassert>
+
+#include <boost/uuid/random_generator.hpp>
+
+#include <System/Context.h>
+#include <System/InterruptedException.h>
+#include <System/Ipv4Address.h>
+#include <System/Timer.h>
+
+#include "Common/ScopeExit.h"
+
+using namespace Logging;
+
+namespace CryptoNote {
+
+P2pShard::P2pShard(NodeServer& server, Logging::ILogger& log) :
+  server(server),
+  logger(log, "node_server"),
+  dispatcher(nullptr),
+  workingContextGroup(nullptr),
+  stopEvent(nullptr),
+  requests(nullptr) {
+}
+
+P2pShard::~P2pShard() {
+  stop();
+}
+
+void P2pShard::start(const std::string& bindIp, uint16_t port) {
+  assert(!thread.joinable());
+  std::promise<void> started;
+  std::future<void> startedFuture = started.get_future();
+  thread = std::thread(std::bind(&P2pShard::threadProcedure, this, bindIp, port, std::ref(started)));
+  try {
+    startedFuture.get();
+  } catch (...) {
+    thread.join();
+    throw;
+  }
+}
+
+void P2pShard::stop() {
+  if (thread.joinable()) {
+    {
+      // the thread may have already exited on an error
+      std::lock_guard<std::mutex> lock(requestsMutex);
+      if (requests != nullptr) {
+        P2pShardRequest request;
+        request.type = P2pShardRequest::STOP;
+        requests->push(std::move(request));
+      }
+    }
+
+    thread.join();
+  }
+}
+
+bool P2pShard::isRunning() const {
+  std::lock_guard<std::mutex> lock(requestsMutex);
+  return requests != nullptr;
+}
+
+void P2pShard::send(std::vector<boost::uuids::uuid>&& connectionIds, P2pMessage::Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode) {
+  std::lock_guard<std::mutex> lock(requestsMutex);
+  if (requests != nullptr) {
+    P2pShardRequest request;
+    request.type = P2pShardRequest::SEND;
+    request.connectionIds = std::move(connectionIds);
+    request.messageType = type;
+    request.command = command;
+    request.buffer = buffer;
+    request.returnCode = returnCode;
+    requests->push(std::move(request));
+  }
+}
+
+void P2pShard::closeConnection(const boost::uuids::uuid& connectionId) {
+  std::lock_guard<std::mutex> lock(requestsMutex);
+  if (requests != nullptr) {
+    P2pShardRequest request;
+    request.type = P2pShardRequest::CLOSE;
+    request.connectionIds.push_back(connectionId);
+    requests->push(std::move(request));
+  }
+}
+
+void P2pShard::threadProcedure(const std::string& bindIp, uint16_t port, std::promise<void>& started) {
+  bool running = false;
+  try {
+    System::Dispatcher localDispatcher;
+    System::TcpListener listener(localDispatcher, System::Ipv4Address(bindIp), port, true);
+    System::ContextGroup contextGroup(localDispatcher);
+    System::Event localStopEvent(localDispatcher);
+    P2pShardQueue<P2pShardRequest> localRequests(localDispatcher, std::bind(&P2pShard::handleRequest, this, std::placeholders::_1));
+    {
+      std::lock_guard<std::mutex> lock(requestsMutex);
+      dispatcher = &localDispatcher;
+      workingContextGroup = &contextGroup;
+      stopEvent = &localStopEvent;
+      requests = &localRequests;
+    }
+
+    // runs before the locals above are destroyed, on an exception as well, so nothing points at them afterwards
+    Tools::ScopeExit clearPointers([this] {
+      std::lock_guard<std::mutex> lock(requestsMutex);
+      dispatcher = nullptr;
+      workingContextGroup = nullptr;
+      stopEvent = nullptr;
+      requests = nullptr;
+    });
+
+    running = true;
+    started.set_value();
+
+    // a failure while running still goes through the shutdown below, a drain left scheduled would outlive localRequests
+    try {
+      contextGroup.spawn(std::bind(&P2pShard::acceptLoop, this, std::ref(listener)));
+      contextGroup.spawn(std::bind(&P2pShard::timeoutLoop, this));
+      localStopEvent.wait();
+    } catch (std::exception& e) {
+      logger(ERROR) << "Exception in p2p shard: " << e.what();
+    }
+
+    {
+      // requests pushed from now on are dropped, so the drain loop below terminates
+      std::lock_guard<std::mutex> lock(requestsMutex);
+      requests = nullptr;
+    }
+
+    contextGroup.interrupt();
+    contextGroup.wait();
+    while (localRequests.isDrainScheduled()) {
+      localDispatcher.yield();
+    }
+
+    assert(connections.empty());
+  } catch (std::exception& e) {
+    if (!running) {
+      started.set_exception(std::current_exception());
+    } else {
+      logger(ERROR) << "Exception in p2p shard: " << e.what();
+    }
+  }
+}
+
+void P2pShard::handleRequest(P2pShardRequest& request) {
+  switch (request.type) {
+  case P2pShardRequest::SEND:
+    for (const auto& connectionId : request.connectionIds) {
+      auto it = connections.find(connectionId);
+      if (it != connections.end()) {
+        it->second.pushMessage(P2pMessage(request.messageType, request.command, request.buffer, request.returnCode));
+      }
+    }
+
+    break;
+  case P2pShardRequest::CLOSE: {
+    auto it = connections.find(request.connectionIds.front());
+    if (it != connections.end()) {
+      it->second.interrupt();
+    }
+
+    break;
+  }
+  case P2pShardRequest::STOP:
+    stopEvent->set();
+    break;
+  }
+}
+
+void P2pShard::acceptLoop(System::TcpListener& listener) {
+  for (;;) {
+    try {
+      P2pConnectionContext ctx(*dispatcher, logger.getLogger(), listener.accept());
+      ctx.m_connection_id = boost::uuids::random_generator()();
+      ctx.m_is_income = true;
+      ctx.m_started = time(nullptr);
+
+      auto addressAndPort = ctx.connection.getPeerAddressAndPort();
+      ctx.m_remote_ip = hostToNetwork(addressAndPort.first.getValue());
+      ctx.m_remote_port = addressAndPort.second;
+
+      auto iter = connections.emplace(ctx.m_connection_id, std::move(ctx)).first;
+      const boost::uuids::uuid& connectionId = iter->first;
+      P2pConnectionContext& connection = iter->second;
+
+      workingContextGroup->spawn(std::bind(&P2pShard::connectionHandler, this, std::cref(connectionId), std::ref(connection)));
+    } catch (System::InterruptedException&) {
+      logger(DEBUGGING) << "Shard acceptLoop() is interrupted";
+      break;
+    } catch (const std::exception& e) {
+      logger(WARNING) << "Exception in shard acceptLoop: " << e.what();
+    }
+  }
+}
+
+void P2pShard::timeoutLoop() {
+  try {
+    System::Timer timer(*dispatcher);
+    for (;;) {
+      timer.sleep(std::chrono::seconds(10));
+      auto now = P2pConnectionContext::Clock::now();
+
+      for (auto& kv : connections) {
+        auto& ctx = kv.second;
+        if (ctx.writeDuration(now) > P2P_DEFAULT_INVOKE_TIMEOUT) {
+          logger(WARNING) << ctx << "write operation timed out, stopping connection";
+          ctx.interrupt();
+        }
+      }
+    }
+  } catch (System::InterruptedException&) {
+    logger(DEBUGGING) << "Shard timeoutLoop() is interrupted";
+  } catch (std::exception& e) {
+    logger(WARNING) << "Exception in shard timeoutLoop: " << e.what();
+  }
+}
+
+void P2pShard::connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx) {
+  System::Context<> context(*dispatcher, [this, &connectionId, &ctx] {
+    System::Context<> writeContext(*dispatcher, std::bind(&NodeServer::writeHandler, &server, std::ref(ctx)));
+
+    // one connection goes through the event queue in order: opened, its commands, closed
+    pushEvent(P2pShardEvent::CONNECTION_OPENED, ctx);
+    try {
+      LevinProtocol proto(ctx.connection);
+      for (;;) {
+        P2pShardEvent event;
+        event.type = P2pShardEvent::COMMAND;
+        event.shard = this;
+        event.connectionId = connectionId;
+        if (!proto.readCommand(event.command)) {
+          break;
+        }
+
+        server.pushShardEvent(std::move(event));
+      }
+    } catch (System::InterruptedException&) {
+      logger(DEBUGGING) << ctx << "Shard connectionHandler() inner context is interrupted";
+    } catch (std::exception& e) {
+      logger(WARNING) << ctx << "Exception in shard connectionHandler: " << e.what();
+    }
+
+    ctx.interrupt();
+    writeContext.interrupt();
+    writeContext.get();
+
+    pushEvent(P2pShardEvent::CONNECTION_CLOSED, ctx);
+    connections.erase(connectionId);
+  });
+
+  ctx.context = &context;
+
+  try {
+    context.get();
+  } catch (System::InterruptedException&) {
+    logger(DEBUGGING) << "Shard connectionHandler() is interrupted";
+  }
+}
+
+void P2pShard::pushEvent(P2pShardEvent::Type type, const P2pConnectionContext& ctx) {
+  P2pShardEvent event;
+  event.type = type;
+  event.shard = this;
+  event.connectionId = ctx.m_connection_id;
+  event.remoteIp = ctx.m_remote_ip;
+  event.remotePort = ctx.m_remote_port;
+  event.started = ctx.m_started;
+  server.pushShardEvent(std::move(event));
+}
+
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include <Common/MpscQueue.h>
+#include <System/ContextGroup.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+#include <System/TcpListener.h>
+
+#include "Logging/LoggerRef.h"
+#include "NetNode.h"
+
+namespace CryptoNote {
+
+// Hands items produced on other threads to a dispatcher. Producers push to a lock-free queue and wake the dispatcher
+// through remoteSpawn only when it is not draining the queue already, so a burst of items costs one wakeup.
+template <typename T>
+class P2pShardQueue {
+public:
+  P2pShardQueue(System::Dispatcher& dispatcher, std::function<void(T&)>&& handler) :
+    dispatcher(dispatcher), handler(std::move(handler)), drainScheduled(false) {
+  }
+
+  P2pShardQueue(const P2pShardQueue&) = delete;
+  P2pShardQueue& operator=(const P2pShardQueue&) = delete;
+
+  void push(T&& item) {
+    items.push(std::move(item));
+    if (!drainScheduled.exchange(true)) {
+      dispatcher.remoteSpawn([this] {
+        drain();
+      });
+    }
+  }
+
+  // True while a drain is pending on the dispatcher, the queue must outlive it
+  bool isDrainScheduled() const {
+    return drainScheduled;
+  }
+
+private:
+  void drain() {
+    // cleared before popping, an item pushed after the last pop schedules another drain
+    drainScheduled = false;
+    T item;
+    while (items.pop(item)) {
+      handler(item);
+    }
+  }
+
+  System::Dispatcher& dispatcher;
+  std::function<void(T&)> handler;
+  Common::MpscQueue<T> items;
+  std::atomic<bool> drainScheduled;
+};
+
+// Sent by a shard to the NodeServer dispatcher
+struct P2pShardEvent {
+  enum Type {
+    CONNECTION_OPENED,
+    COMMAND,
+    CONNECTION_CLOSED
+  };
+
+  Type type;
+  P2pShard* shard;
+  boost::uuids::uuid connectionId;
+  uint32_t remoteIp;
+  uint32_t remotePort;
+  time_t started;
+  LevinProtocol::Command command;
+};
+
+// Sent by the NodeServer dispatcher to a shard
+struct P2pShardRequest {
+  enum Type {
+    SEND,
+    CLOSE,
+    STOP
+  };
+
+  Type type = SEND;
+  std::vector<boost::uuids::uuid> connectionIds;
+  P2pMessage::Type messageType = P2pMessage::COMMAND;
+  uint32_t command = 0;
+  BinaryArray buffer;
+  int32_t returnCode = 0;
+};
+
+// Thread with its own dispatcher accepting incoming p2p connections on a port shared with the other shards. The shard
+// reads and frames commands and writes queued messages, everything else is left to the NodeServer dispatcher, which
+// gets the commands through its event queue and sends replies and relays back with shard requests.
+class P2pShard {
+public:
+  P2pShard(NodeServer& server, Logging::ILogger& log);
+  P2pShard(const P2pShard&) = delete;
+  ~P2pShard();
+  P2pShard& operator=(const P2pShard&) = delete;
+
+  // Starts the thread once its listener is bound, throws when binding fails
+  void start(const std::string& bindIp, uint16_t port);
+  void stop();
+  bool isRunning() const;
+
+  // Called on the NodeServer dispatcher, requests to connections the shard has closed already are dropped
+  void send(std::vector<boost::uuids::uuid>&& connectionIds, P2pMessage::Type type, uint32_t command, const BinaryArray& buffer, int32_t returnCode = 0);
+  void closeConnection(const boost::uuids::uuid& connectionId);
+
+private:
+  void threadProcedure(const std::string& bindIp, uint16_t port, std::promise<void>& started);
+  void handleRequest(P2pShardRequest& request);
+  void acceptLoop(System::TcpListener& listener);
+  void timeoutLoop();
+  void connectionHandler(const boost::uuids::uuid& connectionId, P2pConnectionContext& ctx);
+  void pushEvent(P2pShardEvent::Type type, const P2pConnectionContext& ctx);
+
+  NodeServer& server;
+  Logging::LoggerRef logger;
+  std::thread thread;
+  // owned by the shard thread, valid while it runs, cleared under requestsMutex before the thread destroys them
+  System::Dispatcher* dispatcher;
+  System::ContextGroup* workingContextGroup;
+  System::Event* stopEvent;
+  P2pShardQueue<P2pShardRequest>* requests;
+  mutable std::mutex requestsMutex;
+  std::unordered_map<boost::uuids::uuid, P2pConnectionContext, boost::hash<boost::uuids::uuid>> connections;
+};
+
+}
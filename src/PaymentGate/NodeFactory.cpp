@@ -129,8 +129,10 @@ NodeFactory::NodeFactory() {
 NodeFactory::~NodeFactory() {
 }
 
-CryptoNote::INode* NodeFactory::createNode(const std::string& daemonAddress, uint16_t daemonPort) {
-  std::unique_ptr<CryptoNote::INode> node(new CryptoNote::NodeRpcProxy(daemonAddress, daemonPort));
+CryptoNote::INode* NodeFactory::createNode(const std::string& daemonAddress, uint16_t daemonPort, size_t decoyCacheSize,
+  uint32_t decoyCacheMaxAge) {
+  std::unique_ptr<CryptoNote::NodeRpcProxy> node(new CryptoNote::NodeRpcProxy(daemonAddress, daemonPort));
+  node->setDecoyCacheLimits(decoyCacheSize, std::chrono::seconds(decoyCacheMaxAge));
 
   NodeInitObserver initObserver;
   node->init(std::bind(&NodeInitObserver::initCompleted, &initObserver, std::placeholders::_1));
@@ -38,7 +38,8 @@ namespace PaymentService {
 
 class NodeFactory {
 public:
-  static CryptoNote::INode* createNode(const std::string& daemonAddress, uint16_t daemonPort);
+  static CryptoNote::INode* createNode(const std::string& daemonAddress, uint16_t daemonPort, size_t decoyCacheSize = 0,
+    uint32_t decoyCacheMaxAge = 0);
   static CryptoNote::INode* createNodeStub();
 private:
   NodeFactory();
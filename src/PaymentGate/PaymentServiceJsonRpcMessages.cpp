@@ -244,6 +244,22 @@ void SendTransaction::Response::serialize(CryptoNote::ISerializer& serializer) {
   serializer(transactionHash, "transactionHash");
 }
 
+void SendTransactions::Request::serialize(CryptoNote::ISerializer& serializer) {
+  if (!serializer(transactions, "transactions")) {
+    throw RequestSerializationError();
+  }
+}
+
+void SendTransactions::TransactionResult::serialize(CryptoNote::ISerializer& serializer) {
+  serializer(transactionHash, "transactionHash");
+  serializer(errorCode, "errorCode");
+  serializer(errorMessage, "errorMessage");
+}
+
+void SendTransactions::Response::serialize(CryptoNote::ISerializer& serializer) {
+  serializer(transactions, "transactions");
+}
+
 void CreateDelayedTransaction::Request::serialize(CryptoNote::ISerializer& serializer) {
   serializer(addresses, "addresses");
 
@@ -298,6 +298,28 @@ struct SendTransaction {
   };
 };
 
+struct SendTransactions {
+  struct Request {
+    std::vector<SendTransaction::Request> transactions;
+
+    void serialize(CryptoNote::ISerializer& serializer);
+  };
+
+  struct TransactionResult {
+    std::string transactionHash;
+    int64_t errorCode = 0;
+    std::string errorMessage;
+
+    void serialize(CryptoNote::ISerializer& serializer);
+  };
+
+  struct Response {
+    std::vector<TransactionResult> transactions;
+
+    void serialize(CryptoNote::ISerializer& serializer);
+  };
+};
+
 struct CreateDelayedTransaction {
   struct Request {
     std::vector<std::string> addresses;
@@ -56,6 +56,7 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys
   handlers.emplace("getUnconfirmedTransactionHashes", jsonHandler<GetUnconfirmedTransactionHashes::Request, GetUnconfirmedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetUnconfirmedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getTransaction", jsonHandler<GetTransaction::Request, GetTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetTransaction, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("sendTransaction", jsonHandler<SendTransaction::Request, SendTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransaction, this, std::placeholders::_1, std::placeholders::_2)));
+  handlers.emplace("sendTransactions", jsonHandler<SendTransactions::Request, SendTransactions::Response>(std::bind(&PaymentServiceJsonRpcServer::handleSendTransactions, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("createDelayedTransaction", jsonHandler<CreateDelayedTransaction::Request, CreateDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleCreateDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getDelayedTransactionHashes", jsonHandler<GetDelayedTransactionHashes::Request, GetDelayedTransactionHashes::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetDelayedTransactionHashes, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("deleteDelayedTransaction", jsonHandler<DeleteDelayedTransaction::Request, DeleteDelayedTransaction::Response>(std::bind(&PaymentServiceJsonRpcServer::handleDeleteDelayedTransaction, this, std::placeholders::_1, std::placeholders::_2)));
@@ -63,6 +64,9 @@ PaymentServiceJsonRpcServer::PaymentServiceJsonRpcServer(System::Dispatcher& sys
   handlers.emplace("getViewKey", jsonHandler<GetViewKey::Request, GetViewKey::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetViewKey, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getStatus", jsonHandler<GetStatus::Request, GetStatus::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetStatus, this, std::placeholders::_1, std::placeholders::_2)));
   handlers.emplace("getAddresses", jsonHandler<GetAddresses::Request, GetAddresses::Response>(std::bind(&PaymentServiceJsonRpcServer::handleGetAddresses, this, std::placeholders::_1, std::placeholders::_2)));
+
+  readOnlyMethods = { "getSpendKeys", "getBalance", "getBlockHashes", "getTransactionHashes", "getTransactions",
+    "getUnconfirmedTransactionHashes", "getTransaction", "getDelayedTransactionHashes", "getViewKey", "getStatus", "getAddresses" };
 }
 
 void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) {
@@ -104,6 +108,18 @@ void PaymentServiceJsonRpcServer::processJsonRpcRequest(const Common::JsonValue&
   }
 }
 
+bool PaymentServiceJsonRpcServer::isReadOnlyRequest(const Common::JsonValue& req) const {
+  return req.contains("method") && req("method").isString() && readOnlyMethods.count(req("method").getString()) != 0;
+}
+
+void PaymentServiceJsonRpcServer::beginReadOnlyRequests() {
+  service.beginReadOnlyBatch();
+}
+
+void PaymentServiceJsonRpcServer::endReadOnlyRequests() {
+  service.endReadOnlyBatch();
+}
+
 std::error_code PaymentServiceJsonRpcServer::handleReset(const Reset::Request& request, Reset::Response& response) {
   if (request.viewSecretKey.empty()) {
     return service.resetWallet();
@@ -170,6 +186,10 @@ std::error_code PaymentServiceJsonRpcServer::handleSendTransaction(const SendTra
   return service.sendTransaction(request, response.transactionHash);
 }
 
+std::error_code PaymentServiceJsonRpcServer::handleSendTransactions(const SendTransactions::Request& request, SendTransactions::Response& response) {
+  return service.sendTransactions(request.transactions, response.transactions);
+}
+
 std::error_code PaymentServiceJsonRpcServer::handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response) {
   return service.createDelayedTransaction(request, response.transactionHash);
 }
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include "Common/JsonValue.h"
 #include "JsonRpcServer/JsonRpcServer.h"
@@ -49,6 +50,9 @@ public:
 
 protected:
   virtual void processJsonRpcRequest(const Common::JsonValue& req, Common::JsonValue& resp) override;
+  virtual bool isReadOnlyRequest(const Common::JsonValue& req) const override;
+  virtual void beginReadOnlyRequests() override;
+  virtual void endReadOnlyRequests() override;
 
 private:
   WalletService& service;
@@ -83,6 +87,7 @@ private:
   }
 
   std::unordered_map<std::string, HandlerFunction> handlers;
+  std::unordered_set<std::string> readOnlyMethods;
 
   std::error_code handleReset(const Reset::Request& request, Reset::Response& response);
   std::error_code handleCreateAddress(const CreateAddress::Request& request, CreateAddress::Response& response);
@@ -95,6 +100,7 @@ private:
   std::error_code handleGetUnconfirmedTransactionHashes(const GetUnconfirmedTransactionHashes::Request& request, GetUnconfirmedTransactionHashes::Response& response);
   std::error_code handleGetTransaction(const GetTransaction::Request& request, GetTransaction::Response& response);
   std::error_code handleSendTransaction(const SendTransaction::Request& request, SendTransaction::Response& response);
+  std::error_code handleSendTransactions(const SendTransactions::Request& request, SendTransactions::Response& response);
   std::error_code handleCreateDelayedTransaction(const CreateDelayedTransaction::Request& request, CreateDelayedTransaction::Response& response);
   std::error_code handleGetDelayedTransactionHashes(const GetDelayedTransactionHashes::Request& request, GetDelayedTransactionHashes::Response& response);
   std::error_code handleDeleteDelayedTransaction(const DeleteDelayedTransaction::Request& request, DeleteDelayedTransaction::Response& response);
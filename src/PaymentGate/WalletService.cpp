@@ -33,6 +33,7 @@
 
 #include <future>
 #include <assert.h>
+#include <memory>
 #include <sstream>
 #include <unordered_set>
 
@@ -152,6 +153,17 @@ struct TransactionsInBlockInfoFilter {
     return haveAddress;
   }
 
+  CryptoNote::TransactionsFilter toWalletFilter() const {
+    CryptoNote::TransactionsFilter filter;
+    filter.addresses.assign(addresses.begin(), addresses.end());
+    filter.hasPaymentId = havePaymentId;
+    if (havePaymentId) {
+      filter.paymentId = paymentId;
+    }
+
+    return filter;
+  }
+
   std::unordered_set<std::string> addresses;
   bool havePaymentId = false;
   Crypto::Hash paymentId;
@@ -347,6 +359,32 @@ std::vector<CryptoNote::WalletOrder> convertWalletRpcOrdersToWalletOrders(const
   return result;
 }
 
+CryptoNote::TransactionParameters makeTransactionParameters(const SendTransaction::Request& request, const CryptoNote::Currency& currency,
+  Logging::LoggerRef logger) {
+
+  validateAddresses(request.sourceAddresses, currency, logger);
+  validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
+  if (!request.changeAddress.empty()) {
+    validateAddresses({ request.changeAddress }, currency, logger);
+  }
+
+  CryptoNote::TransactionParameters sendParams;
+  if (!request.paymentId.empty()) {
+    addPaymentIdToExtra(request.paymentId, sendParams.extra);
+  } else {
+    sendParams.extra = Common::asString(Common::fromHex(request.extra));
+  }
+
+  sendParams.sourceAddresses = request.sourceAddresses;
+  sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
+  sendParams.fee = request.fee;
+  sendParams.mixIn = request.anonymity;
+  sendParams.unlockTimestamp = request.unlockTime;
+  sendParams.changeDestination = request.changeAddress;
+
+  return sendParams;
+}
+
 }
 
 void createWalletFile(std::fstream& walletFile, const std::string& filename) {
@@ -432,6 +470,7 @@ WalletService::WalletService(const CryptoNote::Currency& currency, System::Dispa
     node(node),
     config(conf),
     inited(false),
+    readOnlyBatchContext(nullptr),
     logger(logger, "WalletService"),
     dispatcher(sys),
     readyEvent(dispatcher),
@@ -448,6 +487,19 @@ WalletService::~WalletService() {
   }
 }
 
+class WalletService::ReadLock {
+public:
+  explicit ReadLock(WalletService& service) {
+    // only the context that opened the batch already holds the lock, any other one waits for it as usual
+    if (service.readOnlyBatchContext != service.dispatcher.getCurrentContext()) {
+      lock.reset(new System::EventLock(service.readyEvent));
+    }
+  }
+
+private:
+  std::unique_ptr<System::EventLock> lock;
+};
+
 void WalletService::init() {
   loadWallet();
   loadTransactionIdIndex();
@@ -484,6 +536,24 @@ void WalletService::loadTransactionIdIndex() {
   }
 }
 
+void WalletService::beginReadOnlyBatch() {
+  assert(readOnlyBatchContext == nullptr);
+
+  while (!readyEvent.get()) {
+    readyEvent.wait();
+  }
+
+  readyEvent.clear();
+  readOnlyBatchContext = dispatcher.getCurrentContext();
+}
+
+void WalletService::endReadOnlyBatch() {
+  assert(readOnlyBatchContext == dispatcher.getCurrentContext());
+
+  readOnlyBatchContext = nullptr;
+  readyEvent.set();
+}
+
 std::error_code WalletService::resetWallet() {
   try {
     System::EventLock lk(readyEvent);
@@ -616,7 +686,7 @@ std::error_code WalletService::deleteAddress(const std::string& address) {
 
 std::error_code WalletService::getSpendkeys(const std::string& address, std::string& publicSpendKeyText, std::string& secretSpendKeyText) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
 
     CryptoNote::KeyPair key = wallet.getAddressSpendKey(address);
 
@@ -633,7 +703,7 @@ std::error_code WalletService::getSpendkeys(const std::string& address, std::str
 
 std::error_code WalletService::getBalance(const std::string& address, uint64_t& availableBalance, uint64_t& lockedAmount) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     logger(Logging::DEBUGGING) << "Getting balance for address " << address;
 
     availableBalance = wallet.getActualBalance(address);
@@ -649,7 +719,7 @@ std::error_code WalletService::getBalance(const std::string& address, uint64_t&
 
 std::error_code WalletService::getBalance(uint64_t& availableBalance, uint64_t& lockedAmount) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     logger(Logging::DEBUGGING) << "Getting wallet balance";
 
     availableBalance = wallet.getActualBalance();
@@ -665,7 +735,7 @@ std::error_code WalletService::getBalance(uint64_t& availableBalance, uint64_t&
 
 std::error_code WalletService::getBlockHashes(uint32_t firstBlockIndex, uint32_t blockCount, std::vector<std::string>& blockHashes) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     std::vector<Crypto::Hash> hashes = wallet.getBlockHashes(firstBlockIndex, blockCount);
 
     blockHashes.reserve(hashes.size());
@@ -682,7 +752,7 @@ std::error_code WalletService::getBlockHashes(uint32_t firstBlockIndex, uint32_t
 
 std::error_code WalletService::getViewKey(std::string& viewSecretKey) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     CryptoNote::KeyPair viewKey = wallet.getViewKey();
     viewSecretKey = Common::podToHex(viewKey.secretKey);
   } catch (std::system_error& x) {
@@ -696,7 +766,7 @@ std::error_code WalletService::getViewKey(std::string& viewSecretKey) {
 std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, const std::string& blockHashString,
   uint32_t blockCount, const std::string& paymentId, std::vector<TransactionHashesInBlockRpcInfo>& transactionHashes) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     validateAddresses(addresses, currency, logger);
 
     if (!paymentId.empty()) {
@@ -721,7 +791,7 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
 std::error_code WalletService::getTransactionHashes(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
   uint32_t blockCount, const std::string& paymentId, std::vector<TransactionHashesInBlockRpcInfo>& transactionHashes) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     validateAddresses(addresses, currency, logger);
 
     if (!paymentId.empty()) {
@@ -745,7 +815,7 @@ std::error_code WalletService::getTransactionHashes(const std::vector<std::strin
 std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, const std::string& blockHashString,
   uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     validateAddresses(addresses, currency, logger);
 
     if (!paymentId.empty()) {
@@ -771,7 +841,7 @@ std::error_code WalletService::getTransactions(const std::vector<std::string>& a
 std::error_code WalletService::getTransactions(const std::vector<std::string>& addresses, uint32_t firstBlockIndex,
   uint32_t blockCount, const std::string& paymentId, std::vector<TransactionsInBlockRpcInfo>& transactions) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     validateAddresses(addresses, currency, logger);
 
     if (!paymentId.empty()) {
@@ -794,7 +864,7 @@ std::error_code WalletService::getTransactions(const std::vector<std::string>& a
 
 std::error_code WalletService::getTransaction(const std::string& transactionHash, TransactionRpcInfo& transaction) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
     Crypto::Hash hash = parseHash(transactionHash, logger);
 
     CryptoNote::WalletTransactionWithTransfers transactionWithTransfers = wallet.getTransaction(hash);
@@ -818,7 +888,7 @@ std::error_code WalletService::getTransaction(const std::string& transactionHash
 
 std::error_code WalletService::getAddresses(std::vector<std::string>& addresses) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
 
     addresses.clear();
     addresses.reserve(wallet.getAddressCount());
@@ -838,26 +908,7 @@ std::error_code WalletService::sendTransaction(const SendTransaction::Request& r
   try {
     System::EventLock lk(readyEvent);
 
-    validateAddresses(request.sourceAddresses, currency, logger);
-    validateAddresses(collectDestinationAddresses(request.transfers), currency, logger);
-    if (!request.changeAddress.empty()) {
-      validateAddresses({ request.changeAddress }, currency, logger);
-    }
-
-    CryptoNote::TransactionParameters sendParams;
-    if (!request.paymentId.empty()) {
-      addPaymentIdToExtra(request.paymentId, sendParams.extra);
-    } else {
-      sendParams.extra = Common::asString(Common::fromHex(request.extra));
-    }
-
-    sendParams.sourceAddresses = request.sourceAddresses;
-    sendParams.destinations = convertWalletRpcOrdersToWalletOrders(request.transfers);
-    sendParams.fee = request.fee;
-    sendParams.mixIn = request.anonymity;
-    sendParams.unlockTimestamp = request.unlockTime;
-    sendParams.changeDestination = request.changeAddress;
-
+    CryptoNote::TransactionParameters sendParams = makeTransactionParameters(request, currency, logger);
     size_t transactionId = wallet.transfer(sendParams);
     transactionHash = Common::podToHex(wallet.getTransaction(transactionId).hash);
 
@@ -873,6 +924,59 @@ std::error_code WalletService::sendTransaction(const SendTransaction::Request& r
   return std::error_code();
 }
 
+std::error_code WalletService::sendTransactions(const std::vector<SendTransaction::Request>& requests,
+  std::vector<SendTransactions::TransactionResult>& results) {
+
+  try {
+    System::EventLock lk(readyEvent);
+
+    if (config.maxSendTransactions != 0 && requests.size() > config.maxSendTransactions) {
+      logger(Logging::WARNING) << "Too many transactions in one request: " << requests.size() << ", maximum is " << config.maxSendTransactions;
+      throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::TOO_MANY_TRANSACTIONS));
+    }
+
+    results.assign(requests.size(), SendTransactions::TransactionResult());
+
+    //requests that fail validation get their error here, the rest go to the wallet as one batch
+    std::vector<CryptoNote::TransactionParameters> batch;
+    std::vector<size_t> batchIndexes;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      try {
+        batch.push_back(makeTransactionParameters(requests[i], currency, logger));
+        batchIndexes.push_back(i);
+      } catch (std::system_error& x) {
+        results[i].errorCode = x.code().value();
+        results[i].errorMessage = x.code().message();
+      } catch (std::exception& x) {
+        logger(Logging::WARNING) << "Error while preparing transaction: " << x.what();
+        results[i].errorCode = CryptoNote::error::INTERNAL_WALLET_ERROR;
+        results[i].errorMessage = make_error_code(CryptoNote::error::INTERNAL_WALLET_ERROR).message();
+      }
+    }
+
+    std::vector<CryptoNote::TransferBatchResult> batchResults = wallet.transferBatch(batch);
+    for (size_t i = 0; i < batchResults.size(); ++i) {
+      SendTransactions::TransactionResult& result = results[batchIndexes[i]];
+      if (batchResults[i].error) {
+        logger(Logging::WARNING) << "Error while sending transaction: " << batchResults[i].error.message();
+        result.errorCode = batchResults[i].error.value();
+        result.errorMessage = batchResults[i].error.message();
+      } else {
+        result.transactionHash = Common::podToHex(wallet.getTransaction(batchResults[i].transactionId).hash);
+        logger(Logging::DEBUGGING) << "Transaction " << result.transactionHash << " has been sent";
+      }
+    }
+  } catch (std::system_error& x) {
+    logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
+    return x.code();
+  } catch (std::exception& x) {
+    logger(Logging::WARNING) << "Error while sending transactions: " << x.what();
+    return make_error_code(CryptoNote::error::INTERNAL_WALLET_ERROR);
+  }
+
+  return std::error_code();
+}
+
 std::error_code WalletService::createDelayedTransaction(const CreateDelayedTransaction::Request& request, std::string& transactionHash) {
   try {
     System::EventLock lk(readyEvent);
@@ -914,7 +1018,7 @@ std::error_code WalletService::createDelayedTransaction(const CreateDelayedTrans
 
 std::error_code WalletService::getDelayedTransactionHashes(std::vector<std::string>& transactionHashes) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
 
     std::vector<size_t> transactionIds = wallet.getDelayedTransactionIds();
     transactionHashes.reserve(transactionIds.size());
@@ -988,7 +1092,7 @@ std::error_code WalletService::sendDelayedTransaction(const std::string& transac
 
 std::error_code WalletService::getUnconfirmedTransactionHashes(const std::vector<std::string>& addresses, std::vector<std::string>& transactionHashes) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
 
     validateAddresses(addresses, currency, logger);
 
@@ -1014,7 +1118,7 @@ std::error_code WalletService::getUnconfirmedTransactionHashes(const std::vector
 
 std::error_code WalletService::getStatus(uint32_t& blockCount, uint32_t& knownBlockCount, std::string& lastBlockHash, uint32_t& peerCount) {
   try {
-    System::EventLock lk(readyEvent);
+    ReadLock lk(*this);
 
     knownBlockCount = node.getKnownBlockCount();
     peerCount = node.getPeerCount();
@@ -1074,8 +1178,8 @@ void WalletService::replaceWithNewWallet(const Crypto::SecretKey& viewSecretKey)
   inited = true;
 }
 
-std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(const Crypto::Hash& blockHash, size_t blockCount) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(blockHash, blockCount);
+std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(const Crypto::Hash& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
+  std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(blockHash, blockCount, filter.toWalletFilter());
   if (result.empty()) {
     throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
   }
@@ -1083,8 +1187,8 @@ std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(
   return result;
 }
 
-std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(uint32_t firstBlockIndex, size_t blockCount) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(firstBlockIndex, blockCount);
+std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
+  std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(firstBlockIndex, blockCount, filter.toWalletFilter());
   if (result.empty()) {
     throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
   }
@@ -1093,25 +1197,25 @@ std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(
 }
 
 std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(const Crypto::Hash& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
+  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount, filter);
   std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
   return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
 }
 
 std::vector<TransactionHashesInBlockRpcInfo> WalletService::getRpcTransactionHashes(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
+  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount, filter);
   std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
   return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
 }
 
 std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(const Crypto::Hash& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
+  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount, filter);
   std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
   return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
 }
 
 std::vector<TransactionsInBlockRpcInfo> WalletService::getRpcTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const {
-  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
+  std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount, filter);
   std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions = filterTransactions(allTransactions, filter);
   return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
 }
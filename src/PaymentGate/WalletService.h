@@ -51,6 +51,8 @@ namespace PaymentService {
 struct WalletConfiguration {
   std::string walletFile;
   std::string walletPassword;
+  // maximum number of transactions in one sendTransactions request, 0 for no limit
+  size_t maxSendTransactions;
 };
 
 void generateNewWallet(const CryptoNote::Currency &currency, const WalletConfiguration &conf, Logging::ILogger &logger, System::Dispatcher& dispatcher);
@@ -65,6 +67,11 @@ public:
   void init();
   void saveWallet();
 
+  //between these calls the read-only methods below share one acquisition of the service lock instead of taking it
+  //each; the caller must not suspend its context in between
+  void beginReadOnlyBatch();
+  void endReadOnlyBatch();
+
   std::error_code resetWallet();
   std::error_code replaceWithNewWallet(const std::string& viewSecretKey);
   std::error_code createAddress(const std::string& spendSecretKeyText, std::string& address);
@@ -87,6 +94,7 @@ public:
   std::error_code getTransaction(const std::string& transactionHash, TransactionRpcInfo& transaction);
   std::error_code getAddresses(std::vector<std::string>& addresses);
   std::error_code sendTransaction(const SendTransaction::Request& request, std::string& transactionHash);
+  std::error_code sendTransactions(const std::vector<SendTransaction::Request>& requests, std::vector<SendTransactions::TransactionResult>& results);
   std::error_code createDelayedTransaction(const CreateDelayedTransaction::Request& request, std::string& transactionHash);
   std::error_code getDelayedTransactionHashes(std::vector<std::string>& transactionHashes);
   std::error_code deleteDelayedTransaction(const std::string& transactionHash);
@@ -95,6 +103,8 @@ public:
   std::error_code getStatus(uint32_t& blockCount, uint32_t& knownBlockCount, std::string& lastBlockHash, uint32_t& peerCount);
 
 private:
+  class ReadLock;
+
   void refresh();
   void reset();
 
@@ -103,8 +113,8 @@ private:
 
   void replaceWithNewWallet(const Crypto::SecretKey& viewSecretKey);
 
-  std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t blockCount) const;
-  std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(uint32_t firstBlockIndex, size_t blockCount) const;
+  std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
+  std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
 
   std::vector<TransactionHashesInBlockRpcInfo> getRpcTransactionHashes(const Crypto::Hash& blockHash, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
   std::vector<TransactionHashesInBlockRpcInfo> getRpcTransactionHashes(uint32_t firstBlockIndex, size_t blockCount, const TransactionsInBlockInfoFilter& filter) const;
@@ -117,6 +127,8 @@ private:
   CryptoNote::INode& node;
   const WalletConfiguration& config;
   bool inited;
+  // context inside beginReadOnlyBatch/endReadOnlyBatch, it holds readyEvent for the whole run
+  System::NativeContext* readOnlyBatchContext;
   Logging::LoggerRef logger;
   System::Dispatcher& dispatcher;
   System::Event readyEvent;
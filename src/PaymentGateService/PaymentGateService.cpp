@@ -42,6 +42,7 @@
 #include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
 #include "P2p/NetNode.h"
 #include "PaymentGate/WalletFactory.h"
+#include "Wallet/IFusionManager.h"
 #include <System/Context.h>
 
 #ifdef ERROR
@@ -101,7 +102,8 @@ bool PaymentGateService::init(int argc, char** argv) {
 WalletConfiguration PaymentGateService::getWalletConfig() const {
   return WalletConfiguration{
     config.gateConfiguration.containerFile,
-    config.gateConfiguration.containerPassword
+    config.gateConfiguration.containerPassword,
+    config.gateConfiguration.maxSendTransactions
   };
 }
 
@@ -223,7 +225,9 @@ void PaymentGateService::runRpcProxy(Logging::LoggerRef& log) {
   std::unique_ptr<CryptoNote::INode> node(
     PaymentService::NodeFactory::createNode(
       config.remoteNodeConfig.daemonHost, 
-      config.remoteNodeConfig.daemonPort));
+      config.remoteNodeConfig.daemonPort,
+      config.remoteNodeConfig.decoyCacheSize,
+      config.remoteNodeConfig.decoyCacheMaxAge));
 
   runWalletService(currency, *node);
 }
@@ -231,7 +235,8 @@ void PaymentGateService::runRpcProxy(Logging::LoggerRef& log) {
 void PaymentGateService::runWalletService(const CryptoNote::Currency& currency, CryptoNote::INode& node) {
   PaymentService::WalletConfiguration walletConfiguration{
     config.gateConfiguration.containerFile,
-    config.gateConfiguration.containerPassword
+    config.gateConfiguration.containerPassword,
+    config.gateConfiguration.maxSendTransactions
   };
 
   std::unique_ptr<CryptoNote::IWallet> wallet (WalletFactory::createWallet(currency, node, *dispatcher));
@@ -245,6 +250,21 @@ void PaymentGateService::runWalletService(const CryptoNote::Currency& currency,
     return;
   }
 
+  if (config.gateConfiguration.fusionThreshold != 0 && !config.gateConfiguration.printAddresses) {
+    CryptoNote::IFusionManager& fusionManager = dynamic_cast<CryptoNote::IFusionManager&>(*wallet);
+    try {
+      fusionManager.startFusionPlanner({
+        config.gateConfiguration.fusionThreshold,
+        config.gateConfiguration.fusionMixin,
+        config.gateConfiguration.fusionMaxTransactions,
+        std::chrono::seconds(config.gateConfiguration.fusionInterval)
+      });
+    } catch (std::exception& e) {
+      Logging::LoggerRef(logger, "run")(Logging::ERROR, Logging::BRIGHT_RED) << "Failed to start fusion planner: " << e.what();
+      return;
+    }
+  }
+
   if (config.gateConfiguration.printAddresses) {
     // print addresses and exit
     std::vector<std::string> addresses;
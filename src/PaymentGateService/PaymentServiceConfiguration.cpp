@@ -51,6 +51,11 @@ Configuration::Configuration() {
   logLevel = Logging::INFO;
   bindAddress = "";
   bindPort = 0;
+  fusionThreshold = 0;
+  fusionMixin = 0;
+  fusionMaxTransactions = 1;
+  fusionInterval = 60;
+  maxSendTransactions = 100;
 }
 
 void Configuration::initOptions(boost::program_options::options_description& desc) {
@@ -68,6 +73,11 @@ void Configuration::initOptions(boost::program_options::options_description& des
       ("log-file,l", po::value<std::string>(), "log file")
       ("server-root", po::value<std::string>(), "server root. The service will use it as working directory. Don't set it if don't want to change it")
       ("log-level", po::value<size_t>(), "log level")
+      ("fusion-threshold", po::value<uint64_t>(), "send fusion transactions for outputs below this amount in background, 0 to disable")
+      ("fusion-mixin", po::value<uint64_t>(), "mixin count of background fusion transactions")
+      ("fusion-max-transactions", po::value<size_t>(), "maximum number of fusion transactions sent per round")
+      ("fusion-interval", po::value<uint32_t>(), "interval between fusion rounds, in seconds")
+      ("max-send-transactions", po::value<size_t>(), "maximum number of transactions in one sendTransactions request")
       ("address", "print wallet addresses and exit");
 }
 
@@ -104,6 +114,35 @@ void Configuration::init(const boost::program_options::variables_map& options) {
     }
   }
 
+  if (options.count("fusion-threshold") != 0) {
+    fusionThreshold = options["fusion-threshold"].as<uint64_t>();
+  }
+
+  if (options.count("fusion-mixin") != 0) {
+    fusionMixin = options["fusion-mixin"].as<uint64_t>();
+  }
+
+  if (options.count("fusion-max-transactions") != 0) {
+    fusionMaxTransactions = options["fusion-max-transactions"].as<size_t>();
+    if (fusionMaxTransactions == 0) {
+      throw ConfigurationError("fusion-max-transactions option must be greater than 0");
+    }
+  }
+
+  if (options.count("fusion-interval") != 0) {
+    fusionInterval = options["fusion-interval"].as<uint32_t>();
+    if (fusionInterval == 0) {
+      throw ConfigurationError("fusion-interval option must be greater than 0");
+    }
+  }
+
+  if (options.count("max-send-transactions") != 0) {
+    maxSendTransactions = options["max-send-transactions"].as<size_t>();
+    if (maxSendTransactions == 0) {
+      throw ConfigurationError("max-send-transactions option must be greater than 0");
+    }
+  }
+
   if (options.count("server-root") != 0) {
     serverRoot = options["server-root"].as<std::string>();
   }
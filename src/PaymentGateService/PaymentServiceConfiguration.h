@@ -65,6 +65,13 @@ struct Configuration {
   bool printAddresses;
 
   size_t logLevel;
+  size_t maxSendTransactions;
+
+  // background fusion planner, disabled while fusionThreshold is 0
+  uint64_t fusionThreshold;
+  uint64_t fusionMixin;
+  size_t fusionMaxTransactions;
+  uint32_t fusionInterval;
 };
 
 } //namespace PaymentService
@@ -37,12 +37,16 @@ namespace po = boost::program_options;
 RpcNodeConfiguration::RpcNodeConfiguration() {
   daemonHost = "";
   daemonPort = 0;
+  decoyCacheSize = 0;
+  decoyCacheMaxAge = 600;
 }
 
 void RpcNodeConfiguration::initOptions(boost::program_options::options_description& desc) {
   desc.add_options()
     ("daemon-address", po::value<std::string>()->default_value("localhost"), "daemon address")
-    ("daemon-port", po::value<uint16_t>()->default_value(8081), "daemon port");
+    ("daemon-port", po::value<uint16_t>()->default_value(8081), "daemon port")
+    ("decoy-cache-size", po::value<size_t>(), "random outputs prefetched per amount for sending, 0 to disable")
+    ("decoy-cache-max-age", po::value<uint32_t>(), "maximum age of prefetched random outputs, in seconds");
 }
 
 void RpcNodeConfiguration::init(const boost::program_options::variables_map& options) {
@@ -53,6 +57,14 @@ void RpcNodeConfiguration::init(const boost::program_options::variables_map& opt
   if (options.count("daemon-port") != 0 && (!options["daemon-port"].defaulted() || daemonPort == 0)) {
     daemonPort = options["daemon-port"].as<uint16_t>();
   }
+
+  if (options.count("decoy-cache-size") != 0) {
+    decoyCacheSize = options["decoy-cache-size"].as<size_t>();
+  }
+
+  if (options.count("decoy-cache-max-age") != 0) {
+    decoyCacheMaxAge = options["decoy-cache-max-age"].as<uint32_t>();
+  }
 }
 
 } //namespace PaymentService
@@ -44,6 +44,10 @@ public:
 
   std::string daemonHost;
   uint16_t daemonPort;
+
+  // random outputs kept per amount for sending, disabled while decoyCacheSize is 0
+  size_t decoyCacheSize;
+  uint32_t decoyCacheMaxAge;
 };
 
 } //namespace PaymentService
@@ -0,0 +1,211 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "Context.h"
+
+#include <stdint.h>
+
+#if defined(__x86_64__)
+
+/*
+ * Frame saved on a suspended stack, from the stack pointer up:
+ *   mxcsr, x87 control word, r15, r14, r13, r12, rbx, rbp, return address
+ */
+__asm__(
+  ".text\n"
+  ".globl switchStackContext\n"
+  ".type switchStackContext, @function\n"
+  ".align 16\n"
+  "switchStackContext:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  subq $8, %rsp\n"
+  "  stmxcsr (%rsp)\n"
+  "  fnstcw 4(%rsp)\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq %rsi, %rsp\n"
+  "  ldmxcsr (%rsp)\n"
+  "  fldcw 4(%rsp)\n"
+  "  addq $8, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".size switchStackContext, .-switchStackContext\n"
+  "\n"
+  ".type startStackContext, @function\n"
+  ".align 16\n"
+  "startStackContext:\n"
+  "  .cfi_startproc\n"
+  "  .cfi_undefined rip\n"
+  "  movq %r12, %rdi\n"
+  "  callq *%r13\n"
+  "  ud2\n"
+  "  .cfi_endproc\n"
+  ".size startStackContext, .-startStackContext\n"
+);
+
+void startStackContext(void);
+
+void* makeStackContext(void* stack, size_t size, void (*procedure)(void*), void* argument) {
+  void* stackTop = (uint8_t*)stack + size;
+  /* after the frame is popped the stack pointer is 16-byte aligned, as before a call */
+  uint64_t* frame = (uint64_t*)((uintptr_t)stackTop & ~(uintptr_t)15) - 8;
+  frame[0] = 0x1F80 | ((uint64_t)0x037F << 32);
+  frame[1] = 0;
+  frame[2] = 0;
+  frame[3] = (uint64_t)(uintptr_t)procedure;
+  frame[4] = (uint64_t)(uintptr_t)argument;
+  frame[5] = 0;
+  frame[6] = 0;
+  frame[7] = (uint64_t)(uintptr_t)startStackContext;
+  return frame;
+}
+
+#elif defined(__aarch64__)
+
+/*
+ * Frame saved on a suspended stack, from the stack pointer up:
+ *   x19..x28, x29, x30 (return address), d8..d15
+ */
+__asm__(
+  ".text\n"
+  ".globl switchStackContext\n"
+  ".type switchStackContext, %function\n"
+  ".align 4\n"
+  "switchStackContext:\n"
+  "  sub sp, sp, #160\n"
+  "  stp x19, x20, [sp, #0]\n"
+  "  stp x21, x22, [sp, #16]\n"
+  "  stp x23, x24, [sp, #32]\n"
+  "  stp x25, x26, [sp, #48]\n"
+  "  stp x27, x28, [sp, #64]\n"
+  "  stp x29, x30, [sp, #80]\n"
+  "  stp d8, d9, [sp, #96]\n"
+  "  stp d10, d11, [sp, #112]\n"
+  "  stp d12, d13, [sp, #128]\n"
+  "  stp d14, d15, [sp, #144]\n"
+  "  mov x9, sp\n"
+  "  str x9, [x0]\n"
+  "  mov sp, x1\n"
+  "  ldp x19, x20, [sp, #0]\n"
+  "  ldp x21, x22, [sp, #16]\n"
+  "  ldp x23, x24, [sp, #32]\n"
+  "  ldp x25, x26, [sp, #48]\n"
+  "  ldp x27, x28, [sp, #64]\n"
+  "  ldp x29, x30, [sp, #80]\n"
+  "  ldp d8, d9, [sp, #96]\n"
+  "  ldp d10, d11, [sp, #112]\n"
+  "  ldp d12, d13, [sp, #128]\n"
+  "  ldp d14, d15, [sp, #144]\n"
+  "  add sp, sp, #160\n"
+  "  ret\n"
+  ".size switchStackContext, .-switchStackContext\n"
+  "\n"
+  ".type startStackContext, %function\n"
+  ".align 4\n"
+  "startStackContext:\n"
+  "  .cfi_startproc\n"
+  "  .cfi_undefined x30\n"
+  "  mov x0, x19\n"
+  "  blr x20\n"
+  "  brk #0\n"
+  "  .cfi_endproc\n"
+  ".size startStackContext, .-startStackContext\n"
+);
+
+void startStackContext(void);
+
+void* makeStackContext(void* stack, size_t size, void (*procedure)(void*), void* argument) {
+  void* stackTop = (uint8_t*)stack + size;
+  uint64_t* frame = (uint64_t*)((uintptr_t)stackTop & ~(uintptr_t)15) - 20;
+  int i;
+  for (i = 0; i < 20; ++i) {
+    frame[i] = 0;
+  }
+
+  frame[0] = (uint64_t)(uintptr_t)argument;
+  frame[1] = (uint64_t)(uintptr_t)procedure;
+  frame[11] = (uint64_t)(uintptr_t)startStackContext;
+  return frame;
+}
+
+#else
+
+/* Other architectures fall back to ucontext, the saved "stack pointer" is then the address of
+ * a ucontext_t kept on the suspended stack. */
+
+#include <stdlib.h>
+#include <ucontext.h>
+
+struct StartData {
+  void (*procedure)(void*);
+  void* argument;
+};
+
+static void startStackContext(unsigned int high, unsigned int low) {
+  struct StartData* data = (struct StartData*)(((uintptr_t)high << 16 << 16) | (uintptr_t)low);
+  data->procedure(data->argument);
+  abort();
+}
+
+void* makeStackContext(void* stack, size_t size, void (*procedure)(void*), void* argument) {
+  uintptr_t top = ((uintptr_t)stack + size) & ~(uintptr_t)15;
+  ucontext_t* context = (ucontext_t*)((top - sizeof(ucontext_t)) & ~(uintptr_t)15);
+  struct StartData* data = (struct StartData*)(((uintptr_t)context - sizeof(struct StartData)) & ~(uintptr_t)15);
+  uintptr_t address = (uintptr_t)data;
+  if (getcontext(context) == -1) {
+    abort();
+  }
+
+  data->procedure = procedure;
+  data->argument = argument;
+  context->uc_link = NULL;
+  context->uc_stack.ss_sp = stack;
+  context->uc_stack.ss_size = (uintptr_t)data - (uintptr_t)stack;
+  makecontext(context, (void (*)(void))startStackContext, 2, (unsigned int)(address >> 16 >> 16), (unsigned int)address);
+  return context;
+}
+
+void switchStackContext(void** currentStackPointer, void* nextStackPointer) {
+  ucontext_t context;
+  *currentStackPointer = &context;
+  if (swapcontext(&context, (ucontext_t*)nextStackPointer) == -1) {
+    abort();
+  }
+}
+
+#endif
@@ -30,26 +30,26 @@
 
 #include "Dispatcher.h"
 #include <cassert>
+#include <climits>
+#include <cstdlib>
 #include <cstdint> //dm
 #include <stdexcept> //dm
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
-#include <sys/timerfd.h>
+#include <sys/mman.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <string.h>
-#include <ucontext.h>
 #include <unistd.h>
+#include <System/InterruptedException.h>
+#include "Context.h"
 #include "ErrorMessage.h"
+#include "IoUring.h"
 
 namespace System {
 
 namespace {
 
-struct ContextMakingData {
-  Dispatcher* dispatcher;
-  void* ucontext;
-};
-
 class MutextGuard {
 public:
   MutextGuard(pthread_mutex_t& _mutex) : mutex(_mutex) {
@@ -70,6 +70,39 @@ private:
 static_assert(Dispatcher::SIZEOF_PTHREAD_MUTEX_T == sizeof(pthread_mutex_t), "invalid pthread mutex size");
 
 const size_t STACK_SIZE = 64 * 1024;
+const int MAX_EVENT_COUNT = 64;
+const std::chrono::nanoseconds TIMER_TICK = std::chrono::milliseconds(1);
+#ifdef USE_IO_URING
+// user_data of the io_uring poll watching the epoll descriptor, operation contexts are never at this address
+const uint64_t EPOLL_READY = 1;
+#endif
+
+// Stack is mapped with an inaccessible guard page below it, so an overflow faults instead of corrupting the heap
+uint8_t* allocateStack() {
+  size_t guardSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void* mapping = mmap(nullptr, guardSize + STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Dispatcher::getReusableContext, mmap failed, " + lastErrorMessage());
+  }
+
+  if (mprotect(mapping, guardSize, PROT_NONE) == -1) {
+    std::string message = "Dispatcher::getReusableContext, mprotect failed, " + lastErrorMessage();
+    munmap(mapping, guardSize + STACK_SIZE);
+    throw std::runtime_error(message);
+  }
+
+  return static_cast<uint8_t*>(mapping) + guardSize;
+}
+
+std::chrono::nanoseconds getMonotonicTime() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void freeStack(void* stack) {
+  size_t guardSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto result = munmap(static_cast<uint8_t*>(stack) - guardSize, guardSize + STACK_SIZE);
+  assert(result == 0);
+}
 
 };
 
@@ -79,44 +112,56 @@ Dispatcher::Dispatcher() {
   if (epoll == -1) {
     message = "epoll_create1 failed, " + lastErrorMessage();
   } else {
-    mainContext.ucontext = new ucontext_t;
-    if (getcontext(reinterpret_cast<ucontext_t*>(mainContext.ucontext)) == -1) {
-      message = "getcontext failed, " + lastErrorMessage();
+    remoteSpawnEvent = eventfd(0, O_NONBLOCK);
+    if(remoteSpawnEvent == -1) {
+      message = "eventfd failed, " + lastErrorMessage();
     } else {
-      remoteSpawnEvent = eventfd(0, O_NONBLOCK);
-      if(remoteSpawnEvent == -1) {
-        message = "eventfd failed, " + lastErrorMessage();
-      } else {
-        remoteSpawnEventContext.writeContext = nullptr;
-        remoteSpawnEventContext.readContext = nullptr;
+      remoteSpawnEventContext.writeContext = nullptr;
+      remoteSpawnEventContext.readContext = nullptr;
 
-        epoll_event remoteSpawnEventEpollEvent;
-        remoteSpawnEventEpollEvent.events = EPOLLIN;
-        remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
+      epoll_event remoteSpawnEventEpollEvent;
+      remoteSpawnEventEpollEvent.events = EPOLLIN;
+      remoteSpawnEventEpollEvent.data.ptr = &remoteSpawnEventContext;
 
-        if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
-          message = "epoll_ctl failed, " + lastErrorMessage();
-        } else {
-          *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
-
-          mainContext.interrupted = false;
-          mainContext.group = &contextGroup;
-          mainContext.groupPrev = nullptr;
-          mainContext.groupNext = nullptr;
-          contextGroup.firstContext = nullptr;
-          contextGroup.lastContext = nullptr;
-          contextGroup.firstWaiter = nullptr;
-          contextGroup.lastWaiter = nullptr;
-          currentContext = &mainContext;
-          firstResumingContext = nullptr;
-          firstReusableContext = nullptr;
-          runningContextCount = 0;
-          return;
+      if (epoll_ctl(epoll, EPOLL_CTL_ADD, remoteSpawnEvent, &remoteSpawnEventEpollEvent) == -1) {
+        message = "epoll_ctl failed, " + lastErrorMessage();
+      } else {
+        *reinterpret_cast<pthread_mutex_t*>(this->mutex) = pthread_mutex_t(PTHREAD_MUTEX_INITIALIZER);
+
+        mainContext.stackPointer = nullptr;
+        mainContext.stack = nullptr;
+        mainContext.interrupted = false;
+        mainContext.group = &contextGroup;
+        mainContext.groupPrev = nullptr;
+        mainContext.groupNext = nullptr;
+        contextGroup.firstContext = nullptr;
+        contextGroup.lastContext = nullptr;
+        contextGroup.firstWaiter = nullptr;
+        contextGroup.lastWaiter = nullptr;
+        currentContext = &mainContext;
+        firstResumingContext = nullptr;
+        firstReusableContext = nullptr;
+        runningContextCount = 0;
+        timerWheel.start(getMonotonicTime() / TIMER_TICK);
+        ioUring = nullptr;
+#ifdef USE_IO_URING
+        // SYSTEM_DISPATCHER_BACKEND=epoll keeps the readiness backend, otherwise it is only used when io_uring is unavailable
+        const char* backend = getenv("SYSTEM_DISPATCHER_BACKEND");
+        if (backend == nullptr || strcmp(backend, "epoll") != 0) {
+          try {
+            ioUring = new IoUring;
+            armEpollPoll();
+          } catch (std::exception&) {
+            delete ioUring;
+            ioUring = nullptr;
+          }
         }
-
-        auto result = close(remoteSpawnEvent);
-        assert(result == 0);
+#endif
+        return;
       }
+
+      auto result = close(remoteSpawnEvent);
+      assert(result == 0);
     }
 
     auto result = close(epoll);
@@ -132,23 +177,27 @@ Dispatcher::~Dispatcher() {
   }
 
   yield();
+  // interrupted completion operations resume only after their cancellation completes
+  while (contextGroup.firstContext != nullptr) {
+    assert(ioUring != nullptr);
+    harvestEvents(-1);
+    yield();
+  }
+
   assert(contextGroup.firstContext == nullptr);
   assert(contextGroup.firstWaiter == nullptr);
   assert(firstResumingContext == nullptr);
   assert(runningContextCount == 0);
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto stack = firstReusableContext->stack;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
+    freeStack(stack);
   }
 
-  while (!timers.empty()) {
-    int result = ::close(timers.top());
-    assert(result == 0);
-    timers.pop();
-  }
+  assert(timerWheel.empty());
+#ifdef USE_IO_URING
+  delete ioUring;
+#endif
 
   auto result = close(epoll);
   assert(result == 0);
@@ -160,20 +209,9 @@ Dispatcher::~Dispatcher() {
 
 void Dispatcher::clear() {
   while (firstReusableContext != nullptr) {
-    auto ucontext = static_cast<ucontext_t*>(firstReusableContext->ucontext);
-    auto stackPtr = static_cast<uint8_t *>(firstReusableContext->stackPtr);
+    auto stack = firstReusableContext->stack;
     firstReusableContext = firstReusableContext->next;
-    delete[] stackPtr;
-    delete ucontext;
-  }
-
-  while (!timers.empty()) {
-    int result = ::close(timers.top());
-    if (result == -1) {
-      throw std::runtime_error("Dispatcher::clear, close failed, "  + lastErrorMessage());
-    }
-
-    timers.pop();
+    freeStack(stack);
   }
 }
 
@@ -186,51 +224,14 @@ void Dispatcher::dispatch() {
       break;
     }
 
-    epoll_event event;
-    int count = epoll_wait(epoll, &event, 1, -1);
-    if (count == 1) {
-      ContextPair *contextPair = static_cast<ContextPair*>(event.data.ptr);
-      if(((event.events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-        uint64_t buf;
-        auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-        if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-        }
-
-        MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-        while (!remoteSpawningProcedures.empty()) {
-          spawn(std::move(remoteSpawningProcedures.front()));
-          remoteSpawningProcedures.pop();
-        }
-
-        continue;
-      }
-
-      if ((event.events & EPOLLOUT) != 0) {
-        context = contextPair->writeContext->context;
-        contextPair->writeContext->events = event.events;
-      } else if ((event.events & EPOLLIN) != 0) {
-        context = contextPair->readContext->context;
-        contextPair->readContext->events = event.events;
-      } else {
-        continue;
-      }
-
-      assert(context != nullptr);
-      break;
-    }
-
-    if (errno != EINTR) {
-      throw std::runtime_error("Dispatcher::dispatch, epoll_wait failed, "  + lastErrorMessage());
-    }
+    harvestEvents(getWaitTimeout());
+    expireTimers();
   }
 
   if (context != currentContext) {
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
+    NativeContext* oldContext = currentContext;
     currentContext = context;
-    if (swapcontext(oldContext, static_cast<ucontext_t *>(context->ucontext)) == -1) {
-      throw std::runtime_error("Dispatcher::dispatch, swapcontext failed, " + lastErrorMessage());
-    }
+    switchStackContext(&oldContext->stackPointer, context->stackPointer);
   }
 }
 
@@ -309,51 +310,10 @@ void Dispatcher::spawn(std::function<void()>&& procedure) {
 }
 
 void Dispatcher::yield() {
-  for(;;){
-    epoll_event events[16];
-    int count = epoll_wait(epoll, events, 16, 0);
-    if (count == 0) {
-      break;
-    }
-
-    if(count > 0) {
-      for(int i = 0; i < count; ++i) {
-        ContextPair *contextPair = static_cast<ContextPair*>(events[i].data.ptr);
-        if(((events[i].events & (EPOLLIN | EPOLLOUT)) != 0) && contextPair->readContext == nullptr && contextPair->writeContext == nullptr) {
-          uint64_t buf;
-          auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
-          if(transferred == -1) {
-            throw std::runtime_error("Dispatcher::dispatch, read(remoteSpawnEvent) failed, " + lastErrorMessage());
-          }
-
-          MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
-          while (!remoteSpawningProcedures.empty()) {
-            spawn(std::move(remoteSpawningProcedures.front()));
-            remoteSpawningProcedures.pop();
-          }
-
-          continue;
-        }
-
-        if ((events[i].events & EPOLLOUT) != 0) {
-          contextPair->writeContext->context->interruptProcedure = nullptr;
-          pushContext(contextPair->writeContext->context);
-          contextPair->writeContext->events = events[i].events;
-        } else if ((events[i].events & EPOLLIN) != 0) {
-          contextPair->readContext->context->interruptProcedure = nullptr;
-          pushContext(contextPair->readContext->context);
-          contextPair->readContext->events = events[i].events;
-        } else {
-          continue;
-        }
-      }
-    } else {
-      if (errno != EINTR) {
-        throw std::runtime_error("Dispatcher::dispatch, epoll_wait failed, " + lastErrorMessage());
-      }
-    }
+  while (harvestEvents(0) == MAX_EVENT_COUNT) {
   }
 
+  expireTimers();
   if (firstResumingContext != nullptr) {
     pushContext(currentContext);
     dispatch();
@@ -364,28 +324,52 @@ int Dispatcher::getEpoll() const {
   return epoll;
 }
 
-NativeContext& Dispatcher::getReusableContext() {
-  if(firstReusableContext == nullptr) {
-    ucontext_t* newlyCreatedContext = new ucontext_t;
-    if (getcontext(newlyCreatedContext) == -1) { //makecontext precondition
-      throw std::runtime_error("Dispatcher::getReusableContext, getcontext failed, " + lastErrorMessage());
-    }
+IoUring* Dispatcher::getIoUring() const {
+  return ioUring;
+}
 
-    auto stackPointer = new uint8_t[STACK_SIZE];
-    newlyCreatedContext->uc_stack.ss_sp = stackPointer;
-    newlyCreatedContext->uc_stack.ss_size = STACK_SIZE;
+#ifdef USE_IO_URING
+// Waits for the completion of the operation prepared in sqe, it goes to the kernel with the next batch. An interrupt
+// cancels it with cancelOpcode, an operation that completes anyway returns its result and leaves the interrupt for the
+// next operation.
+int32_t Dispatcher::completeOperation(io_uring_sqe& sqe, uint8_t cancelOpcode) {
+  assert(ioUring != nullptr);
+  OperationContext operationContext;
+  operationContext.interrupted = false;
+  operationContext.context = currentContext;
+  sqe.user_data = reinterpret_cast<uintptr_t>(&operationContext);
+
+  currentContext->interruptProcedure = [&]() {
+      assert(ioUring != nullptr);
+      io_uring_sqe& cancel = ioUring->getSqe();
+      cancel.opcode = cancelOpcode;
+      cancel.fd = -1;
+      cancel.addr = reinterpret_cast<uintptr_t>(&operationContext);
+      operationContext.interrupted = true;
+  };
 
-    ContextMakingData makingContextData {this, newlyCreatedContext};
-    makecontext(newlyCreatedContext, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(&makingContextData));
+  dispatch();
+  currentContext->interruptProcedure = nullptr;
+  assert(operationContext.context == currentContext);
+  if (operationContext.result == -ECANCELED) {
+    throw InterruptedException();
+  }
 
-    ucontext_t* oldContext = static_cast<ucontext_t*>(currentContext->ucontext);
-    if (swapcontext(oldContext, newlyCreatedContext) == -1) {
-      throw std::runtime_error("Dispatcher::getReusableContext, swapcontext failed, " + lastErrorMessage());
-    }
+  if (operationContext.interrupted) {
+    currentContext->interrupted = true;
+  }
 
+  return operationContext.result;
+}
+#endif
+
+NativeContext& Dispatcher::getReusableContext() {
+  if(firstReusableContext == nullptr) {
+    uint8_t* stack = allocateStack();
+    void* stackPointer = makeStackContext(stack, STACK_SIZE, contextProcedureStatic, this);
+    switchStackContext(&currentContext->stackPointer, stackPointer);
     assert(firstReusableContext != nullptr);
-    assert(firstReusableContext->ucontext == newlyCreatedContext);
-    firstReusableContext->stackPtr = stackPointer;
+    firstReusableContext->stack = stack;
   };
 
   NativeContext* context = firstReusableContext;
@@ -399,40 +383,153 @@ void Dispatcher::pushReusableContext(NativeContext& context) {
   --runningContextCount;
 }
 
-int Dispatcher::getTimer() {
-  int timer;
-  if (timers.empty()) {
-    timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
-    epoll_event timerEvent;
-    timerEvent.events = 0;
-    timerEvent.data.ptr = nullptr;
+void Dispatcher::addTimer(TimerEntry& timer, std::chrono::nanoseconds duration) {
+  // rounded up, a timer never fires early
+  timer.expiry = (getMonotonicTime() + duration + TIMER_TICK - std::chrono::nanoseconds(1)) / TIMER_TICK;
+  timerWheel.insert(timer);
+}
+
+void Dispatcher::removeTimer(TimerEntry& timer) {
+  timerWheel.remove(timer);
+}
+
+int Dispatcher::harvestEvents(int timeout) {
+#ifdef USE_IO_URING
+  if (ioUring != nullptr) {
+    return harvestCompletions(timeout);
+  }
+#endif
+
+  return harvestEpollEvents(timeout);
+}
 
-    if (epoll_ctl(getEpoll(), EPOLL_CTL_ADD, timer, &timerEvent) == -1) {
-      throw std::runtime_error("Dispatcher::getTimer, epoll_ctl failed, "  + lastErrorMessage());
+// Takes every ready event in one call and queues the waiting contexts, returns the number of events taken
+int Dispatcher::harvestEpollEvents(int timeout) {
+  epoll_event events[MAX_EVENT_COUNT];
+  int count = epoll_wait(epoll, events, MAX_EVENT_COUNT, timeout);
+  if (count == -1) {
+    if (errno != EINTR) {
+      throw std::runtime_error("Dispatcher::harvestEvents, epoll_wait failed, "  + lastErrorMessage());
+    }
+
+    return 0;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    ContextPair* contextPair = static_cast<ContextPair*>(events[i].data.ptr);
+    if (contextPair == &remoteSpawnEventContext) {
+      uint64_t buf;
+      auto transferred = read(remoteSpawnEvent, &buf, sizeof buf);
+      if(transferred == -1) {
+          throw std::runtime_error("Dispatcher::harvestEvents, read(remoteSpawnEvent) failed, " + lastErrorMessage());
+      }
+
+      MutextGuard guard(*reinterpret_cast<pthread_mutex_t*>(this->mutex));
+      while (!remoteSpawningProcedures.empty()) {
+        spawn(std::move(remoteSpawningProcedures.front()));
+        remoteSpawningProcedures.pop();
+      }
+
+      continue;
+    }
+
+    if (contextPair->readContext != nullptr && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0) {
+      resumeOperation(contextPair->readContext, events[i].events);
+    }
+
+    if (contextPair->writeContext != nullptr && (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0) {
+      resumeOperation(contextPair->writeContext, events[i].events);
+    }
+  }
+
+  return count;
+}
+
+#ifdef USE_IO_URING
+// Submits every operation queued since the last call, then takes the completions
+int Dispatcher::harvestCompletions(int timeout) {
+  if (timeout != 0 && ioUring->hasCompletions()) {
+    if (ioUring->hasUnsubmitted()) {
+      ioUring->enter(0);
+    }
+  } else if (!ioUring->enter(timeout != 0 ? 1 : 0, timeout)) {
+    return 0;
+  }
+
+  int count = 0;
+  io_uring_cqe completion;
+  while (count < MAX_EVENT_COUNT && ioUring->popCompletion(completion)) {
+    ++count;
+    if (completion.user_data == EPOLL_READY) {
+      while (harvestEpollEvents(0) == MAX_EVENT_COUNT) {
+      }
+
+      armEpollPoll();
+    } else if (completion.user_data != 0) {
+      OperationContext* operationContext = reinterpret_cast<OperationContext*>(completion.user_data);
+      operationContext->result = completion.res;
+      operationContext->context->interruptProcedure = nullptr;
+      pushContext(operationContext->context);
     }
-  } else {
-    timer = timers.top();
-    timers.pop();
   }
 
-  return timer;
+  return count;
 }
 
-void Dispatcher::pushTimer(int timer) {
-  timers.push(timer);
+// Descriptors that stay on epoll (remote spawn event, pending connects) are watched through a poll on the epoll descriptor
+void Dispatcher::armEpollPoll() {
+  io_uring_sqe& sqe = ioUring->getSqe();
+  sqe.opcode = IORING_OP_POLL_ADD;
+  sqe.fd = epoll;
+  sqe.poll32_events = POLLIN;
+  sqe.user_data = EPOLL_READY;
 }
+#endif
 
-void Dispatcher::contextProcedure(void* ucontext) {
+// Milliseconds until the wheel has timers to fire, -1 when it is empty
+int Dispatcher::getWaitTimeout() {
+  uint64_t tick = timerWheel.nextTick();
+  if (tick == TimerWheel::NO_EXPIRY) {
+    return -1;
+  }
+
+  auto remaining = static_cast<int64_t>(tick) * TIMER_TICK - getMonotonicTime();
+  if (remaining.count() <= 0) {
+    return 0;
+  }
+
+  auto milliseconds = (remaining + std::chrono::milliseconds(1) - std::chrono::nanoseconds(1)) / std::chrono::milliseconds(1);
+  return milliseconds < INT_MAX ? static_cast<int>(milliseconds) : INT_MAX;
+}
+
+void Dispatcher::expireTimers() {
+  if (timerWheel.empty()) {
+    return;
+  }
+
+  TimerEntry* timer = timerWheel.advance(getMonotonicTime() / TIMER_TICK);
+  while (timer != nullptr) {
+    TimerEntry* next = timer->next;
+    timer->context->interruptProcedure = nullptr;
+    pushContext(timer->context);
+    timer = next;
+  }
+}
+
+void Dispatcher::resumeOperation(OperationContext*& operationContext, uint32_t events) {
+  operationContext->events = events;
+  operationContext->context->interruptProcedure = nullptr;
+  pushContext(operationContext->context);
+  operationContext = nullptr;
+}
+
+void Dispatcher::contextProcedure() {
   assert(firstReusableContext == nullptr);
   NativeContext context;
-  context.ucontext = ucontext;
   context.interrupted = false;
   context.next = nullptr;
   firstReusableContext = &context;
-  ucontext_t* oldContext = static_cast<ucontext_t*>(context.ucontext);
-  if (swapcontext(oldContext, static_cast<ucontext_t*>(currentContext->ucontext)) == -1) {
-    throw std::runtime_error("Dispatcher::contextProcedure, swapcontext failed, " + lastErrorMessage());
-  }
+  switchStackContext(&context.stackPointer, currentContext->stackPointer);
 
   for (;;) {
     ++runningContextCount;
@@ -481,9 +578,8 @@ void Dispatcher::contextProcedure(void* ucontext) {
   }
 };
 
-void Dispatcher::contextProcedureStatic(void *context) {
-  ContextMakingData* makingContextData = reinterpret_cast<ContextMakingData*>(context);
-  makingContextData->dispatcher->contextProcedure(makingContextData->ucontext);
+void Dispatcher::contextProcedureStatic(void* dispatcher) {
+  static_cast<Dispatcher*>(dispatcher)->contextProcedure();
 }
 
 }
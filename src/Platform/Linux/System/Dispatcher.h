@@ -30,20 +30,25 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <queue>
-#include <stack>
 #include <cstdint> //dm
 #include <stdexcept> //dm
 
+#include "TimerWheel.h"
+
+struct io_uring_sqe;
+
 namespace System {
 
+class IoUring;
 struct NativeContextGroup;
 
 struct NativeContext {
-  void* ucontext;
-  void* stackPtr;
+  void* stackPointer;
+  void* stack;
   bool interrupted;
   NativeContext* next;
   NativeContextGroup* group;
@@ -64,8 +69,11 @@ struct OperationContext {
   NativeContext *context;
   bool interrupted;
   uint32_t events;
+  int32_t result;
 };
 
+// Waiters of a descriptor registered with the dispatcher. Descriptors stay registered (edge-triggered) for their
+// whole lifetime, a slot holds an operation only while it waits and is cleared when the operation is resumed.
 struct ContextPair {
   OperationContext *readContext;
   OperationContext *writeContext;
@@ -89,10 +97,14 @@ public:
 
   // system-dependent
   int getEpoll() const;
+  // Completion (io_uring) backend, nullptr when the dispatcher runs on epoll
+  IoUring* getIoUring() const;
+  int32_t completeOperation(io_uring_sqe& sqe, uint8_t cancelOpcode);
   NativeContext& getReusableContext();
   void pushReusableContext(NativeContext&);
-  int getTimer();
-  void pushTimer(int timer);
+  // Timers live in a wheel checked whenever the dispatcher waits, the context in timer is resumed when duration elapses
+  void addTimer(TimerEntry& timer, std::chrono::nanoseconds duration);
+  void removeTimer(TimerEntry& timer);
 
 #ifdef __x86_64__
 # if __WORDSIZE == 64
@@ -100,18 +112,28 @@ public:
 # else
   static const int SIZEOF_PTHREAD_MUTEX_T = 32;
 # endif
+#elif defined(__aarch64__)
+  static const int SIZEOF_PTHREAD_MUTEX_T = 48;
 #else
   static const int SIZEOF_PTHREAD_MUTEX_T = 24;
 #endif
 
 private:
   void spawn(std::function<void()>&& procedure);
+  int harvestEvents(int timeout);
+  int harvestEpollEvents(int timeout);
+  int harvestCompletions(int timeout);
+  void armEpollPoll();
+  int getWaitTimeout();
+  void expireTimers();
+  void resumeOperation(OperationContext*& operationContext, uint32_t events);
   int epoll;
+  IoUring* ioUring;
   alignas(void*) uint8_t mutex[SIZEOF_PTHREAD_MUTEX_T];
   int remoteSpawnEvent;
   ContextPair remoteSpawnEventContext;
   std::queue<std::function<void()>> remoteSpawningProcedures;
-  std::stack<int> timers;
+  TimerWheel timerWheel;
 
   NativeContext mainContext;
   NativeContextGroup contextGroup;
@@ -121,8 +143,8 @@ private:
   NativeContext* firstReusableContext;
   size_t runningContextCount;
 
-  void contextProcedure(void* ucontext);
-  static void contextProcedureStatic(void* context);
+  void contextProcedure();
+  static void contextProcedureStatic(void* dispatcher);
 };
 
 }
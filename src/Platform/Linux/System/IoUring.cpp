@@ -0,0 +1,201 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#ifdef USE_IO_URING
+
+#include "IoUring.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "ErrorMessage.h"
+
+namespace System {
+
+IoUring::IoUring() : sqMapping(MAP_FAILED), cqMapping(MAP_FAILED), sqes(static_cast<io_uring_sqe*>(MAP_FAILED)) {
+  io_uring_params params;
+  memset(&params, 0, sizeof params);
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = COMPLETION_ENTRY_COUNT;
+  ring = static_cast<int>(syscall(__NR_io_uring_setup, ENTRY_COUNT, &params));
+  if (ring == -1) {
+    throw std::runtime_error("IoUring::IoUring, io_uring_setup failed, " + lastErrorMessage());
+  }
+
+  std::string message;
+  // timed waits pass their timeout with the enter call
+  if ((params.features & IORING_FEAT_EXT_ARG) == 0) {
+    close(ring);
+    throw std::runtime_error("IoUring::IoUring, io_uring_setup failed, IORING_FEAT_EXT_ARG not supported");
+  }
+
+  sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    sqMappingSize = cqMappingSize = std::max(sqMappingSize, cqMappingSize);
+  }
+
+  sqMapping = mmap(nullptr, sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+  if (sqMapping == MAP_FAILED) {
+    message = "mmap failed, " + lastErrorMessage();
+  } else {
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+      cqMapping = sqMapping;
+    } else {
+      cqMapping = mmap(nullptr, cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    if (cqMapping == MAP_FAILED) {
+      message = "mmap failed, " + lastErrorMessage();
+    } else {
+      sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES));
+      if (sqes == MAP_FAILED) {
+        message = "mmap failed, " + lastErrorMessage();
+      } else {
+        uint8_t* sq = static_cast<uint8_t*>(sqMapping);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqLocalTail = *sqTail;
+        unsubmitted = 0;
+        unsigned* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sqEntries; ++i) {
+          array[i] = i;
+        }
+
+        uint8_t* cq = static_cast<uint8_t*>(cqMapping);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return;
+      }
+    }
+  }
+
+  release();
+  throw std::runtime_error("IoUring::IoUring, " + message);
+}
+
+IoUring::~IoUring() {
+  release();
+}
+
+io_uring_sqe& IoUring::getSqe() {
+  while (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) == sqEntries) {
+    enter(0);
+  }
+
+  io_uring_sqe& sqe = sqes[sqLocalTail & sqMask];
+  memset(&sqe, 0, sizeof sqe);
+  ++sqLocalTail;
+  ++unsubmitted;
+  // The entry is published on the next enter, callers fill it in before that
+  return sqe;
+}
+
+bool IoUring::hasUnsubmitted() const {
+  return unsubmitted != 0;
+}
+
+bool IoUring::hasCompletions() const {
+  return *cqHead != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+}
+
+bool IoUring::enter(unsigned waitCount, int timeout) {
+  __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+  long result;
+  if (waitCount != 0 && timeout >= 0) {
+    __kernel_timespec timespec;
+    timespec.tv_sec = timeout / 1000;
+    timespec.tv_nsec = static_cast<long long>(timeout % 1000) * 1000000;
+    io_uring_getevents_arg argument;
+    memset(&argument, 0, sizeof argument);
+    argument.ts = reinterpret_cast<uintptr_t>(&timespec);
+    result = syscall(__NR_io_uring_enter, ring, unsubmitted, waitCount, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument, sizeof argument);
+  } else {
+    result = syscall(__NR_io_uring_enter, ring, unsubmitted, waitCount, IORING_ENTER_GETEVENTS, nullptr, 0);
+  }
+
+  // the kernel consumes submissions even when the wait fails, its head tells how many
+  unsubmitted = sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+  if (result == -1) {
+    if (errno == ETIME) {
+      return true;
+    }
+
+    if (errno == EINTR || errno == EBUSY || errno == EAGAIN) {
+      return false;
+    }
+
+    throw std::runtime_error("IoUring::enter, io_uring_enter failed, " + lastErrorMessage());
+  }
+
+  return true;
+}
+
+bool IoUring::popCompletion(io_uring_cqe& completion) {
+  unsigned head = *cqHead;
+  if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+
+  completion = cqes[head & cqMask];
+  __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void IoUring::release() {
+  if (sqes != MAP_FAILED) {
+    munmap(sqes, sqesSize);
+  }
+
+  if (cqMapping != MAP_FAILED && cqMapping != sqMapping) {
+    munmap(cqMapping, cqMappingSize);
+  }
+
+  if (sqMapping != MAP_FAILED) {
+    munmap(sqMapping, sqMappingSize);
+  }
+
+  close(ring);
+}
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#ifdef USE_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+namespace System {
+
+// Minimal io_uring submission/completion ring driven by the dispatcher. Entries taken with getSqe are
+// only handed to the kernel by the next enter, so every operation started between two dispatcher
+// waits goes in with a single system call.
+class IoUring {
+public:
+  static const unsigned ENTRY_COUNT = 256;
+  static const unsigned COMPLETION_ENTRY_COUNT = 4096;
+
+  IoUring();
+  IoUring(const IoUring&) = delete;
+  ~IoUring();
+  IoUring& operator=(const IoUring&) = delete;
+
+  io_uring_sqe& getSqe();
+  bool hasUnsubmitted() const;
+  bool hasCompletions() const;
+  // Submits queued entries, flushes finished operations to the completion queue and waits until it holds waitCount entries
+  // or, with a non-negative timeout, for at most timeout milliseconds. Returns false if interrupted by a signal.
+  bool enter(unsigned waitCount, int timeout = -1);
+  bool popCompletion(io_uring_cqe& completion);
+
+private:
+  int ring;
+  void* sqMapping;
+  size_t sqMappingSize;
+  void* cqMapping;
+  size_t cqMappingSize;
+  io_uring_sqe* sqes;
+  size_t sqesSize;
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned sqMask;
+  unsigned sqEntries;
+  unsigned sqLocalTail;
+  unsigned unsubmitted;
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned cqMask;
+  io_uring_cqe* cqes;
+
+  void release();
+};
+
+}
+
+#endif
@@ -38,9 +38,28 @@
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
 #include <System/Ipv4Address.h>
+#include "IoUring.h"
 
 namespace System {
 
+namespace {
+
+// Connections stay registered for their whole lifetime, a move only points the registration at the new waiter slots
+void updateRegistration(Dispatcher& dispatcher, int connection, ContextPair& contextPair, int operation) {
+  if (dispatcher.getIoUring() != nullptr) {
+    return;
+  }
+
+  epoll_event connectionEvent;
+  connectionEvent.events = EPOLLIN | EPOLLOUT | EPOLLET;
+  connectionEvent.data.ptr = &contextPair;
+  if (epoll_ctl(dispatcher.getEpoll(), operation, connection, &connectionEvent) == -1) {
+    throw std::runtime_error("TcpConnection, epoll_ctl failed, " + lastErrorMessage());
+  }
+}
+
+}
+
 TcpConnection::TcpConnection() : dispatcher(nullptr) {
 }
 
@@ -51,6 +70,7 @@ TcpConnection::TcpConnection(TcpConnection&& other) : dispatcher(other.dispatche
     connection = other.connection;
     contextPair = other.contextPair;
     other.dispatcher = nullptr;
+    updateRegistration(*dispatcher, connection, contextPair, EPOLL_CTL_MOD);
   }
 }
 
@@ -79,6 +99,7 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other) {
     connection = other.connection;
     contextPair = other.contextPair;
     other.dispatcher = nullptr;
+    updateRegistration(*dispatcher, connection, contextPair, EPOLL_CTL_MOD);
   }
 
   return *this;
@@ -91,85 +112,60 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
-  std::string message;
-  ssize_t transferred = ::recv(connection, (void *)data, size, 0);
-  if (transferred == -1) {
+#ifdef USE_IO_URING
+  if (IoUring* ioUring = dispatcher->getIoUring()) {
+    io_uring_sqe& sqe = ioUring->getSqe();
+    sqe.opcode = IORING_OP_RECV;
+    sqe.fd = connection;
+    sqe.addr = reinterpret_cast<uintptr_t>(data);
+    sqe.len = static_cast<uint32_t>(size);
+    int32_t transferred = dispatcher->completeOperation(sqe, IORING_OP_ASYNC_CANCEL);
+    if (transferred < 0) {
+      throw std::runtime_error("TcpConnection::read, recv failed, " + errorMessage(-transferred));
+    }
+
+    assert(transferred <= static_cast<ssize_t>(size));
+    return transferred;
+  }
+#endif
+
+  for (;;) {
+    ssize_t transferred = ::recv(connection, (void *)data, size, 0);
+    if (transferred != -1) {
+      assert(transferred <= static_cast<ssize_t>(size));
+      return transferred;
+    }
+
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
-      message = "recv failed, " + lastErrorMessage();
-    } else {
-      epoll_event connectionEvent;
-      OperationContext operationContext;
-      operationContext.interrupted = false;
-      operationContext.context = dispatcher->getCurrentContext();
-      contextPair.readContext = &operationContext;
-      connectionEvent.data.ptr = &contextPair;
-
-      if(contextPair.writeContext != nullptr) {
-        connectionEvent.events = EPOLLIN | EPOLLOUT | EPOLLONESHOT;
-      } else {
-        connectionEvent.events = EPOLLIN | EPOLLONESHOT;
-      }
-
-      if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-        message = "epoll_ctl failed, " + lastErrorMessage();
-      } else {
-        dispatcher->getCurrentContext()->interruptProcedure = [&]() {
-            assert(dispatcher != nullptr);
-            assert(contextPair.readContext != nullptr);
-            epoll_event connectionEvent;
-            connectionEvent.events = 0;
-            connectionEvent.data.ptr = nullptr;
-
-            if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-              throw std::runtime_error("TcpConnection::stop, epoll_ctl failed, " + lastErrorMessage());
-            }
-
-            contextPair.readContext->interrupted = true;
-            dispatcher->pushContext(contextPair.readContext->context);
-        };
-
-        dispatcher->dispatch();
-        dispatcher->getCurrentContext()->interruptProcedure = nullptr;
+      throw std::runtime_error("TcpConnection::read, recv failed, " + lastErrorMessage());
+    }
+
+    OperationContext operationContext;
+    operationContext.interrupted = false;
+    operationContext.context = dispatcher->getCurrentContext();
+    contextPair.readContext = &operationContext;
+    dispatcher->getCurrentContext()->interruptProcedure = [&]() {
         assert(dispatcher != nullptr);
-        assert(operationContext.context == dispatcher->getCurrentContext());
         assert(contextPair.readContext == &operationContext);
-
-        if (operationContext.interrupted) {
-          contextPair.readContext = nullptr;
-          throw InterruptedException();
-        }
-
         contextPair.readContext = nullptr;
-        if(contextPair.writeContext != nullptr) { //write is presented, rearm
-          epoll_event connectionEvent;
-          connectionEvent.events = EPOLLOUT | EPOLLONESHOT;
-          connectionEvent.data.ptr = &contextPair;
-
-          if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-            message = "epoll_ctl failed, " + lastErrorMessage();
-            throw std::runtime_error("TcpConnection::read");
-          }
-        }
-
-        if((operationContext.events & (EPOLLERR | EPOLLHUP)) != 0) {
-          throw std::runtime_error("TcpConnection::read");
-        }
-
-        ssize_t transferred = ::recv(connection, (void *)data, size, 0);
-        if (transferred == -1) {
-          message = "recv failed, " + lastErrorMessage();
-        } else {
-          assert(transferred <= static_cast<ssize_t>(size));
-          return transferred;
-        }
-      }
+        operationContext.interrupted = true;
+        dispatcher->pushContext(operationContext.context);
+    };
+
+    dispatcher->dispatch();
+    dispatcher->getCurrentContext()->interruptProcedure = nullptr;
+    assert(dispatcher != nullptr);
+    assert(operationContext.context == dispatcher->getCurrentContext());
+    assert(contextPair.readContext == nullptr);
+
+    if (operationContext.interrupted) {
+      throw InterruptedException();
     }
 
-    throw std::runtime_error("TcpConnection::read, "+ message);
+    if((operationContext.events & (EPOLLERR | EPOLLHUP)) != 0) {
+      throw std::runtime_error("TcpConnection::read");
+    }
   }
-
-  assert(transferred <= static_cast<ssize_t>(size));
-  return transferred;
 }
 
 std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
@@ -179,7 +175,6 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     throw InterruptedException();
   }
 
-  std::string message;
   if(size == 0) {
     if(shutdown(connection, SHUT_WR) == -1) {
       throw std::runtime_error("TcpConnection::write, shutdown failed, " + lastErrorMessage());
@@ -188,84 +183,61 @@ std::size_t TcpConnection::write(const uint8_t* data, size_t size) {
     return 0;
   }
 
-  ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
-  if (transferred == -1) {
+#ifdef USE_IO_URING
+  if (IoUring* ioUring = dispatcher->getIoUring()) {
+    io_uring_sqe& sqe = ioUring->getSqe();
+    sqe.opcode = IORING_OP_SEND;
+    sqe.fd = connection;
+    sqe.addr = reinterpret_cast<uintptr_t>(data);
+    sqe.len = static_cast<uint32_t>(size);
+    sqe.msg_flags = MSG_NOSIGNAL;
+    int32_t transferred = dispatcher->completeOperation(sqe, IORING_OP_ASYNC_CANCEL);
+    if (transferred < 0) {
+      throw std::runtime_error("TcpConnection::write, send failed, " + errorMessage(-transferred));
+    }
+
+    assert(transferred <= static_cast<ssize_t>(size));
+    return transferred;
+  }
+#endif
+
+  for (;;) {
+    ssize_t transferred = ::send(connection, (void *)data, size, MSG_NOSIGNAL);
+    if (transferred != -1) {
+      assert(transferred <= static_cast<ssize_t>(size));
+      return transferred;
+    }
+
     if (errno != EAGAIN  && errno != EWOULDBLOCK) {
-      message = "send failed, " + lastErrorMessage();
-    } else {
-      epoll_event connectionEvent;
-      OperationContext operationContext;
-      operationContext.interrupted = false;
-      operationContext.context = dispatcher->getCurrentContext();
-      contextPair.writeContext = &operationContext;
-      connectionEvent.data.ptr = &contextPair;
-
-      if(contextPair.readContext != nullptr) {
-        connectionEvent.events = EPOLLIN | EPOLLOUT | EPOLLONESHOT;
-      } else {
-        connectionEvent.events = EPOLLOUT | EPOLLONESHOT;
-      }
-
-      if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-        message = "epoll_ctl failed, " + lastErrorMessage();
-      } else {
-        dispatcher->getCurrentContext()->interruptProcedure = [&]() {
-            assert(dispatcher != nullptr);
-            assert(contextPair.writeContext != nullptr);
-            epoll_event connectionEvent;
-            connectionEvent.events = 0;
-            connectionEvent.data.ptr = nullptr;
-
-            if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-              throw std::runtime_error("TcpConnection::stop, epoll_ctl failed, " + lastErrorMessage());
-            }
-
-            contextPair.writeContext->interrupted = true;
-            dispatcher->pushContext(contextPair.writeContext->context);
-        };
-
-        dispatcher->dispatch();
-        dispatcher->getCurrentContext()->interruptProcedure = nullptr;
+      throw std::runtime_error("TcpConnection::write, send failed, " + lastErrorMessage());
+    }
+
+    OperationContext operationContext;
+    operationContext.interrupted = false;
+    operationContext.context = dispatcher->getCurrentContext();
+    contextPair.writeContext = &operationContext;
+    dispatcher->getCurrentContext()->interruptProcedure = [&]() {
         assert(dispatcher != nullptr);
-        assert(operationContext.context == dispatcher->getCurrentContext());
         assert(contextPair.writeContext == &operationContext);
-
-        if (operationContext.interrupted) {
-          contextPair.writeContext = nullptr;
-          throw InterruptedException();
-        }
-
         contextPair.writeContext = nullptr;
-        if(contextPair.readContext != nullptr) { //read is presented, rearm
-          epoll_event connectionEvent;
-          connectionEvent.events = EPOLLIN | EPOLLONESHOT;
-          connectionEvent.data.ptr = &contextPair;
-
-          if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, connection, &connectionEvent) == -1) {
-            message = "epoll_ctl failed, " + lastErrorMessage();
-            throw std::runtime_error("TcpConnection::write, " + message);
-          }
-        }
-
-        if((operationContext.events & (EPOLLERR | EPOLLHUP)) != 0) {
-          throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
-        }
-
-        ssize_t transferred = ::send(connection, (void *)data, size, 0);
-        if (transferred == -1) {
-          message = "send failed, "  + lastErrorMessage();
-        } else {
-          assert(transferred <= static_cast<ssize_t>(size));
-          return transferred;
-        }
-      }
+        operationContext.interrupted = true;
+        dispatcher->pushContext(operationContext.context);
+    };
+
+    dispatcher->dispatch();
+    dispatcher->getCurrentContext()->interruptProcedure = nullptr;
+    assert(dispatcher != nullptr);
+    assert(operationContext.context == dispatcher->getCurrentContext());
+    assert(contextPair.writeContext == nullptr);
+
+    if (operationContext.interrupted) {
+      throw InterruptedException();
     }
 
-    throw std::runtime_error("TcpConnection::write, " + message);
+    if((operationContext.events & (EPOLLERR | EPOLLHUP)) != 0) {
+      throw std::runtime_error("TcpConnection::write, events & (EPOLLERR | EPOLLHUP) != 0");
+    }
   }
-
-  assert(transferred <= static_cast<ssize_t>(size));
-  return transferred;
 }
 
 std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
@@ -282,13 +254,7 @@ std::pair<Ipv4Address, uint16_t> TcpConnection::getPeerAddressAndPort() const {
 TcpConnection::TcpConnection(Dispatcher& dispatcher, int socket) : dispatcher(&dispatcher), connection(socket) {
   contextPair.readContext = nullptr;
   contextPair.writeContext = nullptr;
-  epoll_event connectionEvent;
-  connectionEvent.events = EPOLLONESHOT;
-  connectionEvent.data.ptr = nullptr;
-
-  if (epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_ADD, socket, &connectionEvent) == -1) {
-    throw std::runtime_error("TcpConnection::TcpConnection, epoll_ctl failed, " + lastErrorMessage());
-  }
+  updateRegistration(dispatcher, socket, contextPair, EPOLL_CTL_ADD);
 }
 
 }
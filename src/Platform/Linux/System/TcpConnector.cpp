@@ -131,6 +131,7 @@ TcpConnection TcpConnector::connect(const Ipv4Address& address, uint16_t port) {
               dispatcher->getCurrentContext()->interruptProcedure = [&] {
                 TcpConnectorContextExt* connectorContext1 = static_cast<TcpConnectorContextExt*>(context);
                 if (!connectorContext1->interrupted) {
+                  contextPair.writeContext = nullptr;
                   if (close(connectorContext1->connection) == -1) {
                     throw std::runtime_error("TcpListener::stop, close failed, " + lastErrorMessage());
                   }
@@ -145,6 +146,7 @@ TcpConnection TcpConnector::connect(const Ipv4Address& address, uint16_t port) {
               assert(dispatcher != nullptr);
               assert(connectorContext.context == dispatcher->getCurrentContext());
               assert(contextPair.readContext == nullptr);
+              assert(contextPair.writeContext == nullptr);
               assert(context == &connectorContext);
               context = nullptr;
               connectorContext.context = nullptr;
@@ -39,6 +39,7 @@
 #include <string.h>
 
 #include "Dispatcher.h"
+#include "IoUring.h"
 #include "TcpConnection.h"
 #include <System/ErrorMessage.h>
 #include <System/InterruptedException.h>
@@ -46,10 +47,28 @@
 
 namespace System {
 
+namespace {
+
+// Listener stays registered for its whole lifetime, a move only points the registration at the new waiter slots
+void updateRegistration(Dispatcher& dispatcher, int listener, ContextPair& contextPair, int operation) {
+  if (dispatcher.getIoUring() != nullptr) {
+    return;
+  }
+
+  epoll_event listenEvent;
+  listenEvent.events = EPOLLIN | EPOLLET;
+  listenEvent.data.ptr = &contextPair;
+  if (epoll_ctl(dispatcher.getEpoll(), operation, listener, &listenEvent) == -1) {
+    throw std::runtime_error("TcpListener, epoll_ctl failed, " + lastErrorMessage());
+  }
+}
+
+}
+
 TcpListener::TcpListener() : dispatcher(nullptr) {
 }
 
-TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16_t port) : dispatcher(&dispatcher) {
+TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16_t port, bool reusePort) : dispatcher(&dispatcher) {
   std::string message;
   listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
   if (listener == -1) {
@@ -60,7 +79,8 @@ TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16
       message = "fcntl failed, " + lastErrorMessage();
     } else {
       int on = 1;
-      if (setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on) == -1) {
+      if (setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on) == -1 ||
+        (reusePort && setsockopt(listener, SOL_SOCKET, SO_REUSEPORT, &on, sizeof on) == -1)) {
         message = "setsockopt failed, " + lastErrorMessage();
       } else {
         sockaddr_in address;
@@ -72,11 +92,13 @@ TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& addr, uint16
         } else if (listen(listener, SOMAXCONN) != 0) {
           message = "listen failed, " + lastErrorMessage();
         } else {
+          contextPair.readContext = nullptr;
+          contextPair.writeContext = nullptr;
           epoll_event listenEvent;
-          listenEvent.events = 0;
-          listenEvent.data.ptr = nullptr;
+          listenEvent.events = EPOLLIN | EPOLLET;
+          listenEvent.data.ptr = &contextPair;
 
-          if (epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_ADD, listener, &listenEvent) == -1) {
+          if (dispatcher.getIoUring() == nullptr && epoll_ctl(dispatcher.getEpoll(), EPOLL_CTL_ADD, listener, &listenEvent) == -1) {
             message = "epoll_ctl failed, " + lastErrorMessage();
           } else {
             context = nullptr;
@@ -98,7 +120,9 @@ TcpListener::TcpListener(TcpListener&& other) : dispatcher(other.dispatcher) {
     assert(other.context == nullptr);
     listener = other.listener;
     context = nullptr;
+    contextPair = other.contextPair;
     other.dispatcher = nullptr;
+    updateRegistration(*dispatcher, listener, contextPair, EPOLL_CTL_MOD);
   }
 }
 
@@ -123,7 +147,9 @@ TcpListener& TcpListener::operator=(TcpListener&& other) {
     assert(other.context == nullptr);
     listener = other.listener;
     context = nullptr;
+    contextPair = other.contextPair;
     other.dispatcher = nullptr;
+    updateRegistration(*dispatcher, listener, contextPair, EPOLL_CTL_MOD);
   }
 
   return *this;
@@ -136,35 +162,44 @@ TcpConnection TcpListener::accept() {
     throw InterruptedException();
   }
 
-  ContextPair contextPair;
-  OperationContext listenerContext;
-  listenerContext.interrupted = false;
-  listenerContext.context = dispatcher->getCurrentContext();
+#ifdef USE_IO_URING
+  if (IoUring* ioUring = dispatcher->getIoUring()) {
+    io_uring_sqe& sqe = ioUring->getSqe();
+    sqe.opcode = IORING_OP_ACCEPT;
+    sqe.fd = listener;
+    sqe.accept_flags = SOCK_NONBLOCK;
+    int32_t connection = dispatcher->completeOperation(sqe, IORING_OP_ASYNC_CANCEL);
+    if (connection < 0) {
+      throw std::runtime_error("TcpListener::accept, accept failed, " + errorMessage(-connection));
+    }
 
-  contextPair.writeContext = nullptr;
-  contextPair.readContext = &listenerContext;
+    return TcpConnection(*dispatcher, connection);
+  }
+#endif
 
-  epoll_event listenEvent;
-  listenEvent.events = EPOLLIN | EPOLLONESHOT;
-  listenEvent.data.ptr = &contextPair;
-  std::string message;
-  if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, listener, &listenEvent) == -1) {
-    message = "epoll_ctl failed, " + lastErrorMessage();
-  } else {
+  for (;;) {
+    sockaddr inAddr;
+    socklen_t inLen = sizeof(inAddr);
+    int connection = ::accept4(listener, &inAddr, &inLen, SOCK_NONBLOCK);
+    if (connection != -1) {
+      return TcpConnection(*dispatcher, connection);
+    }
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      throw std::runtime_error("TcpListener::accept, accept failed, " + lastErrorMessage());
+    }
+
+    OperationContext listenerContext;
+    listenerContext.interrupted = false;
+    listenerContext.context = dispatcher->getCurrentContext();
+    contextPair.readContext = &listenerContext;
     context = &listenerContext;
     dispatcher->getCurrentContext()->interruptProcedure = [&]() {
         assert(dispatcher != nullptr);
         assert(context != nullptr);
         OperationContext* listenerContext = static_cast<OperationContext*>(context);
         if (!listenerContext->interrupted) {
-          epoll_event listenEvent;
-          listenEvent.events = 0;
-          listenEvent.data.ptr = nullptr;
-
-          if (epoll_ctl(dispatcher->getEpoll(), EPOLL_CTL_MOD, listener, &listenEvent) == -1) {
-            throw std::runtime_error("TcpListener::stop, epoll_ctl failed, " + lastErrorMessage() );
-          }
-
+          contextPair.readContext = nullptr;
           listenerContext->interrupted = true;
           dispatcher->pushContext(listenerContext->context);
         }
@@ -174,7 +209,7 @@ TcpConnection TcpListener::accept() {
     dispatcher->getCurrentContext()->interruptProcedure = nullptr;
     assert(dispatcher != nullptr);
     assert(listenerContext.context == dispatcher->getCurrentContext());
-    assert(contextPair.writeContext == nullptr);
+    assert(contextPair.readContext == nullptr);
     assert(context == &listenerContext);
     context = nullptr;
     listenerContext.context = nullptr;
@@ -185,26 +220,7 @@ TcpConnection TcpListener::accept() {
     if((listenerContext.events & (EPOLLERR | EPOLLHUP)) != 0) {
       throw std::runtime_error("TcpListener::accept, accepting failed");
     }
-
-    sockaddr inAddr;
-    socklen_t inLen = sizeof(inAddr);
-    int connection = ::accept(listener, &inAddr, &inLen);
-    if (connection == -1) {
-      message = "accept failed, " + lastErrorMessage();
-    } else {
-      int flags = fcntl(connection, F_GETFL, 0);
-      if (flags == -1 || fcntl(connection, F_SETFL, flags | O_NONBLOCK) == -1) {
-        message = "fcntl failed, " + lastErrorMessage();
-      } else {
-        return TcpConnection(*dispatcher, connection);
-      }
-
-      int result = close(connection);
-      assert(result != -1);
-    }
   }
-
-  throw std::runtime_error("TcpListener::accept, " + message);
 }
 
 }
@@ -32,17 +32,18 @@
 
 #include <cstdint>
 #include <string>
+#include "Dispatcher.h"
 
 namespace System {
 
-class Dispatcher;
 class Ipv4Address;
 class TcpConnection;
 
 class TcpListener {
 public:
   TcpListener();
-  TcpListener(Dispatcher& dispatcher, const Ipv4Address& address, uint16_t port);
+  // Listeners created with reusePort may bind the same port, the system spreads incoming connections among them
+  TcpListener(Dispatcher& dispatcher, const Ipv4Address& address, uint16_t port, bool reusePort = false);
   TcpListener(const TcpListener&) = delete;
   TcpListener(TcpListener&& other);
   ~TcpListener();
@@ -54,6 +55,7 @@ private:
   Dispatcher* dispatcher;
   void* context;
   int listener;
+  ContextPair contextPair;
 };
 
 }
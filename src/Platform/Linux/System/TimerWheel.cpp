@@ -0,0 +1,204 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "TimerWheel.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace System {
+
+namespace {
+
+const uint64_t SLOT_MASK = TimerWheel::SLOT_COUNT - 1;
+
+// Distance from slot to the next occupied slot after it, SLOT_COUNT when only slot itself is occupied, 0 when none is
+unsigned nextOccupied(const uint64_t* bitmap, unsigned slot) {
+  for (unsigned distance = 1; distance <= TimerWheel::SLOT_COUNT; ) {
+    unsigned index = (slot + distance) & SLOT_MASK;
+    uint64_t word = bitmap[index / 64] >> (index % 64);
+    if (word != 0) {
+      unsigned found = distance + static_cast<unsigned>(__builtin_ctzll(word));
+      return found <= TimerWheel::SLOT_COUNT ? found : 0;
+    }
+
+    distance += 64 - index % 64;
+  }
+
+  return 0;
+}
+
+}
+
+TimerWheel::TimerWheel() : current(0), count(0) {
+  memset(slots, 0, sizeof slots);
+  memset(occupied, 0, sizeof occupied);
+}
+
+void TimerWheel::start(uint64_t now) {
+  assert(count == 0);
+  current = now;
+}
+
+bool TimerWheel::empty() const {
+  return count == 0;
+}
+
+void TimerWheel::insert(TimerEntry& entry) {
+  ++count;
+  // the current tick has already been handled
+  place(entry, entry.expiry > current ? entry.expiry : current + 1);
+}
+
+void TimerWheel::remove(TimerEntry& entry) {
+  assert(count > 0);
+  --count;
+  if (entry.prev != nullptr) {
+    entry.prev->next = entry.next;
+  } else {
+    unsigned level = entry.position / SLOT_COUNT;
+    unsigned slot = entry.position % SLOT_COUNT;
+    assert(slots[level][slot] == &entry);
+    slots[level][slot] = entry.next;
+    if (entry.next == nullptr) {
+      occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+  }
+
+  if (entry.next != nullptr) {
+    entry.next->prev = entry.prev;
+  }
+}
+
+TimerEntry* TimerWheel::advance(uint64_t now) {
+  TimerEntry* expired = nullptr;
+  TimerEntry** expiredTail = &expired;
+  if (count == 0) {
+    if (now > current) {
+      current = now;
+    }
+
+    return expired;
+  }
+
+  while (current < now && count != 0) {
+    // ticks without an occupied slot are skipped
+    uint64_t tick = nextTick();
+    if (tick > now) {
+      break;
+    }
+
+    current = tick;
+    for (unsigned level = 1; level < LEVEL_COUNT && ((current >> ((level - 1) * SLOT_BITS)) & SLOT_MASK) == 0; ++level) {
+      TimerEntry* entry = take(level, static_cast<unsigned>((current >> (level * SLOT_BITS)) & SLOT_MASK));
+      while (entry != nullptr) {
+        TimerEntry* next = entry->next;
+        place(*entry, entry->expiry > current ? entry->expiry : current);
+        entry = next;
+      }
+    }
+
+    // slots hold the latest insert first, the expired list keeps insertion order
+    TimerEntry* entry = take(0, static_cast<unsigned>(current & SLOT_MASK));
+    TimerEntry* first = nullptr;
+    TimerEntry* last = entry;
+    while (entry != nullptr) {
+      TimerEntry* next = entry->next;
+      --count;
+      entry->next = first;
+      first = entry;
+      entry = next;
+    }
+
+    if (first != nullptr) {
+      *expiredTail = first;
+      expiredTail = &last->next;
+    }
+  }
+
+  if (now > current) {
+    current = now;
+  }
+
+  return expired;
+}
+
+uint64_t TimerWheel::nextTick() const {
+  if (count == 0) {
+    return NO_EXPIRY;
+  }
+
+  uint64_t next = NO_EXPIRY;
+  for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+    unsigned shift = level * SLOT_BITS;
+    unsigned distance = nextOccupied(occupied[level], static_cast<unsigned>((current >> shift) & SLOT_MASK));
+    if (distance != 0) {
+      uint64_t tick = ((current >> shift) + distance) << shift;
+      if (tick < next) {
+        next = tick;
+      }
+    }
+  }
+
+  assert(next != NO_EXPIRY);
+  return next;
+}
+
+void TimerWheel::place(TimerEntry& entry, uint64_t expiry) {
+  uint64_t delta = expiry - current;
+  unsigned level = 0;
+  while (level + 1 < LEVEL_COUNT && delta >= (uint64_t(1) << ((level + 1) * SLOT_BITS))) {
+    ++level;
+  }
+
+  if (delta >= (uint64_t(1) << (LEVEL_COUNT * SLOT_BITS))) {
+    // beyond the wheel span, parked in the farthest slot and placed again when it is reached
+    expiry = current + (uint64_t(SLOT_COUNT - 1) << (level * SLOT_BITS));
+  }
+
+  unsigned slot = static_cast<unsigned>((expiry >> (level * SLOT_BITS)) & SLOT_MASK);
+  entry.prev = nullptr;
+  entry.position = level * SLOT_COUNT + slot;
+  entry.next = slots[level][slot];
+  if (entry.next != nullptr) {
+    entry.next->prev = &entry;
+  }
+
+  slots[level][slot] = &entry;
+  occupied[level][slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+TimerEntry* TimerWheel::take(unsigned level, unsigned slot) {
+  TimerEntry* entry = slots[level][slot];
+  slots[level][slot] = nullptr;
+  occupied[level][slot / 64] &= ~(uint64_t(1) << (slot % 64));
+  return entry;
+}
+
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace System {
+
+struct NativeContext;
+
+struct TimerEntry {
+  uint64_t expiry;
+  TimerEntry* prev;
+  TimerEntry* next;
+  unsigned position;
+  NativeContext* context;
+};
+
+// Hierarchical timing wheel: LEVEL_COUNT levels of SLOT_COUNT slots, each level covering SLOT_COUNT times the
+// span of the one below. Entries sit in intrusive lists, so insert and remove are O(1); an entry moves down a
+// level when the wheel reaches its slot, at most LEVEL_COUNT - 1 times.
+class TimerWheel {
+public:
+  static const unsigned SLOT_BITS = 8;
+  static const unsigned SLOT_COUNT = 1 << SLOT_BITS;
+  static const unsigned LEVEL_COUNT = 4;
+  static const uint64_t NO_EXPIRY = UINT64_MAX;
+
+  TimerWheel();
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  void start(uint64_t now);
+  bool empty() const;
+  // Entries expiring at or before the current tick fire on the next tick
+  void insert(TimerEntry& entry);
+  void remove(TimerEntry& entry);
+  // Moves the wheel to tick now and returns the expired entries, linked through next
+  TimerEntry* advance(uint64_t now);
+  // First tick at which advance has work to do, NO_EXPIRY when the wheel is empty
+  uint64_t nextTick() const;
+
+private:
+  uint64_t current;
+  size_t count;
+  TimerEntry* slots[LEVEL_COUNT][SLOT_COUNT];
+  uint64_t occupied[LEVEL_COUNT][SLOT_COUNT / 64];
+
+  void place(TimerEntry& entry, uint64_t expiry);
+  TimerEntry* take(unsigned level, unsigned slot);
+};
+
+}
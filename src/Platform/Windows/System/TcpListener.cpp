@@ -59,7 +59,12 @@ LPFN_ACCEPTEX acceptEx = nullptr;
 TcpListener::TcpListener() : dispatcher(nullptr) {
 }
 
-TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& address, uint16_t port) : dispatcher(&dispatcher) {
+TcpListener::TcpListener(Dispatcher& dispatcher, const Ipv4Address& address, uint16_t port, bool reusePort) : dispatcher(&dispatcher) {
+  // Windows has no load-balanced port sharing, SO_REUSEADDR would let the listeners steal each other's connections
+  if (reusePort) {
+    throw std::runtime_error("TcpListener::TcpListener, reusePort is not supported");
+  }
+
   std::string message;
   listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
   if (listener == INVALID_SOCKET) {
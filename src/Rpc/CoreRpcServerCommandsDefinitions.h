@@ -167,6 +167,24 @@ struct COMMAND_RPC_GET_POOL_CHANGES_LITE {
   };
 };
 
+// Long-poll variant of COMMAND_RPC_GET_POOL_CHANGES_LITE: the node holds the request until the tail block differs from
+// tailBlockId, the pool differs from knownTxsIds or timeout (in milliseconds) expires, and then answers with the changes.
+struct COMMAND_RPC_WAIT_FOR_CHANGES {
+  struct request {
+    Crypto::Hash tailBlockId;
+    std::vector<Crypto::Hash> knownTxsIds;
+    uint32_t timeout;
+
+    void serialize(ISerializer &s) {
+      KV_MEMBER(tailBlockId)
+      serializeAsBinary(knownTxsIds, "knownTxsIds", s);
+      KV_MEMBER(timeout)
+    }
+  };
+
+  typedef COMMAND_RPC_GET_POOL_CHANGES_LITE::response response;
+};
+
 //-----------------------------------------------
 struct COMMAND_RPC_GET_TX_GLOBAL_OUTPUTS_INDEXES {
   
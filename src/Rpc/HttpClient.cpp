@@ -57,6 +57,10 @@ void HttpClient::request(const HttpRequest &req, HttpResponse &res) {
     HttpParser parser;
     stream << req;
     stream.flush();
+    if (stream.peek() == std::char_traits<char>::eof()) {
+      throw ConnectionClosedException("HttpClient::request, connection closed before response");
+    }
+
     parser.receiveResponse(stream, res);
   } catch (const std::exception &) {
     disconnect();
@@ -99,4 +103,7 @@ void HttpClient::disconnect() {
 ConnectException::ConnectException(const std::string& whatArg) : std::runtime_error(whatArg.c_str()) {
 }
 
+ConnectionClosedException::ConnectionClosedException(const std::string& whatArg) : std::runtime_error(whatArg.c_str()) {
+}
+
 }
@@ -46,6 +46,12 @@ public:
   ConnectException(const std::string& whatArg);
 };
 
+// The server closed the connection before sending any byte of the response
+class ConnectionClosedException : public std::runtime_error  {
+public:
+  ConnectionClosedException(const std::string& whatArg);
+};
+
 class HttpClient {
 public:
 
@@ -68,8 +74,9 @@ private:
   std::unique_ptr<System::TcpStreambuf> m_streamBuf;
 };
 
-template <typename Request, typename Response>
-void invokeJsonCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+// Client is an HttpClient or an HttpClientPool
+template <typename Client, typename Request, typename Response>
+void invokeJsonCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
@@ -86,8 +93,8 @@ void invokeJsonCommand(HttpClient& client, const std::string& url, const Request
   }
 }
 
-template <typename Request, typename Response>
-void invokeBinaryCommand(HttpClient& client, const std::string& url, const Request& req, Response& res) {
+template <typename Client, typename Request, typename Response>
+void invokeBinaryCommand(Client& client, const std::string& url, const Request& req, Response& res) {
   HttpRequest hreq;
   HttpResponse hres;
 
@@ -0,0 +1,122 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "HttpClientPool.h"
+
+#include <cassert>
+
+#include <boost/scope_exit.hpp>
+
+#include <System/InterruptedException.h>
+
+#include "HttpClient.h"
+
+namespace CryptoNote {
+
+HttpClientPool::HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t connectionCount) :
+  m_clientReleased(dispatcher) {
+  assert(connectionCount > 0);
+  for (size_t i = 0; i < connectionCount; ++i) {
+    m_clients.emplace_back(new HttpClient(dispatcher, address, port));
+    m_idleClients.push_back(m_clients.back().get());
+  }
+}
+
+HttpClientPool::~HttpClientPool() {
+  assert(m_idleClients.size() == m_clients.size());
+}
+
+void HttpClientPool::request(const HttpRequest& req, HttpResponse& res) {
+  HttpClient* client = acquire();
+  BOOST_SCOPE_EXIT_ALL(this, client) {
+    release(client);
+  };
+
+  bool reused = client->isConnected();
+  try {
+    client->request(req, res);
+  } catch (const System::InterruptedException&) {
+    throw;
+  } catch (const ConnectionClosedException&) {
+    if (!reused || m_nonIdempotentUrls.count(req.getUrl()) != 0) {
+      m_connected = false;
+      throw;
+    }
+
+    // the server may have dropped the idle keep-alive connection, so retry once on a fresh one
+    HttpResponse retryResponse;
+    try {
+      client->request(req, retryResponse);
+    } catch (const System::InterruptedException&) {
+      throw;
+    } catch (const std::exception&) {
+      m_connected = false;
+      throw;
+    }
+
+    res = std::move(retryResponse);
+  } catch (const std::exception&) {
+    // the server may have started answering, so the request is not sent again
+    m_connected = false;
+    throw;
+  }
+
+  m_connected = true;
+}
+
+void HttpClientPool::addNonIdempotentUrl(const std::string& url) {
+  m_nonIdempotentUrls.insert(url);
+}
+
+bool HttpClientPool::isConnected() const {
+  return m_connected;
+}
+
+size_t HttpClientPool::connectionCount() const {
+  return m_clients.size();
+}
+
+HttpClient* HttpClientPool::acquire() {
+  while (m_idleClients.empty()) {
+    m_clientReleased.wait();
+  }
+
+  // the most recently released connection is the most likely to still be open
+  HttpClient* client = m_idleClients.back();
+  m_idleClients.pop_back();
+  return client;
+}
+
+void HttpClientPool::release(HttpClient* client) {
+  m_idleClients.push_back(client);
+  m_clientReleased.set();
+  m_clientReleased.clear();
+}
+
+}
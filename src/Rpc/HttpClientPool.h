@@ -0,0 +1,76 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <HTTP/HttpRequest.h>
+#include <HTTP/HttpResponse.h>
+#include <System/Event.h>
+
+namespace System {
+class Dispatcher;
+}
+
+namespace CryptoNote {
+
+class HttpClient;
+
+// Keep-alive connections to one HTTP server, shared by the contexts of a dispatcher. A request takes an idle
+// connection or waits until one is released, so up to connectionCount requests are in flight at the same time
+// and a slow one does not hold back the others.
+class HttpClientPool {
+public:
+  HttpClientPool(System::Dispatcher& dispatcher, const std::string& address, uint16_t port, size_t connectionCount);
+  ~HttpClientPool();
+
+  void request(const HttpRequest& req, HttpResponse& res);
+
+  // Requests to url are never sent twice, not even when a reused connection was closed before the response
+  void addNonIdempotentUrl(const std::string& url);
+
+  bool isConnected() const;
+  size_t connectionCount() const;
+
+private:
+  HttpClient* acquire();
+  void release(HttpClient* client);
+
+  std::vector<std::unique_ptr<HttpClient>> m_clients;
+  std::vector<HttpClient*> m_idleClients;
+  System::Event m_clientReleased;
+  std::unordered_set<std::string> m_nonIdempotentUrls;
+  bool m_connected = false;
+};
+
+}
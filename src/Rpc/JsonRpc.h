@@ -82,16 +82,23 @@ public:
   JsonRpcRequest() : psReq(Common::JsonValue::OBJECT) {}
 
   bool parseRequest(const std::string& requestBody) {
+    Common::JsonValue request;
     try {
-      psReq = Common::JsonValue::fromString(requestBody);
+      request = Common::JsonValue::fromString(requestBody);
     } catch (std::exception&) {
       throw JsonRpcError(errParseError);
     }
 
-    if (!psReq.contains("method")) {
+    return parseRequest(request);
+  }
+
+  bool parseRequest(const Common::JsonValue& request) {
+    if (!request.isObject() || !request.contains("method") || !request("method").isString()) {
       throw JsonRpcError(errInvalidRequest);
     }
 
+    psReq = request;
+
     method = psReq("method").getString();
 
     if (psReq.contains("id")) {
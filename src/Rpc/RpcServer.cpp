@@ -30,9 +30,18 @@
 
 #include "RpcServer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <future>
+#include <sstream>
 #include <unordered_map>
 
+#include <boost/scope_exit.hpp>
+
+#include <System/Context.h>
+#include <System/Event.h>
+#include <System/Timer.h>
+
 // CryptoNote
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
@@ -43,6 +52,8 @@
 
 #include "CryptoNoteProtocol/ICryptoNoteProtocolQuery.h"
 
+#include "Common/Metrics.h"
+
 #include "P2p/NetNode.h"
 
 #include "CoreRpcServerErrorCodes.h"
@@ -104,6 +115,7 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/getrandom_outs.bin", { binMethod<COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS>(&RpcServer::on_get_random_outs), false } },
   { "/get_pool_changes.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES>(&RpcServer::onGetPoolChanges), false } },
   { "/get_pool_changes_lite.bin", { binMethod<COMMAND_RPC_GET_POOL_CHANGES_LITE>(&RpcServer::onGetPoolChangesLite), false } },
+  { "/wait_for_changes.bin", { binMethod<COMMAND_RPC_WAIT_FOR_CHANGES>(&RpcServer::onWaitForChanges), false } },
 
   // json handlers
   { "/getinfo", { jsonMethod<COMMAND_RPC_GET_INFO>(&RpcServer::on_get_info), true } },
@@ -115,11 +127,20 @@ std::unordered_map<std::string, RpcServer::RpcHandler<RpcServer::HandlerFunction
   { "/stop_daemon", { jsonMethod<COMMAND_RPC_STOP_DAEMON>(&RpcServer::on_stop_daemon), true } },
 
   // json rpc
-  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
+  { "/json_rpc", { std::bind(&RpcServer::processJsonRpcRequest, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } },
+
+  // prometheus
+  { "/metrics", { std::bind(&RpcServer::on_get_metrics, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3), true } }
 };
 
 RpcServer::RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery) :
-  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery) {
+  HttpServer(dispatcher, log), logger(log, "RpcServer"), m_core(c), m_p2p(p2p), m_protocolQuery(protocolQuery), m_changeNotificationPending(false),
+  m_maxWaitForChangesTimeout(COMMAND_RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT) {
+  m_core.addObserver(this);
+}
+
+RpcServer::~RpcServer() {
+  m_core.removeObserver(this);
 }
 
 void RpcServer::processRequest(const HttpRequest& request, HttpResponse& response) {
@@ -137,6 +158,7 @@ void RpcServer::processRequest(const HttpRequest& request, HttpResponse& respons
     return;
   }
 
+  MetricTimer timer(requestLatency(url));
   it->second.handler(this, request, response);
 }
 
@@ -145,13 +167,65 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
   using namespace JsonRpc;
 
   response.addHeader("Content-Type", "application/json");
+  logger(TRACE) << "JSON-RPC request: " << request.getBody();
+
+  Common::JsonValue jsonBody;
+  try {
+    jsonBody = Common::JsonValue::fromString(request.getBody());
+  } catch (std::exception&) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(errParseError));
+    response.setBody(jsonResponse.getBody());
+    return true;
+  }
+
+  if (!jsonBody.isArray() || jsonBody.size() == 0) {
+    JsonRpcResponse jsonResponse;
+    processJsonRpcItem(jsonBody, jsonResponse);
+    std::string body = jsonResponse.getBody();
+    response.setBody(body);
+    logger(TRACE) << "JSON-RPC response: " << body;
+    return true;
+  }
+
+  if (jsonBody.size() > JSON_RPC_MAX_BATCH_SIZE) {
+    JsonRpcResponse jsonResponse;
+    jsonResponse.setError(JsonRpcError(errInvalidRequest, "Batch exceeds " + std::to_string(JSON_RPC_MAX_BATCH_SIZE) + " requests"));
+    response.setBody(jsonResponse.getBody());
+    return true;
+  }
+
+  // batch: every response is appended to the body as soon as it's ready, notifications get none
+  std::string body;
+  for (size_t i = 0; i < jsonBody.size(); ++i) {
+    const Common::JsonValue& item = jsonBody[i];
+
+    JsonRpcResponse jsonResponse;
+    processJsonRpcItem(item, jsonResponse);
+    if (item.isObject() && !item.contains("id")) {
+      continue;
+    }
+
+    body.push_back(body.empty() ? '[' : ',');
+    body += jsonResponse.getBody();
+  }
+
+  if (!body.empty()) {
+    body.push_back(']');
+  }
+
+  response.setBody(body);
+  logger(TRACE) << "JSON-RPC response: " << body;
+  return true;
+}
+
+void RpcServer::processJsonRpcItem(const Common::JsonValue& request, JsonRpc::JsonRpcResponse& jsonResponse) {
+  using namespace JsonRpc;
 
   JsonRpcRequest jsonRequest;
-  JsonRpcResponse jsonResponse;
 
   try {
-    logger(TRACE) << "JSON-RPC request: " << request.getBody();
-    jsonRequest.parseRequest(request.getBody());
+    jsonRequest.parseRequest(request);
     jsonResponse.setId(jsonRequest.getId()); // copy id
 
     static std::unordered_map<std::string, RpcServer::RpcHandler<JsonMemberMethod>> jsonRpcHandlers = {
@@ -174,6 +248,7 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
       throw JsonRpcError(CORE_RPC_ERROR_CODE_CORE_BUSY, "Core is busy");
     }
 
+    MetricTimer timer(jsonRequestLatency(jsonRequest.getMethod()));
     it->second.handler(this, jsonRequest, jsonResponse);
 
   } catch (const JsonRpcError& err) {
@@ -181,9 +256,35 @@ bool RpcServer::processJsonRpcRequest(const HttpRequest& request, HttpResponse&
   } catch (const std::exception& e) {
     jsonResponse.setError(JsonRpcError(JsonRpc::errInternalError, e.what()));
   }
+}
 
-  response.setBody(jsonResponse.getBody());
-  logger(TRACE) << "JSON-RPC response: " << jsonResponse.getBody();
+MetricHistogram& RpcServer::requestLatency(const std::string& url) {
+  auto it = m_requestLatency.find(url);
+  if (it == m_requestLatency.end()) {
+    MetricHistogram& histogram = MetricsRegistry::instance().histogram("dynex_rpc_request_seconds", "RPC request handling time by endpoint",
+      "endpoint=\"" + url + "\"");
+    it = m_requestLatency.emplace(url, &histogram).first;
+  }
+
+  return *it->second;
+}
+
+MetricHistogram& RpcServer::jsonRequestLatency(const std::string& method) {
+  auto it = m_jsonRequestLatency.find(method);
+  if (it == m_jsonRequestLatency.end()) {
+    MetricHistogram& histogram = MetricsRegistry::instance().histogram("dynex_rpc_json_request_seconds", "JSON-RPC request handling time by method",
+      "method=\"" + method + "\"");
+    it = m_jsonRequestLatency.emplace(method, &histogram).first;
+  }
+
+  return *it->second;
+}
+
+bool RpcServer::on_get_metrics(const HttpRequest& request, HttpResponse& response) {
+  std::ostringstream metrics;
+  MetricsRegistry::instance().write(metrics);
+  response.addHeader("Content-Type", "text/plain; version=0.0.4");
+  response.setBody(metrics.str());
   return true;
 }
 
@@ -191,6 +292,23 @@ bool RpcServer::isCoreReady() {
   return m_core.currency().isTestnet() || m_p2p.get_payload_object().isSynchronized();
 }
 
+void RpcServer::blockchainUpdated() {
+  if (!m_changeNotificationPending.exchange(true)) {
+    m_dispatcher.remoteSpawn(std::bind(&RpcServer::notifyChangeWaiters, this));
+  }
+}
+
+void RpcServer::poolUpdated() {
+  blockchainUpdated();
+}
+
+void RpcServer::notifyChangeWaiters() {
+  m_changeNotificationPending = false;
+  for (System::Event* waiter : m_changeWaiters) {
+    waiter->set();
+  }
+}
+
 //
 // Binary handlers
 //
@@ -331,6 +449,41 @@ bool RpcServer::onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::re
   return true;
 }
 
+bool RpcServer::onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::min(req.timeout, m_maxWaitForChangesTimeout));
+
+  for (;;) {
+    rsp.addedTxs.clear();
+    rsp.deletedTxsIds.clear();
+    rsp.status = CORE_RPC_STATUS_OK;
+    rsp.isTailBlockActual = m_core.getPoolChangesLite(req.tailBlockId, req.knownTxsIds, rsp.addedTxs, rsp.deletedTxsIds);
+    if (!rsp.isTailBlockActual || !rsp.addedTxs.empty() || !rsp.deletedTxsIds.empty()) {
+      break;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      break;
+    }
+
+    // core notifications reach the waiters through remoteSpawn, so a change made after the check above still wakes us
+    System::Event changed(m_dispatcher);
+    m_changeWaiters.insert(&changed);
+    BOOST_SCOPE_EXIT_ALL(this, &changed) {
+      m_changeWaiters.erase(&changed);
+    };
+
+    System::Context<> timeoutContext(m_dispatcher, [this, &changed, deadline, now] {
+      System::Timer(m_dispatcher).sleep(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now));
+      changed.set();
+    });
+
+    changed.wait();
+  }
+
+  return true;
+}
+
 //
 // JSON handlers
 //
@@ -30,24 +30,41 @@
 
 #include "HttpServer.h"
 
+#include <atomic>
 #include <functional>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <Logging/LoggerRef.h>
 #include "CoreRpcServerCommandsDefinitions.h"
+#include "CryptoNoteCore/ICoreObserver.h"
+
+namespace Common {
+class JsonValue;
+class MetricHistogram;
+}
 
 namespace CryptoNote {
 
+namespace JsonRpc {
+class JsonRpcResponse;
+}
+
 class core;
 class NodeServer;
 class ICryptoNoteProtocolQuery;
 
-class RpcServer : public HttpServer {
+class RpcServer : public HttpServer, private ICoreObserver {
 public:
   RpcServer(System::Dispatcher& dispatcher, Logging::ILogger& log, core& c, NodeServer& p2p, const ICryptoNoteProtocolQuery& protocolQuery);
+  virtual ~RpcServer();
 
   typedef std::function<bool(RpcServer*, const HttpRequest& request, HttpResponse& response)> HandlerFunction;
 
+  // Longest time a /wait_for_changes.bin request may stay parked, in milliseconds
+  uint32_t maxWaitForChangesTimeout() const { return m_maxWaitForChangesTimeout; }
+  void maxWaitForChangesTimeout(uint32_t val) { m_maxWaitForChangesTimeout = val; }
+
 private:
 
   template <class Handler>
@@ -61,7 +78,16 @@ private:
 
   virtual void processRequest(const HttpRequest& request, HttpResponse& response) override;
   bool processJsonRpcRequest(const HttpRequest& request, HttpResponse& response);
+  void processJsonRpcItem(const Common::JsonValue& request, JsonRpc::JsonRpcResponse& response);
+  bool on_get_metrics(const HttpRequest& request, HttpResponse& response);
   bool isCoreReady();
+  Common::MetricHistogram& requestLatency(const std::string& url);
+  Common::MetricHistogram& jsonRequestLatency(const std::string& method);
+
+  // ICoreObserver, called from core threads
+  virtual void blockchainUpdated() override;
+  virtual void poolUpdated() override;
+  void notifyChangeWaiters();
 
   // binary handlers
   bool on_get_blocks(const COMMAND_RPC_GET_BLOCKS_FAST::request& req, COMMAND_RPC_GET_BLOCKS_FAST::response& res);
@@ -71,6 +97,7 @@ private:
   bool on_get_random_outs(const COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request& req, COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response& res);
   bool onGetPoolChanges(const COMMAND_RPC_GET_POOL_CHANGES::request& req, COMMAND_RPC_GET_POOL_CHANGES::response& rsp);
   bool onGetPoolChangesLite(const COMMAND_RPC_GET_POOL_CHANGES_LITE::request& req, COMMAND_RPC_GET_POOL_CHANGES_LITE::response& rsp);
+  bool onWaitForChanges(const COMMAND_RPC_WAIT_FOR_CHANGES::request& req, COMMAND_RPC_WAIT_FOR_CHANGES::response& rsp);
 
   // json handlers
   bool on_get_info(const COMMAND_RPC_GET_INFO::request& req, COMMAND_RPC_GET_INFO::response& res);
@@ -97,6 +124,15 @@ private:
   core& m_core;
   NodeServer& m_p2p;
   const ICryptoNoteProtocolQuery& m_protocolQuery;
+
+  // events of the long-poll requests currently parked in onWaitForChanges
+  std::unordered_set<System::Event*> m_changeWaiters;
+  std::atomic<bool> m_changeNotificationPending;
+  uint32_t m_maxWaitForChangesTimeout;
+
+  // histograms of the registered handlers, looked up in MetricsRegistry once per endpoint
+  std::unordered_map<std::string, Common::MetricHistogram*> m_requestLatency;
+  std::unordered_map<std::string, Common::MetricHistogram*> m_jsonRequestLatency;
 };
 
 }
@@ -0,0 +1,133 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "JsonOutputBufferSerializer.h"
+#include "Common/StringTools.h"
+
+namespace CryptoNote {
+
+JsonOutputBufferSerializer::JsonOutputBufferSerializer(std::string& buffer) : writer(buffer) {
+  writer.beginObject();
+}
+
+JsonOutputBufferSerializer::~JsonOutputBufferSerializer() {
+}
+
+ISerializer::SerializerType JsonOutputBufferSerializer::type() const {
+  return ISerializer::OUTPUT;
+}
+
+bool JsonOutputBufferSerializer::beginObject(Common::StringView name) {
+  writer.beginValue(name);
+  writer.beginObject();
+  return true;
+}
+
+void JsonOutputBufferSerializer::endObject() {
+  writer.endObject();
+}
+
+bool JsonOutputBufferSerializer::beginArray(size_t& size, Common::StringView name) {
+  writer.beginValue(name);
+  writer.beginArray();
+  return true;
+}
+
+void JsonOutputBufferSerializer::endArray() {
+  writer.endArray();
+}
+
+bool JsonOutputBufferSerializer::operator()(uint64_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(uint16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(int16_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(uint32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(int32_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(int64_t& value, Common::StringView name) {
+  writer.beginValue(name);
+  writer.writeInteger(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(double& value, Common::StringView name) {
+  writer.beginValue(name);
+  writer.writeReal(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(std::string& value, Common::StringView name) {
+  writer.beginValue(name);
+  writer.writeString(Common::StringView(value.data(), value.size()));
+  return true;
+}
+
+bool JsonOutputBufferSerializer::operator()(uint8_t& value, Common::StringView name) {
+  int64_t v = static_cast<int64_t>(value);
+  return operator()(v, name);
+}
+
+bool JsonOutputBufferSerializer::operator()(bool& value, Common::StringView name) {
+  writer.beginValue(name);
+  writer.writeBool(value);
+  return true;
+}
+
+bool JsonOutputBufferSerializer::binary(void* value, size_t size, Common::StringView name) {
+  std::string hex = Common::toHex(value, size);
+  return (*this)(hex, name);
+}
+
+bool JsonOutputBufferSerializer::binary(std::string& value, Common::StringView name) {
+  return binary(const_cast<char*>(value.data()), value.size(), name);
+}
+
+void JsonOutputBufferSerializer::finish() {
+  writer.endObject();
+}
+
+}
@@ -32,6 +32,7 @@
 
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <unordered_set>
 #include <thread>//dm
@@ -270,6 +271,7 @@ void BlockchainSynchronizer::workingProcedure() {
   }
 
   actualizeFutureState();
+  discardPrefetchedBlocks();
 }
 
 void BlockchainSynchronizer::start() {
@@ -363,25 +365,16 @@ void BlockchainSynchronizer::startBlockchainSync() {
 
   try {
     if (!req.knownBlocks.empty()) {
-      auto queryBlocksCompleted = std::promise<std::error_code>();
-      auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
-
-      m_node.queryBlocks(
-        std::move(req.knownBlocks),
-        req.syncStart.timestamp,
-        response.newBlocks,
-        response.startHeight,
-        [&queryBlocksCompleted](std::error_code ec) {
-          auto detachedPromise = std::move(queryBlocksCompleted);
-          detachedPromise.set_value(ec);
-        });
-
-      std::error_code ec = queryBlocksWaitFuture.get();
+      std::error_code ec;
+      if (!takePrefetchedBlocks(req.knownBlocks.front(), response)) {
+        ec = queryBlocksAsync(std::vector<Hash>(req.knownBlocks), req.syncStart.timestamp, response).get();
+      }
 
       if (ec) {
         setFutureStateIf(State::idle, [this] { return m_futureState != State::stopped; });
         m_observerManager.notify(&IBlockchainSynchronizerObserver::synchronizationCompleted, ec);
       } else {
+        prefetchBlocks(req, response);
         processBlocks(response);
       }
     }
@@ -391,6 +384,80 @@ void BlockchainSynchronizer::startBlockchainSync() {
   }
 }
 
+std::future<std::error_code> BlockchainSynchronizer::queryBlocksAsync(std::vector<Hash>&& knownBlocks, uint64_t timestamp, GetBlocksResponse& response) {
+  auto queryBlocksCompleted = std::make_shared<std::promise<std::error_code>>();
+  auto queryBlocksWaitFuture = queryBlocksCompleted->get_future();
+
+  m_node.queryBlocks(
+    std::move(knownBlocks),
+    timestamp,
+    response.newBlocks,
+    response.startHeight,
+    [queryBlocksCompleted](std::error_code ec) {
+      queryBlocksCompleted->set_value(ec);
+    });
+
+  return queryBlocksWaitFuture;
+}
+
+void BlockchainSynchronizer::prefetchBlocks(const GetBlocksRequest& request, const GetBlocksResponse& response) {
+  // read ahead by one range at most, and only while the node has blocks beyond the current one
+  if (m_prefetchedBlocks || response.newBlocks.empty() ||
+      response.startHeight + response.newBlocks.size() >= m_node.getLocalBlockCount()) {
+    return;
+  }
+
+  // the history the consumers are going to report once they have taken the current range
+  std::vector<Hash> knownBlocks;
+  for (auto it = response.newBlocks.rbegin(); it != response.newBlocks.rend() && knownBlocks.size() < 10; ++it) {
+    if (it->blockHash == request.knownBlocks.front()) {
+      break;
+    }
+
+    knownBlocks.push_back(it->blockHash);
+  }
+
+  knownBlocks.insert(knownBlocks.end(), request.knownBlocks.begin(), request.knownBlocks.end());
+
+  std::unique_ptr<PrefetchedBlocks> prefetched(new PrefetchedBlocks());
+  prefetched->knownTailBlock = knownBlocks.front();
+  try {
+    prefetched->completed = queryBlocksAsync(std::move(knownBlocks), request.syncStart.timestamp, prefetched->response);
+  } catch (std::exception&) {
+    return;
+  }
+
+  m_prefetchedBlocks = std::move(prefetched);
+}
+
+bool BlockchainSynchronizer::takePrefetchedBlocks(const Hash& knownTailBlock, GetBlocksResponse& response) {
+  if (!m_prefetchedBlocks) {
+    return false;
+  }
+
+  std::error_code ec = m_prefetchedBlocks->completed.get();
+  GetBlocksResponse& prefetched = m_prefetchedBlocks->response;
+
+  // a failed consumer update leaves the tail behind, and a node that switched chains answers from an older block
+  if (ec || m_prefetchedBlocks->knownTailBlock != knownTailBlock || prefetched.newBlocks.empty() ||
+      prefetched.newBlocks.front().blockHash != knownTailBlock) {
+    m_prefetchedBlocks.reset();
+    return false;
+  }
+
+  response = std::move(prefetched);
+  m_prefetchedBlocks.reset();
+  return true;
+}
+
+void BlockchainSynchronizer::discardPrefetchedBlocks() {
+  if (m_prefetchedBlocks) {
+    // the node writes into the response until the query completes
+    m_prefetchedBlocks->completed.wait();
+    m_prefetchedBlocks.reset();
+  }
+}
+
 void BlockchainSynchronizer::processBlocks(GetBlocksResponse& response) {
   BlockchainInterval interval;
   interval.startHeight = response.startHeight;
@@ -491,6 +558,9 @@ BlockchainSynchronizer::UpdateConsumersResult BlockchainSynchronizer::updateCons
 }
 
 void BlockchainSynchronizer::startPoolSync() {
+  // the blockchain is synchronized, a range read ahead of it could only hold blocks the node has dropped since
+  discardPrefetchedBlocks();
+
   std::unordered_set<Crypto::Hash> unionPoolHistory;
   std::unordered_set<Crypto::Hash> intersectedPoolHistory;
   getPoolUnionAndIntersection(unionPoolHistory, intersectedPoolHistory);
@@ -88,6 +88,14 @@ private:
     std::vector<Crypto::Hash> knownBlocks;
   };
 
+  // Next block range requested while the consumers still process the current one. It is only taken when the
+  // consumers' history still ends at knownTailBlock and the node answered starting from that very block.
+  struct PrefetchedBlocks {
+    Crypto::Hash knownTailBlock;
+    GetBlocksResponse response;
+    std::future<std::error_code> completed;
+  };
+
   struct GetPoolResponse {
     bool isLastKnownBlockActual;
     std::vector<std::unique_ptr<ITransactionReader>> newTxs;
@@ -116,6 +124,10 @@ private:
   void startPoolSync();
   void startBlockchainSync();
 
+  std::future<std::error_code> queryBlocksAsync(std::vector<Crypto::Hash>&& knownBlocks, uint64_t timestamp, GetBlocksResponse& response);
+  void prefetchBlocks(const GetBlocksRequest& request, const GetBlocksResponse& response);
+  bool takePrefetchedBlocks(const Crypto::Hash& knownTailBlock, GetBlocksResponse& response);
+  void discardPrefetchedBlocks();
   void processBlocks(GetBlocksResponse& response);
   UpdateConsumersResult updateConsumers(const BlockchainInterval& interval, const std::vector<CompleteBlock>& blocks);
   std::error_code processPoolTxs(GetPoolResponse& response);
@@ -148,6 +160,7 @@ private:
   State m_currentState;
   State m_futureState;
   std::unique_ptr<std::thread> workingThread;
+  std::unique_ptr<PrefetchedBlocks> m_prefetchedBlocks; // touched by the working thread only
   std::list<std::pair<const ITransactionReader*, std::promise<std::error_code>>> m_addTransactionTasks;
   std::list<std::pair<const Crypto::Hash*, std::promise<void>>> m_removeTransactionTasks;
 
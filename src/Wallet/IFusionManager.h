@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <utility>
 
@@ -42,11 +43,23 @@ public:
     size_t totalOutputCount;
   };
 
+  // Budget of the background fusion planner: every round it sends at most maxTransactionsPerRound fusion
+  // transactions while estimate(threshold) still finds ready outputs, then sleeps for roundInterval.
+  struct PlannerSettings {
+    uint64_t threshold;
+    uint64_t mixin;
+    size_t maxTransactionsPerRound;
+    std::chrono::milliseconds roundInterval;
+  };
+
   virtual ~IFusionManager() {}
 
   virtual size_t createFusionTransaction(uint64_t threshold, uint64_t mixin) = 0;
   virtual bool isFusionTransaction(size_t transactionId) const = 0;
   virtual EstimateResult estimate(uint64_t threshold) const = 0;
+
+  virtual void startFusionPlanner(const PlannerSettings& settings) = 0;
+  virtual void stopFusionPlanner() = 0;
 };
 
 }
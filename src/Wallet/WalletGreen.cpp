@@ -32,18 +32,23 @@
 
 #include <algorithm>
 #include <ctime>
+#include <iterator>
 #include <cassert>
 #include <numeric>
 #include <random>
 #include <set>
+#include <thread>
 #include <tuple>
 #include <utility>
 
 #include <System/EventLock.h>
+#include <System/InterruptedException.h>
 #include <System/RemoteContext.h>
+#include <System/Timer.h>
 
 #include "ITransaction.h"
 
+#include "Common/ParallelFor.h"
 #include "Common/ScopeExit.h"
 #include "Common/ShuffleGenerator.h"
 #include "Common/StdInputStream.h"
@@ -54,6 +59,7 @@
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h"
 #include "CryptoNoteCore/CryptoNoteTools.h"
 #include "CryptoNoteCore/TransactionApi.h"
+#include "CryptoNoteCore/TransactionExtra.h"
 #include "crypto/crypto.h"
 #include "Transfers/TransfersContainer.h"
 #include "WalletSerialization.h"
@@ -263,13 +269,17 @@ WalletGreen::WalletGreen(System::Dispatcher& dispatcher, const Currency& currenc
   m_state(WalletState::NOT_INITIALIZED),
   m_actualBalance(0),
   m_pendingBalance(0),
-  m_transactionSoftLockTime(transactionSoftLockTime)
+  m_transactionSoftLockTime(transactionSoftLockTime),
+  m_fusionPlannerStarted(false),
+  m_fusionPlannerContext(m_dispatcher)
 {
   m_upperTransactionSizeLimit = m_currency.blockGrantedFullRewardZone() * 2 - m_currency.minerTxBlobReservedSize();
   m_readyEvent.set();
 }
 
 WalletGreen::~WalletGreen() {
+  stopFusionPlanner();
+
   if (m_state == WalletState::INITIALIZED) {
     doShutdown();
   }
@@ -327,6 +337,9 @@ void WalletGreen::clearCaches() {
   m_transactions.clear();
   m_transfers.clear();
   m_uncommitedTransactions.clear();
+  m_paymentIdTransactions.clear();
+  m_addressTransactions.clear();
+  m_fusionOutputsIndices.clear();
   m_actualBalance = 0;
   m_pendingBalance = 0;
   m_fusionTxsCache.clear();
@@ -438,6 +451,7 @@ void WalletGreen::unsafeLoad(std::istream& source, const std::string& password)
 
   StdInputStream inputStream(source);
   s.load(password, inputStream);
+  rebuildTransactionIndices();
 
   m_password = password;
   m_blockchainSynchronizer.addObserver(this);
@@ -628,6 +642,7 @@ void WalletGreen::deleteAddress(const std::string& address) {
   std::vector<size_t> updatedTransactions = deleteTransfersForAddress(address, deletedTransactions);
   deleteFromUncommitedTransactions(deletedTransactions);
 
+  m_fusionOutputsIndices.erase(it->container);
   m_walletsContainer.get<KeysIndex>().erase(it);
 
   if (m_walletsContainer.get<RandomAccessIndex>().size() != 0) {
@@ -765,6 +780,15 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
   std::vector<InputInfo> keysInfo;
   prepareInputs(selectedTransfers, mixinResult, mixIn, keysInfo);
 
+  std::vector<ReceiverAmounts> decomposedOutputs = decomposeTransactionOutputs(foundMoney, donation, changeDestination, preparedTransaction);
+  preparedTransaction.transaction = makeTransaction(decomposedOutputs, keysInfo, extra, unlockTimestamp, std::thread::hardware_concurrency());
+}
+
+std::vector<WalletGreen::ReceiverAmounts> WalletGreen::decomposeTransactionOutputs(uint64_t foundMoney,
+  const DonationSettings& donation,
+  const CryptoNote::AccountPublicAddress& changeDestination,
+  PreparedTransaction& preparedTransaction) {
+
   uint64_t donationAmount = pushDonationTransferIfPossible(donation, foundMoney - preparedTransaction.neededMoney, m_currency.defaultDustThreshold(), preparedTransaction.destinations);
   preparedTransaction.changeAmount = foundMoney - preparedTransaction.neededMoney - donationAmount;
 
@@ -780,7 +804,7 @@ void WalletGreen::prepareTransaction(std::vector<WalletOuts>&& wallets,
     decomposedOutputs.emplace_back(std::move(splittedChange));
   }
 
-  preparedTransaction.transaction = makeTransaction(decomposedOutputs, keysInfo, extra, unlockTimestamp);
+  return decomposedOutputs;
 }
 
 void WalletGreen::validateTransactionParameters(const TransactionParameters& transactionParameters) {
@@ -849,6 +873,200 @@ size_t WalletGreen::doTransfer(const TransactionParameters& transactionParameter
   return validateSaveAndSendTransaction(*preparedTransaction.transaction, preparedTransaction.destinations, false, true);
 }
 
+std::vector<TransferBatchResult> WalletGreen::transferBatch(const std::vector<TransactionParameters>& sendingTransactions) {
+  Tools::ScopeExit releaseContext([this] {
+    m_dispatcher.yield();
+  });
+
+  System::EventLock lk(m_readyEvent);
+
+  throwIfNotInitialized();
+  throwIfTrackingMode();
+  throwIfStopped();
+
+  std::vector<TransferBatchResult> results(sendingTransactions.size());
+
+  //outputs are read once per address and removed as soon as a transaction of the batch takes them
+  std::unordered_map<WalletRecord*, std::vector<TransactionOutputInformation>> unspentOuts;
+  auto pickUnspentOuts = [this, &unspentOuts] (std::vector<WalletOuts>&& wallets) {
+    std::vector<WalletOuts> result;
+    for (auto& wallet: wallets) {
+      auto it = unspentOuts.emplace(wallet.wallet, std::move(wallet.outs)).first;
+      if (!it->second.empty()) {
+        result.push_back({ wallet.wallet, it->second });
+      }
+    }
+
+    return result;
+  };
+
+  //requests short of money while other transactions hold outputs wait for the next round, in case one of those fails
+  std::vector<size_t> pending(sendingTransactions.size());
+  std::iota(pending.begin(), pending.end(), 0);
+  while (!pending.empty()) {
+    std::vector<BatchTransaction> batch;
+    std::vector<size_t> deferred;
+    batch.reserve(pending.size());
+
+    for (size_t i: pending) {
+      const TransactionParameters& transactionParameters = sendingTransactions[i];
+
+      try {
+        validateTransactionParameters(transactionParameters);
+        CryptoNote::AccountPublicAddress changeDestination = getChangeDestination(transactionParameters.changeDestination, transactionParameters.sourceAddresses);
+
+        std::vector<WalletOuts> wallets;
+        if (!transactionParameters.sourceAddresses.empty()) {
+          wallets = pickUnspentOuts(pickWallets(transactionParameters.sourceAddresses));
+        } else {
+          wallets = pickUnspentOuts(pickWalletsWithMoney());
+        }
+
+        BatchTransaction transaction;
+        transaction.requestIndex = i;
+        transaction.preparedTransaction.destinations = convertOrdersToTransfers(transactionParameters.destinations);
+        transaction.preparedTransaction.neededMoney = countNeededMoney(transaction.preparedTransaction.destinations, transactionParameters.fee);
+
+        transaction.foundMoney = selectTransfers(transaction.preparedTransaction.neededMoney, transactionParameters.mixIn == 0,
+          m_currency.defaultDustThreshold(), std::move(wallets), transaction.selectedTransfers);
+
+        if (transaction.foundMoney < transaction.preparedTransaction.neededMoney) {
+          if (!batch.empty()) {
+            deferred.push_back(i);
+            continue;
+          }
+
+          throw std::system_error(make_error_code(error::WRONG_AMOUNT), "Not enough money");
+        }
+
+        for (const auto& selected: transaction.selectedTransfers) {
+          auto& outs = unspentOuts[selected.wallet];
+          outs.erase(std::find_if(outs.begin(), outs.end(), [&selected] (const TransactionOutputInformation& out) {
+            return out.outputKey == selected.out.outputKey;
+          }));
+        }
+
+        transaction.decomposedOutputs = decomposeTransactionOutputs(transaction.foundMoney, transactionParameters.donation, changeDestination,
+          transaction.preparedTransaction);
+        batch.push_back(std::move(transaction));
+      } catch (std::system_error& e) {
+        results[i].error = e.code();
+      } catch (std::exception&) {
+        results[i].error = make_error_code(error::INTERNAL_WALLET_ERROR);
+      }
+    }
+
+    sendBatch(batch, sendingTransactions, results);
+
+    //outputs of the transactions that failed can be spent by the rest of the batch
+    bool outsReturned = false;
+    for (const auto& transaction: batch) {
+      if (results[transaction.requestIndex].error) {
+        for (const auto& selected: transaction.selectedTransfers) {
+          unspentOuts[selected.wallet].push_back(selected.out);
+          outsReturned = true;
+        }
+      }
+    }
+
+    if (!outsReturned) {
+      for (size_t i: deferred) {
+        results[i].error = make_error_code(error::WRONG_AMOUNT);
+      }
+
+      break;
+    }
+
+    pending = std::move(deferred);
+  }
+
+  return results;
+}
+
+void WalletGreen::sendBatch(std::vector<BatchTransaction>& batch, const std::vector<TransactionParameters>& sendingTransactions,
+  std::vector<TransferBatchResult>& results) {
+  requestBatchMixinOuts(batch, sendingTransactions, results);
+
+  for (auto& transaction: batch) {
+    if (!results[transaction.requestIndex].error) {
+      prepareInputs(transaction.selectedTransfers, transaction.mixinResult, sendingTransactions[transaction.requestIndex].mixIn, transaction.keysInfo);
+    }
+  }
+
+  //transactions are built and signed one per thread, the results are only relayed from the dispatcher thread
+  parallelFor(batch.size(), std::thread::hardware_concurrency(), [&](size_t i) {
+    BatchTransaction& transaction = batch[i];
+    TransferBatchResult& result = results[transaction.requestIndex];
+    if (result.error) {
+      return;
+    }
+
+    const TransactionParameters& transactionParameters = sendingTransactions[transaction.requestIndex];
+    try {
+      transaction.preparedTransaction.transaction = makeTransaction(transaction.decomposedOutputs, transaction.keysInfo,
+        transactionParameters.extra, transactionParameters.unlockTimestamp, 1);
+    } catch (std::system_error& e) {
+      result.error = e.code();
+    } catch (std::exception&) {
+      result.error = make_error_code(error::INTERNAL_WALLET_ERROR);
+    }
+  });
+
+  for (auto& transaction: batch) {
+    TransferBatchResult& result = results[transaction.requestIndex];
+    if (result.error) {
+      continue;
+    }
+
+    try {
+      result.transactionId = validateSaveAndSendTransaction(*transaction.preparedTransaction.transaction,
+        transaction.preparedTransaction.destinations, false, true);
+    } catch (std::system_error& e) {
+      result.error = e.code();
+    } catch (std::exception&) {
+      result.error = make_error_code(error::INTERNAL_WALLET_ERROR);
+    }
+  }
+}
+
+void WalletGreen::requestBatchMixinOuts(std::vector<BatchTransaction>& batch, const std::vector<TransactionParameters>& sendingTransactions,
+  std::vector<TransferBatchResult>& results) {
+
+  //one decoy request per distinct mixin covers the inputs of every transaction that uses it
+  std::map<uint64_t, std::vector<BatchTransaction*>> mixInGroups;
+  for (auto& transaction: batch) {
+    uint64_t mixIn = sendingTransactions[transaction.requestIndex].mixIn;
+    if (mixIn != 0) {
+      mixInGroups[mixIn].push_back(&transaction);
+    }
+  }
+
+  for (const auto& group: mixInGroups) {
+    std::vector<OutputToTransfer> selectedTransfers;
+    for (const BatchTransaction* transaction: group.second) {
+      selectedTransfers.insert(selectedTransfers.end(), transaction->selectedTransfers.begin(), transaction->selectedTransfers.end());
+    }
+
+    std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> mixinResult;
+    try {
+      requestMixinOuts(selectedTransfers, group.first, mixinResult);
+    } catch (std::system_error& e) {
+      for (const BatchTransaction* transaction: group.second) {
+        results[transaction->requestIndex].error = e.code();
+      }
+
+      continue;
+    }
+
+    auto mixinIt = mixinResult.begin();
+    for (BatchTransaction* transaction: group.second) {
+      auto mixinEnd = mixinIt + transaction->selectedTransfers.size();
+      transaction->mixinResult.assign(std::make_move_iterator(mixinIt), std::make_move_iterator(mixinEnd));
+      mixinIt = mixinEnd;
+    }
+  }
+}
+
 size_t WalletGreen::makeTransaction(const TransactionParameters& sendingTransaction) {
   throwIfNotInitialized();
   throwIfTrackingMode();
@@ -952,6 +1170,7 @@ void WalletGreen::pushBackOutgoingTransfers(size_t txId, const std::vector<Walle
     d.amount = dest.amount;
 
     m_transfers.emplace_back(txId, std::move(d));
+    indexTransactionTransfer(txId, dest.address);
   }
 }
 
@@ -969,6 +1188,7 @@ size_t WalletGreen::insertOutgoingTransactionAndPushEvent(const Hash& transactio
   insertTx.isBase = false;
 
   size_t txId = m_transactions.get<RandomAccessIndex>().size();
+  indexTransactionPaymentId(txId, insertTx.extra);
   m_transactions.get<RandomAccessIndex>().push_back(std::move(insertTx));
 
   pushEvent(makeTransactionCreatedEvent(txId));
@@ -994,7 +1214,8 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const Crypto
   auto it = std::next(txIdIndex.begin(), transactionId);
 
   bool updated = false;
-  bool r = txIdIndex.modify(it, [&info, totalAmount, &updated](WalletTransaction& transaction) {
+  bool extraUpdated = false;
+  bool r = txIdIndex.modify(it, [&info, totalAmount, &updated, &extraUpdated](WalletTransaction& transaction) {
     if (transaction.blockHeight != info.blockHeight) {
       transaction.blockHeight = info.blockHeight;
       updated = true;
@@ -1024,6 +1245,7 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const Crypto
     if (transaction.extra.empty() && !info.extra.empty()) {
       transaction.extra = Common::asString(info.extra);
       updated = true;
+      extraUpdated = true;
     }
 
     bool isBase = info.totalAmountIn == 0;
@@ -1035,6 +1257,10 @@ bool WalletGreen::updateWalletTransactionInfo(size_t transactionId, const Crypto
 
   assert(r);
 
+  if (extraUpdated) {
+    indexTransactionPaymentId(transactionId, it->extra);
+  }
+
   return updated;
 }
 
@@ -1059,6 +1285,7 @@ size_t WalletGreen::insertBlockchainTransaction(const TransactionInformation& in
   tx.creationTime = info.timestamp;
 
   size_t txId = index.size();
+  indexTransactionPaymentId(txId, tx.extra);
   index.push_back(std::move(tx));
 
   return txId;
@@ -1191,6 +1418,7 @@ void WalletGreen::appendTransfer(size_t transactionId, size_t firstTransferIdx,
 
   WalletTransfer transfer{ WalletTransferType::USUAL, address, amount };
   m_transfers.emplace(insertIt, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+  indexTransactionTransfer(transactionId, address);
 }
 
 bool WalletGreen::adjustTransfer(size_t transactionId, size_t firstTransferIdx, const std::string& address, int64_t amount) {
@@ -1224,6 +1452,7 @@ bool WalletGreen::adjustTransfer(size_t transactionId, size_t firstTransferIdx,
   if (!firstAddressTransferFound) {
     WalletTransfer transfer{ WalletTransferType::USUAL, address, amount };
     m_transfers.emplace(it, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+    indexTransactionTransfer(transactionId, address);
     updated = true;
   }
 
@@ -1261,7 +1490,7 @@ bool WalletGreen::eraseForeignTransfers(size_t transactionId, size_t firstTransf
 }
 
 std::unique_ptr<CryptoNote::ITransaction> WalletGreen::makeTransaction(const std::vector<ReceiverAmounts>& decomposedOutputs,
-  std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp) {
+  std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp, size_t threadCount) {
 
   std::unique_ptr<ITransaction> tx = createTransaction();
 
@@ -1285,15 +1514,34 @@ std::unique_ptr<CryptoNote::ITransaction> WalletGreen::makeTransaction(const std
   tx->setUnlockTime(unlockTimestamp);
   tx->appendExtra(Common::asBinaryArray(extra));
 
-  for (auto& input: keysInfo) {
-    tx->addInput(makeAccountKeys(*input.walletRecord), input.keyInfo, input.ephKeys);
-  }
+  //key derivation and ring signing of inputs dominate the construction time, spread them over the cores
+  std::vector<KeyInput> inputs(keysInfo.size());
+  std::vector<uint8_t> derived(keysInfo.size());
+  parallelFor(keysInfo.size(), threadCount, [&](size_t i) {
+    InputInfo& input = keysInfo[i];
+    inputs[i].amount = input.keyInfo.amount;
+    derived[i] = generate_key_image_helper(makeAccountKeys(*input.walletRecord), input.keyInfo.realOutput.transactionPublicKey,
+      input.keyInfo.realOutput.outputInTransaction, input.ephKeys, inputs[i].keyImage);
+  });
 
-  size_t i = 0;
-  for(auto& input: keysInfo) {
-    tx->signInputKey(i++, input.keyInfo, input.ephKeys);
+  std::vector<std::pair<TransactionTypes::InputKeyInfo, KeyPair>> signingInputs;
+  signingInputs.reserve(keysInfo.size());
+  for (size_t i = 0; i < keysInfo.size(); ++i) {
+    if (!derived[i]) {
+      throw std::system_error(make_error_code(error::INTERNAL_WALLET_ERROR), "Failed to derive input key");
+    }
+
+    for (const auto& out : keysInfo[i].keyInfo.outputs) {
+      inputs[i].outputIndexes.push_back(out.outputIndex);
+    }
+
+    inputs[i].outputIndexes = absolute_output_offsets_to_relative(inputs[i].outputIndexes);
+    tx->addInput(inputs[i]);
+    signingInputs.emplace_back(keysInfo[i].keyInfo, keysInfo[i].ephKeys);
   }
 
+  tx->signInputKeys(signingInputs, threadCount);
+
   return tx;
 }
 
@@ -1622,6 +1870,29 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(uint32_t block
   return getTransactionsInBlocks(blockIndex, count);
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(const Crypto::Hash& blockHash, size_t count, const TransactionsFilter& filter) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  auto& hashIndex = m_blockchain.get<BlockHashIndex>();
+  auto it = hashIndex.find(blockHash);
+  if (it == hashIndex.end()) {
+    return std::vector<TransactionsInBlockInfo>();
+  }
+
+  auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
+
+  uint32_t blockIndex = static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
+  return getTransactionsInBlocks(blockIndex, count, filter);
+}
+
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactions(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const {
+  throwIfNotInitialized();
+  throwIfStopped();
+
+  return getTransactionsInBlocks(blockIndex, count, filter);
+}
+
 std::vector<Crypto::Hash> WalletGreen::getBlockHashes(uint32_t blockIndex, size_t count) const {
   throwIfNotInitialized();
   throwIfStopped();
@@ -1802,6 +2073,7 @@ void WalletGreen::unlockBalances(uint32_t height) {
   if (index.begin() != upper) {
     for (auto it = index.begin(); it != upper; ++it) {
       updateBalance(it->container);
+      updateFusionOutputsIndex(it->container, it->transactionHash);
     }
 
     index.erase(index.begin(), upper);
@@ -1871,6 +2143,7 @@ void WalletGreen::transactionUpdated(const TransactionInformation& transactionIn
   // Update cached balance
   for (auto containerAmounts : containerAmountsList) {
     updateBalance(containerAmounts.container);
+    updateFusionOutputsIndex(containerAmounts.container, transactionInfo.transactionHash);
 
     if (transactionInfo.blockHeight != CryptoNote::WALLET_UNCONFIRMED_TRANSACTION_HEIGHT) {
       uint32_t unlockHeight = std::max(transactionInfo.blockHeight + m_transactionSoftLockTime, static_cast<uint32_t>(transactionInfo.unlockTime));
@@ -1926,6 +2199,8 @@ void WalletGreen::transactionDeleted(ITransfersSubscription* object, const Hash&
   CryptoNote::ITransfersContainer* container = &object->getContainer();
   updateBalance(container);
   deleteUnlockTransactionJob(transactionHash);
+  //outputs spent by the deleted transaction can't be queried any more, so the container is recounted on demand
+  m_fusionOutputsIndices.erase(container);
 
   bool updated = false;
   m_transactions.get<TransactionIndex>().modify(it, [&updated](CryptoNote::WalletTransaction& tx) {
@@ -2131,7 +2406,7 @@ size_t WalletGreen::createFusionTransaction(uint64_t threshold, uint64_t mixin)
     ReceiverAmounts decomposedOutputs = decomposeFusionOutputs(inputsAmount);
     assert(decomposedOutputs.amounts.size() <= MAX_FUSION_OUTPUT_COUNT);
 
-    fusionTransaction = makeTransaction(std::vector<ReceiverAmounts>{decomposedOutputs}, keysInfo, "", 0);
+    fusionTransaction = makeTransaction(std::vector<ReceiverAmounts>{decomposedOutputs}, keysInfo, "", 0, std::thread::hardware_concurrency());
 
     transactionSize = getTransactionSize(*fusionTransaction);
 
@@ -2225,46 +2500,149 @@ IFusionManager::EstimateResult WalletGreen::estimate(uint64_t threshold) const {
   throwIfStopped();
 
   IFusionManager::EstimateResult result{0, 0};
-  auto walletOuts = pickWalletsWithMoney();
-  std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
-  bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
-      uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen)) {
-        assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
+  auto bucketSizes = getFusionBucketSizes(threshold, result.totalOutputCount);
+  for (auto bucketSize : bucketSizes) {
+    if (bucketSize >= m_currency.fusionTxMinInputCount()) {
+      result.fusionReadyCount += bucketSize;
+    }
+  }
+
+  return result;
+}
+
+void WalletGreen::startFusionPlanner(const IFusionManager::PlannerSettings& settings) {
+  if (settings.threshold <= m_currency.defaultDustThreshold()) {
+    throw std::runtime_error("Threshold must be greater than " + std::to_string(m_currency.defaultDustThreshold()));
+  }
+
+  if (settings.maxTransactionsPerRound == 0) {
+    throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "Fusion planner budget must be greater than zero");
+  }
+
+  stopFusionPlanner();
+
+  m_fusionPlannerStarted = true;
+  m_fusionPlannerContext.spawn([this, settings] { runFusionPlanner(settings); });
+}
+
+void WalletGreen::stopFusionPlanner() {
+  if (!m_fusionPlannerStarted) {
+    return;
+  }
+
+  m_fusionPlannerStarted = false;
+  m_fusionPlannerContext.interrupt();
+  m_fusionPlannerContext.wait();
+}
+
+void WalletGreen::runFusionPlanner(IFusionManager::PlannerSettings settings) {
+  System::Timer timer(m_dispatcher);
+
+  try {
+    for (;;) {
+      timer.sleep(settings.roundInterval);
+
+      //the planner outlives shutdown and load, it only skips rounds while the wallet can't spend
+      if (m_state != WalletState::INITIALIZED || m_stopped || getTrackingMode() != WalletTrackingMode::NOT_TRACKING) {
+        continue;
+      }
+
+      try {
+        for (size_t sent = 0; sent < settings.maxTransactionsPerRound; ++sent) {
+          if (estimate(settings.threshold).fusionReadyCount == 0) {
+            break;
+          }
+
+          if (createFusionTransaction(settings.threshold, settings.mixin) == WALLET_INVALID_TRANSACTION_ID) {
+            break;
+          }
+        }
+      } catch (System::InterruptedException&) {
+        throw;
+      } catch (std::exception&) {
+        //e.g. the node rejected the transaction, try again next round
       }
     }
+  } catch (System::InterruptedException&) {
+  }
+}
 
-    result.totalOutputCount += walletOuts[walletIndex].outs.size();
+const FusionOutputsIndex& WalletGreen::getFusionOutputsIndex(const WalletRecord& wallet) const {
+  auto it = m_fusionOutputsIndices.find(wallet.container);
+  if (it != m_fusionOutputsIndices.end()) {
+    return it->second;
   }
 
-  for (auto bucketSize : bucketSizes) {
-    if (bucketSize >= m_currency.fusionTxMinInputCount()) {
-      result.fusionReadyCount += bucketSize;
+  std::vector<TransactionOutputInformation> outs;
+  wallet.container->getOutputs(outs, ITransfersContainer::IncludeKeyUnlocked);
+
+  FusionOutputsIndex index;
+  index.totalOutputCount = outs.size();
+  for (const auto& out : outs) {
+    index.outputs[out.amount].emplace(out.outputKey, out);
+  }
+
+  return m_fusionOutputsIndices.emplace(wallet.container, std::move(index)).first->second;
+}
+
+void WalletGreen::updateFusionOutputsIndex(const ITransfersContainer* container, const Crypto::Hash& transactionHash) {
+  auto it = m_fusionOutputsIndices.find(container);
+  if (it == m_fusionOutputsIndices.end()) {
+    return;
+  }
+
+  FusionOutputsIndex& index = it->second;
+
+  //outputs of the transaction that are unlocked now, already counted ones are kept as they are
+  for (auto& out : container->getTransactionOutputs(transactionHash, ITransfersContainer::IncludeKeyUnlocked)) {
+    if (index.outputs[out.amount].emplace(out.outputKey, out).second) {
+      ++index.totalOutputCount;
     }
   }
 
-  return result;
+  //outputs spent by the transaction
+  for (const auto& in : container->getTransactionInputs(transactionHash, ITransfersContainer::IncludeTypeKey)) {
+    auto amountIt = index.outputs.find(in.amount);
+    if (amountIt == index.outputs.end() || amountIt->second.erase(in.outputKey) == 0) {
+      continue;
+    }
+
+    --index.totalOutputCount;
+    if (amountIt->second.empty()) {
+      index.outputs.erase(amountIt);
+    }
+  }
 }
 
-std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(uint64_t threshold, size_t minInputCount, size_t maxInputCount) {
-  std::vector<WalletGreen::OutputToTransfer> allFusionReadyOuts;
-  auto walletOuts = pickWalletsWithMoney();
+std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> WalletGreen::getFusionBucketSizes(uint64_t threshold, size_t& totalOutputCount) const {
   std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> bucketSizes;
   bucketSizes.fill(0);
-  for (size_t walletIndex = 0; walletIndex < walletOuts.size(); ++walletIndex) {
-    for (auto& out : walletOuts[walletIndex].outs) {
+  totalOutputCount = 0;
+
+  for (const auto& wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+    if (wallet.actualBalance == 0) {
+      continue;
+    }
+
+    const FusionOutputsIndex& index = getFusionOutputsIndex(wallet);
+    for (auto it = index.outputs.begin(); it != index.outputs.end() && it->first < threshold; ++it) {
       uint8_t powerOfTen = 0;
-      if (m_currency.isAmountApplicableInFusionTransactionInput(out.amount, threshold, powerOfTen)) {
-        allFusionReadyOuts.push_back({std::move(out), walletOuts[walletIndex].wallet});
+      if (m_currency.isAmountApplicableInFusionTransactionInput(it->first, threshold, powerOfTen)) {
         assert(powerOfTen < std::numeric_limits<uint64_t>::digits10 + 1);
-        bucketSizes[powerOfTen]++;
+        bucketSizes[powerOfTen] += it->second.size();
       }
     }
+
+    totalOutputCount += index.totalOutputCount;
   }
 
+  return bucketSizes;
+}
+
+std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(uint64_t threshold, size_t minInputCount, size_t maxInputCount) {
+  size_t totalOutputCount;
+  auto bucketSizes = getFusionBucketSizes(threshold, totalOutputCount);
+
   //now, pick the bucket
   std::vector<uint8_t> bucketNumbers(bucketSizes.size());
   std::iota(bucketNumbers.begin(), bucketNumbers.end(), 0);
@@ -2289,15 +2667,31 @@ std::vector<WalletGreen::OutputToTransfer> WalletGreen::pickRandomFusionInputs(u
   }
    
   uint64_t upperBound = selectedBucket == std::numeric_limits<uint64_t>::digits10 ? UINT64_MAX : lowerBound * 10;
+  upperBound = std::min(upperBound, threshold);
+
+  //the selected bucket is read from the indices, containers aren't scanned again
   std::vector<WalletGreen::OutputToTransfer> selectedOuts;
   selectedOuts.reserve(bucketSizes[selectedBucket]);
-  for (size_t outIndex = 0; outIndex < allFusionReadyOuts.size(); ++outIndex) {
-    if (allFusionReadyOuts[outIndex].out.amount >= lowerBound && allFusionReadyOuts[outIndex].out.amount < upperBound) {
-      selectedOuts.push_back(std::move(allFusionReadyOuts[outIndex]));
+  for (const auto& wallet : m_walletsContainer.get<RandomAccessIndex>()) {
+    if (wallet.actualBalance == 0) {
+      continue;
+    }
+
+    const FusionOutputsIndex& index = getFusionOutputsIndex(wallet);
+    for (auto it = index.outputs.lower_bound(lowerBound); it != index.outputs.end() && it->first < upperBound; ++it) {
+      if (!m_currency.isAmountApplicableInFusionTransactionInput(it->first, threshold)) {
+        continue;
+      }
+
+      for (const auto& out : it->second) {
+        selectedOuts.push_back({out.second, const_cast<WalletRecord *>(&wallet)});
+      }
     }
   }
 
-  assert(selectedOuts.size() >= minInputCount);
+  if (selectedOuts.size() < minInputCount) {
+    return {};
+  }
 
   auto outputsSortingFunction = [](const OutputToTransfer& l, const OutputToTransfer& r) { return l.out.amount < r.out.amount; };
   if (selectedOuts.size() <= maxInputCount) {
@@ -2355,6 +2749,73 @@ std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32
   return result;
 }
 
+std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const {
+  if (!filter.hasPaymentId && filter.addresses.empty()) {
+    return getTransactionsInBlocks(blockIndex, count);
+  }
+
+  if (count == 0) {
+    throw std::system_error(make_error_code(error::WRONG_PARAMETERS), "blocks count must be greater than zero");
+  }
+
+  std::vector<TransactionsInBlockInfo> result;
+
+  if (blockIndex >= m_blockchain.size()) {
+    return result;
+  }
+
+  uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
+
+  result.resize(stopIndex - blockIndex);
+  for (uint32_t height = blockIndex; height < stopIndex; ++height) {
+    result[height - blockIndex].blockHash = m_blockchain[height];
+  }
+
+  //only transactions from the indices are visited, so the cost doesn't depend on the size of the range
+  std::unordered_set<std::string> addresses(filter.addresses.begin(), filter.addresses.end());
+  std::set<size_t> candidates;
+  if (filter.hasPaymentId) {
+    auto it = m_paymentIdTransactions.find(filter.paymentId);
+    if (it != m_paymentIdTransactions.end()) {
+      candidates = it->second;
+    }
+  } else {
+    for (const auto& address: addresses) {
+      auto it = m_addressTransactions.find(address);
+      if (it != m_addressTransactions.end()) {
+        candidates.insert(it->second.begin(), it->second.end());
+      }
+    }
+  }
+
+  auto& transactionIdIndex = m_transactions.get<RandomAccessIndex>();
+  for (size_t transactionId: candidates) {
+    const WalletTransaction& walletTransaction = transactionIdIndex[transactionId];
+    if (walletTransaction.state != WalletTransactionState::SUCCEEDED ||
+        walletTransaction.blockHeight < blockIndex || walletTransaction.blockHeight >= stopIndex) {
+      continue;
+    }
+
+    WalletTransactionWithTransfers transaction;
+    transaction.transaction = walletTransaction;
+    transaction.transfers = getTransactionTransfers(walletTransaction);
+
+    if (!addresses.empty()) {
+      auto transferIt = std::find_if(transaction.transfers.begin(), transaction.transfers.end(), [&addresses](const WalletTransfer& transfer) {
+        return addresses.count(transfer.address) != 0;
+      });
+
+      if (transferIt == transaction.transfers.end()) {
+        continue;
+      }
+    }
+
+    result[walletTransaction.blockHeight - blockIndex].transactions.emplace_back(std::move(transaction));
+  }
+
+  return result;
+}
+
 Crypto::Hash WalletGreen::getBlockHashByIndex(uint32_t blockIndex) const {
   assert(blockIndex < m_blockchain.size());
   return m_blockchain.get<BlockHeightIndex>()[blockIndex];
@@ -2513,4 +2974,31 @@ void WalletGreen::deleteFromUncommitedTransactions(const std::vector<size_t>& de
   }
 }
 
+void WalletGreen::indexTransactionPaymentId(size_t transactionId, const std::string& extra) {
+  Crypto::Hash paymentId;
+  if (getPaymentIdFromTxExtra(Common::asBinaryArray(extra), paymentId)) {
+    m_paymentIdTransactions[paymentId].insert(transactionId);
+  }
+}
+
+void WalletGreen::indexTransactionTransfer(size_t transactionId, const std::string& address) {
+  if (!address.empty()) {
+    m_addressTransactions[address].insert(transactionId);
+  }
+}
+
+void WalletGreen::rebuildTransactionIndices() {
+  m_paymentIdTransactions.clear();
+  m_addressTransactions.clear();
+
+  auto& index = m_transactions.get<RandomAccessIndex>();
+  for (size_t transactionId = 0; transactionId < index.size(); ++transactionId) {
+    indexTransactionPaymentId(transactionId, index[transactionId].extra);
+  }
+
+  for (const auto& transfer: m_transfers) {
+    indexTransactionTransfer(transfer.first, transfer.second.address);
+  }
+}
+
 } //namespace CryptoNote
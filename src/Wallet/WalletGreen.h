@@ -32,12 +32,15 @@
 
 #include "IWallet.h"
 
+#include <array>
+#include <limits>
 #include <queue>
 #include <unordered_map>
 
 #include "IFusionManager.h"
 #include "WalletIndices.h"
 
+#include <System/ContextGroup.h>
 #include <System/Dispatcher.h>
 #include <System/Event.h>
 #include "Transfers/TransfersSynchronizer.h"
@@ -85,12 +88,15 @@ public:
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const override;
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count, const TransactionsFilter& filter) const override;
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const override;
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const override;
   virtual uint32_t getBlockCount() const override;
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override;
   virtual std::vector<size_t> getDelayedTransactionIds() const override;
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override;
+  virtual std::vector<TransferBatchResult> transferBatch(const std::vector<TransactionParameters>& sendingTransactions) override;
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override;
   virtual void commitTransaction(size_t) override;
@@ -103,6 +109,8 @@ public:
   virtual size_t createFusionTransaction(uint64_t threshold, uint64_t mixin) override;
   virtual bool isFusionTransaction(size_t transactionId) const override;
   virtual IFusionManager::EstimateResult estimate(uint64_t threshold) const override;
+  virtual void startFusionPlanner(const IFusionManager::PlannerSettings& settings) override;
+  virtual void stopFusionPlanner() override;
 
 protected:
   void throwIfNotInitialized() const;
@@ -210,6 +218,26 @@ protected:
     const DonationSettings& donation,
     const CryptoNote::AccountPublicAddress& changeDestinationAddress,
     PreparedTransaction& preparedTransaction);
+  std::vector<ReceiverAmounts> decomposeTransactionOutputs(uint64_t foundMoney,
+    const DonationSettings& donation,
+    const CryptoNote::AccountPublicAddress& changeDestination,
+    PreparedTransaction& preparedTransaction);
+
+  //transaction of a payout batch between output selection and relay
+  struct BatchTransaction {
+    size_t requestIndex;
+    uint64_t foundMoney;
+    std::vector<OutputToTransfer> selectedTransfers;
+    std::vector<CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::outs_for_amount> mixinResult;
+    std::vector<ReceiverAmounts> decomposedOutputs;
+    std::vector<InputInfo> keysInfo;
+    PreparedTransaction preparedTransaction;
+  };
+
+  void sendBatch(std::vector<BatchTransaction>& batch, const std::vector<TransactionParameters>& sendingTransactions,
+    std::vector<TransferBatchResult>& results);
+  void requestBatchMixinOuts(std::vector<BatchTransaction>& batch, const std::vector<TransactionParameters>& sendingTransactions,
+    std::vector<TransferBatchResult>& results);
 
   void validateTransactionParameters(const TransactionParameters& transactionParameters);
   size_t doTransfer(const TransactionParameters& transactionParameters);
@@ -234,7 +262,7 @@ protected:
   ReceiverAmounts splitAmount(uint64_t amount, const AccountPublicAddress& destination, uint64_t dustThreshold);
 
   std::unique_ptr<CryptoNote::ITransaction> makeTransaction(const std::vector<ReceiverAmounts>& decomposedOutputs,
-    std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp);
+    std::vector<InputInfo>& keysInfo, const std::string& extra, uint64_t unlockTimestamp, size_t threadCount);
 
   void sendTransaction(const CryptoNote::Transaction& cryptoNoteTransaction);
   size_t validateSaveAndSendTransaction(const ITransactionReader& transaction, const std::vector<WalletTransfer>& destinations, bool isFusion, bool send);
@@ -266,6 +294,10 @@ protected:
   void unsafeSave(std::ostream& destination, bool saveDetails, bool saveCache);
 
   std::vector<OutputToTransfer> pickRandomFusionInputs(uint64_t threshold, size_t minInputCount, size_t maxInputCount);
+  const FusionOutputsIndex& getFusionOutputsIndex(const WalletRecord& wallet) const;
+  void updateFusionOutputsIndex(const ITransfersContainer* container, const Crypto::Hash& transactionHash);
+  std::array<size_t, std::numeric_limits<uint64_t>::digits10 + 1> getFusionBucketSizes(uint64_t threshold, size_t& totalOutputCount) const;
+  void runFusionPlanner(IFusionManager::PlannerSettings settings);
   ReceiverAmounts decomposeFusionOutputs(uint64_t inputsAmount);
 
   enum class WalletState {
@@ -283,6 +315,7 @@ protected:
 
   TransfersRange getTransactionTransfersRange(size_t transactionIndex) const;
   std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count) const;
+  std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const;
   Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const;
 
   std::vector<WalletTransfer> getTransactionTransfers(const WalletTransaction& transaction) const;
@@ -295,6 +328,10 @@ protected:
   std::vector<size_t> deleteTransfersForAddress(const std::string& address, std::vector<size_t>& deletedTransactions);
   void deleteFromUncommitedTransactions(const std::vector<size_t>& deletedTransactions);
 
+  void indexTransactionPaymentId(size_t transactionId, const std::string& extra);
+  void indexTransactionTransfer(size_t transactionId, const std::string& address);
+  void rebuildTransactionIndices();
+
   System::Dispatcher& m_dispatcher;
   const Currency& m_currency;
   INode& m_node;
@@ -306,6 +343,9 @@ protected:
   WalletTransfers m_transfers; //sorted
   mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
   UncommitedTransactions m_uncommitedTransactions;
+  PaymentIdTransactionsIndex m_paymentIdTransactions;
+  AddressTransactionsIndex m_addressTransactions;
+  mutable FusionOutputsIndices m_fusionOutputsIndices;
 
   bool m_blockchainSynchronizerStarted;
   BlockchainSynchronizer m_blockchainSynchronizer;
@@ -329,6 +369,9 @@ protected:
   uint32_t m_transactionSoftLockTime;
 
   BlockHashesContainer m_blockchain;
+
+  bool m_fusionPlannerStarted;
+  System::ContextGroup m_fusionPlannerContext;
 };
 
 } //namespace CryptoNote
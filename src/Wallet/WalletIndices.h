@@ -31,6 +31,7 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <unordered_map>
 
 #include "ITransfersContainer.h"
@@ -115,6 +116,21 @@ typedef std::pair<size_t, CryptoNote::WalletTransfer> TransactionTransferPair;
 typedef std::vector<TransactionTransferPair> WalletTransfers;
 typedef std::map<size_t, CryptoNote::Transaction> UncommitedTransactions;
 
+// Transaction ids grouped by payment id and by transfer address. They are rebuilt on load and only grow
+// afterwards, so the address index may still list a transaction whose transfers to that address were removed.
+typedef std::unordered_map<Crypto::Hash, std::set<size_t>> PaymentIdTransactionsIndex;
+typedef std::unordered_map<std::string, std::set<size_t>> AddressTransactionsIndex;
+
+// Unlocked key outputs of one container by amount and output key. It is built once by a full scan and then kept
+// up to date from the transactions the container reports, so a threshold splits the amounts into decade buckets
+// and fusion inputs are picked from a bucket without rescanning the container.
+struct FusionOutputsIndex {
+  std::map<uint64_t, std::unordered_map<Crypto::PublicKey, TransactionOutputInformation>> outputs;
+  size_t totalOutputCount = 0;
+};
+
+typedef std::unordered_map<const ITransfersContainer*, FusionOutputsIndex> FusionOutputsIndices;
+
 typedef boost::multi_index_container<
   Crypto::Hash,
   boost::multi_index::indexed_by <
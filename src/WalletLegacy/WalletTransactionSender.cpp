@@ -41,6 +41,7 @@
 #include <Logging/LoggerGroup.h>
 
 #include <random>
+#include <thread>
 
 using namespace Crypto;
 
@@ -75,7 +76,7 @@ void constructTx(const AccountKeys keys, const std::vector<TransactionSourceEntr
   std::for_each(extra.begin(), extra.end(), [&extraVec] (const char el) { extraVec.push_back(el);});
 
   Logging::LoggerGroup nullLog;
-  bool r = constructTransaction(keys, sources, splittedDests, extraVec, tx, unlockTimestamp, nullLog);
+  bool r = constructTransaction(keys, sources, splittedDests, extraVec, tx, unlockTimestamp, nullLog, std::thread::hardware_concurrency());
 
   throwIf(!r, error::INTERNAL_WALLET_ERROR);
   throwIf(getObjectBinarySize(tx) >= sizeLimit, error::TRANSACTION_SIZE_TOO_BIG);
@@ -356,7 +356,22 @@ namespace Crypto {
     const PublicKey *const *pubs, size_t pubs_count,
     const SecretKey &sec, size_t sec_index,
     Signature *sig) {
+    EllipticCurveScalar *const randomness = reinterpret_cast<EllipticCurveScalar *>(alloca(ring_signature_randomness_size(pubs_count) * sizeof(EllipticCurveScalar)));
+    generate_ring_signature_randomness(pubs_count, randomness);
+    generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, randomness, sig);
+  }
+
+  void crypto_ops::generate_ring_signature_randomness(size_t pubs_count, EllipticCurveScalar *randomness) {
     lock_guard<mutex> lock(random_lock);
+    for (size_t i = 0; i < ring_signature_randomness_size(pubs_count); i++) {
+      random_scalar(randomness[i]);
+    }
+  }
+
+  void crypto_ops::generate_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const PublicKey *const *pubs, size_t pubs_count,
+    const SecretKey &sec, size_t sec_index,
+    const EllipticCurveScalar *randomness, Signature *sig) {
     size_t i;
     ge_p3 image_unp;
     ge_dsmp image_pre;
@@ -389,15 +404,15 @@ namespace Crypto {
       ge_p2 tmp2;
       ge_p3 tmp3;
       if (i == sec_index) {
-        random_scalar(k);
+        k = *randomness++;
         ge_scalarmult_base(&tmp3, reinterpret_cast<unsigned char*>(&k));
         ge_p3_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].a), &tmp3);
         hash_to_ec(*pubs[i], tmp3);
         ge_scalarmult(&tmp2, reinterpret_cast<unsigned char*>(&k), &tmp3);
         ge_tobytes(reinterpret_cast<unsigned char*>(&buf->ab[i].b), &tmp2);
       } else {
-        random_scalar(reinterpret_cast<EllipticCurveScalar&>(sig[i]));
-        random_scalar(*reinterpret_cast<EllipticCurveScalar*>(reinterpret_cast<unsigned char*>(&sig[i]) + 32));
+        reinterpret_cast<EllipticCurveScalar&>(sig[i]) = *randomness++;
+        *reinterpret_cast<EllipticCurveScalar*>(reinterpret_cast<unsigned char*>(&sig[i]) + 32) = *randomness++;
         if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char*>(&*pubs[i])) != 0) {
           abort();
         }
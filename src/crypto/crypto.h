@@ -101,6 +101,12 @@ struct EllipticCurveScalar {
       const PublicKey *const *, size_t, const SecretKey &, size_t, Signature *);
     friend void generate_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const SecretKey &, size_t, Signature *);
+    static void generate_ring_signature_randomness(size_t, EllipticCurveScalar *);
+    friend void generate_ring_signature_randomness(size_t, EllipticCurveScalar *);
+    static void generate_ring_signature(const Hash &, const KeyImage &,
+      const PublicKey *const *, size_t, const SecretKey &, size_t, const EllipticCurveScalar *, Signature *);
+    friend void generate_ring_signature(const Hash &, const KeyImage &,
+      const PublicKey *const *, size_t, const SecretKey &, size_t, const EllipticCurveScalar *, Signature *);
     static bool check_ring_signature(const Hash &, const KeyImage &,
       const PublicKey *const *, size_t, const Signature *);
     friend bool check_ring_signature(const Hash &, const KeyImage &,
@@ -242,6 +248,25 @@ struct EllipticCurveScalar {
     Signature *sig) {
     crypto_ops::generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, sig);
   }
+
+  /* Ring signature split in two steps: the random scalars are drawn first (under the random lock, in the
+   * order generate_ring_signature above draws them), the signature is then computed without the lock.
+   * Drawing the scalars of several signatures in a fixed order lets them be computed in parallel with the
+   * same result as signing one after another.
+   */
+  inline std::size_t ring_signature_randomness_size(std::size_t pubs_count) {
+    // an empty ring draws nothing, 2 * 0 - 1 would wrap around
+    return pubs_count == 0 ? 0 : 2 * pubs_count - 1;
+  }
+  inline void generate_ring_signature_randomness(std::size_t pubs_count, EllipticCurveScalar *randomness) {
+    crypto_ops::generate_ring_signature_randomness(pubs_count, randomness);
+  }
+  inline void generate_ring_signature(const Hash &prefix_hash, const KeyImage &image,
+    const PublicKey *const *pubs, std::size_t pubs_count,
+    const SecretKey &sec, std::size_t sec_index,
+    const EllipticCurveScalar *randomness, Signature *sig) {
+    crypto_ops::generate_ring_signature(prefix_hash, image, pubs, pubs_count, sec, sec_index, randomness, sig);
+  }
   inline bool check_ring_signature(const Hash &prefix_hash, const KeyImage &image,
     const PublicKey *const *pubs, size_t pubs_count,
     const Signature *sig) {
@@ -73,12 +73,17 @@ void hash_process(union hash_state *state, const uint8_t *buf, size_t count);
 enum {
   HASH_SIZE = 32,
   HASH_DATA_AREA = 136,
-  SLOW_HASH_CONTEXT_SIZE = 2097552
+  SLOW_HASH_CONTEXT_SIZE = 2097552,
+  SLOW_HASH_SCRATCHPAD_SIZE = 2097152,
+  SLOW_HASH_MAX_WAYS = 4
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
 
 void cn_slow_hash_f(void *, const void *, size_t, void *);
+// Computes count (1..SLOW_HASH_MAX_WAYS) independent slow hashes at once, each one
+// using its own 16-byte aligned scratchpad of SLOW_HASH_SCRATCHPAD_SIZE bytes
+void cn_slow_hash_multi(void *const *scratchpads, const void *const *data, const size_t *lengths, void *const *hashes, size_t count);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
 void hash_extra_groestl(const void *data, size_t length, char *hash);
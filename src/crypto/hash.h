@@ -75,6 +75,35 @@ namespace Crypto {
     (*cn_slow_hash_f)(context.data, data, length, reinterpret_cast<void *>(&hash));
   }
 
+  /*
+    Scratchpads for up to SLOW_HASH_MAX_WAYS hashes computed together by cn_slow_hash_multi.
+    Backed by huge pages when the system provides them, by regular pages otherwise.
+  */
+  class cn_multi_context {
+  public:
+
+    explicit cn_multi_context(size_t ways = SLOW_HASH_MAX_WAYS);
+    ~cn_multi_context();
+#if !defined(_MSC_VER) || _MSC_VER >= 1800
+    cn_multi_context(const cn_multi_context &) = delete;
+    void operator=(const cn_multi_context &) = delete;
+#endif
+
+    size_t ways() const { return count; }
+    bool hugePages() const { return huge; }
+
+  private:
+
+    void *data;
+    size_t count;
+    size_t size;
+    bool huge;
+    friend void cn_slow_hash_multi(cn_multi_context &, const void *const *, const size_t *, Hash *, size_t);
+  };
+
+  // Computes count (1..context.ways()) independent slow hashes, interleaving their memory-hard loops
+  void cn_slow_hash_multi(cn_multi_context &context, const void *const *data, const size_t *lengths, Hash *hashes, size_t count);
+
   inline void tree_hash(const Hash *hashes, size_t count, Hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
@@ -53,6 +53,12 @@ void cn_slow_hash_f(void * a, const void * b, size_t c, void * d){
 (*cn_slow_hash_fp)(a, b, c, d);
 }
 
+void (*cn_slow_hash_multi_fp)(void *const *, const void *const *, const size_t *, void *const *, size_t);
+
+void cn_slow_hash_multi(void *const *scratchpads, const void *const *data, const size_t *lengths, void *const *hashes, size_t count) {
+  (*cn_slow_hash_multi_fp)(scratchpads, data, lengths, hashes, count);
+}
+
 #if defined(__GNUC__)
 #define likely(x) (__builtin_expect(!!(x), 1))
 #define unlikely(x) (__builtin_expect(!!(x), 0))
@@ -102,6 +108,17 @@ struct cn_ctx {
 };
 
 static_assert(sizeof(struct cn_ctx) == SLOW_HASH_CONTEXT_SIZE, "Invalid structure size");
+static_assert(MEMORY == SLOW_HASH_SCRATCHPAD_SIZE, "Invalid scratchpad size");
+
+/* Per-hash state of the multi-way variant; the scratchpad lives outside, see cn_slow_hash_multi */
+struct cn_way {
+  ALIGNED_DECL(union cn_slow_hash_state state, 16);
+  ALIGNED_DECL(uint8_t text[INIT_SIZE_BYTE], 16);
+  ALIGNED_DECL(uint8_t expanded_key[256], 16);
+  ALIGNED_DECL(uint64_t a[AES_BLOCK_SIZE >> 3], 16);
+  ALIGNED_DECL(uint64_t b[AES_BLOCK_SIZE >> 3], 16);
+  uint8_t *long_state;
+};
 
 static inline void ExpandAESKey256_sub1(__m128i *tmp1, __m128i *tmp2)
 {
@@ -203,4 +220,5 @@ INITIALIZER(detect_aes) {
   __cpuid(1, a, b, ecx, d);
 #endif
   cn_slow_hash_fp = (ecx & (1 << 25)) ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
+  cn_slow_hash_multi_fp = (ecx & (1 << 25)) ? &cn_slow_hash_multi_aesni : &cn_slow_hash_multi_noaesni;
 }
@@ -28,6 +28,9 @@
 // 
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <new>
 
 #include "hash.h"
@@ -61,18 +64,81 @@ namespace Crypto {
     }
   }
 
+  cn_multi_context::cn_multi_context(size_t ways) : data(nullptr), count(ways), size(ways * SLOW_HASH_SCRATCHPAD_SIZE), huge(false) {
+    assert(ways >= 1 && ways <= SLOW_HASH_MAX_WAYS);
+    // Large pages need SeLockMemoryPrivilege, without it the allocation simply fails
+    SIZE_T largePageSize = GetLargePageMinimum();
+    if (largePageSize != 0 && size % largePageSize == 0) {
+      data = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+      huge = data != nullptr;
+    }
+
+    if (data == nullptr) {
+      data = VirtualAlloc(nullptr, size, MEM_COMMIT, PAGE_READWRITE);
+      if (data == nullptr) {
+        throw bad_alloc();
+      }
+    }
+  }
+
+  cn_multi_context::~cn_multi_context() {
+    if (!VirtualFree(data, 0, MEM_RELEASE)) {
+      throw bad_alloc();
+    }
+  }
+
 #else
 
-  cn_context::cn_context() {
-#if !defined(__APPLE__)
-    data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+  namespace {
+
+    const size_t HUGE_PAGE_SIZE = 1 << 21;
+
+    // Maps size bytes starting at a huge page boundary, so that transparent huge pages can back them
+    void *mapHugePageAligned(size_t size) {
+      size_t padded = size + HUGE_PAGE_SIZE;
+      void *mapping = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+      if (mapping == MAP_FAILED) {
+        return MAP_FAILED;
+      }
+
+      uintptr_t begin = reinterpret_cast<uintptr_t>(mapping);
+      uintptr_t aligned = (begin + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1);
+      uintptr_t end = begin + padded;
+      if (aligned != begin) {
+        munmap(mapping, aligned - begin);
+      }
+
+      if (aligned + size != end) {
+        munmap(reinterpret_cast<void *>(aligned + size), end - aligned - size);
+      }
+
+      return reinterpret_cast<void *>(aligned);
+    }
+
+    bool adviseHugePages(void *data, size_t size) {
+#if defined(MADV_HUGEPAGE)
+      return madvise(data, size, MADV_HUGEPAGE) == 0;
 #else
-    data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+      return false;
 #endif
+    }
+
+    // Faults the pages in after the advice, so they are allocated huge when possible
+    void populate(void *data, size_t size) {
+      memset(data, 0, size);
+      mlock(data, size);
+    }
+
+  }
+
+  cn_context::cn_context() {
+    data = mapHugePageAligned(MAP_SIZE);
     if (data == MAP_FAILED) {
       throw bad_alloc();
     }
-    mlock(data, MAP_SIZE);
+
+    adviseHugePages(data, MAP_SIZE);
+    populate(data, MAP_SIZE);
   }
 
   cn_context::~cn_context() {
@@ -81,6 +147,45 @@ namespace Crypto {
     }
   }
 
+  cn_multi_context::cn_multi_context(size_t ways) : data(MAP_FAILED), count(ways), size(ways * SLOW_HASH_SCRATCHPAD_SIZE), huge(false) {
+    assert(ways >= 1 && ways <= SLOW_HASH_MAX_WAYS);
+#if defined(MAP_HUGETLB)
+    // Explicit huge pages are reserved at mmap time, so this fails cleanly when the pool is too small
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (data != MAP_FAILED) {
+      huge = true;
+      mlock(data, size);
+      return;
+    }
+#endif
+
+    data = mapHugePageAligned(size);
+    if (data == MAP_FAILED) {
+      throw bad_alloc();
+    }
+
+    huge = adviseHugePages(data, size);
+    populate(data, size);
+  }
+
+  cn_multi_context::~cn_multi_context() {
+    if (munmap(data, size) != 0) {
+      throw bad_alloc();
+    }
+  }
+
 #endif
 
+  void cn_slow_hash_multi(cn_multi_context &context, const void *const *data, const size_t *lengths, Hash *hashes, size_t count) {
+    assert(count >= 1 && count <= context.count);
+    void *scratchpads[SLOW_HASH_MAX_WAYS];
+    void *results[SLOW_HASH_MAX_WAYS];
+    for (size_t i = 0; i < count; ++i) {
+      scratchpads[i] = static_cast<char *>(context.data) + i * SLOW_HASH_SCRATCHPAD_SIZE;
+      results[i] = &hashes[i];
+    }
+
+    cn_slow_hash_multi(scratchpads, data, lengths, results, count);
+  }
+
 }
@@ -212,3 +212,214 @@ cn_slow_hash_noaesni
   hash_permutation(&ctx->state.hs);
   extra_hashes[ctx->state.hs.b[0] & 3](&ctx->state, 200, hash);
 }
+
+/*
+  Multi-way variant: computes up to SLOW_HASH_MAX_WAYS independent hashes per call.
+  The scratchpad fill and the final implode run way after way, while the memory-hard
+  loops of all ways are interleaved, so the AES round and the scratchpad accesses of one
+  way overlap with the dependency chains of the others.
+*/
+
+#if defined(AESNI)
+#define SLOW_HASH_VARIANT(name) name##_aesni
+#else
+#define SLOW_HASH_VARIANT(name) name##_noaesni
+#endif
+
+static inline void SLOW_HASH_VARIANT(cn_pseudo_rounds)(__m128i *xmminput, const __m128i *expkey)
+{
+#if defined(AESNI)
+  for(size_t j = 0; j < 10; j++)
+  {
+    xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
+    xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
+    xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
+    xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
+    xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
+    xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
+    xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
+    xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
+  }
+#else
+  for(size_t j = 0; j < INIT_SIZE_BLK; j++)
+  {
+    aesb_pseudo_round((uint8_t *) &xmminput[j], (uint8_t *) &xmminput[j], (uint8_t *) expkey);
+  }
+#endif
+}
+
+static inline void SLOW_HASH_VARIANT(cn_expand_key)(struct cn_way *way, const uint8_t *key)
+{
+#if defined(AESNI)
+  memcpy(way->expanded_key, key, AES_KEY_SIZE);
+  ExpandAESKey256(way->expanded_key);
+#else
+  oaes_ctx *aes_ctx = (oaes_ctx *) oaes_alloc();
+  oaes_key_import_data(aes_ctx, key, AES_KEY_SIZE);
+  memcpy(way->expanded_key, aes_ctx->key->exp_data, aes_ctx->key->exp_data_len);
+  oaes_free((OAES_CTX **) &aes_ctx);
+#endif
+}
+
+static inline void SLOW_HASH_VARIANT(cn_explode)(struct cn_way *way, const void *data, size_t length)
+{
+  __m128i *longoutput = (__m128i *) way->long_state;
+  __m128i *xmminput = (__m128i *) way->text;
+  size_t i;
+
+  hash_process(&way->state.hs, (const uint8_t*) data, length);
+  memcpy(way->text, way->state.init, INIT_SIZE_BYTE);
+  SLOW_HASH_VARIANT(cn_expand_key)(way, way->state.hs.b);
+
+  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  {
+    SLOW_HASH_VARIANT(cn_pseudo_rounds)(xmminput, (const __m128i *) way->expanded_key);
+    _mm_store_si128(&(longoutput[(i >> 4)]), xmminput[0]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 1]), xmminput[1]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 2]), xmminput[2]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 3]), xmminput[3]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 4]), xmminput[4]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 5]), xmminput[5]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 6]), xmminput[6]);
+    _mm_store_si128(&(longoutput[(i >> 4) + 7]), xmminput[7]);
+  }
+
+  for (i = 0; i < 2; i++)
+  {
+    way->a[i] = ((uint64_t *)way->state.k)[i] ^  ((uint64_t *)way->state.k)[i+4];
+    way->b[i] = ((uint64_t *)way->state.k)[i+2] ^  ((uint64_t *)way->state.k)[i+6];
+  }
+}
+
+static inline void SLOW_HASH_VARIANT(cn_implode)(struct cn_way *way, void *hash)
+{
+  __m128i *longoutput = (__m128i *) way->long_state;
+  __m128i *xmminput = (__m128i *) way->text;
+  size_t i;
+
+  memcpy(way->text, way->state.init, INIT_SIZE_BYTE);
+  SLOW_HASH_VARIANT(cn_expand_key)(way, &way->state.hs.b[32]);
+
+  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  {
+    xmminput[0] = _mm_xor_si128(longoutput[(i >> 4)], xmminput[0]);
+    xmminput[1] = _mm_xor_si128(longoutput[(i >> 4) + 1], xmminput[1]);
+    xmminput[2] = _mm_xor_si128(longoutput[(i >> 4) + 2], xmminput[2]);
+    xmminput[3] = _mm_xor_si128(longoutput[(i >> 4) + 3], xmminput[3]);
+    xmminput[4] = _mm_xor_si128(longoutput[(i >> 4) + 4], xmminput[4]);
+    xmminput[5] = _mm_xor_si128(longoutput[(i >> 4) + 5], xmminput[5]);
+    xmminput[6] = _mm_xor_si128(longoutput[(i >> 4) + 6], xmminput[6]);
+    xmminput[7] = _mm_xor_si128(longoutput[(i >> 4) + 7], xmminput[7]);
+    SLOW_HASH_VARIANT(cn_pseudo_rounds)(xmminput, (const __m128i *) way->expanded_key);
+  }
+
+  memcpy(way->state.init, way->text, INIT_SIZE_BYTE);
+  hash_permutation(&way->state.hs);
+  extra_hashes[way->state.hs.b[0] & 3](&way->state, 200, hash);
+}
+
+// count is a compile-time constant at every call site, so the inner loop over the ways is unrolled
+// and the state of every way stays in registers
+static inline __attribute__((always_inline)) void SLOW_HASH_VARIANT(cn_mix)(struct cn_way *ways, size_t count)
+{
+  uint8_t *long_state[SLOW_HASH_MAX_WAYS];
+  ALIGNED_DECL(uint64_t a[SLOW_HASH_MAX_WAYS][2], 16);
+  __m128i b_x[SLOW_HASH_MAX_WAYS];
+  size_t i, w;
+
+  for (w = 0; w < count; w++)
+  {
+    long_state[w] = ways[w].long_state;
+    a[w][0] = ways[w].a[0];
+    a[w][1] = ways[w].a[1];
+    b_x[w] = _mm_load_si128((__m128i *) ways[w].b);
+  }
+
+  for(i = 0; likely(i < 0x80000); i++)
+  {
+    for (w = 0; w < count; w++)
+    {
+      __m128i c_x = _mm_load_si128((__m128i *)&long_state[w][a[w][0] & 0x1FFFF0]);
+      __m128i a_x = _mm_load_si128((__m128i *)a[w]);
+      ALIGNED_DECL(uint64_t c[2], 16);
+      ALIGNED_DECL(uint64_t b[2], 16);
+      uint64_t *nextblock;
+
+#if defined(AESNI)
+      c_x = _mm_aesenc_si128(c_x, a_x);
+#else
+      aesb_single_round((uint8_t *) &c_x, (uint8_t *) &c_x, (uint8_t *) &a_x);
+#endif
+
+      _mm_store_si128((__m128i *)c, c_x);
+
+      b_x[w] = _mm_xor_si128(b_x[w], c_x);
+      _mm_store_si128((__m128i *)&long_state[w][a[w][0] & 0x1FFFF0], b_x[w]);
+
+      nextblock = (uint64_t *)&long_state[w][c[0] & 0x1FFFF0];
+      b[0] = nextblock[0];
+      b[1] = nextblock[1];
+
+      {
+        uint64_t hi, lo;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+        __asm__("mulq %3\n\t"
+          : "=d" (hi),
+          "=a" (lo)
+          : "%a" (c[0]),
+          "rm" (b[0])
+          : "cc" );
+#else
+        lo = mul128(c[0], b[0], &hi);
+#endif
+
+        a[w][0] += hi;
+        a[w][1] += lo;
+      }
+      nextblock[0] = a[w][0];
+      nextblock[1] = a[w][1];
+
+      a[w][0] ^= b[0];
+      a[w][1] ^= b[1];
+      b_x[w] = c_x;
+    }
+  }
+}
+
+static void SLOW_HASH_VARIANT(cn_slow_hash_multi)(void *const *scratchpads, const void *const *data, const size_t *lengths, void *const *hashes, size_t count)
+{
+  struct cn_way ways[SLOW_HASH_MAX_WAYS];
+  size_t w;
+
+  assert(count >= 1 && count <= SLOW_HASH_MAX_WAYS);
+
+  for (w = 0; w < count; w++)
+  {
+    ways[w].long_state = (uint8_t *) scratchpads[w];
+    SLOW_HASH_VARIANT(cn_explode)(&ways[w], data[w], lengths[w]);
+  }
+
+  switch (count)
+  {
+  case 1:
+    SLOW_HASH_VARIANT(cn_mix)(ways, 1);
+    break;
+  case 2:
+    SLOW_HASH_VARIANT(cn_mix)(ways, 2);
+    break;
+  case 3:
+    SLOW_HASH_VARIANT(cn_mix)(ways, 3);
+    break;
+  default:
+    SLOW_HASH_VARIANT(cn_mix)(ways, 4);
+    break;
+  }
+
+  for (w = 0; w < count; w++)
+  {
+    SLOW_HASH_VARIANT(cn_implode)(&ways[w], hashes[w]);
+  }
+}
+
+#undef SLOW_HASH_VARIANT
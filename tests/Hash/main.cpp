@@ -41,6 +41,7 @@ using namespace std;
 typedef Crypto::Hash chash;
 
 Crypto::cn_context *context;
+Crypto::cn_multi_context *multiContext;
 
 extern "C" {
 #ifdef _MSC_VER
@@ -57,13 +58,35 @@ extern "C" {
   static void slow_hash(const void *data, size_t length, char *hash) {
     cn_slow_hash(*context, data, length, *reinterpret_cast<chash *>(hash));
   }
+
+  // The first way hashes the test vector, the others hash its suffixes and are checked against cn_slow_hash
+  static void slow_hash_multi(const void *data, size_t length, char *hash) {
+    const void *inputs[Crypto::SLOW_HASH_MAX_WAYS];
+    size_t lengths[Crypto::SLOW_HASH_MAX_WAYS];
+    chash results[Crypto::SLOW_HASH_MAX_WAYS];
+    size_t ways = multiContext->ways();
+    for (size_t i = 0; i < ways; i++) {
+      size_t skip = i < length ? i : length;
+      inputs[i] = static_cast<const char *>(data) + skip;
+      lengths[i] = length - skip;
+    }
+    Crypto::cn_slow_hash_multi(*multiContext, inputs, lengths, results, ways);
+    for (size_t i = 1; i < ways; i++) {
+      chash expected;
+      cn_slow_hash(*context, inputs[i], lengths[i], expected);
+      if (results[i] != expected) {
+        throw ios_base::failure("Multi-way slow hash differs from cn_slow_hash");
+      }
+    }
+    *reinterpret_cast<chash *>(hash) = results[0];
+  }
 }
 
 extern "C" typedef void hash_f(const void *, size_t, char *);
 struct hash_func {
   const string name;
   hash_f &f;
-} hashes[] = {{"fast", Crypto::cn_fast_hash}, {"slow", slow_hash}, {"tree", hash_tree},
+} hashes[] = {{"fast", Crypto::cn_fast_hash}, {"slow", slow_hash}, {"slow-multi", slow_hash_multi}, {"tree", hash_tree},
   {"extra-blake", Crypto::hash_extra_blake}, {"extra-groestl", Crypto::hash_extra_groestl},
   {"extra-jh", Crypto::hash_extra_jh}, {"extra-skein", Crypto::hash_extra_skein}};
 
@@ -89,9 +112,12 @@ int main(int argc, char *argv[]) {
       break;
     }
   }
-  if (f == slow_hash) {
+  if (f == slow_hash || f == slow_hash_multi) {
     context = new Crypto::cn_context();
   }
+  if (f == slow_hash_multi) {
+    multiContext = new Crypto::cn_multi_context();
+  }
   input.open(argv[2], ios_base::in);
   for (;;) {
     ++test;
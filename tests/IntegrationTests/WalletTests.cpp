@@ -0,0 +1,114 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "BaseTests.h"
+
+#include <chrono>
+#include <System/Timer.h>
+#include "Wallet/WalletGreen.h"
+
+using namespace Tests;
+using namespace CryptoNote;
+
+class WalletTests : public BaseTest {
+
+protected:
+
+  void waitForSynchronization(INode& node, WalletGreen& wallet) {
+    System::Timer timer(dispatcher);
+    while (wallet.getBlockCount() < node.getLastLocalBlockHeight() + 1 || wallet.getActualBalance() == 0) {
+      timer.sleep(std::chrono::milliseconds(500));
+    }
+  }
+
+  std::vector<TransactionParameters> makePayouts(WalletGreen& payees, size_t count, uint64_t mixIn) {
+    std::vector<TransactionParameters> payouts;
+    for (size_t i = 0; i < count; ++i) {
+      TransactionParameters params;
+      params.destinations = {{payees.createAddress(), currency.minimumFee() * 10}};
+      params.fee = currency.minimumFee();
+      params.mixIn = mixIn;
+      payouts.push_back(std::move(params));
+    }
+
+    return payouts;
+  }
+};
+
+// Compares payouts sent one by one with the same number of payouts planned as one batch.
+TEST_F(WalletTests, payoutBatchThroughput) {
+  const size_t PAYOUT_COUNT = 20;
+  const uint64_t MIXIN = 2;
+
+  auto networkCfg = TestNetworkBuilder(1, Topology::Star).build();
+  networkCfg[0].nodeType = NodeType::InProcess;
+  network.addNodes(networkCfg);
+  network.waitNodesReady();
+
+  auto& daemon = network.getNode(0);
+  std::unique_ptr<INode> node;
+  ASSERT_TRUE(daemon.makeINode(node));
+
+  WalletGreen wallet(dispatcher, currency, *node);
+  wallet.initialize("pass");
+  std::string minerAddress = wallet.createAddress();
+
+  WalletGreen payees(dispatcher, currency, *node);
+  payees.initialize("pass");
+
+  System::Timer timer(dispatcher);
+  daemon.startMining(1, minerAddress);
+  while (daemon.getLocalHeight() < currency.minedMoneyUnlockWindow() + 2 * PAYOUT_COUNT) {
+    timer.sleep(std::chrono::seconds(1));
+  }
+
+  daemon.stopMining();
+  waitForSynchronization(*node, wallet);
+
+  auto sequentialPayouts = makePayouts(payees, PAYOUT_COUNT, MIXIN);
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& payout: sequentialPayouts) {
+    ASSERT_NO_THROW(wallet.transfer(payout));
+  }
+  auto sequentialTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  auto batchPayouts = makePayouts(payees, PAYOUT_COUNT, MIXIN);
+  start = std::chrono::steady_clock::now();
+  auto results = wallet.transferBatch(batchPayouts);
+  auto batchTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+  for (const auto& result: results) {
+    ASSERT_FALSE(result.error) << result.error.message();
+  }
+
+  std::cout << PAYOUT_COUNT << " payouts, transfer: " << sequentialTime.count() << " ms, transferBatch: " << batchTime.count() << " ms" << std::endl;
+
+  payees.shutdown();
+  wallet.shutdown();
+}
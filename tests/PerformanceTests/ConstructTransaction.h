@@ -76,3 +76,46 @@ private:
   std::vector<CryptoNote::TransactionDestinationEntry> m_destinations;
   CryptoNote::Transaction m_tx;
 };
+
+// a_in_count inputs with rings of a_ring_size keys, derived and signed on a_thread_count threads
+template<size_t a_in_count, size_t a_ring_size, size_t a_thread_count>
+class test_construct_tx_parallel : private multi_tx_test_base<a_ring_size>
+{
+  static_assert(0 < a_in_count, "in_count must be greater than 0");
+  static_assert(0 < a_thread_count, "thread_count must be greater than 0");
+
+public:
+  static const size_t loop_count = (a_in_count * a_ring_size < 1000) ? 100 : 10;
+  static const size_t in_count = a_in_count;
+  static const size_t thread_count = a_thread_count;
+
+  typedef multi_tx_test_base<a_ring_size> base_class;
+
+  bool init()
+  {
+    using namespace CryptoNote;
+
+    if (!base_class::init())
+      return false;
+
+    m_alice.generate();
+
+    // every input spends the same output, construction doesn't check for double spends
+    CryptoNote::TransactionSourceEntry source = this->m_sources.front();
+    this->m_sources.assign(in_count, source);
+
+    m_destinations.push_back(TransactionDestinationEntry(this->m_source_amount, m_alice.getAccountKeys().address));
+
+    return true;
+  }
+
+  bool test()
+  {
+    return CryptoNote::constructTransaction(this->m_miners[this->real_source_idx].getAccountKeys(), this->m_sources, m_destinations, std::vector<uint8_t>(), m_tx, 0, this->m_logger, thread_count);
+  }
+
+private:
+  CryptoNote::AccountBase m_alice;
+  std::vector<CryptoNote::TransactionDestinationEntry> m_destinations;
+  CryptoNote::Transaction m_tx;
+};
@@ -36,6 +36,8 @@
 
 class test_cn_slow_hash {
 public:
+  template<size_t ways> friend class test_cn_slow_hash_multi;
+
   static const size_t loop_count = 10;
 
 #pragma pack(push, 1)
@@ -70,3 +72,45 @@ private:
   Crypto::Hash m_expected_hash;
   Crypto::cn_context m_context;
 };
+
+// Each call computes hashes_per_call hashes whatever the way count, so ms/call compares across way counts
+template<size_t ways>
+class test_cn_slow_hash_multi {
+public:
+  static const size_t loop_count = 10;
+  static const size_t hashes_per_call = 12;
+
+  static_assert(hashes_per_call % ways == 0, "Ways must divide hashes per call");
+
+  test_cn_slow_hash_multi() : m_context(ways) {
+  }
+
+  bool init() {
+    return m_single.init();
+  }
+
+  bool test() {
+    const void* data[Crypto::SLOW_HASH_MAX_WAYS];
+    size_t lengths[Crypto::SLOW_HASH_MAX_WAYS];
+    Crypto::Hash hashes[Crypto::SLOW_HASH_MAX_WAYS];
+    for (size_t i = 0; i < ways; ++i) {
+      data[i] = &m_single.m_data;
+      lengths[i] = sizeof(m_single.m_data);
+    }
+
+    for (size_t call = 0; call < hashes_per_call / ways; ++call) {
+      Crypto::cn_slow_hash_multi(m_context, data, lengths, hashes, ways);
+      for (size_t i = 0; i < ways; ++i) {
+        if (hashes[i] != m_single.m_expected_hash) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+private:
+  test_cn_slow_hash m_single;
+  Crypto::cn_multi_context m_context;
+};
@@ -0,0 +1,93 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#pragma once
+
+#include <memory>
+
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+// One call is a ping-pong round trip with another context: two context switches
+class test_dispatcher_context_switch {
+public:
+  static const size_t loop_count = 1000000;
+
+  bool init() {
+    m_ping.reset(new System::Event(m_dispatcher));
+    m_pong.reset(new System::Event(m_dispatcher));
+    m_context.reset(new System::Context<>(m_dispatcher, [this] {
+      for (;;) {
+        m_ping->wait();
+        m_ping->clear();
+        m_pong->set();
+      }
+    }));
+
+    return true;
+  }
+
+  bool test() {
+    m_ping->set();
+    m_pong->wait();
+    m_pong->clear();
+    return true;
+  }
+
+private:
+  System::Dispatcher m_dispatcher;
+  std::unique_ptr<System::Event> m_ping;
+  std::unique_ptr<System::Event> m_pong;
+  // destroyed first, interrupting the context parked on m_ping
+  std::unique_ptr<System::Context<>> m_context;
+};
+
+// One call spawns a context and waits for it to finish
+class test_dispatcher_context_spawn {
+public:
+  static const size_t loop_count = 100000;
+
+  bool init() {
+    return true;
+  }
+
+  bool test() {
+    bool done = false;
+    System::Context<> context(m_dispatcher, [&done] {
+      done = true;
+    });
+
+    context.get();
+    return done;
+  }
+
+private:
+  System::Dispatcher m_dispatcher;
+};
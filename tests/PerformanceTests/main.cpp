@@ -37,6 +37,7 @@
 #include "CryptoNoteSlowHash.h"
 #include "DerivePublicKey.h"
 #include "DeriveSecretKey.h"
+#include "DispatcherContexts.h"
 #include "GenerateKeyDerivation.h"
 #include "GenerateKeyImage.h"
 #include "GenerateKeyImageHelper.h"
@@ -84,6 +85,25 @@ int main(int argc, char** argv)
   TEST_PERFORMANCE0(test_derive_secret_key);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 1);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 2);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 3);
+  TEST_PERFORMANCE1(test_cn_slow_hash_multi, 4);
+
+  TEST_PERFORMANCE0(test_dispatcher_context_switch);
+  TEST_PERFORMANCE0(test_dispatcher_context_spawn);
+
+  // the parallel variants need more than the single core the tests above are pinned to
+  clear_process_affinity();
+
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 10, 10, 1);
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 10, 10, 2);
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 10, 10, 4);
+
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 100, 10, 1);
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 100, 10, 2);
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 100, 10, 4);
+  TEST_PERFORMANCE3(test_construct_tx_parallel, 100, 10, 8);
 
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
@@ -28,6 +28,8 @@
 // 
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
+#include <chrono>
+#include <iostream>
 #include <System/Dispatcher.h>
 #include <System/ContextGroup.h>
 #include <System/Event.h>
@@ -377,3 +379,54 @@ TEST_F(TcpConnectionTests, sendBigChunkThruTcpStream) {
     ASSERT_EQ(buf[i], incoming[i]); //for better output.
   }
 }
+
+TEST_F(TcpConnectionTests, concurrentEchoThroughput) {
+  const size_t CONNECTION_COUNT = 256;
+  const size_t ROUND_COUNT = 200;
+  const size_t MESSAGE_SIZE = 64;
+  size_t echoedCount = 0;
+
+  auto readExactly = [](TcpConnection& connection, uint8_t* data, size_t size) {
+    while (size > 0) {
+      size_t transferred = connection.read(data, size);
+      if (transferred == 0) {
+        throw std::runtime_error("connection closed");
+      }
+
+      data += transferred;
+      size -= transferred;
+    }
+  };
+
+  std::vector<TcpConnection> clients;
+  std::vector<TcpConnection> servers;
+  for (size_t i = 0; i < CONNECTION_COUNT; ++i) {
+    clients.emplace_back(TcpConnector(dispatcher).connect(LISTEN_ADDRESS, LISTEN_PORT));
+    servers.emplace_back(listener.accept());
+  }
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < CONNECTION_COUNT; ++i) {
+    contextGroup.spawn([&, i] {
+      uint8_t message[MESSAGE_SIZE];
+      for (size_t round = 0; round < ROUND_COUNT; ++round) {
+        readExactly(servers[i], message, MESSAGE_SIZE);
+        servers[i].write(message, MESSAGE_SIZE);
+      }
+    });
+
+    contextGroup.spawn([&, i] {
+      uint8_t message[MESSAGE_SIZE] = {};
+      for (size_t round = 0; round < ROUND_COUNT; ++round) {
+        clients[i].write(message, MESSAGE_SIZE);
+        readExactly(clients[i], message, MESSAGE_SIZE);
+        ++echoedCount;
+      }
+    });
+  }
+
+  contextGroup.wait();
+  std::chrono::duration<double> duration = std::chrono::steady_clock::now() - begin;
+  ASSERT_EQ(CONNECTION_COUNT * ROUND_COUNT, echoedCount);
+  std::cout << "echo round trips per second: " << static_cast<uint64_t>(echoedCount / duration.count()) << std::endl;
+}
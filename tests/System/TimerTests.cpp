@@ -28,7 +28,9 @@
 // 
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
+#include <algorithm>
 #include <thread>
+#include <vector>
 #include <System/Context.h>
 #include <System/Dispatcher.h>
 #include <System/ContextGroup.h>
@@ -291,3 +293,31 @@ TEST_F(TimerTests, timerWithZeroTimeIsYielding) {
   Timer(dispatcher).sleep(std::chrono::milliseconds(0));
   ASSERT_TRUE(done);
 }
+
+TEST_F(TimerTests, timersExpireInDeadlineOrder) {
+  std::vector<int> expired;
+  for (int i = 0; i < 200; ++i) {
+    int delay = (i * 37) % 20 * 20;
+    contextGroup.spawn([&, delay] {
+      Timer(dispatcher).sleep(std::chrono::milliseconds(delay));
+      expired.push_back(delay);
+    });
+  }
+
+  bool canceledExpired = false;
+  ContextGroup canceledGroup(dispatcher);
+  for (int i = 0; i < 100; ++i) {
+    canceledGroup.spawn([&] {
+      Timer(dispatcher).sleep(std::chrono::milliseconds(200));
+      canceledExpired = true;
+    });
+  }
+
+  dispatcher.yield();
+  canceledGroup.interrupt();
+  canceledGroup.wait();
+  contextGroup.wait();
+  ASSERT_FALSE(canceledExpired);
+  ASSERT_EQ(200, expired.size());
+  ASSERT_TRUE(std::is_sorted(expired.begin(), expired.end()));
+}
@@ -28,9 +28,23 @@
 // 
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 #include <gtest/gtest.h>
+#include <System/Dispatcher.h>
 
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
+
+#ifdef USE_IO_URING
+  // the dispatcher falls back to epoll when io_uring can't be set up, a run asking for io_uring must not pass on epoll
+  const char* backend = getenv("SYSTEM_DISPATCHER_BACKEND");
+  if (backend != nullptr && strcmp(backend, "io_uring") == 0 && System::Dispatcher().getIoUring() == nullptr) {
+    std::cerr << "io_uring dispatcher backend is unavailable, skipping" << std::endl;
+    return 77;
+  }
+#endif
+
   return RUN_ALL_TESTS();
 }
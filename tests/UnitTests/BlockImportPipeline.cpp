@@ -0,0 +1,177 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <limits>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteProtocol/BlockImportPipeline.h"
+
+#include "ICoreStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class CheckpointZoneCoreStub : public ICoreStub {
+public:
+  virtual bool isInCheckpointZone(uint32_t height) override {
+    return height < checkpointZoneHeight;
+  }
+
+  uint32_t checkpointZoneHeight = std::numeric_limits<uint32_t>::max();
+};
+
+class BlockImportPipelineTest : public ::testing::Test {
+public:
+  BlockImportPipelineTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    pipeline(dispatcher, currency, core, 2, 4) {
+  }
+
+protected:
+  std::vector<block_complete_entry> makeEntries(size_t count) {
+    std::vector<block_complete_entry> entries;
+    Block block = currency.genesisBlock();
+    for (size_t i = 0; i < count; ++i) {
+      block.previousBlockHash = get_block_hash(block);
+      block.nonce = static_cast<uint32_t>(i);
+      boost::get<BaseInput>(block.baseTransaction.inputs.front()).blockIndex = static_cast<uint32_t>(i + 1);
+
+      block_complete_entry entry;
+      entry.block = Common::asString(toBinaryArray(block));
+      entries.push_back(entry);
+      hashes.push_back(get_block_hash(block));
+    }
+
+    return entries;
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  System::Dispatcher dispatcher;
+  CheckpointZoneCoreStub core;
+  BlockImportPipeline pipeline;
+  std::vector<Crypto::Hash> hashes;
+};
+
+TEST_F(BlockImportPipelineTest, blocksAreCommittedInOrder) {
+  auto entries = makeEntries(25);
+
+  std::vector<Crypto::Hash> committed;
+  pipeline.process(entries, [&](BlockImportPipeline::PreparedBlock& prepared) {
+    EXPECT_TRUE(prepared.valid);
+    EXPECT_FALSE(prepared.hasProofOfWork);
+    committed.push_back(prepared.hash);
+    return true;
+  });
+
+  ASSERT_EQ(hashes, committed);
+
+  auto statistics = pipeline.getStatistics();
+  ASSERT_EQ(25, statistics.decode.items);
+  ASSERT_EQ(0, statistics.proofOfWork.items);
+  ASSERT_EQ(25, statistics.commit.items);
+}
+
+TEST_F(BlockImportPipelineTest, proofOfWorkIsComputedOutsideCheckpointZone) {
+  core.checkpointZoneHeight = 2;
+  auto entries = makeEntries(3);
+
+  std::vector<BlockImportPipeline::PreparedBlock> committed;
+  pipeline.process(entries, [&](BlockImportPipeline::PreparedBlock& prepared) {
+    committed.push_back(prepared);
+    return true;
+  });
+
+  ASSERT_EQ(3, committed.size());
+  ASSERT_FALSE(committed[0].hasProofOfWork);
+  ASSERT_TRUE(committed[1].hasProofOfWork);
+  ASSERT_TRUE(committed[2].hasProofOfWork);
+
+  Crypto::cn_context context;
+  Crypto::Hash proofOfWork;
+  ASSERT_TRUE(get_block_longhash(context, committed[2].block, proofOfWork));
+  ASSERT_EQ(proofOfWork, committed[2].proofOfWork);
+}
+
+TEST_F(BlockImportPipelineTest, badBlockMidBatchIsRejected) {
+  auto entries = makeEntries(10);
+  entries[5].block = "not a block";
+
+  std::vector<bool> committed;
+  pipeline.process(entries, [&](BlockImportPipeline::PreparedBlock& prepared) {
+    committed.push_back(prepared.valid);
+    return prepared.valid;
+  });
+
+  ASSERT_EQ((std::vector<bool>{ true, true, true, true, true, false }), committed);
+}
+
+TEST_F(BlockImportPipelineTest, oversizedBlockIsRejectedBeforeHashing) {
+  core.checkpointZoneHeight = 0;
+  auto entries = makeEntries(2);
+  entries[1].block.resize(currency.maxBlockBlobSize() + 1);
+
+  std::vector<BlockImportPipeline::PreparedBlock> committed;
+  pipeline.process(entries, [&](BlockImportPipeline::PreparedBlock& prepared) {
+    committed.push_back(prepared);
+    return true;
+  });
+
+  ASSERT_EQ(2, committed.size());
+  ASSERT_TRUE(committed[0].valid);
+  ASSERT_FALSE(committed[1].valid);
+  ASSERT_FALSE(committed[1].hasProofOfWork);
+  ASSERT_EQ(1, pipeline.getStatistics().proofOfWork.items);
+}
+
+TEST_F(BlockImportPipelineTest, stoppedImportDoesNotDecodeRestOfBatch) {
+  auto entries = makeEntries(200);
+
+  size_t committed = 0;
+  pipeline.process(entries, [&](BlockImportPipeline::PreparedBlock& prepared) {
+    return ++committed < 3;
+  });
+
+  ASSERT_EQ(3, committed);
+
+  // workers never run more than maxReadAhead blocks ahead of commit
+  auto statistics = pipeline.getStatistics();
+  ASSERT_EQ(3, statistics.commit.items);
+  ASSERT_LT(statistics.decode.items, 20);
+}
+
+}
@@ -0,0 +1,287 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Dispatcher.h>
+
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/VerificationContext.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "P2p/LevinProtocol.h"
+
+#include "ICoreStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+class CompactBlockCoreStub : public ICoreStub {
+public:
+  CompactBlockCoreStub(const Block& genesisBlock) : ICoreStub(genesisBlock) {
+  }
+
+  virtual bool handle_incoming_block_blob(const BinaryArray& block_blob, block_verification_context& bvc, bool control_miner, bool relay_block) override {
+    incomingBlocks.push_back(block_blob);
+    return true;
+  }
+
+  void addPoolTransaction(const Transaction& tx) {
+    tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+    handleIncomingTransaction(tx, getObjectHash(tx), getObjectBinarySize(tx), tvc, false);
+  }
+
+  std::vector<BinaryArray> incomingBlocks;
+};
+
+class NotifyRecorder : public p2p_endpoint_stub {
+public:
+  virtual bool invoke_notify_to_peer(int command, const BinaryArray& req_buff, const CryptoNoteConnectionContext& context) override {
+    notifications.emplace_back(command, req_buff);
+    return true;
+  }
+
+  std::vector<std::pair<int, BinaryArray>> notifications;
+};
+
+class CompactBlockRelayTest : public ::testing::Test {
+public:
+  CompactBlockRelayTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    core(currency.genesisBlock()),
+    handler(currency, dispatcher, core, &endpoint, logger) {
+
+    context.version = P2PProtocolVersion::V2;
+    context.m_connection_id = boost::uuids::random_generator()();
+    context.m_state = CryptoNoteConnectionContext::state_normal;
+
+    for (uint64_t i = 0; i < 3; ++i) {
+      Transaction tx = boost::value_initialized<Transaction>();
+      tx.version = CURRENT_TRANSACTION_VERSION;
+      tx.unlockTime = 100 + i;
+      transactions.push_back(tx);
+    }
+
+    block = currency.genesisBlock();
+    block.previousBlockHash = get_block_hash(currency.genesisBlock());
+    for (const auto& tx : transactions) {
+      block.transactionHashes.push_back(getObjectHash(tx));
+    }
+  }
+
+protected:
+  template<typename Command>
+  void notify(typename Command::request& request) {
+    BinaryArray response;
+    bool handled = false;
+    handler.handleCommand(true, Command::ID, LevinProtocol::encode(request), response, context, handled);
+    ASSERT_TRUE(handled);
+  }
+
+  NOTIFY_NEW_COMPACT_BLOCK::request announce(const Block& announced, uint64_t salt) {
+    NOTIFY_NEW_COMPACT_BLOCK::request request;
+    request.blockHash = get_block_hash(announced);
+    request.salt = salt;
+    request.current_blockchain_height = 2;
+    request.hop = 1;
+    for (const auto& txHash : announced.transactionHashes) {
+      request.shortTxIds.push_back(getCompactTransactionShortId(salt, txHash));
+    }
+
+    Block header = announced;
+    header.transactionHashes.clear();
+    request.block = Common::asString(toBinaryArray(header));
+    return request;
+  }
+
+  NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request takeTransactionsRequest() {
+    NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request request;
+    EXPECT_EQ(1, endpoint.notifications.size());
+    if (!endpoint.notifications.empty()) {
+      EXPECT_EQ(static_cast<int>(NOTIFY_REQUEST_COMPACT_BLOCK_TXS::ID), endpoint.notifications.front().first);
+      EXPECT_TRUE(LevinProtocol::decode(endpoint.notifications.front().second, request));
+      endpoint.notifications.clear();
+    }
+
+    return request;
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  System::Dispatcher dispatcher;
+  CompactBlockCoreStub core;
+  NotifyRecorder endpoint;
+  CryptoNoteProtocolHandler handler;
+  CryptoNoteConnectionContext context;
+
+  std::vector<Transaction> transactions;
+  Block block;
+};
+
+TEST_F(CompactBlockRelayTest, blockIsReconstructedFromPool) {
+  for (const auto& tx : transactions) {
+    core.addPoolTransaction(tx);
+  }
+
+  auto request = announce(block, 12345);
+  notify<NOTIFY_NEW_COMPACT_BLOCK>(request);
+
+  ASSERT_TRUE(endpoint.notifications.empty());
+  ASSERT_EQ(1, core.incomingBlocks.size());
+  ASSERT_EQ(toBinaryArray(block), core.incomingBlocks.front());
+  ASSERT_EQ(CryptoNoteConnectionContext::state_normal, context.m_state);
+}
+
+TEST_F(CompactBlockRelayTest, missingTransactionsAreRequestedFromPeer) {
+  core.addPoolTransaction(transactions[0]);
+  core.addPoolTransaction(transactions[2]);
+
+  auto request = announce(block, 12345);
+  notify<NOTIFY_NEW_COMPACT_BLOCK>(request);
+  ASSERT_TRUE(core.incomingBlocks.empty());
+
+  auto txsRequest = takeTransactionsRequest();
+  ASSERT_EQ(request.blockHash, txsRequest.blockHash);
+  ASSERT_EQ(std::vector<uint32_t>{ 1 }, txsRequest.indices);
+
+  NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request response;
+  response.blockHash = txsRequest.blockHash;
+  response.indices = txsRequest.indices;
+  response.txs.push_back(Common::asString(toBinaryArray(transactions[1])));
+  notify<NOTIFY_RESPONSE_COMPACT_BLOCK_TXS>(response);
+
+  ASSERT_TRUE(endpoint.notifications.empty());
+  ASSERT_EQ(1, core.incomingBlocks.size());
+  ASSERT_EQ(toBinaryArray(block), core.incomingBlocks.front());
+  ASSERT_EQ(CryptoNoteConnectionContext::state_normal, context.m_state);
+}
+
+TEST_F(CompactBlockRelayTest, requestForMissingTransactionsIsServed) {
+  core.addBlock(block);
+  for (const auto& tx : transactions) {
+    core.addTransaction(tx);
+  }
+
+  NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request request;
+  request.blockHash = get_block_hash(block);
+  request.indices = { 2, 0 };
+  notify<NOTIFY_REQUEST_COMPACT_BLOCK_TXS>(request);
+
+  ASSERT_EQ(1, endpoint.notifications.size());
+  ASSERT_EQ(static_cast<int>(NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::ID), endpoint.notifications.front().first);
+
+  NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request response;
+  ASSERT_TRUE(LevinProtocol::decode(endpoint.notifications.front().second, response));
+  ASSERT_EQ(request.blockHash, response.blockHash);
+  ASSERT_EQ(request.indices, response.indices);
+  ASSERT_EQ(2, response.txs.size());
+  ASSERT_EQ(Common::asString(toBinaryArray(transactions[2])), response.txs[0]);
+  ASSERT_EQ(Common::asString(toBinaryArray(transactions[0])), response.txs[1]);
+}
+
+TEST_F(CompactBlockRelayTest, outOfRangeTransactionRequestDropsConnection) {
+  core.addBlock(block);
+
+  NOTIFY_REQUEST_COMPACT_BLOCK_TXS::request request;
+  request.blockHash = get_block_hash(block);
+  request.indices = { static_cast<uint32_t>(block.transactionHashes.size()) };
+  notify<NOTIFY_REQUEST_COMPACT_BLOCK_TXS>(request);
+
+  ASSERT_TRUE(endpoint.notifications.empty());
+  ASSERT_EQ(CryptoNoteConnectionContext::state_shutdown, context.m_state);
+}
+
+TEST_F(CompactBlockRelayTest, shortIdCollisionFallsBackToFullTransactionList) {
+  // the pool holds a transaction whose short id the announcer's transaction collides with
+  Transaction poolTx = boost::value_initialized<Transaction>();
+  poolTx.version = CURRENT_TRANSACTION_VERSION;
+  poolTx.unlockTime = 999;
+  core.addPoolTransaction(poolTx);
+  core.addPoolTransaction(transactions[0]);
+  core.addPoolTransaction(transactions[2]);
+
+  Block poolBlock = block;
+  poolBlock.transactionHashes[1] = getObjectHash(poolTx);
+
+  auto request = announce(poolBlock, 12345);
+  request.blockHash = get_block_hash(block);
+  notify<NOTIFY_NEW_COMPACT_BLOCK>(request);
+  ASSERT_TRUE(core.incomingBlocks.empty());
+
+  auto txsRequest = takeTransactionsRequest();
+  ASSERT_EQ(request.blockHash, txsRequest.blockHash);
+  ASSERT_EQ((std::vector<uint32_t>{ 0, 1, 2 }), txsRequest.indices);
+
+  NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request response;
+  response.blockHash = txsRequest.blockHash;
+  response.indices = txsRequest.indices;
+  for (const auto& tx : transactions) {
+    response.txs.push_back(Common::asString(toBinaryArray(tx)));
+  }
+
+  notify<NOTIFY_RESPONSE_COMPACT_BLOCK_TXS>(response);
+
+  ASSERT_TRUE(endpoint.notifications.empty());
+  ASSERT_EQ(1, core.incomingBlocks.size());
+  ASSERT_EQ(toBinaryArray(block), core.incomingBlocks.front());
+  ASSERT_EQ(CryptoNoteConnectionContext::state_normal, context.m_state);
+}
+
+TEST_F(CompactBlockRelayTest, secondReconstructionFailureDropsConnection) {
+  for (const auto& tx : transactions) {
+    core.addPoolTransaction(tx);
+  }
+
+  auto request = announce(block, 12345);
+  request.blockHash.data[0] ^= 1;
+  notify<NOTIFY_NEW_COMPACT_BLOCK>(request);
+
+  auto txsRequest = takeTransactionsRequest();
+  ASSERT_EQ(3, txsRequest.indices.size());
+
+  NOTIFY_RESPONSE_COMPACT_BLOCK_TXS::request response;
+  response.blockHash = txsRequest.blockHash;
+  response.indices = txsRequest.indices;
+  for (const auto& tx : transactions) {
+    response.txs.push_back(Common::asString(toBinaryArray(tx)));
+  }
+
+  notify<NOTIFY_RESPONSE_COMPACT_BLOCK_TXS>(response);
+
+  ASSERT_TRUE(endpoint.notifications.empty());
+  ASSERT_TRUE(core.incomingBlocks.empty());
+  ASSERT_EQ(CryptoNoteConnectionContext::state_shutdown, context.m_state);
+}
+
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+#include "NodeRpcProxy/DecoyOutputsCache.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const std::chrono::seconds MAX_AGE(60);
+
+DecoyOutputsCache::OutsForAmount makeOuts(uint64_t amount, uint64_t firstIndex, size_t count) {
+  DecoyOutputsCache::OutsForAmount outs;
+  outs.amount = amount;
+  for (size_t i = 0; i < count; ++i) {
+    COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::out_entry entry;
+    entry.global_amount_index = firstIndex + i;
+    entry.out_key = Crypto::PublicKey();
+    outs.outs.push_back(entry);
+  }
+
+  return outs;
+}
+
+}
+
+TEST(DecoyOutputsCache, disabledCacheServesNothing) {
+  DecoyOutputsCache cache;
+  std::vector<DecoyOutputsCache::OutsForAmount> result;
+
+  ASSERT_FALSE(cache.isEnabled());
+  ASSERT_FALSE(cache.take({100}, 3, result));
+
+  uint64_t outsCount;
+  ASSERT_TRUE(cache.getMissingAmounts(outsCount).empty());
+}
+
+TEST(DecoyOutputsCache, refillsRequestedAmountsAndServesThemOnce) {
+  DecoyOutputsCache cache;
+  cache.setLimits(5, MAX_AGE);
+  auto now = DecoyOutputsCache::Clock::now();
+
+  std::vector<DecoyOutputsCache::OutsForAmount> result;
+  ASSERT_FALSE(cache.take({100, 200}, 2, result, now));
+
+  uint64_t outsCount;
+  auto missing = cache.getMissingAmounts(outsCount, now);
+  ASSERT_EQ(2, missing.size());
+  ASSERT_EQ(5, outsCount);
+
+  cache.add({makeOuts(100, 0, 5), makeOuts(200, 10, 5), makeOuts(300, 20, 5)}, now);
+  ASSERT_EQ(5, cache.size(100));
+  ASSERT_EQ(0, cache.size(300));
+
+  ASSERT_TRUE(cache.take({200, 100, 100}, 2, result, now));
+  ASSERT_EQ(3, result.size());
+  ASSERT_EQ(200, result[0].amount);
+  ASSERT_EQ(100, result[1].amount);
+  ASSERT_EQ(2, result[1].outs.size());
+  ASSERT_EQ(0, result[1].outs[0].global_amount_index);
+  ASSERT_EQ(2, result[2].outs[0].global_amount_index);
+  ASSERT_EQ(1, cache.size(100));
+  ASSERT_EQ(3, cache.size(200));
+
+  ASSERT_FALSE(cache.take({100}, 2, result, now));
+  ASSERT_EQ(1, cache.size(100));
+}
+
+TEST(DecoyOutputsCache, skipsDuplicatesAndKeepsSizeLimit) {
+  DecoyOutputsCache cache;
+  cache.setLimits(4, MAX_AGE);
+  auto now = DecoyOutputsCache::Clock::now();
+
+  std::vector<DecoyOutputsCache::OutsForAmount> result;
+  cache.take({100}, 1, result, now);
+
+  cache.add({makeOuts(100, 0, 3)}, now);
+  cache.add({makeOuts(100, 1, 6)}, now);
+  ASSERT_EQ(4, cache.size(100));
+
+  ASSERT_TRUE(cache.take({100}, 4, result, now));
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(i, result[0].outs[i].global_amount_index);
+  }
+}
+
+TEST(DecoyOutputsCache, dropsStaleOutputsAndForgetsUnusedAmounts) {
+  DecoyOutputsCache cache;
+  cache.setLimits(2, MAX_AGE);
+  auto now = DecoyOutputsCache::Clock::now();
+
+  std::vector<DecoyOutputsCache::OutsForAmount> result;
+  cache.take({100}, 1, result, now);
+  cache.add({makeOuts(100, 0, 2)}, now);
+
+  ASSERT_FALSE(cache.take({100}, 1, result, now + MAX_AGE + std::chrono::seconds(1)));
+  ASSERT_EQ(0, cache.size(100));
+
+  uint64_t outsCount;
+  ASSERT_EQ(1, cache.getMissingAmounts(outsCount, now + MAX_AGE).size());
+  ASSERT_TRUE(cache.getMissingAmounts(outsCount, now + 3 * MAX_AGE).empty());
+}
+
+TEST(DecoyOutputsCache, clearKeepsRequestedAmounts) {
+  DecoyOutputsCache cache;
+  cache.setLimits(2, MAX_AGE);
+  auto now = DecoyOutputsCache::Clock::now();
+
+  std::vector<DecoyOutputsCache::OutsForAmount> result;
+  cache.take({100}, 1, result, now);
+  cache.add({makeOuts(100, 0, 2)}, now);
+  cache.clear();
+
+  ASSERT_EQ(0, cache.size(100));
+  uint64_t outsCount;
+  ASSERT_EQ(1, cache.getMissingAmounts(outsCount, now).size());
+  ASSERT_EQ(2, outsCount);
+}
@@ -0,0 +1,399 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <Logging/LoggerGroup.h>
+
+#include "BlockchainExplorer/BlockchainExplorerDataBuilder.h"
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/BlockchainIndices.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+
+#include "../TestGenerator/TestGenerator.h"
+#include "ICoreStub.h"
+#include "ICryptoNoteProtocolQueryStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+Crypto::Hash makeHash(uint8_t value) {
+  Crypto::Hash hash = NULL_HASH;
+  hash.data[0] = value;
+  return hash;
+}
+
+ExplorerTransactionEntry makeEntry(uint64_t fee, const Crypto::Hash& source) {
+  ExplorerTransactionEntry entry;
+  entry.fee = fee;
+  entry.mixin = 3;
+  entry.hasPaymentId = false;
+  entry.paymentId = NULL_HASH;
+  entry.inputs.push_back({ source, 1 });
+  entry.globalIndexes = { 7, 8 };
+  return entry;
+}
+
+class ExplorerIndexCoreStub : public ICoreStub {
+public:
+  ExplorerIndexCoreStub() : scanCalls(0) {
+  }
+
+  virtual bool getExplorerTransaction(const Crypto::Hash& transactionHash, ExplorerTransactionEntry& entry) override {
+    auto it = entries.find(transactionHash);
+    if (it == entries.end()) {
+      return false;
+    }
+
+    entry = it->second;
+    return true;
+  }
+
+  virtual bool scanOutputkeysForIndices(const KeyInput& txInToKey, std::list<std::pair<Crypto::Hash, size_t>>& outputReferences) override {
+    ++scanCalls;
+    return false;
+  }
+
+  std::unordered_map<Crypto::Hash, ExplorerTransactionEntry> entries;
+  size_t scanCalls;
+};
+
+class RecordingLogger : public Logging::ILogger {
+public:
+  virtual void operator()(const std::string& category, Logging::Level level, boost::posix_time::ptime time, const std::string& body) override {
+    messages.push_back(body);
+  }
+
+  bool contains(const std::string& text) const {
+    return std::any_of(messages.begin(), messages.end(), [&](const std::string& message) { return message.find(text) != std::string::npos; });
+  }
+
+  std::vector<std::string> messages;
+};
+
+class BlockchainExplorerIndexTest : public ::testing::Test {
+public:
+  BlockchainExplorerIndexTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    generator(currency) {
+    miner.generate();
+    configFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_%%%%%%%%%%%%");
+    std::vector<size_t> blockSizes;
+    generator.addBlock(currency.genesisBlock(), 0, 0, blockSizes, 0);
+  }
+
+  ~BlockchainExplorerIndexTest() {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(configFolder, ignoredErrorCode);
+  }
+
+  std::unique_ptr<core> startCore(bool explorerIndexEnabled, bool loadExisting) {
+    CoreConfig coreConfig;
+    coreConfig.configFolder = configFolder.string();
+    coreConfig.explorerIndexEnabled = explorerIndexEnabled;
+    std::unique_ptr<core> result(new core(currency, nullptr, logger));
+    if (!result->init(coreConfig, MinerConfig(), loadExisting)) {
+      return nullptr;
+    }
+
+    return result;
+  }
+
+  bool pushBlock(core& c, const Block& previous, Block& block) {
+    if (!generator.constructBlock(block, previous, miner)) {
+      return false;
+    }
+
+    block_verification_context bvc = boost::value_initialized<block_verification_context>();
+    return c.handle_incoming_block_blob(toBinaryArray(block), bvc, false, false) && !bvc.m_verifivation_failed;
+  }
+
+  bool isIndexed(core& c, const Block& block) {
+    ExplorerTransactionEntry entry;
+    if (!c.getExplorerTransaction(getObjectHash(block.baseTransaction), entry)) {
+      return false;
+    }
+
+    return entry.inputs.size() == 1 && entry.globalIndexes.size() == block.baseTransaction.outputs.size();
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  test_generator generator;
+  AccountBase miner;
+  boost::filesystem::path configFolder;
+};
+
+}
+
+TEST(ExplorerIndex, findsTransactionsByHashAndPosition) {
+  ExplorerIndex index;
+  ASSERT_TRUE(index.add(0, 0, makeHash(1), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 0, makeHash(2), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 1, makeHash(3), makeEntry(10, makeHash(1))));
+
+  ExplorerTransactionEntry entry;
+  ASSERT_TRUE(index.find(makeHash(3), entry));
+  ASSERT_EQ(10, entry.fee);
+  ASSERT_EQ(makeHash(1), entry.inputs[0].transactionHash);
+  ASSERT_EQ(std::vector<uint32_t>({ 7, 8 }), entry.globalIndexes);
+
+  Crypto::Hash hash;
+  ASSERT_TRUE(index.findHash(1, 1, hash));
+  ASSERT_EQ(makeHash(3), hash);
+  ASSERT_FALSE(index.findHash(1, 2, hash));
+  ASSERT_FALSE(index.findHash(2, 0, hash));
+}
+
+TEST(ExplorerIndex, acceptsOnlyTheNextPosition) {
+  ExplorerIndex index;
+  ASSERT_TRUE(index.add(0, 0, makeHash(1), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 0, makeHash(2), makeEntry(0, NULL_HASH)));
+  ASSERT_FALSE(index.add(0, 1, makeHash(3), makeEntry(0, NULL_HASH)));
+  ASSERT_FALSE(index.add(1, 2, makeHash(3), makeEntry(0, NULL_HASH)));
+  ASSERT_FALSE(index.add(1, 1, makeHash(2), makeEntry(0, NULL_HASH)));
+}
+
+TEST(ExplorerIndex, removesFromTheTip) {
+  ExplorerIndex index;
+  ASSERT_TRUE(index.add(0, 0, makeHash(1), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 0, makeHash(2), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 1, makeHash(3), makeEntry(0, NULL_HASH)));
+
+  ASSERT_FALSE(index.remove(1, 0, makeHash(2)));
+  ASSERT_TRUE(index.remove(1, 1, makeHash(3)));
+  ASSERT_TRUE(index.remove(1, 0, makeHash(2)));
+
+  ExplorerTransactionEntry entry;
+  ASSERT_FALSE(index.find(makeHash(2), entry));
+  ASSERT_TRUE(index.find(makeHash(1), entry));
+  ASSERT_TRUE(index.add(1, 0, makeHash(4), makeEntry(0, NULL_HASH)));
+}
+
+TEST(ExplorerIndex, serializationRoundTrip) {
+  ExplorerIndex index;
+  ASSERT_TRUE(index.add(0, 0, makeHash(1), makeEntry(0, NULL_HASH)));
+  ASSERT_TRUE(index.add(1, 0, makeHash(2), makeEntry(5, makeHash(1))));
+
+  BinaryArray data;
+  ASSERT_TRUE(toBinaryArray(index, data));
+
+  ExplorerIndex restored;
+  ASSERT_TRUE(fromBinaryArray(restored, data));
+
+  ExplorerTransactionEntry entry;
+  ASSERT_TRUE(restored.find(makeHash(2), entry));
+  ASSERT_EQ(5, entry.fee);
+  ASSERT_EQ(makeHash(1), entry.inputs[0].transactionHash);
+
+  Crypto::Hash hash;
+  ASSERT_TRUE(restored.findHash(1, 0, hash));
+  ASSERT_EQ(makeHash(2), hash);
+  ASSERT_TRUE(restored.add(1, 1, makeHash(3), makeEntry(0, NULL_HASH)));
+}
+
+TEST_F(BlockchainExplorerIndexTest, followsPushPopAndReload) {
+  auto c = startCore(true, false);
+  ASSERT_NE(nullptr, c);
+
+  Block genesis = currency.genesisBlock();
+  Block a1, a2, a3;
+  ASSERT_TRUE(pushBlock(*c, genesis, a1));
+  ASSERT_TRUE(pushBlock(*c, a1, a2));
+  ASSERT_TRUE(pushBlock(*c, a2, a3));
+  ASSERT_TRUE(isIndexed(*c, genesis));
+  ASSERT_TRUE(isIndexed(*c, a3));
+
+  // a longer alternative chain pops a2 and a3
+  Block b2, b3, b4;
+  ASSERT_TRUE(pushBlock(*c, a1, b2));
+  ASSERT_TRUE(pushBlock(*c, b2, b3));
+  ASSERT_TRUE(pushBlock(*c, b3, b4));
+  ASSERT_EQ(5, c->get_current_blockchain_height());
+  ASSERT_FALSE(isIndexed(*c, a2));
+  ASSERT_FALSE(isIndexed(*c, a3));
+  ASSERT_TRUE(isIndexed(*c, a1));
+  ASSERT_TRUE(isIndexed(*c, b4));
+
+  c->deinit();
+  c.reset();
+  c = startCore(true, true);
+  ASSERT_NE(nullptr, c);
+  ASSERT_EQ(5, c->get_current_blockchain_height());
+  ASSERT_TRUE(isIndexed(*c, b4));
+  ASSERT_FALSE(isIndexed(*c, a3));
+
+  Block b5;
+  ASSERT_TRUE(pushBlock(*c, b4, b5));
+  ASSERT_TRUE(isIndexed(*c, b5));
+  c->deinit();
+}
+
+TEST_F(BlockchainExplorerIndexTest, isRebuiltWhenNotStored) {
+  auto c = startCore(false, false);
+  ASSERT_NE(nullptr, c);
+
+  Block genesis = currency.genesisBlock();
+  Block a1, a2;
+  ASSERT_TRUE(pushBlock(*c, genesis, a1));
+  ASSERT_TRUE(pushBlock(*c, a1, a2));
+  ASSERT_FALSE(isIndexed(*c, a2));
+  c->deinit();
+  c.reset();
+
+  c = startCore(true, true);
+  ASSERT_NE(nullptr, c);
+  ASSERT_TRUE(isIndexed(*c, a1));
+  ASSERT_TRUE(isIndexed(*c, a2));
+  c->deinit();
+}
+
+TEST_F(BlockchainExplorerIndexTest, loadsVersionOneIndicesWithoutRebuild) {
+  RecordingLogger recorder;
+  auto c = startCore(false, false);
+  ASSERT_NE(nullptr, c);
+
+  Block genesis = currency.genesisBlock();
+  Block a1;
+  ASSERT_TRUE(pushBlock(*c, genesis, a1));
+  c->deinit();
+  c.reset();
+
+  // a version 1 file is the same minus the trailing explorer index flag
+  std::string indicesFile = (configFolder / currency.blockchinIndicesFileName()).string();
+  std::string data;
+  {
+    std::ifstream in(indicesFile, std::ios_base::binary);
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  ASSERT_EQ(2, data.front());
+  ASSERT_EQ(0, data.back());
+  data.front() = 1;
+  data.pop_back();
+  {
+    std::ofstream out(indicesFile, std::ios_base::binary | std::ios_base::trunc);
+    out.write(data.data(), data.size());
+  }
+
+  logger.addLogger(recorder);
+  c = startCore(false, true);
+  ASSERT_NE(nullptr, c);
+  ASSERT_FALSE(recorder.contains("No actual blockchain indices"));
+  c->deinit();
+  c.reset();
+
+  // with the index enabled only the explorer index is built
+  {
+    std::ofstream out(indicesFile, std::ios_base::binary | std::ios_base::trunc);
+    out.write(data.data(), data.size());
+  }
+
+  recorder.messages.clear();
+  c = startCore(true, true);
+  ASSERT_NE(nullptr, c);
+  ASSERT_FALSE(recorder.contains("No actual blockchain indices"));
+  ASSERT_TRUE(recorder.contains("No actual explorer index"));
+  ASSERT_TRUE(isIndexed(*c, a1));
+  c->deinit();
+  logger.removeLogger(recorder);
+}
+
+TEST(BlockchainExplorerDataBuilder, fillTransactionDetailsUsesExplorerIndex) {
+  ExplorerIndexCoreStub core;
+  ICryptoNoteProtocolQueryStub protocol;
+  BlockchainExplorerDataBuilder builder(core, protocol);
+
+  Transaction transaction;
+  transaction.version = 1;
+  transaction.unlockTime = 0;
+  KeyInput input;
+  input.amount = 100;
+  input.outputIndexes = { 5, 2 };
+  input.keyImage = boost::value_initialized<Crypto::KeyImage>();
+  transaction.inputs.push_back(input);
+  for (uint64_t amount : { 60, 30 }) {
+    TransactionOutput output;
+    output.amount = amount;
+    output.target = KeyOutput{ boost::value_initialized<Crypto::PublicKey>() };
+    transaction.outputs.push_back(output);
+  }
+  transaction.signatures.resize(1);
+  Crypto::Hash transactionHash = getObjectHash(transaction);
+
+  Block block;
+  block.majorVersion = BLOCK_MAJOR_VERSION_1;
+  block.minorVersion = BLOCK_MINOR_VERSION_0;
+  block.timestamp = 1;
+  block.previousBlockHash = NULL_HASH;
+  block.nonce = 0;
+  block.baseTransaction.version = 1;
+  block.baseTransaction.unlockTime = 0;
+  block.baseTransaction.inputs.push_back(BaseInput{ 1 });
+  block.transactionHashes.push_back(transactionHash);
+  core.addBlock(block);
+
+  // deliberately differs from what the scans would compute, so only the indexed path can produce it
+  ExplorerTransactionEntry entry = makeEntry(7, makeHash(4));
+  entry.mixin = 2;
+  entry.hasPaymentId = true;
+  entry.paymentId = makeHash(9);
+  entry.globalIndexes = { 11, 12 };
+  core.entries[transactionHash] = entry;
+
+  TransactionDetails details;
+  ASSERT_TRUE(builder.fillTransactionDetails(transaction, details, 1));
+  ASSERT_EQ(0, core.scanCalls);
+  ASSERT_TRUE(details.inBlockchain);
+  ASSERT_EQ(7, details.fee);
+  ASSERT_EQ(2, details.mixin);
+  ASSERT_EQ(makeHash(9), details.paymentId);
+  ASSERT_EQ(1, details.inputs.size());
+  const TransactionInputToKeyDetails& inputDetails = boost::get<TransactionInputToKeyDetails>(details.inputs[0].input);
+  ASSERT_EQ(makeHash(4), inputDetails.output.transactionHash);
+  ASSERT_EQ(1, inputDetails.output.number);
+  ASSERT_EQ(2, details.outputs.size());
+  ASSERT_EQ(11, details.outputs[0].globalIndex);
+  ASSERT_EQ(12, details.outputs[1].globalIndex);
+
+  // without an index entry the builder falls back to the ring member scans
+  core.entries.clear();
+  ASSERT_FALSE(builder.fillTransactionDetails(transaction, details, 1));
+  ASSERT_EQ(1, core.scanCalls);
+}
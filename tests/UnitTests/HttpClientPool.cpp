@@ -0,0 +1,217 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpListener.h>
+#include <System/Timer.h>
+
+#include "Rpc/HttpClient.h"
+#include "Rpc/HttpClientPool.h"
+#include "Rpc/HttpServer.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t TEST_PORT = 16680;
+
+class TestHttpServer : public HttpServer {
+public:
+  TestHttpServer(System::Dispatcher& dispatcher, Logging::ILogger& log) : HttpServer(dispatcher, log) {
+  }
+
+  virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+    if (request.getUrl() == "/slow") {
+      System::Timer(m_dispatcher).sleep(std::chrono::milliseconds(100));
+    }
+
+    response.setStatus(HttpResponse::STATUS_200);
+    response.setBody(request.getUrl());
+  }
+};
+
+// Answers the first request of every connection and closes the connection on the second one, after
+// sending the given prefix of a response
+void serveOneRequestPerConnection(System::Dispatcher& dispatcher, uint16_t port, const std::string& secondResponsePrefix,
+  size_t& requestCount) {
+  System::TcpListener listener(dispatcher, System::Ipv4Address("127.0.0.1"), port);
+  for (;;) {
+    System::TcpConnection connection = listener.accept();
+    for (size_t i = 0; i < 2; ++i) {
+      uint8_t buffer[4096];
+      if (connection.read(buffer, sizeof(buffer)) == 0) {
+        break;
+      }
+
+      ++requestCount;
+      std::string response = i == 0 ? "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok" : secondResponsePrefix;
+      if (!response.empty()) {
+        connection.write(reinterpret_cast<const uint8_t*>(response.data()), response.size());
+      }
+    }
+  }
+}
+
+void request(HttpClientPool& pool, const std::string& url) {
+  HttpRequest request;
+  HttpResponse response;
+  request.setUrl(url);
+  pool.request(request, response);
+}
+
+class HttpClientPoolTest : public ::testing::Test {
+public:
+  HttpClientPoolTest() : server(dispatcher, logger) {
+  }
+
+  virtual void SetUp() override {
+    server.start("127.0.0.1", TEST_PORT);
+  }
+
+  virtual void TearDown() override {
+    server.stop();
+  }
+
+  void get(HttpClientPool& pool, const std::string& url) {
+    HttpRequest request;
+    HttpResponse response;
+    request.setUrl(url);
+    pool.request(request, response);
+    ASSERT_EQ(url, response.getBody());
+    completed.push_back(url);
+  }
+
+protected:
+  System::Dispatcher dispatcher;
+  Logging::LoggerGroup logger;
+  TestHttpServer server;
+  std::vector<std::string> completed;
+};
+
+}
+
+TEST_F(HttpClientPoolTest, slowRequestDoesNotHoldBackOthers) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 2);
+
+  {
+    System::Context<> slow(dispatcher, [&] { get(pool, "/slow"); });
+    System::Context<> fast(dispatcher, [&] { get(pool, "/fast"); });
+    slow.get();
+    fast.get();
+  }
+
+  ASSERT_EQ(std::vector<std::string>({ "/fast", "/slow" }), completed);
+  ASSERT_TRUE(pool.isConnected());
+}
+
+TEST_F(HttpClientPoolTest, requestWaitsForFreeConnection) {
+  HttpClientPool pool(dispatcher, "127.0.0.1", TEST_PORT, 1);
+
+  {
+    System::Context<> slow(dispatcher, [&] { get(pool, "/slow"); });
+    System::Context<> fast(dispatcher, [&] { get(pool, "/fast"); });
+    slow.get();
+    fast.get();
+  }
+
+  ASSERT_EQ(std::vector<std::string>({ "/slow", "/fast" }), completed);
+}
+
+TEST_F(HttpClientPoolTest, reconnectsAfterServerClosedConnection) {
+  const uint16_t restartedPort = TEST_PORT + 1;
+  HttpClientPool pool(dispatcher, "127.0.0.1", restartedPort, 1);
+
+  {
+    TestHttpServer first(dispatcher, logger);
+    first.start("127.0.0.1", restartedPort);
+    get(pool, "/first");
+    first.stop();
+  }
+
+  TestHttpServer second(dispatcher, logger);
+  second.start("127.0.0.1", restartedPort);
+  get(pool, "/second");
+  second.stop();
+
+  ASSERT_EQ(std::vector<std::string>({ "/first", "/second" }), completed);
+  ASSERT_TRUE(pool.isConnected());
+}
+
+TEST_F(HttpClientPoolTest, retriesWhenReusedConnectionClosesBeforeResponse) {
+  const uint16_t closingPort = TEST_PORT + 2;
+  size_t requestCount = 0;
+  System::Context<> server(dispatcher, [&] { serveOneRequestPerConnection(dispatcher, closingPort, "", requestCount); });
+  dispatcher.yield();
+
+  HttpClientPool pool(dispatcher, "127.0.0.1", closingPort, 1);
+  request(pool, "/first");
+  request(pool, "/second");
+
+  ASSERT_EQ(3, requestCount);
+  ASSERT_TRUE(pool.isConnected());
+}
+
+TEST_F(HttpClientPoolTest, doesNotRetryAfterResponseStarted) {
+  const uint16_t closingPort = TEST_PORT + 2;
+  size_t requestCount = 0;
+  System::Context<> server(dispatcher, [&] { serveOneRequestPerConnection(dispatcher, closingPort, "HTTP/1.1 200", requestCount); });
+  dispatcher.yield();
+
+  HttpClientPool pool(dispatcher, "127.0.0.1", closingPort, 1);
+  request(pool, "/first");
+  ASSERT_ANY_THROW(request(pool, "/second"));
+
+  ASSERT_EQ(2, requestCount);
+  ASSERT_FALSE(pool.isConnected());
+}
+
+TEST_F(HttpClientPoolTest, doesNotResendNonIdempotentRequest) {
+  const uint16_t closingPort = TEST_PORT + 2;
+  size_t requestCount = 0;
+  System::Context<> server(dispatcher, [&] { serveOneRequestPerConnection(dispatcher, closingPort, "", requestCount); });
+  dispatcher.yield();
+
+  HttpClientPool pool(dispatcher, "127.0.0.1", closingPort, 1);
+  pool.addNonIdempotentUrl("/sendrawtransaction");
+  request(pool, "/first");
+  ASSERT_THROW(request(pool, "/sendrawtransaction"), ConnectionClosedException);
+
+  ASSERT_EQ(2, requestCount);
+  ASSERT_FALSE(pool.isConnected());
+}
@@ -121,6 +121,14 @@ std::vector<CryptoNote::Transaction> ICoreStub::getPoolTransactions() {
   return std::vector<CryptoNote::Transaction>();
 }
 
+std::vector<Crypto::Hash> ICoreStub::getPoolTransactionHashes() {
+  std::vector<Crypto::Hash> hashes;
+  for (const auto& kv : transactionPool) {
+    hashes.push_back(kv.first);
+  }
+  return hashes;
+}
+
 bool ICoreStub::getPoolChanges(const Crypto::Hash& tailBlockId, const std::vector<Crypto::Hash>& knownTxsIds,
                                std::vector<CryptoNote::Transaction>& addedTxs, std::vector<Crypto::Hash>& deletedTxsIds) {
   std::unordered_set<Crypto::Hash> knownSet;
@@ -302,6 +310,10 @@ bool ICoreStub::getMultisigOutputReference(const CryptoNote::MultisignatureInput
   return true;
 }
 
+bool ICoreStub::getExplorerTransaction(const Crypto::Hash& transactionHash, CryptoNote::ExplorerTransactionEntry& entry) {
+  return false;
+}
+
 void ICoreStub::addBlock(const CryptoNote::Block& block) {
   uint32_t height = boost::get<CryptoNote::BaseInput>(block.baseTransaction.inputs.front()).blockIndex;
   Crypto::Hash hash = CryptoNote::get_block_hash(block);
@@ -0,0 +1,280 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <boost/filesystem.hpp>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Event.h>
+
+#include "Common/JsonValue.h"
+#include "Common/Metrics.h"
+#include "CryptoNoteConfig.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "JsonRpcServer/JsonRpcServer.h"
+#include "P2p/NetNode.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/RpcServer.h"
+
+#include "ICryptoNoteProtocolQueryStub.h"
+
+using namespace CryptoNote;
+using Common::JsonValue;
+
+namespace {
+
+const uint16_t WALLET_TEST_PORT = 16700;
+const uint16_t DAEMON_TEST_PORT = 16701;
+
+std::string post(System::Dispatcher& dispatcher, uint16_t port, const std::string& body, const std::string& url = "/json_rpc") {
+  HttpClient client(dispatcher, "127.0.0.1", port);
+  HttpRequest request;
+  HttpResponse response;
+  request.setUrl(url);
+  request.setBody(body);
+  client.request(request, response);
+  return response.getBody();
+}
+
+std::string batchOf(size_t count, const std::string& request) {
+  std::string batch = "[";
+  for (size_t i = 0; i < count; ++i) {
+    batch += (i == 0 ? "" : ",") + request;
+  }
+
+  return batch + "]";
+}
+
+int64_t errorCode(const JsonValue& response) {
+  return response("error")("code").getInteger();
+}
+
+// Answers every request with its method name and records the calls and read-only runs
+class RecordingJsonRpcServer : public JsonRpcServer {
+public:
+  RecordingJsonRpcServer(System::Dispatcher& dispatcher, System::Event& stopEvent, Logging::ILogger& logger) :
+    JsonRpcServer(dispatcher, stopEvent, logger) {
+  }
+
+  std::vector<std::string> calls;
+
+protected:
+  virtual void processJsonRpcRequest(const JsonValue& req, JsonValue& resp) override {
+    prepareJsonResponse(req, resp);
+    if (!req.contains("method")) {
+      makeMethodNotFoundResponse(resp);
+      return;
+    }
+
+    calls.push_back(req("method").getString());
+    fillJsonResponse(JsonValue(req("method").getString()), resp);
+  }
+
+  virtual bool isReadOnlyRequest(const JsonValue& req) const override {
+    return req.contains("method") && req("method").getString().compare(0, 3, "get") == 0;
+  }
+
+  virtual void beginReadOnlyRequests() override {
+    calls.push_back("begin");
+  }
+
+  virtual void endReadOnlyRequests() override {
+    calls.push_back("end");
+  }
+};
+
+class JsonRpcServerBatchTest : public ::testing::Test {
+public:
+  JsonRpcServerBatchTest() : stopEvent(dispatcher), server(dispatcher, stopEvent, logger) {
+  }
+
+  JsonValue call(const std::string& body) {
+    std::string response = fetch("/json_rpc", body);
+    return response.empty() ? JsonValue() : JsonValue::fromString(response);
+  }
+
+  std::string fetch(const std::string& url, const std::string& body) {
+    std::string response;
+    System::Context<> serverContext(dispatcher, [this] { server.start("127.0.0.1", WALLET_TEST_PORT); });
+    dispatcher.yield();
+    response = post(dispatcher, WALLET_TEST_PORT, body, url);
+    stopEvent.set();
+    serverContext.get();
+    return response;
+  }
+
+protected:
+  System::Dispatcher dispatcher;
+  Logging::LoggerGroup logger;
+  System::Event stopEvent;
+  RecordingJsonRpcServer server;
+};
+
+class RpcServerBatchTest : public ::testing::Test {
+public:
+  RpcServerBatchTest() :
+    currency(CurrencyBuilder(logger).testnet(true).currency()),
+    c(currency, nullptr, logger),
+    protocol(currency, dispatcher, c, nullptr, logger),
+    p2p(dispatcher, protocol, logger),
+    server(dispatcher, logger, c, p2p, protocolQuery) {
+    configFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_%%%%%%%%%%%%");
+  }
+
+  virtual void SetUp() override {
+    CoreConfig coreConfig;
+    coreConfig.configFolder = configFolder.string();
+    ASSERT_TRUE(c.init(coreConfig, MinerConfig(), false));
+    server.start("127.0.0.1", DAEMON_TEST_PORT);
+  }
+
+  virtual void TearDown() override {
+    server.stop();
+    c.deinit();
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(configFolder, ignoredErrorCode);
+  }
+
+  JsonValue call(const std::string& body) {
+    std::string response = post(dispatcher, DAEMON_TEST_PORT, body);
+    return response.empty() ? JsonValue() : JsonValue::fromString(response);
+  }
+
+protected:
+  System::Dispatcher dispatcher;
+  Logging::LoggerGroup logger;
+  Currency currency;
+  core c;
+  CryptoNoteProtocolHandler protocol;
+  NodeServer p2p;
+  ICryptoNoteProtocolQueryStub protocolQuery;
+  RpcServer server;
+  boost::filesystem::path configFolder;
+};
+
+}
+
+TEST_F(JsonRpcServerBatchTest, mixedBatchAnswersRequestsInOrder) {
+  JsonValue response = call(R"([{"jsonrpc":"2.0","id":1,"method":"first"},)"
+    R"({"jsonrpc":"2.0","method":"notification"},7,{"jsonrpc":"2.0","id":2,"method":"second"}])");
+
+  ASSERT_TRUE(response.isArray());
+  ASSERT_EQ(3, response.size());
+  ASSERT_EQ(1, response[0]("id").getInteger());
+  ASSERT_EQ("first", response[0]("result").getString());
+  ASSERT_EQ(-32600, errorCode(response[1]));
+  ASSERT_EQ(2, response[2]("id").getInteger());
+  ASSERT_EQ("second", response[2]("result").getString());
+  ASSERT_EQ(std::vector<std::string>({ "first", "notification", "second" }), server.calls);
+}
+
+TEST_F(JsonRpcServerBatchTest, notificationOnlyBatchGetsEmptyBody) {
+  JsonValue response = call(R"([{"jsonrpc":"2.0","method":"first"},{"jsonrpc":"2.0","method":"second"}])");
+
+  ASSERT_TRUE(response.isNil());
+  ASSERT_EQ(std::vector<std::string>({ "first", "second" }), server.calls);
+}
+
+TEST_F(JsonRpcServerBatchTest, emptyBatchIsInvalidRequest) {
+  JsonValue response = call("[]");
+
+  ASSERT_TRUE(response.isObject());
+  ASSERT_EQ(-32600, errorCode(response));
+  ASSERT_TRUE(server.calls.empty());
+}
+
+TEST_F(JsonRpcServerBatchTest, oversizedBatchIsInvalidRequest) {
+  JsonValue response = call(batchOf(JSON_RPC_MAX_BATCH_SIZE + 1, R"({"jsonrpc":"2.0","id":1,"method":"first"})"));
+
+  ASSERT_TRUE(response.isObject());
+  ASSERT_EQ(-32600, errorCode(response));
+  ASSERT_TRUE(server.calls.empty());
+}
+
+TEST_F(JsonRpcServerBatchTest, consecutiveReadOnlyRequestsShareOneRun) {
+  JsonValue response = call(R"([{"jsonrpc":"2.0","id":1,"method":"getA"},{"jsonrpc":"2.0","id":2,"method":"getB"},)"
+    R"({"jsonrpc":"2.0","id":3,"method":"send"},{"jsonrpc":"2.0","id":4,"method":"getC"}])");
+
+  ASSERT_EQ(4, response.size());
+  ASSERT_EQ(std::vector<std::string>({ "begin", "getA", "getB", "end", "send", "begin", "getC", "end" }), server.calls);
+}
+
+TEST_F(JsonRpcServerBatchTest, servesMetrics) {
+  Common::MetricsRegistry::instance().histogram("dynex_node_rpc_call_seconds",
+    "Node RPC call latency seen by NodeRpcProxy by call, including the wait for a free connection", "call=\"/getinfo\"");
+
+  std::string metrics = fetch("/metrics", "");
+
+  ASSERT_NE(std::string::npos, metrics.find("dynex_node_rpc_call_seconds"));
+  ASSERT_TRUE(server.calls.empty());
+}
+
+TEST_F(RpcServerBatchTest, mixedBatchAnswersRequestsInOrder) {
+  JsonValue response = call(R"([{"jsonrpc":"2.0","id":1,"method":"getblockcount","params":{}},)"
+    R"({"jsonrpc":"2.0","method":"getblockcount","params":{}},7,{"jsonrpc":"2.0","id":2,"method":"nosuch"}])");
+
+  ASSERT_TRUE(response.isArray());
+  ASSERT_EQ(3, response.size());
+  ASSERT_EQ(1, response[0]("id").getInteger());
+  ASSERT_EQ(1, response[0]("result")("count").getInteger());
+  ASSERT_EQ(-32600, errorCode(response[1]));
+  ASSERT_EQ(2, response[2]("id").getInteger());
+  ASSERT_EQ(-32601, errorCode(response[2]));
+}
+
+TEST_F(RpcServerBatchTest, notificationOnlyBatchGetsEmptyBody) {
+  JsonValue response = call(R"([{"jsonrpc":"2.0","method":"getblockcount","params":{}},{"jsonrpc":"2.0","method":"getcurrencyid","params":{}}])");
+
+  ASSERT_TRUE(response.isNil());
+}
+
+TEST_F(RpcServerBatchTest, emptyBatchIsInvalidRequest) {
+  JsonValue response = call("[]");
+
+  ASSERT_TRUE(response.isObject());
+  ASSERT_EQ(-32600, errorCode(response));
+}
+
+TEST_F(RpcServerBatchTest, oversizedBatchIsInvalidRequest) {
+  JsonValue response = call(batchOf(JSON_RPC_MAX_BATCH_SIZE + 1, R"({"jsonrpc":"2.0","id":1,"method":"getblockcount","params":{}})"));
+
+  ASSERT_TRUE(response.isObject());
+  ASSERT_EQ(-32600, errorCode(response));
+
+  response = call(batchOf(JSON_RPC_MAX_BATCH_SIZE, R"({"jsonrpc":"2.0","id":1,"method":"getblockcount","params":{}})"));
+  ASSERT_TRUE(response.isArray());
+  ASSERT_EQ(JSON_RPC_MAX_BATCH_SIZE, response.size());
+}
@@ -0,0 +1,125 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+
+#include <iomanip>
+#include <sstream>
+
+#include "Logging/LoggerGroup.h"
+#include "Logging/LoggerRef.h"
+#include "Logging/StreamLogger.h"
+
+using namespace Logging;
+
+namespace {
+
+class CountingLogger : public ILogger {
+public:
+  CountingLogger(Level level) : level(level), messages(0) {
+  }
+
+  virtual void operator()(const std::string& category, Level level, boost::posix_time::ptime time, const std::string& body) override {
+    ++messages;
+    lastBody = body;
+  }
+
+  virtual Level getMaxLevel() const override {
+    return level;
+  }
+
+  Level level;
+  size_t messages;
+  std::string lastBody;
+};
+
+}
+
+TEST(LoggerMessage, skipsMessagesAboveMaxLevel) {
+  CountingLogger counter(INFO);
+  LoggerRef logger(counter, "test");
+
+  logger(DEBUGGING) << "dropped " << 1;
+  logger(TRACE) << "dropped";
+  ASSERT_EQ(0, counter.messages);
+
+  logger(INFO) << "kept " << 2;
+  ASSERT_EQ(1, counter.messages);
+  ASSERT_EQ(DEFAULT + "kept 2\n", counter.lastBody);
+}
+
+TEST(LoggerMessage, groupLevelIsMostVerboseChildWithinGroupLevel) {
+  CountingLogger info(INFO);
+  CountingLogger trace(TRACE);
+  LoggerGroup group(DEBUGGING);
+  ASSERT_EQ(FATAL, group.getMaxLevel());
+
+  group.addLogger(info);
+  ASSERT_EQ(INFO, group.getMaxLevel());
+
+  group.addLogger(trace);
+  ASSERT_EQ(DEBUGGING, group.getMaxLevel());
+
+  LoggerRef logger(group, "test");
+  logger(TRACE) << "dropped";
+  ASSERT_EQ(0, trace.messages);
+
+  logger(DEBUGGING) << "kept";
+  ASSERT_EQ(1, trace.messages);
+}
+
+TEST(LoggerMessage, splitsLinesAndResetsFormatting) {
+  std::ostringstream output;
+  StreamLogger streamLogger(output, TRACE);
+  streamLogger.setPattern("");
+  LoggerRef logger(streamLogger, "test");
+
+  logger(INFO) << std::hex << 255 << std::endl << 255;
+  logger(INFO) << 255 << " " << std::string(300, 'x').size();
+
+  ASSERT_EQ("ff\nff\n255 300\n", output.str());
+}
+
+TEST(LoggerMessage, allowsNestedMessages) {
+  CountingLogger counter(TRACE);
+  LoggerRef logger(counter, "test");
+
+  auto outer = logger(INFO);
+  outer << "outer";
+  logger(INFO) << "inner";
+  ASSERT_EQ(DEFAULT + "inner\n", counter.lastBody);
+
+  outer << " message";
+  {
+    auto moved = std::move(outer);
+  }
+
+  ASSERT_EQ(2, counter.messages);
+  ASSERT_EQ(DEFAULT + "outer message\n", counter.lastBody);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+#include "Common/Metrics.h"
+
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace Common;
+
+namespace {
+
+std::string format(const MetricsRegistry& registry) {
+  std::ostringstream stream;
+  registry.write(stream);
+  return stream.str();
+}
+
+}
+
+TEST(Metrics, returnsSameSeriesForSameLabels) {
+  MetricsRegistry registry;
+  MetricCounter& first = registry.counter("requests_total", "Requests", "endpoint=\"/a\"");
+  MetricCounter& second = registry.counter("requests_total", "Requests", "endpoint=\"/b\"");
+  ASSERT_NE(&first, &second);
+  ASSERT_EQ(&first, &registry.counter("requests_total", "Requests", "endpoint=\"/a\""));
+}
+
+TEST(Metrics, rejectsFamilyOfAnotherType) {
+  MetricsRegistry registry;
+  registry.counter("value", "Value");
+  ASSERT_THROW(registry.gauge("value", "Value"), std::runtime_error);
+}
+
+TEST(Metrics, writesCountersAndGauges) {
+  MetricsRegistry registry;
+  registry.counter("requests_total", "Requests", "endpoint=\"/a\"").add(3);
+  registry.gauge("queue_size", "Queue size").set(-2);
+
+  std::string text = format(registry);
+  ASSERT_NE(std::string::npos, text.find("# TYPE requests_total counter\n"));
+  ASSERT_NE(std::string::npos, text.find("requests_total{endpoint=\"/a\"} 3\n"));
+  ASSERT_NE(std::string::npos, text.find("# HELP queue_size Queue size\n"));
+  ASSERT_NE(std::string::npos, text.find("queue_size -2\n"));
+}
+
+TEST(Metrics, writesCumulativeHistogramBuckets) {
+  MetricsRegistry registry;
+  MetricHistogram& histogram = registry.histogram("latency_seconds", "Latency", "stage=\"x\"");
+  histogram.observe(std::chrono::microseconds(5));
+  histogram.observe(std::chrono::microseconds(70));
+  histogram.observe(std::chrono::seconds(20));
+  ASSERT_EQ(3, histogram.getCount());
+  ASSERT_EQ(1, histogram.getBucket(MetricHistogram::BUCKET_COUNT));
+
+  std::string text = format(registry);
+  ASSERT_NE(std::string::npos, text.find("# TYPE latency_seconds histogram\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"x\",le=\"0.000010\"} 1\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"x\",le=\"0.000100\"} 2\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"x\",le=\"10.000000\"} 2\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_bucket{stage=\"x\",le=\"+Inf\"} 3\n"));
+  ASSERT_NE(std::string::npos, text.find("latency_seconds_count{stage=\"x\"} 3\n"));
+}
+
+TEST(Metrics, meteredMutexRecordsOnlyContendedWaits) {
+  MetricHistogram waits;
+  MeteredMutex<std::mutex> mutex(waits);
+  {
+    std::lock_guard<MeteredMutex<std::mutex>> lock(mutex);
+  }
+
+  ASSERT_EQ(0, waits.getCount());
+
+  mutex.lock();
+  std::thread waiter([&mutex] {
+    std::lock_guard<MeteredMutex<std::mutex>> lock(mutex);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  mutex.unlock();
+  waiter.join();
+  ASSERT_EQ(1, waits.getCount());
+}
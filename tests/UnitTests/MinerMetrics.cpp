@@ -0,0 +1,150 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <Logging/LoggerGroup.h>
+#include <System/Dispatcher.h>
+
+#include "Miner/MinerMetrics.h"
+#include "Miner/MinerStatsServer.h"
+#include "Serialization/SerializationTools.h"
+
+using namespace CryptoNote;
+
+TEST(MinerMetrics, emptyLatencyReportsZeros) {
+  MinerMetrics metrics(1);
+  LatencyStatistics statistics = metrics.getStatistics().templateFetch;
+  ASSERT_EQ(0, statistics.count);
+  ASSERT_EQ(0, statistics.averageMicroseconds);
+  ASSERT_EQ(0, statistics.p50Microseconds);
+  ASSERT_EQ(0, statistics.p99Microseconds);
+}
+
+TEST(MinerMetrics, latencyPercentilesAreBucketUpperBounds) {
+  MinerMetrics metrics(1);
+  for (size_t i = 0; i < 98; ++i) {
+    metrics.templateFetch().observe(std::chrono::microseconds(80));
+  }
+
+  metrics.templateFetch().observe(std::chrono::microseconds(4000));
+  metrics.templateFetch().observe(std::chrono::microseconds(4000));
+
+  LatencyStatistics statistics = metrics.getStatistics().templateFetch;
+  ASSERT_EQ(100, statistics.count);
+  ASSERT_EQ((98 * 80 + 2 * 4000) / 100, statistics.averageMicroseconds);
+  // 80 us falls into (50, 100], 4000 us into (1000, 5000]
+  ASSERT_EQ(100, statistics.p50Microseconds);
+  ASSERT_EQ(5000, statistics.p99Microseconds);
+}
+
+TEST(MinerMetrics, latencyOverflowReportsLargestBound) {
+  MinerMetrics metrics(1);
+  metrics.blockchainPoll().observe(std::chrono::seconds(20));
+
+  LatencyStatistics statistics = metrics.getStatistics().blockchainPoll;
+  ASSERT_EQ(1, statistics.count);
+  ASSERT_EQ(Common::MetricHistogram::BUCKET_BOUNDS.back(), statistics.p50Microseconds);
+  ASSERT_EQ(Common::MetricHistogram::BUCKET_BOUNDS.back(), statistics.p99Microseconds);
+}
+
+TEST(MinerMetrics, countersAreAggregated) {
+  MinerMetrics metrics(3);
+  metrics.addHashes(0, 10);
+  metrics.addHashes(2, 5);
+  metrics.addHashes(2, 1);
+  metrics.jobStarted();
+  metrics.jobStarted();
+  metrics.blockFound();
+  metrics.blockFound();
+  metrics.staleBlock();
+  metrics.blockSubmitted(true);
+  metrics.blockSubmitted(false);
+  metrics.templateFetch().observe(std::chrono::microseconds(10));
+
+  ASSERT_EQ(16, metrics.getHashes());
+
+  MinerStatistics statistics = metrics.getStatistics();
+  ASSERT_EQ(16, statistics.hashes);
+  ASSERT_EQ((std::vector<uint64_t>{ 10, 0, 6 }), statistics.threadHashes);
+  ASSERT_EQ(2, statistics.jobs);
+  ASSERT_EQ(2, statistics.blocksFound);
+  ASSERT_EQ(1, statistics.staleBlocks);
+  ASSERT_EQ(1, statistics.blocksSubmitted);
+  ASSERT_EQ(1, statistics.blocksRejected);
+  ASSERT_EQ(1, statistics.templateFetch.count);
+  ASSERT_EQ(0, statistics.blockSubmit.count);
+  ASSERT_EQ(0, statistics.blockchainPoll.count);
+}
+
+TEST(MinerMetrics, metricTimerRecordsScope) {
+  MinerMetrics metrics(1);
+  {
+    Common::MetricTimer timer(metrics.blockSubmit());
+  }
+
+  ASSERT_EQ(1, metrics.getStatistics().blockSubmit.count);
+}
+
+TEST(MinerStatsServer, statsAreServedAsJson) {
+  Logging::LoggerGroup logger;
+  System::Dispatcher dispatcher;
+  MinerMetrics metrics(2);
+  metrics.addHashes(1, 42);
+  metrics.blockFound();
+
+  MinerStatsServer server(dispatcher, logger, metrics);
+  HttpRequest request;
+  request.setUrl("/stats");
+  HttpResponse response;
+  server.processRequest(request, response);
+
+  ASSERT_EQ(HttpResponse::STATUS_200, response.getStatus());
+  ASSERT_EQ("application/json", response.getHeaders().at("Content-Type"));
+
+  MinerStatistics statistics;
+  ASSERT_TRUE(loadFromJson(statistics, response.getBody()));
+  ASSERT_EQ(42, statistics.hashes);
+  ASSERT_EQ((std::vector<uint64_t>{ 0, 42 }), statistics.threadHashes);
+  ASSERT_EQ(1, statistics.blocksFound);
+}
+
+TEST(MinerStatsServer, unknownUrlIsNotFound) {
+  Logging::LoggerGroup logger;
+  System::Dispatcher dispatcher;
+  MinerMetrics metrics(1);
+
+  MinerStatsServer server(dispatcher, logger, metrics);
+  HttpRequest request;
+  request.setUrl("/");
+  HttpResponse response;
+  server.processRequest(request, response);
+
+  ASSERT_EQ(HttpResponse::STATUS_404, response.getStatus());
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Miner/MiningJob.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+// every field of job N is derived from N, so a reader can tell a torn job from a whole one
+BinaryArray makeBlob(uint64_t epoch) {
+  return BinaryArray(40 + epoch % 80, static_cast<uint8_t>(epoch));
+}
+
+size_t makeNonceOffset(uint64_t epoch) {
+  return epoch % 36;
+}
+
+bool isWholeJob(const MiningJobDescriptor::Job& job) {
+  BinaryArray blob = makeBlob(job.epoch);
+  return job.difficulty == job.epoch &&
+    job.startNonce == static_cast<uint32_t>(job.epoch * 7) &&
+    job.nonceOffset == makeNonceOffset(job.epoch) &&
+    job.blobSize == blob.size() &&
+    std::equal(blob.begin(), blob.end(), job.blob);
+}
+
+}
+
+TEST(MiningJobDescriptor, epochIsZeroUntilFirstJob) {
+  MiningJobDescriptor descriptor;
+  ASSERT_EQ(0, descriptor.epoch());
+
+  ASSERT_EQ(1, descriptor.publish(makeBlob(1), makeNonceOffset(1), 1, 7));
+  ASSERT_EQ(1, descriptor.epoch());
+
+  MiningJobDescriptor::Job job;
+  descriptor.read(job);
+  ASSERT_EQ(1, job.epoch);
+  ASSERT_TRUE(isWholeJob(job));
+}
+
+TEST(MiningJobDescriptor, oversizedBlobIsRejected) {
+  MiningJobDescriptor descriptor;
+  ASSERT_ANY_THROW(descriptor.publish(BinaryArray(MiningJobDescriptor::MAX_HASHING_BLOB_SIZE + 1), 0, 1, 0));
+  ASSERT_ANY_THROW(descriptor.publish(BinaryArray(40), 37, 1, 0));
+  ASSERT_EQ(0, descriptor.epoch());
+}
+
+TEST(MiningJobDescriptor, concurrentReadersNeverObserveTornJob) {
+  const size_t READER_COUNT = 3;
+  const size_t MIN_READS = 100000;
+
+  MiningJobDescriptor descriptor;
+  descriptor.publish(makeBlob(1), makeNonceOffset(1), 1, 7);
+
+  std::atomic<bool> stop(false);
+  std::atomic<size_t> tornJobs(0);
+  std::atomic<size_t> epochRegressions(0);
+  std::atomic<size_t> reads(0);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < READER_COUNT; ++i) {
+    readers.emplace_back([&] {
+      uint64_t lastEpoch = 0;
+      MiningJobDescriptor::Job job;
+      while (!stop) {
+        descriptor.read(job);
+        if (!isWholeJob(job)) {
+          ++tornJobs;
+        }
+
+        if (job.epoch < lastEpoch) {
+          ++epochRegressions;
+        }
+
+        lastEpoch = job.epoch;
+        ++reads;
+      }
+    });
+  }
+
+  // keep publishing until the readers had plenty of chances to race a write, on any number of cores
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+  for (uint64_t epoch = 2; reads < MIN_READS || std::chrono::steady_clock::now() < deadline; ++epoch) {
+    ASSERT_EQ(epoch, descriptor.publish(makeBlob(epoch), makeNonceOffset(epoch), epoch, static_cast<uint32_t>(epoch * 7)));
+  }
+
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  ASSERT_EQ(0, tornJobs);
+  ASSERT_EQ(0, epochRegressions);
+}
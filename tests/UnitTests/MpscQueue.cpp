@@ -0,0 +1,97 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+#include "Common/MpscQueue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Common;
+
+TEST(MpscQueue, popsInPushOrder) {
+  MpscQueue<int> queue;
+  int value = 0;
+  ASSERT_FALSE(queue.pop(value));
+
+  for (int i = 0; i < 10; ++i) {
+    queue.push(i);
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(i, value);
+  }
+
+  ASSERT_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueue, keepsOrderOfEachProducer) {
+  const unsigned producerCount = 4;
+  const unsigned iterations = 100000;
+  MpscQueue<std::pair<unsigned, unsigned>> queue;
+
+  std::vector<std::thread> producers;
+  for (unsigned producer = 0; producer < producerCount; ++producer) {
+    producers.emplace_back([&queue, producer, iterations] {
+      for (unsigned i = 0; i < iterations; ++i) {
+        queue.push(std::make_pair(producer, i));
+      }
+    });
+  }
+
+  std::vector<unsigned> expected(producerCount, 0);
+  unsigned popped = 0;
+  std::pair<unsigned, unsigned> item;
+  while (popped < producerCount * iterations) {
+    if (queue.pop(item)) {
+      ASSERT_EQ(expected[item.first], item.second);
+      ++expected[item.first];
+      ++popped;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  ASSERT_FALSE(queue.pop(item));
+}
+
+TEST(MpscQueue, AllowsMoveOnly) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.push(std::unique_ptr<int>(new int(100)));
+
+  std::unique_ptr<int> value;
+  ASSERT_TRUE(queue.pop(value));
+  ASSERT_EQ(100, *value);
+}
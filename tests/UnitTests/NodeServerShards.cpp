@@ -0,0 +1,219 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <future>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Ipv4Address.h>
+#include <System/TcpConnection.h>
+#include <System/TcpConnector.h>
+#include <System/Timer.h>
+
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "Common/Metrics.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "P2p/LevinProtocol.h"
+#include "P2p/NetNode.h"
+#include "P2p/NetNodeConfig.h"
+#include "P2p/P2pNetworks.h"
+
+#include "ICoreStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t TEST_PORT = 16690;
+
+// NodeServer with its own dispatcher thread, incoming connections go to shards
+class ShardedNodeServer {
+public:
+  ShardedNodeServer(const Currency& currency, ICoreStub& core, Logging::ILogger& logger, const boost::filesystem::path& configFolder) {
+    std::promise<void> initialized;
+    auto initializedFuture = initialized.get_future();
+    thread = std::thread([&] {
+      System::Dispatcher dispatcher;
+      CryptoNoteProtocolHandler handler(currency, dispatcher, core, nullptr, logger);
+      NodeServer server(dispatcher, handler, logger);
+      handler.set_p2p_endpoint(&server);
+
+      NetNodeConfig config;
+      config.setTestnet(true);
+      config.setBindIp("127.0.0.1");
+      config.setBindPort(TEST_PORT);
+      config.setAllowLocalIp(true);
+      config.setHideMyPort(true);
+      config.setConfigFolder(configFolder.string());
+      config.setShardCount(2);
+
+      if (!server.init(config)) {
+        initialized.set_exception(std::make_exception_ptr(std::runtime_error("NodeServer::init failed")));
+        return;
+      }
+
+      this->server = &server;
+      initialized.set_value();
+      server.run();
+      server.deinit();
+    });
+
+    try {
+      initializedFuture.get();
+    } catch (...) {
+      thread.join();
+      throw;
+    }
+  }
+
+  ~ShardedNodeServer() {
+    server->sendStopSignal();
+    thread.join();
+  }
+
+  NodeServer* server = nullptr;
+
+private:
+  std::thread thread;
+};
+
+class NodeServerShardsTest : public ::testing::Test {
+public:
+  NodeServerShardsTest() :
+    currency(CurrencyBuilder(logger).currency()),
+    core(currency.genesisBlock()) {
+  }
+
+protected:
+  virtual void SetUp() override {
+    configFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_%%%%%%%%%%%%");
+    boost::filesystem::create_directories(configFolder);
+  }
+
+  virtual void TearDown() override {
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(configFolder, ignoredErrorCode);
+  }
+
+  COMMAND_HANDSHAKE::request makeHandshake() {
+    COMMAND_HANDSHAKE::request request;
+    request.node_data.network_id = CRYPTONOTE_NETWORK;
+    request.node_data.network_id.data[0] += 1; // testnet
+    request.node_data.version = P2PProtocolVersion::CURRENT;
+    request.node_data.local_time = time(nullptr);
+    request.node_data.my_port = 0;
+    request.node_data.peer_id = Crypto::rand<uint64_t>();
+    request.payload_data.current_height = 1;
+    request.payload_data.top_id = get_block_hash(currency.genesisBlock());
+    return request;
+  }
+
+  // reads commands until one with the given id arrives
+  static bool waitForCommand(LevinProtocol& proto, uint32_t command, LevinProtocol::Command& cmd) {
+    while (proto.readCommand(cmd)) {
+      if (cmd.command == command) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  Logging::LoggerGroup logger;
+  Currency currency;
+  ICoreStub core;
+  boost::filesystem::path configFolder;
+};
+
+TEST_F(NodeServerShardsTest, handshakeAndRelayGoThroughShards) {
+  ShardedNodeServer node(currency, core, logger, configFolder);
+
+  NOTIFY_NEW_TRANSACTIONS::request relayed;
+  relayed.txs.push_back("transaction blob");
+  BinaryArray relayedBuffer = LevinProtocol::encode(relayed);
+
+  System::Dispatcher dispatcher;
+  System::Context<> client(dispatcher, [&] {
+    std::vector<System::TcpConnection> connections;
+    for (size_t i = 0; i < 2; ++i) {
+      connections.push_back(System::TcpConnector(dispatcher).connect(System::Ipv4Address("127.0.0.1"), TEST_PORT));
+    }
+
+    for (auto& connection : connections) {
+      LevinProtocol proto(connection);
+      COMMAND_HANDSHAKE::response response;
+      ASSERT_TRUE(proto.invoke(COMMAND_HANDSHAKE::ID, makeHandshake(), response));
+      ASSERT_TRUE(makeHandshake().node_data.network_id == response.node_data.network_id);
+      ASSERT_EQ(P2PProtocolVersion::V2, response.node_data.version);
+      ASSERT_EQ(1, response.payload_data.current_height);
+
+      // the connection is synchronized and becomes a relay target once the pool request arrives
+      LevinProtocol::Command cmd;
+      ASSERT_TRUE(waitForCommand(proto, NOTIFY_REQUEST_TX_POOL::ID, cmd));
+    }
+
+    std::string labels = "command=\"" + std::to_string(NOTIFY_NEW_TRANSACTIONS::ID) + "\"";
+    auto& sentMessages = Common::MetricsRegistry::instance().counter("dynex_p2p_sent_messages_total", "P2P messages sent by command", labels);
+    auto& sentBytes = Common::MetricsRegistry::instance().counter("dynex_p2p_sent_bytes_total", "P2P payload bytes sent by command", labels);
+    uint64_t sentMessagesBefore = sentMessages.get();
+    uint64_t sentBytesBefore = sentBytes.get();
+
+    static_cast<IP2pEndpoint*>(node.server)->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, relayedBuffer);
+
+    for (auto& connection : connections) {
+      LevinProtocol proto(connection);
+      LevinProtocol::Command cmd;
+      ASSERT_TRUE(waitForCommand(proto, NOTIFY_NEW_TRANSACTIONS::ID, cmd));
+      ASSERT_TRUE(cmd.isNotify);
+      ASSERT_EQ(relayedBuffer, cmd.buf);
+    }
+
+    // the shard threads write the relay and count it
+    ASSERT_EQ(sentMessagesBefore + connections.size(), sentMessages.get());
+    ASSERT_EQ(sentBytesBefore + connections.size() * relayedBuffer.size(), sentBytes.get());
+  });
+
+  System::Context<> watchdog(dispatcher, [&] {
+    System::Timer(dispatcher).sleep(std::chrono::seconds(10));
+    client.interrupt();
+  });
+
+  client.get();
+  watchdog.interrupt();
+}
+
+}
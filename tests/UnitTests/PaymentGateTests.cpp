@@ -55,7 +55,7 @@ public:
   {}
 
   WalletConfiguration createWalletConfiguration(const std::string& walletFile = "pgwalleg.bin") const {
-    return WalletConfiguration{ walletFile, "pass" };
+    return WalletConfiguration{ walletFile, "pass", 0 };
   }
 
   std::unique_ptr<WalletService> createWalletService(const WalletConfiguration& cfg) {
@@ -0,0 +1,143 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+
+#include "Logging/LoggerRef.h"
+#include "Logging/StreamLogger.h"
+
+using namespace Logging;
+
+namespace {
+
+// Publishes the written text on every flush so the test can wait for the writer thread
+class FlushedText : public std::stringbuf {
+public:
+  bool waitFor(const std::string& fragment, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return flushed.wait_for(lock, timeout, [&] { return text.find(fragment) != std::string::npos; });
+  }
+
+  std::string get() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return text;
+  }
+
+protected:
+  virtual int sync() override {
+    std::unique_lock<std::mutex> lock(mutex);
+    text = str();
+    flushed.notify_all();
+    return 0;
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable flushed;
+  std::string text;
+};
+
+size_t countLines(const std::string& text) {
+  return std::count(text.begin(), text.end(), '\n');
+}
+
+}
+
+TEST(StreamLogger, asyncWritesQueuedMessagesOnStop) {
+  FlushedText buffer;
+  std::ostream output(&buffer);
+  StreamLogger streamLogger(output, TRACE);
+  streamLogger.setPattern("");
+  streamLogger.startAsync(1024, std::chrono::milliseconds(60000));
+
+  LoggerRef logger(streamLogger, "test");
+  for (int i = 0; i < 10; ++i) {
+    logger(INFO, BRIGHT_GREEN) << "message " << i;
+  }
+
+  streamLogger.stopAsync();
+  std::string text = buffer.get();
+  ASSERT_EQ(10, countLines(text));
+  ASSERT_EQ(0, text.find("message 0\n"));
+  ASSERT_EQ(std::string::npos, text.find(ILogger::COLOR_DELIMETER));
+}
+
+TEST(StreamLogger, asyncFlushesSevereMessagesImmediately) {
+  FlushedText buffer;
+  std::ostream output(&buffer);
+  StreamLogger streamLogger(output, TRACE);
+  streamLogger.startAsync(1024, std::chrono::milliseconds(60000), WARNING);
+
+  LoggerRef logger(streamLogger, "test");
+  logger(INFO) << "first";
+  logger(WARNING) << "urgent";
+  ASSERT_TRUE(buffer.waitFor("urgent", std::chrono::milliseconds(10000)));
+  ASSERT_NE(std::string::npos, buffer.get().find("first"));
+}
+
+TEST(StreamLogger, asyncZeroFlushIntervalStillFlushesPeriodically) {
+  FlushedText buffer;
+  std::ostream output(&buffer);
+  StreamLogger streamLogger(output, TRACE);
+  streamLogger.startAsync(1024, std::chrono::milliseconds(0));
+
+  LoggerRef logger(streamLogger, "test");
+  logger(INFO) << "periodic";
+  ASSERT_TRUE(buffer.waitFor("periodic", std::chrono::milliseconds(10000)));
+}
+
+TEST(StreamLogger, asyncDropsMessagesWhenQueueIsFull) {
+  FlushedText buffer;
+  std::ostream output(&buffer);
+  StreamLogger streamLogger(output, TRACE);
+  streamLogger.setPattern("");
+  streamLogger.startAsync(4, std::chrono::milliseconds(60000));
+
+  LoggerRef logger(streamLogger, "test");
+  const size_t messages = 10000;
+  for (size_t i = 0; i < messages; ++i) {
+    logger(INFO) << "message " << i;
+  }
+
+  streamLogger.stopAsync();
+  std::string text = buffer.get();
+  uint64_t dropped = streamLogger.getDroppedCount();
+  size_t reports = 0;
+  for (size_t pos = text.find(" log messages dropped\n"); pos != std::string::npos; pos = text.find(" log messages dropped\n", pos + 1)) {
+    ++reports;
+  }
+
+  ASSERT_EQ(dropped > 0, reports > 0);
+  ASSERT_EQ(messages, countLines(text) - reports + dropped);
+}
@@ -1277,17 +1277,23 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   generator.generateEmptyBlocks(20);
   m_node.setGetNewBlocksLimit(10);
   
-  int requestsCount = 0;
-  std::list<Hash> firstlyKnownBlockIdsTaken;
-  std::list<Hash> secondlyKnownBlockIdsTaken;
+  // the next range is requested before the current one is processed, so requests are matched to ranges by the known tail
+  int processedRangesCount = 0;
+  Hash lastAcceptedBlock = NULL_HASH;
+  std::vector<std::list<Hash>> knownBlockIdsTaken;
 
   std::vector<Hash> firstlyReceivedBlocks;
   std::vector<Hash> secondlyReceivedBlocks;
 
 
   c.onNewBlocksFunctor = [&](const CompleteBlock* blocks, uint32_t, size_t count) -> bool {
+    ++processedRangesCount;
 
-    if (requestsCount == 2) {
+    if (processedRangesCount == 1) {
+      lastAcceptedBlock = blocks[count - 1].blockHash;
+    }
+
+    if (processedRangesCount == 2) {
       for (size_t i = 0; i < count; ++i) {
         firstlyReceivedBlocks.push_back(blocks[i].blockHash);
       }
@@ -1295,7 +1301,7 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
       return false;
     }
 
-    if (requestsCount == 3) {
+    if (processedRangesCount == 3) {
       for (size_t i = 0; i < count; ++i) {
         secondlyReceivedBlocks.push_back(blocks[i].blockHash);
       }
@@ -1305,16 +1311,7 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   };
 
   m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const INode::Callback& callback) -> bool {
-    if (requestsCount == 1) {
-      firstlyKnownBlockIdsTaken.assign(knownBlockIds.begin(), knownBlockIds.end());
-    }
-
-    if (requestsCount == 2) {
-      secondlyKnownBlockIdsTaken.assign(knownBlockIds.begin(), knownBlockIds.end());
-    }
-
-
-    ++requestsCount;
+    knownBlockIdsTaken.emplace_back(knownBlockIds.begin(), knownBlockIds.end());
     return true;
   };
 
@@ -1330,10 +1327,86 @@ TEST_F(BcSTest, checkBlocksRerequestingOnError) {
   m_sync.removeObserver(&o1);
   o1.syncFunc = [](std::error_code) {};
 
-  EXPECT_EQ(firstlyKnownBlockIdsTaken, secondlyKnownBlockIdsTaken);
+  std::vector<std::list<Hash>> rangeAfterAcceptedRequests;
+  for (const auto& knownBlockIds : knownBlockIdsTaken) {
+    if (knownBlockIds.front() == lastAcceptedBlock) {
+      rangeAfterAcceptedRequests.push_back(knownBlockIds);
+    }
+  }
+
+  ASSERT_EQ(2, rangeAfterAcceptedRequests.size());
+  EXPECT_EQ(rangeAfterAcceptedRequests[0], rangeAfterAcceptedRequests[1]);
   EXPECT_EQ(firstlyReceivedBlocks, secondlyReceivedBlocks);
 }
 
+TEST_F(BcSTest, prefetchedRangeNotStartingAtConsumerTailIsRequestedAgain) {
+  FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
+  IBlockchainSynchronizerFunctorialObserver o1;
+  EventWaiter e;
+  o1.syncFunc = [&](std::error_code) {
+    e.notify();
+  };
+
+  generator.generateEmptyBlocks(20);
+  m_node.setGetNewBlocksLimit(10);
+
+  std::vector<Hash> queriedTails;
+  size_t queriesBeforeFirstRange = 0;
+  std::vector<Hash> receivedBlocks;
+  bool detached = false;
+
+  m_node.queryBlocksFunctor = [&](const std::vector<Hash>& knownBlockIds, uint64_t timestamp, std::vector<BlockShortEntry>& newBlocks, uint32_t& startHeight, const INode::Callback& callback) -> bool {
+    queriedTails.push_back(knownBlockIds.front());
+    if (queriedTails.size() == 2) {
+      // the node answers the read-ahead from the genesis block, as if it had switched chains in the meantime
+      BlockShortEntry genesis;
+      genesis.hasBlock = false;
+      genesis.blockHash = knownBlockIds.back();
+      startHeight = 0;
+      newBlocks.push_back(genesis);
+      callback(std::error_code());
+      return false;
+    }
+
+    return true;
+  };
+
+  c.onNewBlocksFunctor = [&](const CompleteBlock* blocks, uint32_t, size_t count) -> bool {
+    if (receivedBlocks.empty()) {
+      queriesBeforeFirstRange = queriedTails.size();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      receivedBlocks.push_back(blocks[i].blockHash);
+    }
+
+    return true;
+  };
+
+  c.onBlockchainDetachFunctor = [&](uint32_t) {
+    detached = true;
+  };
+
+  m_sync.addObserver(&o1);
+  m_sync.addConsumer(&c);
+  m_sync.start();
+  e.wait();
+  m_sync.stop();
+  m_sync.removeObserver(&o1);
+  o1.syncFunc = [](std::error_code) {};
+
+  EXPECT_EQ(2, queriesBeforeFirstRange);
+  ASSERT_LE(3, queriedTails.size());
+  EXPECT_EQ(queriedTails[1], queriedTails[2]);
+  std::vector<Hash> expectedBlocks;
+  for (size_t i = 1; i < generator.getBlockchain().size(); ++i) {
+    expectedBlocks.push_back(get_block_hash(generator.getBlockchain()[i]));
+  }
+
+  EXPECT_EQ(expectedBlocks, receivedBlocks);
+  EXPECT_FALSE(detached);
+}
+
 TEST_F(BcSTest, checkTxOrder) {
   FunctorialBlockhainConsumerStub c(m_currency.genesisBlockHash());
   IBlockchainSynchronizerFunctorialObserver o1;
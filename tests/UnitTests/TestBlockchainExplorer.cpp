@@ -316,6 +316,86 @@ TEST_F(BlockchainExplorerTests, getBlocksByHashNotInited) {
   ASSERT_ANY_THROW(newExplorer.getBlocks(blockHashes, blocks));
 }
 
+TEST_F(BlockchainExplorerTests, streamBlocksByHeight) {
+  const uint32_t NUMBER_OF_BLOCKS = 120;
+  generator.generateEmptyBlocks(NUMBER_OF_BLOCKS);
+  ASSERT_GE(generator.getBlockchain().size(), NUMBER_OF_BLOCKS);
+
+  std::vector<uint32_t> heights;
+  size_t pages = 0;
+  CallbackStatus status;
+  blockchainExplorer.getBlocks(0, NUMBER_OF_BLOCKS, [&](std::vector<BlockDetails>&& blocks) {
+    ++pages;
+    for (const BlockDetails& block : blocks) {
+      heights.push_back(block.height);
+    }
+    return true;
+  }, [&](std::error_code ec) { status.setStatus(ec); });
+
+  ASSERT_TRUE(status.ok());
+  EXPECT_GT(pages, 1);
+  ASSERT_EQ(NUMBER_OF_BLOCKS, heights.size());
+  for (uint32_t i = 0; i < NUMBER_OF_BLOCKS; ++i) {
+    EXPECT_EQ(i, heights[i]);
+  }
+}
+
+TEST_F(BlockchainExplorerTests, streamBlocksByHeightStoppedByHandler) {
+  const uint32_t NUMBER_OF_BLOCKS = 120;
+  generator.generateEmptyBlocks(NUMBER_OF_BLOCKS);
+
+  size_t pages = 0;
+  CallbackStatus status;
+  blockchainExplorer.getBlocks(0, NUMBER_OF_BLOCKS, [&](std::vector<BlockDetails>&& blocks) {
+    ++pages;
+    return false;
+  }, [&](std::error_code ec) { status.setStatus(ec); });
+
+  ASSERT_TRUE(status.ok());
+  EXPECT_EQ(1, pages);
+}
+
+TEST_F(BlockchainExplorerTests, streamBlocksByHeightFail) {
+  const uint32_t NUMBER_OF_BLOCKS = 10;
+  EXPECT_LT(generator.getBlockchain().size(), NUMBER_OF_BLOCKS);
+
+  CallbackStatus status;
+  blockchainExplorer.getBlocks(0, NUMBER_OF_BLOCKS, [&](std::vector<BlockDetails>&& blocks) {
+    return true;
+  }, [&](std::error_code ec) { status.setStatus(ec); });
+
+  ASSERT_TRUE(status.wait());
+  EXPECT_TRUE(static_cast<bool>(status.getStatus()));
+}
+
+TEST_F(BlockchainExplorerTests, streamBlocksByHeightNotInited) {
+  BlockchainExplorer newExplorer(nodeStub, logger);
+  ASSERT_ANY_THROW(newExplorer.getBlocks(0, 1, [](std::vector<BlockDetails>&& blocks) { return true; }, [](std::error_code) {}));
+}
+
+TEST_F(BlockchainExplorerTests, streamBlocksByHash) {
+  const size_t NUMBER_OF_BLOCKS = 120;
+  generator.generateEmptyBlocks(NUMBER_OF_BLOCKS);
+
+  std::vector<Hash> blockHashes;
+  for (const auto& block : generator.getBlockchain()) {
+    blockHashes.push_back(get_block_hash(block));
+  }
+
+  std::vector<Hash> expectedHashes = blockHashes;
+  std::vector<Hash> hashes;
+  CallbackStatus status;
+  blockchainExplorer.getBlocks(std::move(blockHashes), [&](std::vector<BlockDetails>&& blocks) {
+    for (const BlockDetails& block : blocks) {
+      hashes.push_back(block.hash);
+    }
+    return true;
+  }, [&](std::error_code ec) { status.setStatus(ec); });
+
+  ASSERT_TRUE(status.ok());
+  EXPECT_EQ(expectedHashes, hashes);
+}
+
 TEST_F(BlockchainExplorerTests, getBlockchainTop) {
   BlockDetails topBlock;
 
@@ -29,7 +29,10 @@
 // Parts of this file are originally copyright (c) 2012-2016 The Cryptonote developers
 
 #include "gtest/gtest.h"
+#include <sstream>
 #include <Common/JsonValue.h>
+#include <Serialization/SerializationOverloads.h>
+#include <Serialization/SerializationTools.h>
 
 using Common::JsonValue;
 
@@ -78,3 +81,93 @@ TEST(JsonValue, testBadPatterns) {
   }
 }
 
+
+TEST(JsonValue, keepsWhitespaceAndEscapesInStrings) {
+  JsonValue value = JsonValue::fromString("{\"text\": \"a b\\\"c\\n and a string longer than one vector\"}");
+  ASSERT_EQ("a b\\\"c\\n and a string longer than one vector", value("text").getString());
+  ASSERT_EQ("{\"text\":\"a b\\\"c\\n and a string longer than one vector\"}", value.toString());
+}
+
+TEST(JsonValue, parsesNumbers) {
+  JsonValue value = JsonValue::fromString("[0, -12, 9223372036854775807, 1.5, -0.25, 2.5e2, 1E-2, 3e1]");
+  ASSERT_EQ(0, value[0].getInteger());
+  ASSERT_EQ(-12, value[1].getInteger());
+  ASSERT_EQ(INT64_MAX, value[2].getInteger());
+  ASSERT_DOUBLE_EQ(1.5, value[3].getReal());
+  ASSERT_DOUBLE_EQ(-0.25, value[4].getReal());
+  ASSERT_DOUBLE_EQ(250, value[5].getReal());
+  ASSERT_DOUBLE_EQ(0.01, value[6].getReal());
+  ASSERT_DOUBLE_EQ(30, value[7].getReal());
+  ASSERT_ANY_THROW(JsonValue::fromString("01"));
+  ASSERT_ANY_THROW(JsonValue::fromString("-"));
+  ASSERT_ANY_THROW(JsonValue::fromString("1e"));
+}
+
+TEST(JsonValue, writesObjectMembersSortedAndKeepsLastDuplicate) {
+  JsonValue value = JsonValue::fromString("{\"b\": 1, \"a\": [true, false, null], \"b\": 2.5, \"c\": {}}");
+  ASSERT_EQ(3, value.size());
+  ASSERT_EQ("{\"a\":[true,false,null],\"b\":2.5,\"c\":{}}", value.toString());
+
+  value.insert("b", JsonValue(static_cast<JsonValue::Integer>(7)));
+  ASSERT_DOUBLE_EQ(2.5, value("b").getReal());
+  value.set("aa", JsonValue(static_cast<JsonValue::Integer>(7)));
+  ASSERT_EQ(1, value.erase("c"));
+  ASSERT_EQ("{\"a\":[true,false,null],\"aa\":7,\"b\":2.5}", value.toString());
+}
+
+TEST(JsonValue, streamIsPositionedAfterValue) {
+  std::istringstream stream("  {\"a\": 1}  [2]");
+  JsonValue first;
+  JsonValue second;
+  stream >> first >> second;
+  ASSERT_EQ(1, first("a").getInteger());
+  ASSERT_EQ(2, second[0].getInteger());
+}
+
+namespace {
+
+struct JsonTestItem {
+  uint64_t amount;
+  std::string name;
+
+  void serialize(CryptoNote::ISerializer& s) {
+    KV_MEMBER(amount)
+    KV_MEMBER(name)
+  }
+};
+
+struct JsonTestDocument {
+  int32_t height;
+  bool flag;
+  std::vector<JsonTestItem> items;
+  JsonTestItem last;
+
+  void serialize(CryptoNote::ISerializer& s) {
+    KV_MEMBER(height)
+    KV_MEMBER(flag)
+    KV_MEMBER(items)
+    KV_MEMBER(last)
+  }
+};
+
+}
+
+TEST(JsonValue, bufferSerializerMatchesValueSerializer) {
+  JsonTestDocument document;
+  document.height = -5;
+  document.flag = true;
+  document.items.push_back({ 10, "first" });
+  document.items.push_back({ UINT64_MAX, "second" });
+  document.last = { 3, "third" };
+
+  std::string json = CryptoNote::storeToJson(document);
+  ASSERT_EQ("{\"height\":-5,\"flag\":true,\"items\":[{\"amount\":10,\"name\":\"first\"},"
+    "{\"amount\":-1,\"name\":\"second\"}],\"last\":{\"amount\":3,\"name\":\"third\"}}", json);
+  ASSERT_EQ(CryptoNote::storeToJsonValue(document).toString(), JsonValue::fromString(json).toString());
+
+  JsonTestDocument loaded;
+  ASSERT_TRUE(CryptoNote::loadFromJson(loaded, json));
+  ASSERT_EQ(2, loaded.items.size());
+  ASSERT_EQ(UINT64_MAX, loaded.items[1].amount);
+  ASSERT_EQ("third", loaded.last.name);
+}
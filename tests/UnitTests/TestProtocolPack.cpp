@@ -51,3 +51,33 @@ TEST(protocol_pack, protocol_pack_command)
     ASSERT_TRUE(r.total_height == 3);
   }
 }
+
+TEST(protocol_pack, compactBlockShortIds)
+{
+  CryptoNote::NOTIFY_NEW_COMPACT_BLOCK::request r;
+  r.blockHash = CryptoNote::NULL_HASH;
+  r.block = "header";
+  r.salt = 0x0123456789abcdef;
+  r.current_blockchain_height = 10;
+  r.hop = 2;
+
+  Crypto::Hash txHash = CryptoNote::NULL_HASH;
+  for (uint8_t i = 0; i < 100; ++i) {
+    txHash.data[0] = i;
+    r.shortTxIds.push_back(CryptoNote::getCompactTransactionShortId(r.salt, txHash));
+  }
+
+  std::string buff = CryptoNote::storeToBinaryKeyValue(r);
+
+  CryptoNote::NOTIFY_NEW_COMPACT_BLOCK::request r2;
+  ASSERT_TRUE(CryptoNote::loadFromBinaryKeyValue(r2, buff));
+  ASSERT_EQ(r.block, r2.block);
+  ASSERT_EQ(r.salt, r2.salt);
+  ASSERT_EQ(r.shortTxIds, r2.shortTxIds);
+  ASSERT_EQ(10, r2.current_blockchain_height);
+  ASSERT_EQ(2, r2.hop);
+
+  txHash.data[0] = 5;
+  ASSERT_EQ(r.shortTxIds[5], CryptoNote::getCompactTransactionShortId(r.salt, txHash));
+  ASSERT_NE(r.shortTxIds[5], CryptoNote::getCompactTransactionShortId(r.salt + 1, txHash));
+}
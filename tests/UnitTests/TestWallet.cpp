@@ -34,11 +34,13 @@
 #include <chrono>
 #include <numeric>
 #include <tuple>
+#include <unordered_set>
 
 #include "Common/StringTools.h"
 #include "CryptoNoteCore/Currency.h"
 #include "CryptoNoteCore/TransactionApi.h"
 #include "CryptoNoteCore/TransactionApiExtra.h"
+#include "CryptoNoteCore/TransactionExtra.h"
 #include "INodeStubs.h"
 #include "TestBlockchainGenerator.h"
 #include "TransactionApiHelpers.h"
@@ -721,6 +723,71 @@ TEST_F(WalletApi, transferTooBigMixin) {
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, SENT, FEE, 15));
 }
 
+TEST_F(WalletApi, transferBatchSpendsDifferentOutputsAndReportsErrorsPerTransaction) {
+  //every reward has several outputs that cover a transfer alone, so any selection leaves enough for the rest of the batch
+  for (int i = 0; i < 3; ++i) {
+    generateAndUnlockMoney();
+  }
+
+  CryptoNote::WalletGreen bob(dispatcher, currency, node, TRANSACTION_SOFTLOCK_TIME);
+  bob.initialize("pass2");
+
+  CryptoNote::TransactionParameters params;
+  params.destinations = {{bob.createAddress(), SENT}};
+  params.fee = FEE;
+
+  CryptoNote::TransactionParameters mixinParams = params;
+  mixinParams.mixIn = 4;
+
+  CryptoNote::TransactionParameters invalidParams = params;
+  invalidParams.destinations.clear();
+
+  auto results = alice.transferBatch({params, mixinParams, invalidParams, mixinParams});
+  ASSERT_EQ(4, results.size());
+  ASSERT_EQ(make_error_code(CryptoNote::error::ZERO_DESTINATION), results[2].error);
+  ASSERT_EQ(CryptoNote::WALLET_INVALID_TRANSACTION_ID, results[2].transactionId);
+
+  std::unordered_set<Crypto::KeyImage> keyImages;
+  for (size_t i: {0, 1, 3}) {
+    ASSERT_FALSE(results[i].error);
+    ASSERT_EQ(CryptoNote::WalletTransactionState::SUCCEEDED, alice.getTransaction(results[i].transactionId).state);
+
+    CryptoNote::Transaction tx;
+    ASSERT_TRUE(generator.getTransactionByHash(alice.getTransaction(results[i].transactionId).hash, tx));
+    for (const auto& input: tx.inputs) {
+      ASSERT_TRUE(keyImages.insert(boost::get<CryptoNote::KeyInput>(input).keyImage).second);
+    }
+  }
+
+  bob.shutdown();
+  wait(100);
+}
+
+TEST_F(WalletApi, transferBatchReturnsOutputsOfFailedTransaction) {
+  generateAndUnlockMoney();
+  node.setMaxMixinCount(10);
+
+  CryptoNote::WalletGreen bob(dispatcher, currency, node, TRANSACTION_SOFTLOCK_TIME);
+  bob.initialize("pass2");
+
+  CryptoNote::TransactionParameters failingParams;
+  failingParams.destinations = {{bob.createAddress(), static_cast<int64_t>(alice.getActualBalance() / 4 * 3)}};
+  failingParams.fee = FEE;
+  failingParams.mixIn = 15;
+
+  CryptoNote::TransactionParameters params = failingParams;
+  params.mixIn = 0;
+
+  auto results = alice.transferBatch({failingParams, params});
+  ASSERT_EQ(2, results.size());
+  ASSERT_TRUE(static_cast<bool>(results[0].error));
+  ASSERT_FALSE(results[1].error);
+  ASSERT_EQ(CryptoNote::WalletTransactionState::SUCCEEDED, alice.getTransaction(results[1].transactionId).state);
+
+  bob.shutdown();
+  wait(100);
+}
+
 TEST_F(WalletApi, transferNegativeAmount) {
   generateAndUnlockMoney();
   ASSERT_ANY_THROW(sendMoney(RANDOM_ADDRESS, -static_cast<int64_t>(SENT), FEE));
@@ -2045,6 +2112,47 @@ TEST_F(WalletApi, fusionManagerEstimateNullThreshold) {
   ASSERT_EQ(expectedResult, alice.estimate(0));
 }
 
+TEST_F(WalletApi, fusionManagerEstimateCountsOutputsUnlockedAfterPreviousEstimate) {
+  IFusionManager::EstimateResult emptyResult = {0, 0};
+  ASSERT_EQ(emptyResult, alice.estimate(FUSION_THRESHOLD));
+
+  generateFusionOutputsAndUnlock(alice, node, currency, FUSION_THRESHOLD);
+
+  auto result = alice.estimate(FUSION_THRESHOLD);
+  ASSERT_LE(currency.fusionTxMinInputCount(), result.fusionReadyCount);
+  ASSERT_LE(result.fusionReadyCount, result.totalOutputCount);
+}
+
+TEST_F(WalletApi, fusionManagerEstimateDropsOutputsSpentByFusionTransaction) {
+  generateFusionOutputsAndUnlock(alice, node, currency, FUSION_THRESHOLD);
+
+  auto before = alice.estimate(FUSION_THRESHOLD);
+  ASSERT_NE(WALLET_INVALID_TRANSACTION_ID, alice.createFusionTransaction(FUSION_THRESHOLD, 0));
+
+  auto after = alice.estimate(FUSION_THRESHOLD);
+  ASSERT_LT(after.fusionReadyCount, before.fusionReadyCount);
+  ASSERT_EQ(before.totalOutputCount - after.totalOutputCount, before.fusionReadyCount - after.fusionReadyCount);
+}
+
+TEST_F(WalletApi, fusionPlannerSendsFusionTransactionsWithinBudget) {
+  generateFusionOutputsAndUnlock(alice, node, currency, FUSION_THRESHOLD);
+
+  auto totalBalance = alice.getActualBalance() + alice.getPendingBalance();
+  size_t transactionCount = alice.getTransactionCount();
+
+  alice.startFusionPlanner({FUSION_THRESHOLD, 0, 1, std::chrono::milliseconds(100)});
+  waitForTransactionCount(alice, transactionCount + 1);
+  alice.stopFusionPlanner();
+
+  ASSERT_EQ(transactionCount + 1, alice.getTransactionCount());
+  ASSERT_TRUE(alice.isFusionTransaction(transactionCount));
+  ASSERT_EQ(totalBalance, alice.getActualBalance() + alice.getPendingBalance());
+}
+
+TEST_F(WalletApi, fusionPlannerThrowsIfBudgetIsZero) {
+  ASSERT_ANY_THROW(alice.startFusionPlanner({FUSION_THRESHOLD, 0, 0, std::chrono::milliseconds(100)}));
+}
+
 TEST_F(WalletApi, DISABLED_fusionManagerEstimate) {
   generateAndUnlockMoney();
 
@@ -3058,6 +3166,51 @@ TEST_F(WalletApi, getTransactionsReturnsConfirmedIncomingTransactions) {
   bob.shutdown();
 }
 
+TEST_F(WalletApi, getTransactionsFiltersByPaymentIdAndAddress) {
+  const std::string PAYMENT_ID = "7fb97df81221dd1366051b2d0bc7f49c66c22ac4431d879c895b06d66ef66f4c";
+
+  CryptoNote::WalletGreen bob(dispatcher, currency, node, TRANSACTION_SOFTLOCK_TIME);
+  bob.initialize("pass2");
+  std::string bobAddress = bob.createAddress();
+  std::string bobSecondAddress = bob.createAddress();
+
+  generateAndUnlockMoney();
+
+  std::vector<uint8_t> extra;
+  ASSERT_TRUE(CryptoNote::createTxExtraWithPaymentId(PAYMENT_ID, extra));
+  sendMoney(bobAddress, SENT, FEE, 0, Common::asString(extra));
+  node.updateObservers();
+
+  waitForTransactionCount(bob, 1);
+  waitForWalletEvent(bob, CryptoNote::WalletEventType::SYNC_COMPLETED, std::chrono::seconds(3));
+
+  CryptoNote::TransactionsFilter filter;
+  filter.hasPaymentId = true;
+  ASSERT_TRUE(Common::podFromHex(PAYMENT_ID, filter.paymentId));
+
+  auto transactions = bob.getTransactions(0, generator.getBlockchain().size(), filter);
+  ASSERT_EQ(generator.getBlockchain().size(), transactions.size());
+  ASSERT_EQ(1, getTransactionsCount(transactions));
+  ASSERT_TRUE(transactionWithTransfersFound(bob, transactions, 0));
+
+  filter.addresses = { bobSecondAddress };
+  ASSERT_EQ(0, getTransactionsCount(bob.getTransactions(0, generator.getBlockchain().size(), filter)));
+
+  filter.hasPaymentId = false;
+  filter.addresses = { bobAddress };
+  ASSERT_EQ(1, getTransactionsCount(bob.getTransactions(0, generator.getBlockchain().size(), filter)));
+
+  std::stringstream data;
+  bob.save(data, true, true);
+  bob.shutdown();
+
+  bob.load(data, "pass2");
+  filter.hasPaymentId = true;
+  ASSERT_EQ(1, getTransactionsCount(bob.getTransactions(0, generator.getBlockchain().size(), filter)));
+
+  bob.shutdown();
+}
+
 TEST_F(WalletApi, getTransactionsDoesntReturnFailedTransactions) {
   generateAndUnlockMoney();
 
@@ -39,6 +39,7 @@
 #include "CryptoNoteCore/Currency.h"
 #include "Logging/LoggerGroup.h"
 #include "Logging/ConsoleLogger.h"
+#include <System/Context.h>
 #include <System/Event.h>
 #include "PaymentGate/WalletService.h"
 #include "PaymentGate/WalletServiceErrorCategory.h"
@@ -95,12 +96,15 @@ struct IWalletBaseStub : public CryptoNote::IWallet {
   virtual WalletTransactionWithTransfers getTransaction(const Crypto::Hash& transactionHash) const override { return WalletTransactionWithTransfers(); }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count) const override { return {}; }
   virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const override { return {}; }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(const Crypto::Hash& blockHash, size_t count, const TransactionsFilter& filter) const override { return getTransactions(blockHash, count); }
+  virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count, const TransactionsFilter& filter) const override { return getTransactions(blockIndex, count); }
   virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const override { return {}; }
   virtual uint32_t getBlockCount() const override { return 0; }
   virtual std::vector<WalletTransactionWithTransfers> getUnconfirmedTransactions() const override { return {}; }
   virtual std::vector<size_t> getDelayedTransactionIds() const override { return {}; }
 
   virtual size_t transfer(const TransactionParameters& sendingTransaction) override { return 0; }
+  virtual std::vector<TransferBatchResult> transferBatch(const std::vector<TransactionParameters>& sendingTransactions) override { return {}; }
 
   virtual size_t makeTransaction(const TransactionParameters& sendingTransaction) override { return 0; }
   virtual void commitTransaction(size_t transactionId) override { }
@@ -171,6 +175,7 @@ void WalletServiceTest::SetUp() {
 
   walletConfig.walletFile = "test";
   walletConfig.walletPassword = "test";
+  walletConfig.maxSendTransactions = 0;
 }
 
 std::unique_ptr<WalletService> WalletServiceTest::createWalletService(CryptoNote::IWallet& wallet) {
@@ -354,6 +359,31 @@ TEST_F(WalletServiceTest_getBalance, returnsCorrectBalanceByAddress) {
   ASSERT_EQ(wallet.pendingBalance, pending);
 }
 
+TEST_F(WalletServiceTest_getBalance, readOnlyBatchHoldsLockForOtherContexts) {
+  WalletGetBalanceStub wallet(dispatcher, false);
+  std::unique_ptr<WalletService> service = createWalletService(wallet);
+
+  uint64_t actual;
+  uint64_t pending;
+  service->beginReadOnlyBatch();
+  ASSERT_FALSE(service->getBalance(actual, pending));
+
+  bool otherContextDone = false;
+  System::Context<> other(dispatcher, [&] {
+    uint64_t otherActual;
+    uint64_t otherPending;
+    service->getBalance(otherActual, otherPending);
+    otherContextDone = true;
+  });
+
+  dispatcher.yield();
+  ASSERT_FALSE(otherContextDone);
+
+  service->endReadOnlyBatch();
+  other.get();
+  ASSERT_TRUE(otherContextDone);
+}
+
 class WalletServiceTest_getBlockHashes : public WalletServiceTest {
 protected:
   std::vector<Crypto::Hash> convertBlockHashes(const std::vector<std::string>& hashes) {
@@ -825,6 +855,36 @@ TEST_F(WalletServiceTest_sendTransaction, incorrectTransferAddress) {
   ASSERT_EQ(make_error_code(CryptoNote::error::BAD_ADDRESS), ec);
 }
 
+struct WalletTransferBatchStub : public WalletTransferStub {
+  WalletTransferBatchStub(System::Dispatcher& dispatcher, const Crypto::Hash& hash) : WalletTransferStub(dispatcher, hash), batchCalls(0) {
+  }
+
+  virtual std::vector<TransferBatchResult> transferBatch(const std::vector<TransactionParameters>& sendingTransactions) override {
+    ++batchCalls;
+    return std::vector<TransferBatchResult>(sendingTransactions.size());
+  }
+
+  size_t batchCalls;
+};
+
+TEST_F(WalletServiceTest_sendTransaction, sendTransactionsRejectsMoreThanMaximum) {
+  walletConfig.maxSendTransactions = 2;
+  WalletTransferBatchStub wallet(dispatcher, generateRandomHash());
+  auto service = createWalletService(wallet);
+
+  std::vector<SendTransaction::Request> requests(3, request);
+  std::vector<SendTransactions::TransactionResult> results;
+  auto ec = service->sendTransactions(requests, results);
+  ASSERT_EQ(make_error_code(CryptoNote::error::WalletServiceErrorCode::TOO_MANY_TRANSACTIONS), ec);
+  ASSERT_EQ(0, wallet.batchCalls);
+
+  requests.pop_back();
+  ec = service->sendTransactions(requests, results);
+  ASSERT_FALSE(ec);
+  ASSERT_EQ(2, results.size());
+  ASSERT_EQ(1, wallet.batchCalls);
+}
+
 class WalletServiceTest_createDelayedTransaction : public WalletServiceTest_getTransactions {
   virtual void SetUp() override;
 protected:
@@ -37,6 +37,7 @@
 #include "CryptoNoteCore/CryptoNoteFormatUtils.h" // TODO: delete
 #include "CryptoNoteCore/Account.h"
 #include "crypto/crypto.h"
+#include "Common/ParallelFor.h"
 #include "TransactionApiHelpers.h"
 
 using namespace CryptoNote;
@@ -163,6 +164,64 @@ TEST_F(TransactionApi, addAndSignInput) {
   EXPECT_NO_FATAL_FAILURE(checkHashChanged());
 }
 
+TEST_F(TransactionApi, addAndSignInputsInParallel) {
+  const size_t INPUT_COUNT = 8;
+
+  std::vector<std::pair<TransactionTypes::InputKeyInfo, KeyPair>> inputs;
+  for (size_t i = 0; i < INPUT_COUNT; ++i) {
+    TransactionTypes::InputKeyInfo info = createInputInfo(1000);
+    // decoys make the ring draw more than one scalar
+    for (uint32_t j = 1; j <= 2; ++j) {
+      TransactionTypes::GlobalOutput decoy = { CryptoNote::generateKeyPair().publicKey, j };
+      info.outputs.push_back(decoy);
+    }
+
+    KeyPair ephKeys;
+    ASSERT_EQ(i, tx->addInput(sender, info, ephKeys));
+    inputs.emplace_back(info, ephKeys);
+  }
+
+  ASSERT_FALSE(tx->validateSignatures());
+
+  tx->signInputKeys(inputs, 4);
+
+  ASSERT_TRUE(tx->validateSignatures());
+  EXPECT_NO_FATAL_FAILURE(checkHashChanged());
+
+  // with the randomness drawn once, signing on one thread and on several gives the same bytes
+  Hash prefixHash = tx->getTransactionPrefixHash();
+  std::vector<KeyInput> keyInputs(INPUT_COUNT);
+  std::vector<std::vector<const PublicKey*>> keysPtrs(INPUT_COUNT);
+  std::vector<std::vector<Crypto::EllipticCurveScalar>> randomness(INPUT_COUNT);
+  for (size_t i = 0; i < INPUT_COUNT; ++i) {
+    tx->getInput(i, keyInputs[i]);
+    for (const auto& o : inputs[i].first.outputs) {
+      keysPtrs[i].push_back(&o.targetKey);
+    }
+
+    randomness[i].resize(Crypto::ring_signature_randomness_size(keysPtrs[i].size()));
+    Crypto::generate_ring_signature_randomness(keysPtrs[i].size(), randomness[i].data());
+  }
+
+  auto sign = [&](size_t threadCount) {
+    std::vector<std::vector<Signature>> signatures(INPUT_COUNT);
+    Common::parallelFor(INPUT_COUNT, threadCount, [&](size_t i) {
+      signatures[i].resize(keysPtrs[i].size());
+      Crypto::generate_ring_signature(prefixHash, keyInputs[i].keyImage, keysPtrs[i].data(), keysPtrs[i].size(),
+        inputs[i].second.secretKey, inputs[i].first.realOutput.transactionIndex, randomness[i].data(), signatures[i].data());
+    });
+
+    return signatures;
+  };
+
+  auto sequential = sign(1);
+  auto parallel = sign(4);
+  for (size_t i = 0; i < INPUT_COUNT; ++i) {
+    ASSERT_EQ(sequential[i].size(), parallel[i].size());
+    ASSERT_EQ(0, memcmp(sequential[i].data(), parallel[i].data(), sequential[i].size() * sizeof(Signature)));
+  }
+}
+
 TEST_F(TransactionApi, addAndSignInputMsig) {
 
   MultisignatureInput inputMsig;
@@ -0,0 +1,357 @@
+// Copyright (c) 2021-2022, The TuringX Project
+// 
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without modification, are
+// permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this list of
+//    conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list
+//    of conditions and the following disclaimer in the documentation and/or other
+//    materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its contributors may be
+//    used to endorse or promote products derived from this software without specific
+//    prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+// THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+// STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+// THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include <boost/filesystem.hpp>
+
+#include <Logging/LoggerGroup.h>
+#include <System/Context.h>
+#include <System/Dispatcher.h>
+#include <System/Timer.h>
+
+#include "CryptoNoteCore/Account.h"
+#include "CryptoNoteCore/Core.h"
+#include "CryptoNoteCore/CoreConfig.h"
+#include "CryptoNoteCore/CryptoNoteFormatUtils.h"
+#include "CryptoNoteCore/CryptoNoteTools.h"
+#include "CryptoNoteCore/Currency.h"
+#include "CryptoNoteCore/MinerConfig.h"
+#include "CryptoNoteCore/TransactionExtra.h"
+#include "CryptoNoteProtocol/CryptoNoteProtocolHandler.h"
+#include "NodeRpcProxy/NodeRpcProxy.h"
+#include "P2p/NetNode.h"
+#include "Rpc/HttpClient.h"
+#include "Rpc/RpcServer.h"
+#include "Serialization/SerializationTools.h"
+
+#include "../TestGenerator/TestGenerator.h"
+#include "ICryptoNoteProtocolQueryStub.h"
+
+using namespace CryptoNote;
+
+namespace {
+
+const uint16_t DAEMON_TEST_PORT = 16702;
+const uint16_t LEGACY_DAEMON_TEST_PORT = 16703;
+
+// Runs the dispatcher until the condition holds or five seconds pass
+bool waitFor(System::Dispatcher& dispatcher, const std::function<bool()>& condition) {
+  System::Timer timer(dispatcher);
+  for (size_t i = 0; i < 100 && !condition(); ++i) {
+    timer.sleep(std::chrono::milliseconds(50));
+  }
+
+  return condition();
+}
+
+class PoolObserver : public INodeObserver {
+public:
+  PoolObserver() : poolChanges(0) {
+  }
+
+  virtual void poolChanged() override {
+    ++poolChanges;
+  }
+
+  std::atomic<size_t> poolChanges;
+};
+
+// A daemon that predates /wait_for_changes.bin and doesn't serve anything the proxy asks for
+class LegacyNodeServer : public HttpServer {
+public:
+  LegacyNodeServer(System::Dispatcher& dispatcher, Logging::ILogger& log) : HttpServer(dispatcher, log), waitRequests(0), poolRequests(0) {
+  }
+
+  virtual void processRequest(const HttpRequest& request, HttpResponse& response) override {
+    if (request.getUrl() == "/wait_for_changes.bin") {
+      ++waitRequests;
+    } else if (request.getUrl() == "/get_pool_changes_lite.bin") {
+      ++poolRequests;
+    }
+
+    response.setStatus(HttpResponse::STATUS_404);
+  }
+
+  size_t waitRequests;
+  size_t poolRequests;
+};
+
+class WaitForChangesTest : public ::testing::Test {
+public:
+  WaitForChangesTest() :
+    currency(CurrencyBuilder(logger).testnet(true).currency()),
+    generator(currency),
+    c(currency, nullptr, logger),
+    protocol(currency, dispatcher, c, nullptr, logger),
+    p2p(dispatcher, protocol, logger),
+    server(dispatcher, logger, c, p2p, protocolQuery),
+    tail(currency.genesisBlock()) {
+    miner.generate();
+    configFolder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("test_data_%%%%%%%%%%%%");
+    std::vector<size_t> blockSizes;
+    generator.addBlock(currency.genesisBlock(), 0, 0, blockSizes, 0);
+  }
+
+  virtual void SetUp() override {
+    CoreConfig coreConfig;
+    coreConfig.configFolder = configFolder.string();
+    ASSERT_TRUE(c.init(coreConfig, MinerConfig(), false));
+    server.start("127.0.0.1", DAEMON_TEST_PORT);
+  }
+
+  virtual void TearDown() override {
+    server.stop();
+    c.deinit();
+    boost::system::error_code ignoredErrorCode;
+    boost::filesystem::remove_all(configFolder, ignoredErrorCode);
+  }
+
+  bool pushBlock() {
+    Block block;
+    if (!generator.constructBlock(block, tail, miner)) {
+      return false;
+    }
+
+    block_verification_context bvc = boost::value_initialized<block_verification_context>();
+    if (!c.handle_incoming_block_blob(toBinaryArray(block), bvc, false, false) || bvc.m_verifivation_failed) {
+      return false;
+    }
+
+    tail = block;
+    return true;
+  }
+
+  bool pushBlocks(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if (!pushBlock()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Spends the largest output of the block's coinbase back to the miner
+  bool addPoolTransaction(const Block& block) {
+    const Transaction& coinbase = block.baseTransaction;
+    std::vector<uint32_t> globalIndexes;
+    if (!c.get_tx_outputs_gindexs(getObjectHash(coinbase), globalIndexes)) {
+      return false;
+    }
+
+    size_t outputIndex = 0;
+    for (size_t i = 1; i < coinbase.outputs.size(); ++i) {
+      if (coinbase.outputs[i].amount > coinbase.outputs[outputIndex].amount) {
+        outputIndex = i;
+      }
+    }
+
+    TransactionSourceEntry source;
+    source.outputs.push_back({ globalIndexes[outputIndex], boost::get<KeyOutput>(coinbase.outputs[outputIndex].target).key });
+    source.realOutput = 0;
+    source.realTransactionPublicKey = getTransactionPublicKeyFromExtra(coinbase.extra);
+    source.realOutputIndexInTransaction = outputIndex;
+    source.amount = coinbase.outputs[outputIndex].amount;
+
+    TransactionDestinationEntry destination(source.amount - currency.minimumFee(), miner.getAccountKeys().address);
+
+    Transaction transaction;
+    if (!constructTransaction(miner.getAccountKeys(), { source }, { destination }, {}, transaction, 0, logger)) {
+      return false;
+    }
+
+    tx_verification_context tvc = boost::value_initialized<tx_verification_context>();
+    return c.handle_incoming_tx(toBinaryArray(transaction), tvc, false) && tvc.m_added_to_pool;
+  }
+
+  COMMAND_RPC_WAIT_FOR_CHANGES::response waitForChanges(uint32_t timeout) {
+    COMMAND_RPC_WAIT_FOR_CHANGES::request req;
+    req.tailBlockId = get_block_hash(tail);
+    req.timeout = timeout;
+
+    HttpClient client(dispatcher, "127.0.0.1", DAEMON_TEST_PORT);
+    HttpRequest httpReq;
+    HttpResponse httpRes;
+    httpReq.setUrl("/wait_for_changes.bin");
+    httpReq.setBody(storeToBinaryKeyValue(req));
+    client.request(httpReq, httpRes);
+
+    COMMAND_RPC_WAIT_FOR_CHANGES::response rsp;
+    EXPECT_EQ(HttpResponse::STATUS_200, httpRes.getStatus());
+    EXPECT_TRUE(loadFromBinaryKeyValue(rsp, httpRes.getBody()));
+    return rsp;
+  }
+
+  // Starts the proxy and runs the server until the proxy has caught up with the tail and parked its long-poll request
+  bool startProxy(NodeRpcProxy& proxy) {
+    std::atomic<bool> initialized(false);
+    proxy.init([&initialized](std::error_code ec) { initialized = !ec; });
+
+    uint32_t tailIndex = c.get_current_blockchain_height() - 1;
+    if (!waitFor(dispatcher, [&] { return initialized && proxy.getLastLocalBlockHeight() == tailIndex; })) {
+      return false;
+    }
+
+    System::Timer(dispatcher).sleep(std::chrono::milliseconds(200));
+    return true;
+  }
+
+protected:
+  System::Dispatcher dispatcher;
+  Logging::LoggerGroup logger;
+  Currency currency;
+  test_generator generator;
+  AccountBase miner;
+  core c;
+  CryptoNoteProtocolHandler protocol;
+  NodeServer p2p;
+  ICryptoNoteProtocolQueryStub protocolQuery;
+  RpcServer server;
+  Block tail;
+  boost::filesystem::path configFolder;
+};
+
+}
+
+TEST_F(WaitForChangesTest, wakesOnPoolChange) {
+  ASSERT_TRUE(pushBlock());
+  Block spendable = tail;
+  ASSERT_TRUE(pushBlocks(currency.minedMoneyUnlockWindow()));
+
+  bool added = false;
+  System::Context<> poolContext(dispatcher, [&] {
+    System::Timer(dispatcher).sleep(std::chrono::milliseconds(100));
+    added = addPoolTransaction(spendable);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(10000);
+  poolContext.get();
+
+  ASSERT_TRUE(added);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_TRUE(rsp.isTailBlockActual);
+  ASSERT_EQ(1, rsp.addedTxs.size());
+  ASSERT_TRUE(rsp.deletedTxsIds.empty());
+}
+
+TEST_F(WaitForChangesTest, wakesOnTailChange) {
+  ASSERT_TRUE(pushBlock());
+
+  COMMAND_RPC_WAIT_FOR_CHANGES::response rsp;
+  auto start = std::chrono::steady_clock::now();
+  {
+    System::Context<> waitContext(dispatcher, [&] { rsp = waitForChanges(10000); });
+    System::Timer(dispatcher).sleep(std::chrono::milliseconds(100));
+    Block previous = tail;
+    ASSERT_TRUE(pushBlock());
+    tail = previous;
+    waitContext.get();
+  }
+
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_FALSE(rsp.isTailBlockActual);
+}
+
+TEST_F(WaitForChangesTest, timeoutReturnsEmptyDelta) {
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(200);
+
+  ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+  ASSERT_EQ(CORE_RPC_STATUS_OK, rsp.status);
+  ASSERT_TRUE(rsp.isTailBlockActual);
+  ASSERT_TRUE(rsp.addedTxs.empty());
+  ASSERT_TRUE(rsp.deletedTxsIds.empty());
+}
+
+TEST_F(WaitForChangesTest, timeoutIsCapped) {
+  server.maxWaitForChangesTimeout(200);
+
+  auto start = std::chrono::steady_clock::now();
+  auto rsp = waitForChanges(std::numeric_limits<uint32_t>::max());
+
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_TRUE(rsp.isTailBlockActual);
+  ASSERT_TRUE(rsp.addedTxs.empty());
+}
+
+TEST_F(WaitForChangesTest, proxyAppliesPoolChangeFromParkedRequest) {
+  ASSERT_TRUE(pushBlock());
+  Block spendable = tail;
+  ASSERT_TRUE(pushBlocks(currency.minedMoneyUnlockWindow()));
+
+  // only the parked request can deliver the change in time, the fallback poll is a minute away
+  NodeRpcProxy proxy("127.0.0.1", DAEMON_TEST_PORT);
+  proxy.pullInterval(60000);
+  proxy.longPollTimeout(30000);
+  PoolObserver observer;
+  proxy.addObserver(&observer);
+  ASSERT_TRUE(startProxy(proxy));
+
+  ASSERT_TRUE(addPoolTransaction(spendable));
+  ASSERT_TRUE(waitFor(dispatcher, [&observer] { return observer.poolChanges > 0; }));
+
+  proxy.removeObserver(&observer);
+  proxy.shutdown();
+}
+
+TEST_F(WaitForChangesTest, proxyShutdownInterruptsParkedRequest) {
+  ASSERT_TRUE(pushBlock());
+
+  NodeRpcProxy proxy("127.0.0.1", DAEMON_TEST_PORT);
+  proxy.pullInterval(60000);
+  proxy.longPollTimeout(60000);
+  ASSERT_TRUE(startProxy(proxy));
+
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(proxy.shutdown());
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(NodeRpcProxyLongPoll, fallsBackToPollingWhenNodeAnswers404) {
+  System::Dispatcher dispatcher;
+  Logging::LoggerGroup logger;
+  LegacyNodeServer server(dispatcher, logger);
+  server.start("127.0.0.1", LEGACY_DAEMON_TEST_PORT);
+
+  NodeRpcProxy proxy("127.0.0.1", LEGACY_DAEMON_TEST_PORT);
+  proxy.pullInterval(50);
+  proxy.init([](std::error_code) {});
+
+  ASSERT_TRUE(waitFor(dispatcher, [&server] { return server.poolRequests >= 4; }));
+  ASSERT_EQ(1, server.waitRequests);
+
+  proxy.shutdown();
+  server.stop();
+}